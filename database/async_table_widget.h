@@ -7,9 +7,22 @@
 #include <memory>
 #include <any>
 #include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <optional>
 #include <set>
+#include <thread>
+#include <unordered_set>
 #include <iostream>
 #include "imgui.h"
+#include "cell_change_tracker.h"
+#include "perf_counters.h"
+#include "row_grouper.h"
+#include "style_rules.h"
+#include "table_export.h"
+#include "trace.h"
 
 namespace db {
 
@@ -28,12 +41,17 @@ namespace db {
  * - ImGuiListClipper for efficient large lists
  * - Frozen header row / frozen left columns
  * - Row selection (single or multi via ImGui MultiSelect API)
- * - Per-row and per-cell background colors
+ * - Per-row and per-cell colors: rule-based (precomputed in Refresh) or callbacks
  * - Right-click context menu callback
  * - Scroll-to-row support
  * - Column hide/show, stretch modes, horizontal scroll
  * - Customizable column formatters and renderers
  * - Background refresh support
+ * - Streaming refresh: rows are published in growing chunks while the query runs
+ * - Views over a SharedRowStore: several widgets share one refcounted copy of the rows
+ * - Grouped mode: collapsible multi-level group rows with incrementally maintained aggregates
+ * - Change highlighting: changed cells flash (up/down for numeric columns) and fade out
+ * - Background export of the displayed rows or the selection to CSV/TSV/columnar files
  *
  * Example (sqlpp23 integration):
  *   struct FooData { int64_t id; std::string name; bool active; };
@@ -170,10 +188,149 @@ public:
         int direction = ImGuiSortDirection_None; // ImGuiSortDirection_Ascending or _Descending
     };
 
+    /**
+     * @brief Progressive result of a streaming refresh (immutable once published)
+     *
+     * Rows live in chunks shared between successive snapshots, so publishing another
+     * chunk costs O(chunks) rather than O(rows). `order` is an optional display
+     * permutation (sorted and/or filtered row indices); views over a SharedRowStore
+     * share the store's chunks and only own their `order`.
+     */
+    struct StreamSnapshot {
+        std::vector<std::shared_ptr<const std::vector<Row>>> chunks;
+        std::vector<size_t> chunkEnds; // cumulative row count after each chunk
+        std::vector<size_t> order;
+        size_t rowCount = 0; // rows displayed (order.size() when order is set)
+        bool complete = false;
+
+        const Row& RowAt(size_t displayIdx) const { return StoredRow(order.empty() ? displayIdx : order[displayIdx]); }
+
+        /// Row by arrival index (ignores `order`)
+        const Row& StoredRow(size_t idx) const {
+            size_t chunk = std::upper_bound(chunkEnds.begin(), chunkEnds.end(), idx) - chunkEnds.begin();
+            size_t chunkStart = chunk == 0 ? 0 : chunkEnds[chunk - 1];
+            return (*chunks[chunk])[idx - chunkStart];
+        }
+    };
+
+    /**
+     * @brief Row sink handed to the streaming refresh callback (background thread)
+     *
+     * Push() buffers rows and publishes them to the GUI in chunks: the first row is
+     * published immediately, then chunk sizes double up to the configured chunk size;
+     * rows pending for more than kMaxPublishDelay are published regardless. While a
+     * previous complete result is displayed, chunks are only published once the new
+     * stream has at least as many rows (or is complete), so a periodic refresh does not
+     * collapse the table to its first rows and lose the scroll position and selection.
+     *
+     * Producers should poll Cancelled() (StreamStatement does this for SQLite) and stop
+     * early once the stream is superseded by a newer refresh, CancelStreaming() or a
+     * sort change.
+     */
+    class StreamSink {
+    public:
+        static constexpr std::chrono::milliseconds kMaxPublishDelay{50};
+
+        void Push(Row&& row) {
+            if (m_pending.empty()) m_pendingSince = std::chrono::steady_clock::now();
+            m_pending.push_back(std::move(row));
+            if (m_pending.size() >= m_nextChunkRows ||
+                std::chrono::steady_clock::now() - m_pendingSince >= kMaxPublishDelay) {
+                Publish(false);
+                m_nextChunkRows = std::min(m_nextChunkRows * 2, m_maxChunkRows);
+            }
+        }
+
+        bool Cancelled() const {
+            return m_widget.m_streamGeneration.load(std::memory_order_acquire) != m_generation ||
+                   m_widget.m_sortSpecsDirty.load(std::memory_order_acquire);
+        }
+
+        /// Sort order requested by the user when the stream started (may be empty)
+        const std::vector<SortSpec>& SortSpecs() const { return m_sortSpecs; }
+
+        /// Declare that rows arrive already ordered by SortSpecs() (e.g. via SQL ORDER BY)
+        void SetSortedBySource(bool sorted = true) { m_sortedBySource = sorted; }
+
+        /// Rows pushed so far (published or pending)
+        size_t RowCount() const { return m_published ? m_published->rowCount + m_pending.size() : m_pending.size(); }
+
+    private:
+        friend class AsyncTableWidget;
+
+        StreamSink(AsyncTableWidget& widget, uint64_t generation, size_t maxChunkRows)
+            : m_widget(widget), m_generation(generation), m_maxChunkRows(std::max<size_t>(maxChunkRows, 1)),
+              m_holdRows(widget.CompleteRowCount()) {
+            int count = widget.m_sortSpecCount.load(std::memory_order_acquire);
+            m_sortSpecs.assign(widget.m_sortSpecs, widget.m_sortSpecs + count);
+        }
+
+        void Publish(bool complete) {
+            if (Cancelled()) return;
+            auto next = std::make_shared<StreamSnapshot>();
+            if (m_published) {
+                next->chunks = m_published->chunks;
+                next->chunkEnds = m_published->chunkEnds;
+                next->rowCount = m_published->rowCount;
+            }
+            if (!m_pending.empty()) {
+                next->rowCount += m_pending.size();
+                next->chunks.push_back(std::make_shared<const std::vector<Row>>(std::move(m_pending)));
+                next->chunkEnds.push_back(next->rowCount);
+                m_pending = {};
+                m_pending.reserve(std::min(m_nextChunkRows * 2, m_maxChunkRows));
+            }
+            if (complete && !m_sortedBySource && !m_sortSpecs.empty() &&
+                m_widget.CanSort(m_sortSpecs.data(), (int)m_sortSpecs.size())) {
+                next->order.resize(next->rowCount);
+                for (size_t i = 0; i < next->rowCount; i++) next->order[i] = i;
+                std::stable_sort(next->order.begin(), next->order.end(), [&](size_t a, size_t b) {
+                    return m_widget.RowLess(next->StoredRow(a), next->StoredRow(b), m_sortSpecs.data(),
+                                            (int)m_sortSpecs.size());
+                });
+            }
+            next->complete = complete;
+            m_published = next;
+            if (!complete && next->rowCount < m_holdRows) return; // keep showing the previous result
+            std::atomic_store_explicit(&m_widget.m_streamSnapshot, std::shared_ptr<const StreamSnapshot>(next),
+                                       std::memory_order_release);
+        }
+
+        AsyncTableWidget& m_widget;
+        uint64_t m_generation;
+        size_t m_maxChunkRows;
+        size_t m_nextChunkRows = 1;
+        std::vector<Row> m_pending;
+        std::chrono::steady_clock::time_point m_pendingSince;
+        std::vector<SortSpec> m_sortSpecs;
+        bool m_sortedBySource = false;
+        size_t m_holdRows; // rows of the complete result displayed when the stream started
+        std::shared_ptr<StreamSnapshot> m_published;
+    };
+
+    /**
+     * @brief Streaming refresh callback: push rows into the sink as they are produced
+     */
+    using StreamingRefreshCallback = std::function<void(StreamSink&)>;
+
+    /**
+     * @brief Shared row source for view mode (see SharedRowStore::AttachView)
+     *
+     * Returns the current immutable snapshot (without `order`), or null if none yet.
+     */
+    using RowSource = std::function<std::shared_ptr<const StreamSnapshot>()>;
+
+    /**
+     * @brief View predicate: rows for which it returns false are hidden
+     */
+    using RowFilter = std::function<bool(const Row&)>;
+
 private:
     // Double buffer for rows
     std::vector<Row> m_buffers[2];
     std::atomic<int> m_frontIndex{0};
+    // Per buffer: -1 = being written (Refresh/SetData/Clear), > 0 = pinned by running exports
+    std::atomic<int> m_bufferState[2] = {0, 0};
 
     // Column definitions
     std::vector<ColumnConfig> m_columns;
@@ -181,6 +338,59 @@ private:
     // Refresh callback (called on background thread)
     std::function<void(std::vector<Row>&)> m_refreshCallback;
 
+    // Skip unchanged refreshes (SetRefreshVersionCallback). The epoch is bumped by setters
+    // that change how rows are derived; m_refreshed* belong to the refreshing thread.
+    std::function<uint64_t()> m_refreshVersion;
+    std::atomic<uint64_t> m_refreshEpoch{1};
+    uint64_t m_refreshedEpoch = 0;
+    uint64_t m_refreshedVersion = 0;
+
+    // Streaming refresh (takes precedence over m_refreshCallback when set). While
+    // m_streamSnapshot is non-null it is displayed instead of the double buffer.
+    StreamingRefreshCallback m_streamingCallback;
+    size_t m_streamChunkRows = 4096;
+    std::atomic<uint64_t> m_streamGeneration{0};
+    std::shared_ptr<const StreamSnapshot> m_streamSnapshot; // accessed via std::atomic_load/atomic_store
+
+    // View mode (takes precedence over both refresh callbacks when set): the widget only
+    // owns a permutation of the source rows, a filter bitmap and its selection.
+    RowSource m_rowSource;
+    RowFilter m_rowFilter;
+    std::shared_ptr<const StreamSnapshot> m_viewSource; // source the current view was built from
+    std::vector<uint64_t> m_viewFilterBits;             // bit i: source row i passes m_rowFilter
+    std::atomic<bool> m_viewFilterDirty{false};
+
+    // Grouped mode (plain refresh only): grouper lives on the refresh thread; each buffer has
+    // the group layout computed for it. Expansion state is GUI-thread only.
+    std::unique_ptr<RowGrouper<Row>> m_grouper;
+    std::shared_ptr<const GroupSnapshot> m_groupSnapshots[2];
+    std::unordered_set<std::string> m_expandedGroups;
+
+    // Change highlighting (plain refresh only): the tracker diffs each refresh against the
+    // front buffer on the refresh thread; each buffer has the change marks computed for it.
+    std::unique_ptr<CellChangeTracker<Row>> m_changeTracker;
+    std::shared_ptr<const CellChangeSnapshot> m_cellChanges[2];
+    float m_changeFadeSeconds = 1.0f;
+    ImU32 m_changeColors[4] = {0, IM_COL32(200, 170, 40, 140), IM_COL32(40, 170, 60, 140), IM_COL32(200, 50, 50, 140)};
+
+    // Rule-based styling: evaluated on the refresh thread, one style array per buffer
+    RowStyler m_styler;
+    std::shared_ptr<const StyleSnapshot> m_styles[2];
+
+    // Background export (started and joined on the GUI thread)
+    std::shared_ptr<ExportJob> m_exportJob;
+    std::thread m_exportThread;
+    size_t m_clipboardLimit = 8 << 20;
+    std::string m_clipboardFallbackPath;
+
+    // Called on the GUI thread when the user changes the sort (e.g. to wake the refresh thread)
+    std::function<void()> m_sortChangedCallback;
+
+    // Optional perf counters (registered via SetPerfName)
+    PerfDuration* m_perfRefresh = nullptr;
+    PerfDuration* m_perfRender = nullptr;
+    std::string m_perfName; // also used as the trace span detail
+
     // ImGui table state
     std::string m_tableId;
     ImGuiTableFlags m_tableFlags = ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY |
@@ -226,6 +436,11 @@ public:
         m_tableId = "AsyncTable##" + std::to_string(s_tableCounter++);
     }
 
+    ~AsyncTableWidget() {
+        if (m_exportJob) m_exportJob->Cancel();
+        if (m_exportThread.joinable()) m_exportThread.join();
+    }
+
     /**
      * @brief Add a column to the table
      *
@@ -243,6 +458,9 @@ public:
         m_columns.push_back(col);
     }
 
+    /// Number of columns added so far
+    size_t GetColumnCount() const { return m_columns.size(); }
+
     /**
      * @brief Set the refresh callback
      *
@@ -251,7 +469,213 @@ public:
      *
      * @param callback Function that fills vector with updated rows
      */
-    void SetRefreshCallback(std::function<void(std::vector<Row>&)> callback) { m_refreshCallback = callback; }
+    void SetRefreshCallback(std::function<void(std::vector<Row>&)> callback) {
+        m_refreshCallback = callback;
+        InvalidateRefreshVersion();
+    }
+
+    /**
+     * @brief Let Refresh() skip work when the source reports no change
+     *
+     * The callback returns a version of everything the refresh callback reads (e.g. the
+     * model's write generation combined with a query revision). When it equals the
+     * version the displayed rows were built from and the sort specs are unchanged,
+     * Refresh() returns without calling the refresh callback, sorting, grouping,
+     * styling or change tracking, so idle periodic refreshes cost one call. Changing
+     * grouping, style rules or change highlighting forces the next refresh.
+     * Applies to the plain refresh callback.
+     */
+    void SetRefreshVersionCallback(std::function<uint64_t()> version) {
+        m_refreshVersion = std::move(version);
+        InvalidateRefreshVersion();
+    }
+
+    /**
+     * @brief Set a streaming refresh callback (replaces the plain refresh callback)
+     *
+     * Refresh() then runs the callback with a StreamSink; rows become visible in chunks
+     * while the callback is still producing them, so time to first row does not depend
+     * on result size. Starting a new Refresh(), CancelStreaming() or a sort change
+     * cancels the running stream.
+     *
+     * SQLite streams (StreamStatement) install a progress handler on the whole connection,
+     * so they need a read connection of their own, not the shared GetRawHandle().
+     *
+     * Example:
+     *   auto reader = std::shared_ptr<sqlite3>(DatabaseManager::Get().OpenWorkerConnection());
+     *   widget.SetStreamingRefreshCallback([reader](AsyncTableWidget::StreamSink& sink) {
+     *       FooCodec::Stream(reader.get(), sink);
+     *   });
+     *
+     * @param chunkRows Maximum rows per published chunk
+     */
+    void SetStreamingRefreshCallback(StreamingRefreshCallback callback, size_t chunkRows = 4096) {
+        m_streamingCallback = std::move(callback);
+        m_streamChunkRows = chunkRows;
+    }
+
+    /**
+     * @brief Make this widget a view over a shared row source
+     *
+     * Refresh() then no longer produces rows: it rebuilds the view's sorted/filtered
+     * index permutation when the source snapshot, the sort or the filter changed, and is
+     * a no-op otherwise. Usually set through SharedRowStore::AttachView().
+     */
+    void SetRowSource(RowSource source) {
+        m_rowSource = std::move(source);
+        m_viewSource.reset();
+    }
+
+    /**
+     * @brief Set the view predicate (view mode only; applied on the next Refresh())
+     *
+     * Call before the first Refresh() or from the thread that calls Refresh().
+     */
+    void SetRowFilter(RowFilter filter) {
+        m_rowFilter = std::move(filter);
+        m_viewFilterDirty.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Group rows on one or more columns, with aggregate header rows
+     *
+     * Group keys are the displayed strings of groupColumns (outermost first). Each
+     * aggregate reads its column's typed extractor (int64/int/double/bool) and is shown
+     * in that column of the group header rows. With a rowKey, each Refresh() only patches
+     * the groups of rows that were inserted, changed or removed; rows within a group keep
+     * the widget's sort order. Applies to the plain refresh callback (not streaming or
+     * view mode). Call after SetColumnTypedExtractor() and before Refresh() runs.
+     *
+     * Example:
+     *   widget.EnableGrouping({1, 2}, {{4, AggregateOp::Count}, {4, AggregateOp::Last}, {4, AggregateOp::Max}},
+     *                         [](const Row& r) { return (uint64_t)std::any_cast<const Tick&>(r.userData).id; });
+     */
+    void EnableGrouping(std::vector<int> groupColumns, std::vector<AggregateSpec> aggregates,
+                        RowGrouper<Row>::RowKeyFn rowKey = nullptr) {
+        std::vector<RowGrouper<Row>::ValueFn> values;
+        for (const auto& agg : aggregates) {
+            TypedExtractor extractor;
+            if (agg.column >= 0 && agg.column < (int)m_columns.size()) {
+                extractor = m_columns[agg.column].typedExtractor;
+            }
+            if (!extractor || agg.op == AggregateOp::Count) {
+                values.emplace_back();
+                continue;
+            }
+            values.emplace_back([extractor](const Row& row) { return NumericValue(extractor(row)); });
+        }
+        m_grouper = std::make_unique<RowGrouper<Row>>(std::move(groupColumns), std::move(aggregates),
+                                                      std::move(values), std::move(rowKey));
+        m_groupSnapshots[0].reset();
+        m_groupSnapshots[1].reset();
+        InvalidateRefreshVersion();
+    }
+
+    void DisableGrouping() {
+        m_grouper.reset();
+        m_groupSnapshots[0].reset();
+        m_groupSnapshots[1].reset();
+        InvalidateRefreshVersion();
+    }
+
+    bool IsGrouped() const { return m_grouper != nullptr; }
+
+    /**
+     * @brief Expand or collapse every group (GUI thread)
+     */
+    void SetAllGroupsExpanded(bool expanded) {
+        m_expandedGroups.clear();
+        if (!expanded) return;
+        RowView rows = AcquireRows();
+        if (rows.buffer && m_groupSnapshots[rows.front]) {
+            for (const auto& node : m_groupSnapshots[rows.front]->nodes) m_expandedGroups.insert(node.path);
+        }
+    }
+
+    /**
+     * @brief Flash cells whose value changed since the previous refresh
+     *
+     * Refresh() diffs the new rows against the displayed ones by rowKey and stores two
+     * bits per cell (changed / up / down) plus the time of each row's last change, so
+     * Render() only reads the marks of visible rows: no per-frame diffing and no
+     * callbacks. Direction is taken from the column's typed extractor (int64/int/double/
+     * bool); other columns flash as "changed". Rows that appear are flashed as changed.
+     * Marks fade out over fadeSeconds and are drawn below m_cellColorCallback colors.
+     * Applies to the plain refresh callback (not streaming or view mode). Call after
+     * SetColumnTypedExtractor() and before Refresh() runs.
+     *
+     * Example:
+     *   widget.EnableChangeHighlight([](const Row& r) { return (uint64_t)std::any_cast<const Tick&>(r.userData).id; });
+     */
+    void EnableChangeHighlight(CellChangeTracker<Row>::RowKeyFn rowKey, float fadeSeconds = 1.0f) {
+        std::vector<CellChangeTracker<Row>::ValueFn> values;
+        for (const auto& col : m_columns) {
+            if (!col.typedExtractor) {
+                values.emplace_back();
+                continue;
+            }
+            values.emplace_back([extractor = col.typedExtractor](const Row& row) { return NumericValue(extractor(row)); });
+        }
+        m_changeTracker = std::make_unique<CellChangeTracker<Row>>(std::move(rowKey), std::move(values));
+        m_changeFadeSeconds = fadeSeconds > 0.0f ? fadeSeconds : 1.0f;
+        m_cellChanges[0].reset();
+        m_cellChanges[1].reset();
+        InvalidateRefreshVersion();
+    }
+
+    void DisableChangeHighlight() {
+        m_changeTracker.reset();
+        m_cellChanges[0].reset();
+        m_cellChanges[1].reset();
+        InvalidateRefreshVersion();
+    }
+
+    /**
+     * @brief Flash colors (full strength; alpha fades to 0 over the fade time)
+     */
+    void SetChangeHighlightColors(ImU32 changed, ImU32 up, ImU32 down) {
+        m_changeColors[(int)CellChange::Changed] = changed;
+        m_changeColors[(int)CellChange::Up] = up;
+        m_changeColors[(int)CellChange::Down] = down;
+    }
+
+    /**
+     * @brief Change mark of a displayed cell that is still fading (GUI thread)
+     *
+     * @param rowIndex Index into the displayed rows (as passed to the color callbacks)
+     */
+    CellChange GetCellChange(int rowIndex, int col) const {
+        RowView rows = AcquireRows();
+        if (!rows.buffer || !m_changeTracker) return CellChange::None;
+        const auto& changes = m_cellChanges[rows.front];
+        if (!changes || changes->rowCount() != rows.size() || rowIndex < 0 || (size_t)rowIndex >= rows.size() ||
+            col < 0 || (size_t)col >= changes->columns) {
+            return CellChange::None;
+        }
+        float changedAt = changes->changedAt[rowIndex];
+        if (changedAt < 0 || ChangeClock() - changedAt >= m_changeFadeSeconds) return CellChange::None;
+        return changes->Get(rowIndex, col);
+    }
+
+    /**
+     * @brief Cancel the running streaming refresh (safe to call from any thread)
+     *
+     * Rows already published stay visible until the next refresh.
+     */
+    void CancelStreaming() { m_streamGeneration.fetch_add(1, std::memory_order_acq_rel); }
+
+    /**
+     * @brief True while a streaming result is displayed but not yet complete
+     */
+    bool IsStreaming() const {
+        auto snapshot = std::atomic_load_explicit(&m_streamSnapshot, std::memory_order_acquire);
+        return snapshot && !snapshot->complete;
+    }
+
+    /**
+     * @brief Set callback invoked (GUI thread) when the user changes the sort order
+     */
+    void SetSortChangedCallback(std::function<void()> callback) { m_sortChangedCallback = std::move(callback); }
 
     /**
      * @brief Set typed extractor for a column (enables type-safe sorting)
@@ -297,6 +721,15 @@ public:
         m_frozenRows = rows;
     }
 
+    /**
+     * @brief Publish Refresh()/Render() durations to the PerfRegistry under this name
+     */
+    void SetPerfName(const std::string& name) {
+        m_perfRefresh = &PerfRegistry::Get().Duration("Refresh", name);
+        m_perfRender = &PerfRegistry::Get().Duration("Render", name);
+        m_perfName = name;
+    }
+
     /**
      * @brief Set callback for per-row background color
      * Return 0 for default color, or an ImU32 color value.
@@ -309,6 +742,20 @@ public:
      */
     void SetCellColorCallback(CellColorCallback callback) { m_cellColorCallback = callback; }
 
+    /**
+     * @brief Style rows/cells by value rules (thresholds, ranges) instead of callbacks
+     *
+     * Rules read the column's typed extractor and are evaluated once per row in
+     * Refresh()/SetData(), producing packed per-row and per-cell colors for the buffer;
+     * Render() only indexes them. The color callbacks remain as a fallback for rows and
+     * cells no rule styled. Safe to call from any thread; applies from the next refresh.
+     * Applies to the plain refresh callback and SetData() (not streaming or view mode).
+     */
+    void SetStyleRules(std::vector<StyleRule> rules) {
+        m_styler.SetRules(std::move(rules));
+        InvalidateRefreshVersion();
+    }
+
     /**
      * @brief Set right-click context menu callback for rows
      */
@@ -356,9 +803,11 @@ public:
      * Never blocks, even if background refresh is running.
      */
     void Render() {
+        PerfScopedTimer perfTimer(m_perfRender);
+        KS_TRACE_SCOPE("widget", "Render", m_perfName);
+
         // Atomic read (acquire semantics)
-        int frontIdx = m_frontIndex.load(std::memory_order_acquire);
-        const std::vector<Row>& rows = m_buffers[frontIdx];
+        RowView rows = AcquireRows();
 
         // Optional filter bar
         if (m_filterEnabled) {
@@ -369,9 +818,62 @@ public:
             }
         }
 
-        // Build filtered row indices (must happen before clipper)
+        // Running export
+        if (m_exportJob && !m_exportJob->IsFinished()) {
+            char overlay[96];
+            snprintf(overlay, sizeof(overlay), "Exporting %zu / %zu rows", m_exportJob->GetProcessed(),
+                     m_exportJob->GetTotal());
+            ImGui::ProgressBar(m_exportJob->GetProgress(), ImVec2(260.0f, 0.0f), overlay);
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Cancel export")) m_exportJob->Cancel();
+        }
+
+        // Grouped layout for the displayed buffer (null when not grouped or not yet refreshed)
+        std::shared_ptr<const GroupSnapshot> groups;
+        if (m_grouper && rows.buffer) {
+            groups = m_groupSnapshots[rows.front];
+            if (groups && groups->rowCount != rows.size()) groups.reset();
+        }
+
+        // Precomputed styles for the displayed buffer
+        std::shared_ptr<const StyleSnapshot> styles;
+        if (rows.buffer) {
+            styles = m_styles[rows.front];
+            if (styles && styles->rowCount() != rows.size()) styles.reset();
+        }
+
+        // Change marks for the displayed buffer; faded rows are skipped by timestamp alone
+        std::shared_ptr<const CellChangeSnapshot> changes;
+        const float changeNow = ChangeClock();
+        if (m_changeTracker && rows.buffer) {
+            changes = m_cellChanges[rows.front];
+            if (changes && changes->rowCount() != rows.size()) changes.reset();
+        }
+
+        // Build filtered row indices (must happen before clipper).
+        // In grouped mode, header rows are encoded as -(node index + 1).
         std::vector<int> filteredIndices;
-        if (m_filterEnabled && m_filterBuffer[0] != '\0') {
+        auto passesFilter = [&](const Row& row) {
+            if (!m_filterEnabled || m_filterBuffer[0] == '\0') return true;
+            for (const auto& col : row.columns) {
+                if (col.find(m_filterBuffer) != std::string::npos) return true;
+            }
+            return false;
+        };
+        if (groups) {
+            const auto& nodes = groups->nodes;
+            for (size_t n = 0; n < nodes.size();) {
+                filteredIndices.push_back(-(int)n - 1);
+                if (!m_expandedGroups.count(nodes[n].path)) {
+                    n = nodes[n].subtreeEnd;
+                    continue;
+                }
+                for (size_t rowIdx : nodes[n].rows) {
+                    if (passesFilter(rows[rowIdx])) filteredIndices.push_back((int)rowIdx);
+                }
+                n++;
+            }
+        } else if (m_filterEnabled && m_filterBuffer[0] != '\0') {
             for (int i = 0; i < (int)rows.size(); i++) {
                 for (const auto& col : rows[i].columns) {
                     if (col.find(m_filterBuffer) != std::string::npos) {
@@ -387,11 +889,25 @@ public:
             }
         }
 
+        const size_t dataRowCount = groups ? rows.size() : filteredIndices.size();
+
         // Show row count (and selection count if enabled)
         if (m_selectionEnabled && m_selection.Size > 0) {
-            ImGui::Text("%zu rows (%d selected)", filteredIndices.size(), m_selection.Size);
+            ImGui::Text("%zu rows (%d selected)", dataRowCount, m_selection.Size);
         } else {
-            ImGui::Text("%zu rows", filteredIndices.size());
+            ImGui::Text("%zu rows", dataRowCount);
+        }
+        if (groups) {
+            ImGui::SameLine();
+            ImGui::Text("in %zu groups", groups->nodes.size());
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Expand all")) SetAllGroupsExpanded(true);
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Collapse all")) SetAllGroupsExpanded(false);
+        }
+        if (rows.stream && !rows.stream->complete) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(loading...)");
         }
 
         // Render table
@@ -418,6 +934,7 @@ public:
                     m_sortSpecsDirty.store(true, std::memory_order_release);
 
                     sortSpecs->SpecsDirty = false;
+                    if (m_sortChangedCallback) m_sortChangedCallback();
                 }
             }
 
@@ -445,24 +962,49 @@ public:
             while (clipper.Step()) {
                 for (int idx = clipper.DisplayStart; idx < clipper.DisplayEnd; idx++) {
                     int dataIdx = filteredIndices[idx];
+                    if (dataIdx < 0) {
+                        RenderGroupHeader(groups->nodes[(size_t)(-dataIdx - 1)]);
+                        continue;
+                    }
                     const Row& rowData = rows[dataIdx];
 
                     ImGui::TableNextRow();
 
-                    // Per-row background color
-                    if (m_rowColorCallback) {
+                    // Per-row background color (precomputed style, else callback)
+                    const CellStyle rowStyle = styles ? styles->Row(dataIdx) : CellStyle{};
+                    if (rowStyle.bg != 0) {
+                        ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg1, rowStyle.bg);
+                    } else if (m_rowColorCallback) {
                         ImU32 rowColor = m_rowColorCallback(rowData, dataIdx);
                         if (rowColor != 0) {
                             ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg1, rowColor);
                         }
                     }
 
+                    // Flash strength of this row's change marks (0 = none or faded out)
+                    float flash = 0.0f;
+                    if (changes && changes->changedAt[dataIdx] >= 0) {
+                        flash = 1.0f - (changeNow - changes->changedAt[dataIdx]) / m_changeFadeSeconds;
+                    }
+
                     // Render cells
                     for (size_t col = 0; col < m_columns.size() && col < rowData.columns.size(); col++) {
                         ImGui::TableSetColumnIndex(col);
+                        const CellStyle cellStyle = styles ? styles->Cell(dataIdx, col) : CellStyle{};
+                        if (cellStyle.bg != 0) {
+                            ImGui::TableSetBgColor(ImGuiTableBgTarget_CellBg, cellStyle.bg);
+                        }
 
-                        // Per-cell background color
-                        if (m_cellColorCallback) {
+                        // Change flash
+                        if (flash > 0.0f && col < changes->columns) {
+                            CellChange change = changes->Get(dataIdx, col);
+                            if (change != CellChange::None) {
+                                ImGui::TableSetBgColor(ImGuiTableBgTarget_CellBg, FadeColor(m_changeColors[(int)change], flash));
+                            }
+                        }
+
+                        // Per-cell background color callback (cells without a precomputed style)
+                        if (cellStyle.bg == 0 && m_cellColorCallback) {
                             ImU32 cellColor = m_cellColorCallback(rowData, dataIdx, col);
                             if (cellColor != 0) {
                                 ImGui::TableSetBgColor(ImGuiTableBgTarget_CellBg, cellColor);
@@ -493,6 +1035,9 @@ public:
                             ImGui::SameLine(0.0f, 0.0f);
                         }
 
+                        const ImU32 textColor = cellStyle.text != 0 ? cellStyle.text : rowStyle.text;
+                        if (textColor != 0) ImGui::PushStyleColor(ImGuiCol_Text, textColor);
+
                         const auto& colCfg = m_columns[col];
                         bool rendered = false;
 
@@ -526,6 +1071,8 @@ public:
 
                             ImGui::TextUnformatted(text.c_str());
                         }
+
+                        if (textColor != 0) ImGui::PopStyleColor();
                     }
 
                     // Context menu for non-selection mode
@@ -562,14 +1109,38 @@ public:
      * Sorting is applied here (not in Render) to maintain zero-lock rendering.
      */
     void Refresh() {
+        if (m_rowSource) {
+            RefreshView();
+            return;
+        }
+        if (m_streamingCallback) {
+            RefreshStreaming();
+            return;
+        }
         if (!m_refreshCallback) {
             return; // No refresh callback set
         }
 
+        // Nothing the rows depend on changed since the displayed buffer was built
+        const uint64_t epoch = m_refreshEpoch.load(std::memory_order_acquire);
+        const uint64_t version = m_refreshVersion ? m_refreshVersion() : 0;
+        if (m_refreshVersion && epoch == m_refreshedEpoch && version == m_refreshedVersion &&
+            !m_sortSpecsDirty.load(std::memory_order_acquire)) {
+            return;
+        }
+
+        PerfScopedTimer perfTimer(m_perfRefresh);
+        KS_TRACE_SCOPE("widget", "Refresh", m_perfName);
+
         // Determine back buffer index (relaxed is fine - we're the only writer)
         int currentFront = m_frontIndex.load(std::memory_order_relaxed);
         int backIdx = 1 - currentFront;
 
+        // An export may still be reading the back buffer (an older snapshot): keep showing
+        // the front buffer and pick the new data up on the next refresh
+        if (!BeginBufferWrite(backIdx)) return;
+        BufferWriteGuard writeGuard{m_bufferState[backIdx]};
+
         // Clear and populate back buffer
         std::vector<Row>& backBuffer = m_buffers[backIdx];
         backBuffer.clear();
@@ -586,42 +1157,36 @@ public:
                 specs[i] = m_sortSpecs[i];
             }
 
-            // Validate all sort specs have typed extractors
-            bool canSort = true;
-            for (int i = 0; i < specCount; i++) {
-                int colIdx = specs[i].columnIndex;
-                if (colIdx < 0 || colIdx >= (int)m_columns.size() || !m_columns[colIdx].typedExtractor) {
-                    if (colIdx >= 0 && colIdx < (int)m_columns.size()) {
-                        std::cerr << "ERROR: Column '" << m_columns[colIdx].header
-                                  << "' is sortable but has no typedExtractor. Skipping sort.\n";
-                    }
-                    canSort = false;
-                    break;
-                }
-            }
-
-            if (canSort) {
-                std::stable_sort(backBuffer.begin(), backBuffer.end(),
-                                 [this, &specs, specCount](const Row& a, const Row& b) {
-                    for (int s = 0; s < specCount; s++) {
-                        int colIdx = specs[s].columnIndex;
-                        bool ascending = (specs[s].direction == ImGuiSortDirection_Ascending);
-                        const auto& colCfg = m_columns[colIdx];
-
-                        int cmp = CompareTypedValues(colCfg.typedExtractor(a), colCfg.typedExtractor(b));
-                        if (cmp != 0) {
-                            return ascending ? (cmp < 0) : (cmp > 0);
-                        }
-                    }
-                    return false; // Equal across all sort specs
+            if (CanSort(specs, specCount)) {
+                std::stable_sort(backBuffer.begin(), backBuffer.end(), [this, &specs, specCount](const Row& a, const Row& b) {
+                    return RowLess(a, b, specs, specCount);
                 });
             }
 
             m_sortSpecsDirty.store(false, std::memory_order_relaxed);
         }
 
+        // Patch group aggregates for changed rows and lay out the groups for this buffer
+        if (m_grouper) {
+            KS_TRACE_SCOPE("widget", "Group", m_perfName);
+            m_grouper->Apply(backBuffer);
+            m_groupSnapshots[backIdx] = std::make_shared<const GroupSnapshot>(m_grouper->BuildSnapshot(m_columns.size()));
+        }
+
+        ApplyStyles(backIdx);
+
+        // Mark cells that changed since the displayed buffer (the GUI only reads it concurrently)
+        if (m_changeTracker) {
+            KS_TRACE_SCOPE("widget", "ChangeDetect", m_perfName);
+            m_cellChanges[backIdx] =
+                m_changeTracker->Apply(backBuffer, m_buffers[currentFront], m_columns.size(), ChangeClock());
+        }
+
         // Atomic swap (release semantics - ensures all writes are visible)
         m_frontIndex.store(backIdx, std::memory_order_release);
+        std::atomic_store_explicit(&m_streamSnapshot, std::shared_ptr<const StreamSnapshot>(), std::memory_order_release);
+        m_refreshedVersion = version;
+        m_refreshedEpoch = epoch;
     }
 
     /**
@@ -630,16 +1195,30 @@ public:
     void SetData(std::vector<Row>&& rows) {
         int currentFront = m_frontIndex.load(std::memory_order_relaxed);
         int backIdx = 1 - currentFront;
+        WaitBufferWrite(backIdx);
+        BufferWriteGuard writeGuard{m_bufferState[backIdx]};
         m_buffers[backIdx] = std::move(rows);
+        ApplyStyles(backIdx);
+        ResetChangeTracking();
+        InvalidateRefreshVersion();
         m_frontIndex.store(backIdx, std::memory_order_release);
+        std::atomic_store_explicit(&m_streamSnapshot, std::shared_ptr<const StreamSnapshot>(), std::memory_order_release);
     }
 
     /**
      * @brief Get current row count (from front buffer)
      */
-    size_t GetRowCount() const {
-        int frontIdx = m_frontIndex.load(std::memory_order_acquire);
-        return m_buffers[frontIdx].size();
+    size_t GetRowCount() const { return AcquireRows().size(); }
+
+    /**
+     * @brief Visit displayed rows in display order (front buffer or streaming snapshot)
+     */
+    template <typename Fn>
+    void ForEachRow(Fn&& fn) const {
+        RowView rows = AcquireRows();
+        for (size_t i = 0; i < rows.size(); i++) {
+            fn(rows[i]);
+        }
     }
 
     /**
@@ -648,8 +1227,14 @@ public:
     void Clear() {
         int currentFront = m_frontIndex.load(std::memory_order_relaxed);
         int backIdx = 1 - currentFront;
+        WaitBufferWrite(backIdx);
+        BufferWriteGuard writeGuard{m_bufferState[backIdx]};
         m_buffers[backIdx].clear();
+        m_styles[backIdx].reset();
+        ResetChangeTracking();
+        InvalidateRefreshVersion();
         m_frontIndex.store(backIdx, std::memory_order_release);
+        std::atomic_store_explicit(&m_streamSnapshot, std::shared_ptr<const StreamSnapshot>(), std::memory_order_release);
     }
 
     // ==================== Advanced Features Helpers ====================
@@ -784,12 +1369,14 @@ public:
 
     /**
      * @brief Copy selected rows to clipboard as tab-separated text
+     *
+     * Selections whose text would exceed the clipboard limit are exported to a TSV file
+     * in the background instead (see SetClipboardLimit); the export job is returned.
      */
-    void CopySelectionToClipboard() const {
-        if (!m_selectionEnabled || m_selection.Size == 0) return;
+    std::shared_ptr<ExportJob> CopySelectionToClipboard() {
+        if (!m_selectionEnabled || m_selection.Size == 0) return nullptr;
 
-        int frontIdx = m_frontIndex.load(std::memory_order_acquire);
-        const std::vector<Row>& rows = m_buffers[frontIdx];
+        RowView rows = AcquireRows();
 
         std::string text;
 
@@ -803,8 +1390,7 @@ public:
         // Data rows
         void* it = nullptr;
         ImGuiID id;
-        auto& sel = const_cast<ImGuiSelectionBasicStorage&>(m_selection);
-        while (sel.GetNextSelectedItem(&it, &id)) {
+        while (m_selection.GetNextSelectedItem(&it, &id)) {
             int idx = static_cast<int>(id);
             if (idx >= 0 && idx < (int)rows.size()) {
                 for (size_t c = 0; c < rows[idx].columns.size(); c++) {
@@ -813,12 +1399,323 @@ public:
                 }
                 text += '\n';
             }
+            if (text.size() > m_clipboardLimit) {
+                std::string path = m_clipboardFallbackPath;
+                if (path.empty()) {
+                    std::error_code ec;
+                    path = (std::filesystem::temp_directory_path(ec) / "table_selection.tsv").string();
+                }
+                std::cerr << "Selection exceeds the clipboard limit; exporting to " << path << "\n";
+                return ExportAsync(path, ExportFormat::Tsv, true);
+            }
         }
 
         ImGui::SetClipboardText(text.c_str());
+        return nullptr;
     }
 
+    /**
+     * @brief Clipboard copies larger than maxBytes go to fallbackPath instead
+     * (default: table_selection.tsv in the temp directory)
+     */
+    void SetClipboardLimit(size_t maxBytes, std::string fallbackPath = {}) {
+        m_clipboardLimit = maxBytes;
+        m_clipboardFallbackPath = std::move(fallbackPath);
+    }
+
+    /**
+     * @brief Export the displayed rows (or only the selected ones) to a file in the background
+     *
+     * Rows are streamed from the snapshot displayed right now, in display order, through
+     * chunked buffered writes (see RunTableExport); Render() shows a progress bar with a
+     * cancel button while it runs. The GUI never copies the rows: a streaming/view snapshot
+     * is kept alive by reference, and a double-buffer snapshot is pinned, so at most one
+     * more plain Refresh() is published until the export finishes (later ones are skipped).
+     * Starting a new export cancels the running one. GUI thread only.
+     */
+    std::shared_ptr<ExportJob> ExportAsync(const std::string& path, ExportFormat format, bool selectionOnly = false) {
+        if (m_exportJob && !m_exportJob->IsFinished()) m_exportJob->Cancel();
+        if (m_exportThread.joinable()) m_exportThread.join();
+
+        ExportSource source = AcquireExportSource();
+        std::vector<int> indices;
+        if (selectionOnly) {
+            indices = GetSelectedIndices();
+            std::sort(indices.begin(), indices.end());
+            const int rowCount = (int)source.rows.size();
+            indices.erase(std::remove_if(indices.begin(), indices.end(), [rowCount](int i) { return i < 0 || i >= rowCount; }),
+                          indices.end());
+        }
+        std::vector<std::string> headers;
+        headers.reserve(m_columns.size());
+        for (const auto& col : m_columns) headers.push_back(col.header);
+
+        auto job = std::make_shared<ExportJob>(path);
+        m_exportJob = job;
+        m_exportThread = std::thread([job, path, format, selectionOnly, headers = std::move(headers),
+                                      indices = std::move(indices), source = std::move(source)]() mutable {
+            db::Trace::SetThreadName("table export");
+            const size_t count = selectionOnly ? indices.size() : source.rows.size();
+            RunTableExport(path, format, headers, count, [&](size_t i) -> const std::vector<std::string>& {
+                return source.rows[selectionOnly ? (size_t)indices[i] : i].columns;
+            }, *job);
+        });
+        return job;
+    }
+
+    /// Current (or last) export job, nullptr if none was started
+    std::shared_ptr<ExportJob> GetExportJob() const { return m_exportJob; }
+
 private:
+    /**
+     * @brief Rows currently displayed: the streaming snapshot if one is published,
+     * otherwise the front buffer. Holding the view keeps the snapshot alive.
+     */
+    struct RowView {
+        const std::vector<Row>* buffer = nullptr;
+        int front = 0; // buffer index when buffer is set
+        std::shared_ptr<const StreamSnapshot> stream;
+
+        size_t size() const { return stream ? stream->rowCount : buffer->size(); }
+        const Row& operator[](size_t idx) const { return stream ? stream->RowAt(idx) : (*buffer)[idx]; }
+    };
+
+    /// Releases a double-buffer pin taken for an export
+    struct BufferPin {
+        explicit BufferPin(std::atomic<int>* pinned) : state(pinned) {}
+        BufferPin(const BufferPin&) = delete;
+        BufferPin& operator=(const BufferPin&) = delete;
+        ~BufferPin() { state->fetch_sub(1, std::memory_order_acq_rel); }
+        std::atomic<int>* state;
+    };
+
+    /// Rows an export reads from, kept valid until the export thread drops it
+    struct ExportSource {
+        RowView rows;
+        std::shared_ptr<BufferPin> pin; // set when rows.buffer is used
+    };
+
+    ExportSource AcquireExportSource() {
+        for (;;) {
+            ExportSource source;
+            source.rows = AcquireRows();
+            if (source.rows.stream) return source;
+            auto& state = m_bufferState[source.rows.front];
+            int s = state.load(std::memory_order_acquire);
+            while (s >= 0) {
+                if (state.compare_exchange_weak(s, s + 1, std::memory_order_acq_rel)) {
+                    source.pin = std::make_shared<BufferPin>(&state);
+                    return source;
+                }
+            }
+            std::this_thread::yield(); // a refresh is writing it right after a swap; retry
+        }
+    }
+
+    /// Claim a buffer for writing; fails while an export has it pinned
+    bool BeginBufferWrite(int bufferIdx) {
+        int expected = 0;
+        return m_bufferState[bufferIdx].compare_exchange_strong(expected, -1, std::memory_order_acq_rel);
+    }
+
+    void WaitBufferWrite(int bufferIdx) {
+        while (!BeginBufferWrite(bufferIdx)) std::this_thread::yield();
+    }
+
+    struct BufferWriteGuard {
+        std::atomic<int>& state;
+        ~BufferWriteGuard() { state.store(0, std::memory_order_release); }
+    };
+
+    RowView AcquireRows() const {
+        RowView view;
+        view.stream = std::atomic_load_explicit(&m_streamSnapshot, std::memory_order_acquire);
+        if (!view.stream) {
+            view.front = m_frontIndex.load(std::memory_order_acquire);
+            view.buffer = &m_buffers[view.front];
+        }
+        return view;
+    }
+
+    /// Rows displayed if they are a complete result (not a stream still filling in), else 0
+    size_t CompleteRowCount() const {
+        RowView rows = AcquireRows();
+        return rows.stream && !rows.stream->complete ? 0 : rows.size();
+    }
+
+    void RefreshStreaming() {
+        PerfScopedTimer perfTimer(m_perfRefresh);
+        KS_TRACE_SCOPE("widget", "RefreshStreaming", m_perfName);
+
+        // Supersede any running stream; the sort specs are consumed by this one
+        uint64_t generation = m_streamGeneration.fetch_add(1, std::memory_order_acq_rel) + 1;
+        m_sortSpecsDirty.store(false, std::memory_order_release);
+
+        StreamSink sink(*this, generation, m_streamChunkRows);
+        m_streamingCallback(sink);
+        sink.Publish(true);
+    }
+
+    void RefreshView() {
+        std::shared_ptr<const StreamSnapshot> source = m_rowSource();
+        if (!source) return;
+        const bool sortDirty = m_sortSpecsDirty.exchange(false, std::memory_order_acq_rel);
+        const bool filterDirty = m_viewFilterDirty.exchange(false, std::memory_order_acq_rel);
+        const bool sourceChanged = source != m_viewSource;
+        if (!sourceChanged && !sortDirty && !filterDirty) {
+            return;
+        }
+
+        PerfScopedTimer perfTimer(m_perfRefresh);
+        KS_TRACE_SCOPE("widget", "RefreshView", m_perfName);
+
+        const size_t rowCount = source->rowCount;
+        if (sourceChanged || filterDirty) {
+            m_viewFilterBits.assign((rowCount + 63) / 64, 0);
+            size_t idx = 0;
+            for (const auto& chunk : source->chunks) {
+                for (const Row& row : *chunk) {
+                    if (!m_rowFilter || m_rowFilter(row)) {
+                        m_viewFilterBits[idx / 64] |= uint64_t{1} << (idx % 64);
+                    }
+                    idx++;
+                }
+            }
+        }
+
+        SortSpec specs[kMaxSortSpecs];
+        int specCount = m_sortSpecCount.load(std::memory_order_acquire);
+        for (int i = 0; i < specCount; i++) {
+            specs[i] = m_sortSpecs[i];
+        }
+        const bool sorted = specCount > 0 && CanSort(specs, specCount);
+
+        auto view = std::make_shared<StreamSnapshot>();
+        view->chunks = source->chunks;
+        view->chunkEnds = source->chunkEnds;
+        view->complete = true;
+        if (m_rowFilter || sorted) {
+            view->order.reserve(rowCount);
+            for (size_t i = 0; i < rowCount; i++) {
+                if (m_viewFilterBits[i / 64] & (uint64_t{1} << (i % 64))) view->order.push_back(i);
+            }
+            if (sorted) {
+                std::stable_sort(view->order.begin(), view->order.end(), [&](size_t a, size_t b) {
+                    return RowLess(source->StoredRow(a), source->StoredRow(b), specs, specCount);
+                });
+            }
+            view->rowCount = view->order.size();
+        } else {
+            view->rowCount = rowCount;
+        }
+
+        m_viewSource = std::move(source);
+        std::atomic_store_explicit(&m_streamSnapshot, std::shared_ptr<const StreamSnapshot>(std::move(view)),
+                                   std::memory_order_release);
+    }
+
+    void RenderGroupHeader(const GroupSnapshot::Node& node) {
+        ImGui::TableNextRow();
+        ImGui::TableSetColumnIndex(0);
+        const bool expanded = m_expandedGroups.count(node.path) != 0;
+        const float indent = node.depth * 16.0f;
+        if (indent > 0.0f) ImGui::Indent(indent);
+        std::string label = node.label;
+        if (!node.cells.empty() && !node.cells[0].empty()) label += "  " + node.cells[0];
+        label += "##grp";
+        label += node.path;
+        ImGui::SetNextItemOpen(expanded);
+        const bool open =
+            ImGui::TreeNodeEx(label.c_str(), ImGuiTreeNodeFlags_SpanAllColumns | ImGuiTreeNodeFlags_NoTreePushOnOpen);
+        if (indent > 0.0f) ImGui::Unindent(indent);
+        if (open != expanded) {
+            if (open) {
+                m_expandedGroups.insert(node.path);
+            } else {
+                m_expandedGroups.erase(node.path);
+            }
+        }
+        for (size_t col = 1; col < m_columns.size() && col < node.cells.size(); col++) {
+            if (node.cells[col].empty()) continue;
+            ImGui::TableSetColumnIndex((int)col);
+            ImGui::TextUnformatted(node.cells[col].c_str());
+        }
+    }
+
+    /// Evaluate the style rules for a (not displayed) buffer
+    void ApplyStyles(int bufferIdx) {
+        if (!m_styler.HasRules()) {
+            m_styles[bufferIdx].reset();
+            return;
+        }
+        KS_TRACE_SCOPE("widget", "Style", m_perfName);
+        const std::vector<Row>& buffer = m_buffers[bufferIdx];
+        m_styles[bufferIdx] = m_styler.Apply(buffer.size(), m_columns.size(), [&](size_t row, int col) -> std::optional<double> {
+            const auto& extractor = m_columns[col].typedExtractor;
+            if (!extractor) return std::nullopt;
+            return NumericValue(extractor(buffer[row]));
+        });
+    }
+
+    /// Rows replaced wholesale: nothing to diff the next refresh against
+    void ResetChangeTracking() {
+        if (!m_changeTracker) return;
+        m_changeTracker->Reset();
+        m_cellChanges[0].reset();
+        m_cellChanges[1].reset();
+    }
+
+    /// Make the next Refresh() rebuild even if the refresh version is unchanged
+    void InvalidateRefreshVersion() { m_refreshEpoch.fetch_add(1, std::memory_order_release); }
+
+    /// Seconds on a process-wide steady clock (shared by the refresh and GUI threads)
+    static float ChangeClock() {
+        static const auto epoch = std::chrono::steady_clock::now();
+        return std::chrono::duration<float>(std::chrono::steady_clock::now() - epoch).count();
+    }
+
+    static ImU32 FadeColor(ImU32 color, float strength) {
+        ImU32 alpha = (ImU32)(((color & IM_COL32_A_MASK) >> IM_COL32_A_SHIFT) * std::min(strength, 1.0f));
+        return (color & ~IM_COL32_A_MASK) | (alpha << IM_COL32_A_SHIFT);
+    }
+
+    static std::optional<double> NumericValue(const std::any& value) {
+        if (auto* v = std::any_cast<int64_t>(&value)) return static_cast<double>(*v);
+        if (auto* v = std::any_cast<int>(&value)) return static_cast<double>(*v);
+        if (auto* v = std::any_cast<double>(&value)) return *v;
+        if (auto* v = std::any_cast<bool>(&value)) return *v ? 1.0 : 0.0;
+        return std::nullopt;
+    }
+
+    /// True when every spec names a column with a typed extractor
+    bool CanSort(const SortSpec* specs, int specCount) const {
+        for (int i = 0; i < specCount; i++) {
+            int colIdx = specs[i].columnIndex;
+            if (colIdx < 0 || colIdx >= (int)m_columns.size() || !m_columns[colIdx].typedExtractor) {
+                if (colIdx >= 0 && colIdx < (int)m_columns.size()) {
+                    std::cerr << "ERROR: Column '" << m_columns[colIdx].header
+                              << "' is sortable but has no typedExtractor. Skipping sort.\n";
+                }
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool RowLess(const Row& a, const Row& b, const SortSpec* specs, int specCount) const {
+        for (int s = 0; s < specCount; s++) {
+            int colIdx = specs[s].columnIndex;
+            bool ascending = (specs[s].direction == ImGuiSortDirection_Ascending);
+            const auto& colCfg = m_columns[colIdx];
+
+            int cmp = CompareTypedValues(colCfg.typedExtractor(a), colCfg.typedExtractor(b));
+            if (cmp != 0) {
+                return ascending ? (cmp < 0) : (cmp > 0);
+            }
+        }
+        return false; // Equal across all sort specs
+    }
+
     /**
      * @brief Compare two std::any values, returns -1, 0, or 1
      */
@@ -0,0 +1,374 @@
+#pragma once
+
+#include <sqlite3.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/**
+ * @brief Value bound into a staged bulk update column
+ */
+using BulkValue = std::variant<std::nullptr_t, std::int64_t, double, std::string>;
+
+/**
+ * @brief One row selected by a bulk update
+ *
+ * seq is the 0-based position among the selected rows, rowid the SQLite rowid and
+ * key the value of BulkUpdateRequest::keyColumn for that row.
+ */
+struct BulkTarget {
+    std::int64_t seq = 0;
+    std::int64_t rowid = 0;
+    std::int64_t key = 0;
+};
+
+/**
+ * @brief Set-based bulk UPDATE description
+ *
+ * Row selection: rows of `table` matching `where`, numbered by `orderBy`, keeping
+ * every `modN`-th row starting at `offset` (at most `limit` rows, 0 = all). The
+ * selection is materialized once into a temp table with INSERT ... SELECT, so no id
+ * vector ever crosses into C++.
+ *
+ * New values come from either or both of:
+ * - setExpressions: column -> SQL expression, applied set-based per chunk
+ *   (e.g. {"has_fun", "NOT has_fun"})
+ * - stagedColumns + valueProvider: per-row values computed in C++, staged in a temp
+ *   table and applied with one keyed UPDATE per chunk
+ *
+ * Everything runs in one transaction; cancelling rolls the whole job back.
+ * `where`, `orderBy` and `setExpressions` are spliced into SQL verbatim and must come
+ * from trusted code; table and column names are validated as identifiers.
+ */
+struct BulkUpdateRequest {
+    std::string table;
+    std::string where;
+    std::string orderBy = "rowid";
+    std::size_t offset = 0;
+    std::size_t modN = 1;
+    std::size_t limit = 0;
+
+    std::vector<std::pair<std::string, std::string>> setExpressions;
+
+    std::vector<std::string> stagedColumns;
+    std::string keyColumn = "rowid";
+    std::function<void(const BulkTarget&, std::vector<BulkValue>&)> valueProvider;
+
+    std::size_t chunkSize = 16384; // rows per UPDATE; also the progress/cancel granularity
+};
+
+/**
+ * @brief Progress, cancellation and outcome of a background bulk mutation
+ *
+ * Written by the worker thread, read by anyone (e.g. the GUI each frame).
+ */
+class BulkMutationJob {
+public:
+    enum class State { Pending, Running, Succeeded, Failed, Cancelled };
+
+    void Cancel() { m_cancelRequested.store(true, std::memory_order_relaxed); }
+    bool IsCancelRequested() const { return m_cancelRequested.load(std::memory_order_relaxed); }
+
+    State GetState() const { return m_state.load(std::memory_order_acquire); }
+    bool IsFinished() const {
+        State s = GetState();
+        return s == State::Succeeded || s == State::Failed || s == State::Cancelled;
+    }
+
+    std::size_t GetProcessed() const { return m_processed.load(std::memory_order_relaxed); }
+    std::size_t GetTotal() const { return m_total.load(std::memory_order_relaxed); }
+    float GetProgress() const {
+        std::size_t total = GetTotal();
+        return total ? static_cast<float>(GetProcessed()) / static_cast<float>(total) : (IsFinished() ? 1.0f : 0.0f);
+    }
+
+    double GetElapsedMs() const { return m_elapsedMs.load(std::memory_order_relaxed); }
+
+    std::string GetError() const {
+        std::lock_guard<std::mutex> lock(m_errorMutex);
+        return m_error;
+    }
+
+    // ---- Worker side ----
+
+    void SetState(State s) { m_state.store(s, std::memory_order_release); }
+    void SetTotal(std::size_t n) { m_total.store(n, std::memory_order_relaxed); }
+    void AddProcessed(std::size_t n) { m_processed.fetch_add(n, std::memory_order_relaxed); }
+    void SetElapsedMs(double ms) { m_elapsedMs.store(ms, std::memory_order_relaxed); }
+    void SetError(std::string error) {
+        std::lock_guard<std::mutex> lock(m_errorMutex);
+        m_error = std::move(error);
+    }
+
+private:
+    std::atomic<State> m_state{State::Pending};
+    std::atomic<bool> m_cancelRequested{false};
+    std::atomic<std::size_t> m_processed{0};
+    std::atomic<std::size_t> m_total{0};
+    std::atomic<double> m_elapsedMs{0.0};
+    mutable std::mutex m_errorMutex;
+    std::string m_error;
+};
+
+namespace bulk_detail {
+
+inline bool IsIdentifier(const std::string& s) {
+    if (s.empty() || !(std::isalpha(static_cast<unsigned char>(s[0])) || s[0] == '_')) return false;
+    for (char c : s) {
+        if (!(std::isalnum(static_cast<unsigned char>(c)) || c == '_')) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief RAII prepared statement; throws on prepare failure
+ */
+class Statement {
+public:
+    Statement(sqlite3* db, const std::string& sql) : m_db(db) {
+        if (sqlite3_prepare_v2(db, sql.c_str(), -1, &m_stmt, nullptr) != SQLITE_OK) {
+            throw std::runtime_error(std::string("prepare failed: ") + sqlite3_errmsg(db) + " [" + sql + "]");
+        }
+    }
+    ~Statement() { sqlite3_finalize(m_stmt); }
+    Statement(const Statement&) = delete;
+    Statement& operator=(const Statement&) = delete;
+
+    sqlite3_stmt* get() const { return m_stmt; }
+
+    // Step to completion (for statements returning no rows)
+    void Run() {
+        int rc = sqlite3_step(m_stmt);
+        if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
+            throw std::runtime_error(std::string("step failed: ") + sqlite3_errmsg(m_db));
+        }
+        sqlite3_reset(m_stmt);
+    }
+
+private:
+    sqlite3* m_db;
+    sqlite3_stmt* m_stmt = nullptr;
+};
+
+/**
+ * @brief Holds a connection's mutex for the lifetime of a transaction
+ *
+ * A transaction belongs to the connection, not the thread: on a handle several threads
+ * share, statements from other threads would join an open transaction, see its changes
+ * and be rolled back with it. In serialized mode every sqlite3 call on the handle takes
+ * this (recursive) mutex, so holding it from BEGIN to COMMIT/ROLLBACK makes the other
+ * threads wait instead. A no-op for connections opened without SQLITE_OPEN_FULLMUTEX.
+ */
+class ConnectionLock {
+public:
+    explicit ConnectionLock(sqlite3* db) : m_mutex(db ? sqlite3_db_mutex(db) : nullptr) {
+        sqlite3_mutex_enter(m_mutex);
+    }
+    ~ConnectionLock() { sqlite3_mutex_leave(m_mutex); }
+    ConnectionLock(const ConnectionLock&) = delete;
+    ConnectionLock& operator=(const ConnectionLock&) = delete;
+
+private:
+    sqlite3_mutex* m_mutex;
+};
+
+inline void Exec(sqlite3* db, const std::string& sql) {
+    char* err = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &err) != SQLITE_OK) {
+        std::string msg = err ? err : sqlite3_errmsg(db);
+        sqlite3_free(err);
+        throw std::runtime_error(msg + " [" + sql + "]");
+    }
+}
+
+inline void Bind(sqlite3_stmt* stmt, int index, const BulkValue& v) {
+    std::visit([&](const auto& x) {
+        using T = std::decay_t<decltype(x)>;
+        if constexpr (std::is_same_v<T, std::nullptr_t>) {
+            sqlite3_bind_null(stmt, index);
+        } else if constexpr (std::is_same_v<T, std::int64_t>) {
+            sqlite3_bind_int64(stmt, index, x);
+        } else if constexpr (std::is_same_v<T, double>) {
+            sqlite3_bind_double(stmt, index, x);
+        } else {
+            sqlite3_bind_text(stmt, index, x.c_str(), static_cast<int>(x.size()), SQLITE_TRANSIENT);
+        }
+    }, v);
+}
+
+/**
+ * @brief Execute a bulk update on db (blocking). Reports into job; never throws.
+ */
+inline void RunBulkUpdate(sqlite3* db, const BulkUpdateRequest& req, BulkMutationJob& job) {
+    const auto start = std::chrono::steady_clock::now();
+    auto finish = [&](BulkMutationJob::State state) {
+        job.SetElapsedMs(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        job.SetState(state);
+    };
+
+    job.SetState(BulkMutationJob::State::Running);
+
+    // Validate before touching the database
+    bool valid = IsIdentifier(req.table) && IsIdentifier(req.keyColumn) && req.modN > 0 &&
+                 (!req.setExpressions.empty() || !req.stagedColumns.empty()) &&
+                 (req.stagedColumns.empty() || req.valueProvider);
+    for (const auto& [col, expr] : req.setExpressions) valid = valid && IsIdentifier(col) && !expr.empty();
+    for (const auto& col : req.stagedColumns) valid = valid && IsIdentifier(col);
+    if (!valid) {
+        job.SetError("Invalid bulk update request (check table/column names, modN and value source)");
+        finish(BulkMutationJob::State::Failed);
+        return;
+    }
+
+    const bool staged = !req.stagedColumns.empty();
+    const std::size_t chunk = req.chunkSize ? req.chunkSize : 16384;
+    bool inTransaction = false;
+
+    try {
+        Exec(db, "BEGIN IMMEDIATE");
+        inTransaction = true;
+
+        // 1. Materialize the selection (set-based). Rows are numbered by inserting them in
+        //    order into an INTEGER PRIMARY KEY table, which is considerably cheaper than
+        //    ROW_NUMBER() OVER (...), then every modN-th row from offset is kept.
+        Exec(db, "DROP TABLE IF EXISTS temp._bulk_rows");
+        Exec(db, "DROP TABLE IF EXISTS temp._bulk_targets");
+        Exec(db, "CREATE TEMP TABLE _bulk_rows(n INTEGER PRIMARY KEY, rid INTEGER NOT NULL, key)");
+        Exec(db, "CREATE TEMP TABLE _bulk_targets(seq INTEGER PRIMARY KEY, rid INTEGER NOT NULL, key)");
+        Exec(db, "INSERT INTO temp._bulk_rows(rid, key) SELECT rowid, " + req.keyColumn + " FROM " + req.table +
+                     (req.where.empty() ? "" : " WHERE " + req.where) + " ORDER BY " + req.orderBy);
+        {
+            std::string sql =
+                "INSERT INTO temp._bulk_targets(seq, rid, key) "
+                "SELECT (n - 1 - ?1) / ?2, rid, key FROM temp._bulk_rows "
+                "WHERE n - 1 >= ?1 AND (n - 1 - ?1) % ?2 = 0 ORDER BY n";
+            if (req.limit) sql += " LIMIT " + std::to_string(req.limit);
+            Statement select(db, sql);
+            sqlite3_bind_int64(select.get(), 1, static_cast<sqlite3_int64>(req.offset));
+            sqlite3_bind_int64(select.get(), 2, static_cast<sqlite3_int64>(req.modN));
+            select.Run();
+        }
+        const auto total = static_cast<std::size_t>(sqlite3_changes(db));
+        Exec(db, "DROP TABLE temp._bulk_rows");
+        job.SetTotal(total);
+
+        // 2. Build the per-chunk UPDATE
+        std::string setList;
+        auto appendSet = [&setList](const std::string& col, const std::string& value) {
+            if (!setList.empty()) setList += ", ";
+            setList += col + " = " + value;
+        };
+        // Staged values use correlated PK lookups rather than UPDATE ... FROM: the FROM form
+        // makes SQLite scan the whole target table once per chunk.
+        for (const auto& col : req.stagedColumns) {
+            appendSet(col, "(SELECT " + col + " FROM temp._bulk_stage WHERE _bulk_stage.rid = " + req.table + ".rowid)");
+        }
+        for (const auto& [col, expr] : req.setExpressions) appendSet(col, expr);
+
+        std::unique_ptr<Statement> stageInsert;
+        std::unique_ptr<Statement> chunkTargets;
+        std::unique_ptr<Statement> update;
+        std::unique_ptr<Statement> stageClear;
+        if (staged) {
+            std::string cols = "rid INTEGER PRIMARY KEY";
+            std::string placeholders = "?1";
+            for (std::size_t i = 0; i < req.stagedColumns.size(); ++i) {
+                cols += ", " + req.stagedColumns[i];
+                placeholders += ", ?" + std::to_string(i + 2);
+            }
+            Exec(db, "DROP TABLE IF EXISTS temp._bulk_stage");
+            Exec(db, "CREATE TEMP TABLE _bulk_stage(" + cols + ")");
+            std::string colNames = "rid";
+            for (const auto& col : req.stagedColumns) colNames += ", " + col;
+            stageInsert = std::make_unique<Statement>(
+                db, "INSERT INTO temp._bulk_stage(" + colNames + ") VALUES(" + placeholders + ")");
+            chunkTargets = std::make_unique<Statement>(
+                db, "SELECT seq, rid, key FROM temp._bulk_targets WHERE seq >= ?1 AND seq < ?2 ORDER BY seq");
+            update = std::make_unique<Statement>(
+                db, "UPDATE " + req.table + " SET " + setList + " WHERE rowid IN (SELECT rid FROM temp._bulk_stage)");
+            stageClear = std::make_unique<Statement>(db, "DELETE FROM temp._bulk_stage");
+        } else {
+            update = std::make_unique<Statement>(
+                db, "UPDATE " + req.table + " SET " + setList +
+                        " WHERE rowid IN (SELECT rid FROM temp._bulk_targets WHERE seq >= ?1 AND seq < ?2)");
+        }
+
+        // 3. Apply chunk by chunk (progress + cancellation points)
+        std::vector<BulkValue> values(req.stagedColumns.size());
+        for (std::size_t lo = 0; lo < total; lo += chunk) {
+            if (job.IsCancelRequested()) {
+                Exec(db, "ROLLBACK");
+                inTransaction = false;
+                finish(BulkMutationJob::State::Cancelled);
+                return;
+            }
+            const auto hi = static_cast<sqlite3_int64>(std::min(total, lo + chunk));
+
+            if (staged) {
+                sqlite3_bind_int64(chunkTargets->get(), 1, static_cast<sqlite3_int64>(lo));
+                sqlite3_bind_int64(chunkTargets->get(), 2, hi);
+                while (sqlite3_step(chunkTargets->get()) == SQLITE_ROW) {
+                    BulkTarget target{sqlite3_column_int64(chunkTargets->get(), 0),
+                                      sqlite3_column_int64(chunkTargets->get(), 1),
+                                      sqlite3_column_int64(chunkTargets->get(), 2)};
+                    std::fill(values.begin(), values.end(), BulkValue{nullptr});
+                    req.valueProvider(target, values);
+                    sqlite3_bind_int64(stageInsert->get(), 1, target.rowid);
+                    for (std::size_t i = 0; i < values.size(); ++i) {
+                        Bind(stageInsert->get(), static_cast<int>(i + 2), values[i]);
+                    }
+                    stageInsert->Run();
+                }
+                sqlite3_reset(chunkTargets->get());
+                update->Run();
+                stageClear->Run();
+            } else {
+                sqlite3_bind_int64(update->get(), 1, static_cast<sqlite3_int64>(lo));
+                sqlite3_bind_int64(update->get(), 2, hi);
+                update->Run();
+            }
+            job.AddProcessed(static_cast<std::size_t>(hi) - lo);
+        }
+
+        // Finalize statements before dropping the tables they reference
+        stageInsert.reset();
+        chunkTargets.reset();
+        update.reset();
+        stageClear.reset();
+        if (staged) Exec(db, "DROP TABLE temp._bulk_stage");
+        Exec(db, "DROP TABLE temp._bulk_targets");
+        Exec(db, "COMMIT");
+        inTransaction = false;
+        finish(BulkMutationJob::State::Succeeded);
+    } catch (const std::exception& e) {
+        if (inTransaction) {
+            sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+        }
+        job.SetError(e.what());
+        finish(BulkMutationJob::State::Failed);
+    }
+}
+
+/**
+ * @brief RunBulkUpdate() on a connection that other threads keep using
+ *
+ * Statements from other threads would otherwise join the job's transaction, see the staged
+ * rows and be rolled back with a cancelled job; under ConnectionLock they wait for it.
+ */
+inline void RunBulkUpdateExclusive(sqlite3* db, const BulkUpdateRequest& req, BulkMutationJob& job) {
+    ConnectionLock lock(db);
+    RunBulkUpdate(db, req, job);
+}
+
+} // namespace bulk_detail
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace db {
+
+enum class CellChange : uint8_t { None = 0, Changed = 1, Up = 2, Down = 3 };
+
+/**
+ * @brief Per-cell change marks of one row snapshot, computed against the previous one
+ *
+ * Two bits per cell (row-major, four cells per byte) plus one timestamp per row: the
+ * time of the row's most recent change. The marks describe that change; cells the row
+ * has not changed since keep their marks until the next change, so a renderer only
+ * needs `now - changedAt[row]` to fade them out.
+ */
+struct CellChangeSnapshot {
+    std::vector<uint8_t> codes;
+    std::vector<float> changedAt; // per row; < 0 = never changed
+    size_t columns = 0;
+
+    size_t rowCount() const { return changedAt.size(); }
+
+    CellChange Get(size_t row, size_t col) const {
+        size_t bit = (row * columns + col) * 2;
+        return static_cast<CellChange>((codes[bit >> 3] >> (bit & 7)) & 3);
+    }
+
+    void Set(size_t row, size_t col, CellChange change) {
+        size_t bit = (row * columns + col) * 2;
+        codes[bit >> 3] = static_cast<uint8_t>((codes[bit >> 3] & ~(3u << (bit & 7))) |
+                                               (static_cast<unsigned>(change) << (bit & 7)));
+    }
+};
+
+/**
+ * @brief Diffs consecutive row snapshots by row key into CellChangeSnapshots
+ *
+ * A cell is marked when its display string differs from the same row's previous
+ * value; for columns with a numeric value function the mark also carries the
+ * direction (Up/Down). Rows whose key was not in the previous snapshot are marked
+ * Changed in every column (except on the first Apply()). Costs one hash lookup per
+ * row plus string compares; numeric values are only extracted for cells that changed.
+ *
+ * Not thread-safe: owned by the thread that refreshes the widget.
+ */
+template <typename Row>
+class CellChangeTracker {
+public:
+    /// Stable row identity (e.g. the primary key)
+    using RowKeyFn = std::function<uint64_t(const Row&)>;
+    /// Numeric value of a column (nullopt = not numeric)
+    using ValueFn = std::function<std::optional<double>(const Row&)>;
+
+    /**
+     * @param values Optional per-column numeric values used for the change direction
+     */
+    CellChangeTracker(RowKeyFn rowKey, std::vector<ValueFn> values)
+        : rowKey_(std::move(rowKey)), values_(std::move(values)) {}
+
+    /**
+     * @brief Mark the cells of rows that changed since the previous Apply()
+     *
+     * @param previous The rows passed to the previous Apply(), unmodified since
+     * @param now Timestamp recorded for rows changed by this call
+     */
+    std::shared_ptr<const CellChangeSnapshot> Apply(const std::vector<Row>& rows, const std::vector<Row>& previous,
+                                                    size_t columns, float now) {
+        auto out = std::make_shared<CellChangeSnapshot>();
+        out->columns = columns;
+        out->codes.assign((rows.size() * columns * 2 + 7) / 8, 0);
+        out->changedAt.assign(rows.size(), -1.0f);
+
+        const bool hasPrevious = last_ && last_->columns == columns && last_->rowCount() == previous.size();
+        std::unordered_map<uint64_t, uint32_t> index;
+        index.reserve(rows.size());
+        lastChanged_ = 0;
+
+        for (size_t i = 0; i < rows.size(); i++) {
+            const Row& row = rows[i];
+            uint64_t key = rowKey_(row);
+            index[key] = static_cast<uint32_t>(i);
+            if (!hasPrevious) continue;
+
+            auto it = index_.find(key);
+            if (it == index_.end()) {
+                for (size_t col = 0; col < columns; col++) out->Set(i, col, CellChange::Changed);
+                out->changedAt[i] = now;
+                lastChanged_++;
+                continue;
+            }
+
+            const size_t prevIdx = it->second;
+            const Row& old = previous[prevIdx];
+            bool changed = false;
+            for (size_t col = 0; col < columns; col++) {
+                bool inNew = col < row.columns.size();
+                bool inOld = col < old.columns.size();
+                if (inNew == inOld && (!inNew || row.columns[col] == old.columns[col])) continue;
+                out->Set(i, col, Direction(col, row, old));
+                changed = true;
+            }
+            if (changed) {
+                out->changedAt[i] = now;
+                lastChanged_++;
+            } else if (last_->changedAt[prevIdx] >= 0) {
+                out->changedAt[i] = last_->changedAt[prevIdx];
+                for (size_t col = 0; col < columns; col++) out->Set(i, col, last_->Get(prevIdx, col));
+            }
+        }
+
+        index_ = std::move(index);
+        last_ = out;
+        return out;
+    }
+
+    /// Forget the previous snapshot (the next Apply() marks nothing)
+    void Reset() {
+        index_.clear();
+        last_.reset();
+    }
+
+    /// Rows inserted or changed by the last Apply()
+    size_t LastChangedRows() const { return lastChanged_; }
+
+private:
+    CellChange Direction(size_t col, const Row& row, const Row& old) const {
+        if (col >= values_.size() || !values_[col]) return CellChange::Changed;
+        std::optional<double> now = values_[col](row);
+        std::optional<double> before = values_[col](old);
+        if (!now || !before || *now == *before) return CellChange::Changed;
+        return *now > *before ? CellChange::Up : CellChange::Down;
+    }
+
+    RowKeyFn rowKey_;
+    std::vector<ValueFn> values_;
+    std::unordered_map<uint64_t, uint32_t> index_; // row key -> index in the previous snapshot
+    std::shared_ptr<const CellChangeSnapshot> last_;
+    size_t lastChanged_ = 0;
+};
+
+} // namespace db
@@ -0,0 +1,349 @@
+#pragma once
+
+#include <sqlite3.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bulk_mutation.h"
+#include "reactive_two_field_collection.h"
+#include "trace.h"
+
+namespace db {
+
+namespace persist_detail {
+
+template <typename T>
+constexpr const char* SqlType() {
+    if constexpr (std::is_same_v<T, std::string>) {
+        return "TEXT";
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return "REAL";
+    } else {
+        static_assert(std::is_integral_v<T>, "persisted fields must be arithmetic or std::string");
+        return "INTEGER";
+    }
+}
+
+template <typename T>
+void BindValue(sqlite3_stmt* stmt, int index, const T& v) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        sqlite3_bind_text(stmt, index, v.c_str(), static_cast<int>(v.size()), SQLITE_TRANSIENT);
+    } else if constexpr (std::is_floating_point_v<T>) {
+        sqlite3_bind_double(stmt, index, static_cast<double>(v));
+    } else {
+        sqlite3_bind_int64(stmt, index, static_cast<sqlite3_int64>(v));
+    }
+}
+
+template <typename T>
+T ColumnValue(sqlite3_stmt* stmt, int col) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+        return text ? std::string(text, static_cast<std::size_t>(sqlite3_column_bytes(stmt, col))) : std::string();
+    } else if constexpr (std::is_floating_point_v<T>) {
+        return static_cast<T>(sqlite3_column_double(stmt, col));
+    } else {
+        return static_cast<T>(sqlite3_column_int64(stmt, col));
+    }
+}
+
+} // namespace persist_detail
+
+/**
+ * @brief Mirrors a ReactiveTwoFieldCollection into a SQLite table and restores it after a restart
+ *
+ * The collection's change stream is coalesced per element id into a pending map (an insert
+ * followed by updates stays one insert, an insert followed by an erase disappears), which a
+ * writer thread commits in one transaction every `flushInterval`, or as soon as `batchSize`
+ * ids are pending. The table holds the current state only (id, key, elem1, elem2), so a
+ * restart restores the positions from one table scan instead of replaying the feed:
+ * Restore() reads the rows and hands them to the collection's parallel bulk_load(), which
+ * rebuilds totals, key and ordered indices and keeps the ids.
+ *
+ * A failed batch is rolled back and merged back into the pending changes for the next
+ * attempt; the error is kept in GetStats().lastError.
+ *
+ * For a file database pass a connection of its own (DatabaseManager::OpenWorkerConnection),
+ * which must outlive the store. A shared handle (a :memory: database's GetRawHandle()) also
+ * works: each batch holds bulk_detail::ConnectionLock from BEGIN to COMMIT, so other threads'
+ * statements wait for it instead of joining its transaction. A file database in WAL mode with
+ * synchronous = NORMAL loses at most the last flushInterval of changes on power failure.
+ *
+ * Example:
+ *   auto connection = DatabaseManager::Get().OpenWorkerConnection();
+ *   db::CollectionPersistence<PositionCollection> store(positions, connection.get(), "positions");
+ *   store.Restore();   // before the feed starts
+ *   // ... feed updates positions; changes are committed in the background
+ */
+template <typename Collection>
+class CollectionPersistence {
+public:
+    using id_type = typename Collection::id_type;
+    using elem1_type = typename Collection::elem1_type;
+    using elem2_type = typename Collection::elem2_type;
+    using key_type = typename Collection::key_type;
+    using Change = typename Collection::Change;
+    using ChangeKind = reactive::ChangeKind;
+
+    struct Options {
+        std::size_t batchSize = 4096;                 // pending ids that wake the writer early
+        std::chrono::milliseconds flushInterval{50};  // longest a change waits for its commit
+    };
+
+    struct Stats {
+        std::uint64_t batches = 0;
+        std::uint64_t failedBatches = 0;
+        std::uint64_t rowsWritten = 0;  // coalesced rows, not change events
+        std::size_t pending = 0;
+        std::string lastError;
+    };
+
+    /**
+     * @brief Create the table if missing, subscribe to the collection and start the writer
+     *
+     * @throws std::runtime_error if the table name is not an identifier or the schema cannot be created
+     */
+    CollectionPersistence(Collection& collection, sqlite3* handle, std::string table, Options options = {})
+        : m_collection(collection), m_db(handle), m_table(std::move(table)), m_options(options) {
+        if (!m_db) throw std::runtime_error("CollectionPersistence: database not initialized");
+        if (!bulk_detail::IsIdentifier(m_table)) {
+            throw std::runtime_error("CollectionPersistence: invalid table name '" + m_table + "'");
+        }
+        std::string columns = "id INTEGER PRIMARY KEY";
+        if constexpr (kHasKeys) columns += std::string(", key ") + persist_detail::SqlType<key_type>();
+        columns += std::string(", elem1 ") + persist_detail::SqlType<elem1_type>();
+        columns += std::string(", elem2 ") + persist_detail::SqlType<elem2_type>();
+        bulk_detail::Exec(m_db, "CREATE TABLE IF NOT EXISTS " + m_table + " (" + columns + ")");
+
+        m_collection.set_change_listener([this](const Change& c) { OnChange(c); });
+        m_thread = std::thread([this]() { Run(); });
+    }
+
+    /// Unsubscribes and commits what is still pending. No other thread may mutate the collection.
+    ~CollectionPersistence() {
+        m_collection.set_change_listener(nullptr);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_one();
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+    CollectionPersistence(const CollectionPersistence&) = delete;
+    CollectionPersistence& operator=(const CollectionPersistence&) = delete;
+
+    /**
+     * @brief Load the table into the (empty) collection with Collection::bulk_load
+     *
+     * @return Number of elements restored
+     * @throws std::runtime_error on SQLite errors, or from bulk_load if the collection is not empty
+     */
+    std::size_t Restore() {
+        KS_TRACE_SCOPE("persist", "Restore", m_table);
+        std::vector<typename Collection::LoadRecord> records;
+        bulk_detail::ConnectionLock connectionLock(m_db); // not inside another writer's transaction
+        {
+            bulk_detail::Statement count(m_db, "SELECT count(*) FROM " + m_table);
+            if (sqlite3_step(count.get()) == SQLITE_ROW) {
+                records.reserve(static_cast<std::size_t>(sqlite3_column_int64(count.get(), 0)));
+            }
+        }
+        bulk_detail::Statement select(m_db, kHasKeys ? "SELECT id, elem1, elem2, key FROM " + m_table
+                                                     : "SELECT id, elem1, elem2 FROM " + m_table);
+        int rc;
+        while ((rc = sqlite3_step(select.get())) == SQLITE_ROW) {
+            typename Collection::LoadRecord r{persist_detail::ColumnValue<id_type>(select.get(), 0),
+                                              persist_detail::ColumnValue<elem1_type>(select.get(), 1),
+                                              persist_detail::ColumnValue<elem2_type>(select.get(), 2)};
+            if constexpr (kHasKeys) r.key = persist_detail::ColumnValue<key_type>(select.get(), 3);
+            records.push_back(std::move(r));
+        }
+        if (rc != SQLITE_DONE) throw std::runtime_error(std::string("Restore failed: ") + sqlite3_errmsg(m_db));
+
+        const std::size_t restored = records.size();
+        m_collection.bulk_load(std::move(records));
+        return restored;
+    }
+
+    /// Commit everything pending now, on the calling thread
+    void Flush() { WriteBatch(); }
+
+    Stats GetStats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Stats s = m_stats;
+        s.pending = m_pending.size();
+        return s;
+    }
+
+private:
+    static constexpr bool kHasKeys = Collection::has_keys;
+
+    // Latest state of one element since the last commit
+    struct PendingRow {
+        ChangeKind kind;
+        elem1_type elem1{};
+        elem2_type elem2{};
+        std::optional<key_type> key;  // set for Insert
+    };
+    using PendingMap = std::unordered_map<id_type, PendingRow>;
+
+    void OnChange(const Change& c) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_pending.find(c.id);
+        switch (c.kind) {
+            case ChangeKind::Insert:
+                m_pending.insert_or_assign(c.id, PendingRow{ChangeKind::Insert, c.elem1, c.elem2, *c.key});
+                break;
+            case ChangeKind::Update:
+                if (it == m_pending.end()) {
+                    m_pending.emplace(c.id, PendingRow{ChangeKind::Update, c.elem1, c.elem2, std::nullopt});
+                } else {
+                    it->second.elem1 = c.elem1;
+                    it->second.elem2 = c.elem2;
+                }
+                break;
+            case ChangeKind::Erase:
+                // Never committed: nothing to delete
+                if (it != m_pending.end() && it->second.kind == ChangeKind::Insert) {
+                    m_pending.erase(it);
+                } else {
+                    m_pending.insert_or_assign(c.id, PendingRow{ChangeKind::Erase, {}, {}, std::nullopt});
+                }
+                break;
+        }
+        if (m_pending.size() >= m_options.batchSize) m_cv.notify_one();
+    }
+
+    void Run() {
+        Trace::SetThreadName("collection persister");
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait_for(lock, m_options.flushInterval,
+                              [this] { return m_stop || m_pending.size() >= m_options.batchSize; });
+                if (m_stop) break;
+            }
+            WriteBatch();
+        }
+        WriteBatch();
+    }
+
+    // Swap out the pending changes and commit them in one transaction. m_writeMutex keeps
+    // batches in swap order when Flush() races the writer thread.
+    void WriteBatch() {
+        std::lock_guard<std::mutex> writeLock(m_writeMutex);
+        PendingMap batch;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_pending.empty()) return;
+            batch.swap(m_pending);
+        }
+        KS_TRACE_SCOPE("persist", "WriteBatch", m_table);
+
+        bulk_detail::ConnectionLock connectionLock(m_db);
+        bool inTransaction = false;
+        try {
+            if (!m_upsert) Prepare();
+            bulk_detail::Exec(m_db, "BEGIN IMMEDIATE");
+            inTransaction = true;
+            for (const auto& [id, row] : batch) {
+                bulk_detail::Statement* stmt = nullptr;
+                switch (row.kind) {
+                    case ChangeKind::Insert:
+                        stmt = m_upsert.get();
+                        if constexpr (kHasKeys) persist_detail::BindValue(stmt->get(), 4, *row.key);
+                        break;
+                    case ChangeKind::Update:
+                        stmt = m_update.get();
+                        break;
+                    case ChangeKind::Erase:
+                        stmt = m_delete.get();
+                        break;
+                }
+                persist_detail::BindValue(stmt->get(), 1, id);
+                if (row.kind != ChangeKind::Erase) {
+                    persist_detail::BindValue(stmt->get(), 2, row.elem1);
+                    persist_detail::BindValue(stmt->get(), 3, row.elem2);
+                }
+                stmt->Run();
+            }
+            bulk_detail::Exec(m_db, "COMMIT");
+            inTransaction = false;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.batches++;
+            m_stats.rowsWritten += batch.size();
+        } catch (const std::exception& e) {
+            // A statement that failed is not reset by Run(); until it is, binds are refused
+            // and the next step replays the failed row
+            for (auto* stmt : {m_upsert.get(), m_update.get(), m_delete.get()}) {
+                if (stmt) sqlite3_reset(stmt->get());
+            }
+            if (inTransaction) sqlite3_exec(m_db, "ROLLBACK", nullptr, nullptr, nullptr);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.failedBatches++;
+            m_stats.lastError = e.what();
+            Requeue(batch);
+        }
+    }
+
+    // Put a failed batch back under the changes that arrived since; caller holds m_mutex
+    void Requeue(PendingMap& failed) {
+        for (auto& [id, row] : failed) {
+            auto it = m_pending.find(id);
+            if (it == m_pending.end()) {
+                m_pending.emplace(id, std::move(row));
+            } else if (row.kind == ChangeKind::Insert) {
+                // The row never reached the table: a later update still inserts it
+                if (it->second.kind == ChangeKind::Erase) {
+                    m_pending.erase(it);
+                } else {
+                    it->second.kind = ChangeKind::Insert;
+                    it->second.key = std::move(row.key);
+                }
+            }
+        }
+    }
+
+    void Prepare() {
+        m_upsert = std::make_unique<bulk_detail::Statement>(
+            m_db, kHasKeys ? "INSERT OR REPLACE INTO " + m_table + " (id, elem1, elem2, key) VALUES (?1, ?2, ?3, ?4)"
+                           : "INSERT OR REPLACE INTO " + m_table + " (id, elem1, elem2) VALUES (?1, ?2, ?3)");
+        m_update = std::make_unique<bulk_detail::Statement>(
+            m_db, "UPDATE " + m_table + " SET elem1 = ?2, elem2 = ?3 WHERE id = ?1");
+        m_delete = std::make_unique<bulk_detail::Statement>(m_db, "DELETE FROM " + m_table + " WHERE id = ?1");
+    }
+
+    Collection& m_collection;
+    sqlite3* m_db;
+    std::string m_table;
+    Options m_options;
+
+    mutable std::mutex m_mutex;  // m_pending, m_stats, m_stop
+    std::condition_variable m_cv;
+    PendingMap m_pending;
+    Stats m_stats;
+    bool m_stop = false;
+
+    std::mutex m_writeMutex;  // one batch at a time; owns the statements
+    std::unique_ptr<bulk_detail::Statement> m_upsert;
+    std::unique_ptr<bulk_detail::Statement> m_update;
+    std::unique_ptr<bulk_detail::Statement> m_delete;
+
+    std::thread m_thread;
+};
+
+} // namespace db
@@ -6,7 +6,10 @@
 #include <memory>
 #include <iostream>
 #include <functional>
+#include <thread>
+#include "bulk_mutation.h"
 #include "database_mode.h"
+#include "trace.h"
 
 class DatabaseManager {
 public:
@@ -61,6 +64,8 @@ public:
             m_db = std::make_unique<sqlpp::sqlite3::connection>(conn_config);
             m_lastError.clear();
             m_currentMode = config.mode;
+            m_config = config;
+            InstallSqlTrace(m_db->native_handle());
 
             // Apply performance tuning
             if (config.tuning.enabled) {
@@ -338,13 +343,159 @@ public:
      */
     sqlite3* GetRawHandle() { return m_db ? m_db->native_handle() : nullptr; }
 
+    // ============================================================================
+    // Background bulk mutations
+    // ============================================================================
+
+    /**
+     * @brief Start a set-based bulk UPDATE on a background thread
+     *
+     * The selection is materialized with set-based statements and applied in
+     * chunks inside a single transaction (see BulkUpdateRequest). Poll the returned
+     * job for progress, call Cancel() to roll back.
+     *
+     * File-backed databases use a dedicated background connection so readers on the
+     * main connection are not blocked (WAL). :memory: databases are private to their
+     * connection, so the job runs on the main (serialized) connection and holds it
+     * exclusively: statements issued from other threads while it runs wait until it
+     * commits or rolls back (see bulk_detail::RunBulkUpdateExclusive).
+     *
+     * Only one bulk job runs at a time.
+     *
+     * @return The job, or nullptr (see GetLastError()) if not initialized or busy
+     *
+     * Example (every 3rd row from row 10, new values computed per row):
+     *   BulkUpdateRequest req;
+     *   req.table = "foo";
+     *   req.offset = 10;
+     *   req.modN = 3;
+     *   req.keyColumn = "id";
+     *   req.stagedColumns = {"name"};
+     *   req.valueProvider = [](const BulkTarget& t, std::vector<BulkValue>& v) {
+     *       v[0] = "row " + std::to_string(t.key);
+     *   };
+     *   auto job = DatabaseManager::Get().StartBulkUpdate(std::move(req));
+     */
+    std::shared_ptr<BulkMutationJob> StartBulkUpdate(BulkUpdateRequest request) {
+        if (!m_db) {
+            m_lastError = "Database not initialized";
+            return nullptr;
+        }
+        if (m_bulkJob && !m_bulkJob->IsFinished()) {
+            m_lastError = "A bulk mutation is already running";
+            return nullptr;
+        }
+        if (m_bulkThread.joinable()) {
+            m_bulkThread.join();
+        }
+
+        auto job = std::make_shared<BulkMutationJob>();
+        m_bulkJob = job;
+        const bool useMain = m_currentMode == DatabaseMode::Memory;
+        const std::string path = m_config.path;
+        sqlite3* mainHandle = m_db->native_handle();
+
+        m_bulkThread = std::thread([job, request = std::move(request), useMain, path, mainHandle]() {
+            db::Trace::SetThreadName("bulk mutation");
+            KS_TRACE_SCOPE("db", "BulkUpdate", request.table);
+            if (useMain) {
+                bulk_detail::RunBulkUpdateExclusive(mainHandle, request, *job);
+                return;
+            }
+            std::string error;
+            sqlite3* bg = OpenBackgroundConnection(path, error);
+            if (!bg) {
+                job->SetError(error);
+                job->SetState(BulkMutationJob::State::Failed);
+                return;
+            }
+            bulk_detail::RunBulkUpdate(bg, request, *job);
+            sqlite3_close(bg);
+        });
+        return job;
+    }
+
+    // Current (or last) bulk job, nullptr if none was started
+    std::shared_ptr<BulkMutationJob> GetBulkJob() const { return m_bulkJob; }
+
+    struct ConnectionCloser {
+        void operator()(sqlite3* handle) const { sqlite3_close(handle); }
+    };
+    using OwnedConnection = std::unique_ptr<sqlite3, ConnectionCloser>;
+
+    /**
+     * @brief Open a separate connection to the current file database for a background writer
+     *
+     * Transactions belong to a connection, so writers that share GetRawHandle() see and roll
+     * back each other's changes. With a file database (WAL) each writer thread gets its own
+     * connection instead, like StartBulkUpdate's job. A :memory: database is private to the
+     * main connection: this returns nullptr and writers share GetRawHandle(), taking
+     * bulk_detail::ConnectionLock around their transactions.
+     *
+     * @return The connection, or nullptr (see GetLastError()) for :memory: or on failure
+     */
+    OwnedConnection OpenWorkerConnection() {
+        if (!m_db) {
+            m_lastError = "Database not initialized";
+            return nullptr;
+        }
+        if (m_currentMode == DatabaseMode::Memory) {
+            m_lastError = "In-memory databases have no second connection";
+            return nullptr;
+        }
+        return OwnedConnection(OpenBackgroundConnection(m_config.path, m_lastError));
+    }
+
 private:
+    // Serialized connection for a non-UI thread; nullptr and error set on failure
+    static sqlite3* OpenBackgroundConnection(const std::string& path, std::string& error) {
+        sqlite3* bg = nullptr;
+        if (sqlite3_open_v2(path.c_str(), &bg, SQLITE_OPEN_READWRITE | SQLITE_OPEN_FULLMUTEX, nullptr) != SQLITE_OK) {
+            error = std::string("Failed to open background connection: ") + (bg ? sqlite3_errmsg(bg) : "out of memory");
+            sqlite3_close(bg);
+            return nullptr;
+        }
+        InstallSqlTrace(bg);
+        sqlite3_busy_timeout(bg, 5000);
+        sqlite3_exec(bg, "PRAGMA temp_store = MEMORY", nullptr, nullptr, nullptr);
+        return bg;
+    }
+
+    /**
+     * @brief Record every statement as a "sql" span while db::Trace is enabled
+     *
+     * SQLITE_TRACE_PROFILE reports after the statement finishes, with its run time in ns,
+     * so the span is reconstructed backwards from the callback time.
+     */
+    static void InstallSqlTrace(sqlite3* handle) {
+        sqlite3_trace_v2(handle, SQLITE_TRACE_PROFILE, [](unsigned, void*, void* p, void* x) -> int {
+            if (!db::Trace::Enabled()) return 0;
+            const auto durNs = static_cast<std::uint64_t>(*static_cast<sqlite3_int64*>(x));
+            const std::uint64_t now = db::Trace::NowNs();
+            const char* sql = sqlite3_sql(static_cast<sqlite3_stmt*>(p));
+            db::Trace::Complete("sql", "statement", now > durNs ? now - durNs : 0, durNs, sql ? sql : "");
+            return 0;
+        }, nullptr);
+    }
+
     DatabaseManager() = default;
-    ~DatabaseManager() = default;
+    ~DatabaseManager() {
+        if (m_bulkJob) {
+            m_bulkJob->Cancel();
+        }
+        if (m_bulkThread.joinable()) {
+            m_bulkThread.join();
+        }
+    }
     DatabaseManager(const DatabaseManager&) = delete;
     DatabaseManager& operator=(const DatabaseManager&) = delete;
 
     std::unique_ptr<sqlpp::sqlite3::connection> m_db;
     std::string m_lastError;
     DatabaseMode m_currentMode = DatabaseMode::Memory;
+    DatabaseConfig m_config;
+
+    // Background bulk mutation (one at a time)
+    std::shared_ptr<BulkMutationJob> m_bulkJob;
+    std::thread m_bulkThread;
 };
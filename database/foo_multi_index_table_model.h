@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <any>
+#include <atomic>
 #include <cctype>
 #include <cstdint>
 #include <optional>
@@ -15,9 +16,11 @@
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/tag.hpp>
 
-#include <multi_index_lru/container.hpp>
-
 #include "async_table_widget.h"
+#include "indexed_model_core.h"
+#include "lru_container.h"
+#include "query_result_cache.h"
+#include "trace.h"
 
 namespace db {
 
@@ -32,7 +35,7 @@ struct FooByNameTag {};
 struct FooByHasFunTag {};
 struct FooByNameHasFunTag {};
 
-using FooCache = multi_index_lru::Container<
+using FooCache = LruContainer<
     FooCacheEntry,
     boost::multi_index::indexed_by<
         boost::multi_index::ordered_unique<
@@ -74,34 +77,31 @@ public:
         Order order = Order::LruMostRecentFirst;
         std::size_t offset = 0;
         std::size_t limit = 0;
+
+        bool operator==(const Query&) const = default;
     };
 
-    explicit FooMultiIndexTableModel(std::size_t capacity) : cache_(capacity) {}
+    /**
+     * @param policy EvictionPolicy::Clock lets FindById() count as a use under the shared lock
+     */
+    explicit FooMultiIndexTableModel(std::size_t capacity, EvictionPolicy policy = EvictionPolicy::Lru)
+        : core_(capacity, policy, "FooMultiIndexTableModel::mutex_") {}
 
-    bool Upsert(FooCacheEntry row) {
-        std::unique_lock lock(mutex_);
-        cache_.erase<FooByIdTag>(row.id);
-        return cache_.insert(std::move(row));
-    }
+    bool Upsert(FooCacheEntry row) { return core_.Upsert(std::move(row)); }
 
-    bool EraseById(std::int64_t id) {
-        std::unique_lock lock(mutex_);
-        return cache_.erase<FooByIdTag>(id);
-    }
+    bool EraseById(std::int64_t id) { return core_.EraseById(id); }
 
-    std::optional<FooCacheEntry> FindByIdNoUpdate(std::int64_t id) const {
-        std::shared_lock lock(mutex_);
-        auto it = cache_.find_no_update<FooByIdTag>(id);
-        if (it == cache_.end<FooByIdTag>()) {
-            return std::nullopt;
-        }
-        return *it;
-    }
+    /// Look up by id and count it as a use for eviction (see IndexedModelCore::FindById)
+    std::optional<FooCacheEntry> FindById(std::int64_t id) { return core_.FindById(id); }
 
-    std::size_t Size() const {
-        std::shared_lock lock(mutex_);
-        return cache_.size();
-    }
+    std::optional<FooCacheEntry> FindByIdNoUpdate(std::int64_t id) const { return core_.FindByIdNoUpdate(id); }
+
+    std::size_t Size() const { return core_.Size(); }
+
+    /**
+     * @brief Publish lock wait times to the PerfRegistry ("Locks" category) under this name
+     */
+    void SetPerfName(const std::string& name) { core_.SetPerfName(name); }
 
     static void ConfigureAsyncTableColumns(AsyncTableWidget& table) {
         table.AddColumn("ID", 80.0f);
@@ -130,20 +130,54 @@ public:
         });
     }
 
+    /**
+     * @brief Query filters (everything except order/offset/limit)
+     */
+    static bool MatchesQuery(const Query& query, const FooCacheEntry& entry) {
+        if (query.hasFunFilter && entry.hasFun != *query.hasFunFilter) {
+            return false;
+        }
+        if (!query.namePrefix.empty() && !StartsWith(entry.name, query.namePrefix)) {
+            return false;
+        }
+        if (!query.textContains.empty() && !ContainsCaseInsensitive(entry.name, query.textContains)) {
+            return false;
+        }
+        return true;
+    }
+
+    static AsyncTableWidget::Row MakeAsyncRow(const FooCacheEntry& entry) {
+        return AsyncTableWidget::Row{{std::to_string(entry.id), entry.name, entry.hasFun ? "Yes" : "No"},
+                                     FooTypedData{entry.id, entry.name, entry.hasFun}};
+    }
+
+    /**
+     * @brief Rows for query; repeated queries are served from the result cache until a
+     * write that can change their result
+     */
     void BuildAsyncRows(std::vector<AsyncTableWidget::Row>& out, const Query& query) const {
-        out.clear();
-        std::shared_lock lock(mutex_);
+        core_.BuildAsyncRows(*this, out, query);
+    }
+
+    /**
+     * @brief Incremented by every write (a cheap "did anything change" check for refreshes)
+     */
+    std::uint64_t GetGeneration() const { return core_.GetGeneration(); }
 
+    /**
+     * @brief Number of recent queries whose results are kept (default 8, 0 disables)
+     */
+    void SetResultCacheCapacity(std::size_t capacity) { core_.SetResultCacheCapacity(capacity); }
+
+    const QueryResultCache<Query, AsyncTableWidget::Row>& GetResultCache() const { return core_.GetResultCache(); }
+
+private:
+    void CollectMatches(std::vector<const FooCacheEntry*>& out, const Query& query) const {
+        const auto& rows = core_.GetCache().get_container();
         std::size_t seen = 0;
         std::size_t emitted = 0;
         auto pushIfMatch = [&](const FooCacheEntry& entry) {
-            if (query.hasFunFilter && entry.hasFun != *query.hasFunFilter) {
-                return;
-            }
-            if (!query.namePrefix.empty() && !StartsWith(entry.name, query.namePrefix)) {
-                return;
-            }
-            if (!query.textContains.empty() && !ContainsCaseInsensitive(entry.name, query.textContains)) {
+            if (!MatchesQuery(query, entry)) {
                 return;
             }
             if (seen++ < query.offset) {
@@ -153,44 +187,41 @@ public:
                 return;
             }
 
-            out.push_back(AsyncTableWidget::Row{
-                {std::to_string(entry.id), entry.name, entry.hasFun ? "Yes" : "No"},
-                FooTypedData{entry.id, entry.name, entry.hasFun}
-            });
+            out.push_back(&entry);
             ++emitted;
         };
 
         switch (query.order) {
             case Order::LruMostRecentFirst: {
-                const auto& lru = cache_.get_container().template get<0>();
+                const auto& lru = rows.template get<0>();
                 for (const auto& entry : lru) {
                     pushIfMatch(entry);
                 }
                 break;
             }
             case Order::IdAsc: {
-                const auto& idx = cache_.get_container().template get<FooByIdTag>();
+                const auto& idx = rows.template get<FooByIdTag>();
                 for (const auto& entry : idx) {
                     pushIfMatch(entry);
                 }
                 break;
             }
             case Order::IdDesc: {
-                const auto& idx = cache_.get_container().template get<FooByIdTag>();
+                const auto& idx = rows.template get<FooByIdTag>();
                 for (auto it = idx.rbegin(); it != idx.rend(); ++it) {
                     pushIfMatch(*it);
                 }
                 break;
             }
             case Order::NameAsc: {
-                const auto& idx = cache_.get_container().template get<FooByNameTag>();
+                const auto& idx = rows.template get<FooByNameTag>();
                 for (const auto& entry : idx) {
                     pushIfMatch(entry);
                 }
                 break;
             }
             case Order::NameDesc: {
-                const auto& idx = cache_.get_container().template get<FooByNameTag>();
+                const auto& idx = rows.template get<FooByNameTag>();
                 for (auto it = idx.rbegin(); it != idx.rend(); ++it) {
                     pushIfMatch(*it);
                 }
@@ -199,7 +230,6 @@ public:
         }
     }
 
-private:
     static bool StartsWith(const std::string& s, const std::string& prefix) {
         return s.size() >= prefix.size() && std::equal(prefix.begin(), prefix.end(), s.begin());
     }
@@ -214,8 +244,10 @@ private:
         return lhs.find(rhs) != std::string::npos;
     }
 
-    mutable std::shared_mutex mutex_;
-    FooCache cache_;
+    using Core = IndexedModelCore<FooMultiIndexTableModel, FooCacheEntry, FooCache, FooByIdTag, Query>;
+    friend Core; // calls CollectMatches under its read lock
+
+    Core core_;
 };
 
 } // namespace db
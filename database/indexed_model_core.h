@@ -0,0 +1,197 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "async_table_widget.h"
+#include "lock_profiler.h"
+#include "lru_container.h"
+#include "parallel_for.h"
+#include "perf_counters.h"
+#include "query_result_cache.h"
+#include "trace.h"
+
+namespace db {
+
+/**
+ * @brief Locking, write generation and result-cache upkeep shared by the multi-index table models
+ *
+ * The model (Owner) holds one of these and supplies the query semantics:
+ *   static bool MatchesQuery(const Query&, const Entry&)             filters only
+ *   static AsyncTableWidget::Row MakeAsyncRow(const Entry&)
+ *   void CollectMatches(std::vector<const Entry*>&, const Query&) const  (runs under the read lock)
+ * and Query::order has a LruMostRecentFirst value for the recency order.
+ *
+ * Cached results are dropped by one set of rules for every model:
+ *  - an upsert or erase drops the queries the old or the new row matches;
+ *  - an insert into a full cache evicts some unknown row, so it drops everything;
+ *  - a lookup that refreshes recency drops the recency-ordered queries the row matches.
+ */
+template <typename Owner, typename Entry, typename Cache, typename IdTag, typename Query>
+class IndexedModelCore {
+public:
+    using Row = AsyncTableWidget::Row;
+    using ResultCache = QueryResultCache<Query, Row>;
+
+    IndexedModelCore(std::size_t capacity, EvictionPolicy policy, const char* mutexName)
+        : mutex_(mutexName), cache_(capacity, policy) {}
+
+    bool Upsert(Entry row) {
+        KS_TRACE_SCOPE("model", "Upsert");
+        auto lock = WriteLock();
+        BeforeWrite(row.id, &row);
+        return cache_.template upsert<IdTag>(std::move(row));
+    }
+
+    bool EraseById(std::int64_t id) {
+        KS_TRACE_SCOPE("model", "EraseById");
+        auto lock = WriteLock();
+        BeforeWrite(id, nullptr);
+        return cache_.template erase<IdTag>(id);
+    }
+
+    /**
+     * @brief Look up by id and count it as a use for eviction
+     *
+     * With EvictionPolicy::Clock this only sets the entry's reference bit and runs under
+     * the shared lock; with EvictionPolicy::Lru it relocates the entry and takes the
+     * writer lock.
+     */
+    std::optional<Entry> FindById(std::int64_t id) {
+        KS_TRACE_SCOPE("model", "FindById");
+        if (cache_.policy() == EvictionPolicy::Clock) {
+            auto lock = ReadLock();
+            auto it = cache_.template find_shared<IdTag>(id);
+            if (it == cache_.template end<IdTag>()) {
+                return std::nullopt;
+            }
+            return static_cast<const Entry&>(*it);
+        }
+        auto lock = WriteLock();
+        auto it = cache_.template find<IdTag>(id);
+        if (it == cache_.template end<IdTag>()) {
+            return std::nullopt;
+        }
+        AfterRecencyChange(*it);
+        return static_cast<const Entry&>(*it);
+    }
+
+    std::optional<Entry> FindByIdNoUpdate(std::int64_t id) const {
+        auto lock = ReadLock();
+        auto it = cache_.template find_no_update<IdTag>(id);
+        if (it == cache_.template end<IdTag>()) {
+            return std::nullopt;
+        }
+        return static_cast<const Entry&>(*it);
+    }
+
+    std::size_t Size() const {
+        auto lock = ReadLock();
+        return cache_.size();
+    }
+
+    /**
+     * @brief Publish lock wait times to the PerfRegistry ("Locks" category) under this name
+     */
+    void SetPerfName(const std::string& name) {
+        writeWait_ = &PerfRegistry::Get().Duration("Locks", name + " write wait");
+        readWait_ = &PerfRegistry::Get().Duration("Locks", name + " read wait");
+    }
+
+    /**
+     * @brief Rows for query; repeated queries are served from the result cache until a
+     * write that can change their result
+     */
+    void BuildAsyncRows(const Owner& owner, std::vector<Row>& out, const Query& query) const {
+        KS_TRACE_SCOPE("model", "BuildAsyncRows");
+        out.clear();
+        bool admit = false;
+        std::vector<const Entry*> matches;
+        std::vector<Entry> snapshot;
+        std::uint64_t generation = 0;
+        {
+            // Two phases: copy the matches under the lock, then format them without it
+            // (in parallel when large), so writers are not held up by the formatting
+            auto lock = ReadLock();
+            if (auto cached = results_.Find(query, admit)) {
+                out = *cached;
+                return;
+            }
+            owner.CollectMatches(matches, query);
+            DetachMatches(matches, snapshot);
+            generation = GetGeneration();
+        }
+        ParallelMaterialize(matches, out, [](const Entry& entry) { return Owner::MakeAsyncRow(entry); });
+        if (admit) {
+            // A write since the snapshot may already have run its invalidation: don't cache
+            auto lock = ReadLock();
+            if (GetGeneration() == generation) {
+                results_.Store(query, out);
+            }
+        }
+    }
+
+    /**
+     * @brief Incremented by every write (a cheap "did anything change" check for refreshes)
+     */
+    std::uint64_t GetGeneration() const { return generation_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Number of recent queries whose results are kept (default 8, 0 disables)
+     */
+    void SetResultCacheCapacity(std::size_t capacity) { results_.SetCapacity(capacity); }
+
+    const ResultCache& GetResultCache() const { return results_; }
+
+    /// Indexed rows, for Owner::CollectMatches (the read lock is held while it runs)
+    const Cache& GetCache() const { return cache_; }
+
+private:
+    /// Under the write lock, before `after` (null = erase) replaces the row with id
+    void BeforeWrite(std::int64_t id, const Entry* after) {
+        generation_.fetch_add(1, std::memory_order_release);
+        if (!results_.HasResults()) {
+            return;
+        }
+        auto it = cache_.template find_no_update<IdTag>(id);
+        const Entry* before = it == cache_.template end<IdTag>() ? nullptr : &*it;
+        // An insert into a full cache evicts some other row: no query is safe
+        const bool evicts = after && !before && cache_.size() >= cache_.capacity();
+        results_.Invalidate([&](const Query& query) {
+            return evicts || (before && Owner::MatchesQuery(query, *before)) ||
+                   (after && Owner::MatchesQuery(query, *after));
+        });
+    }
+
+    /// Under the write lock, after a lookup moved row to the front of the LRU order
+    void AfterRecencyChange(const Entry& row) {
+        generation_.fetch_add(1, std::memory_order_release);
+        results_.Invalidate([&](const Query& query) {
+            return query.order == decltype(query.order)::LruMostRecentFirst && Owner::MatchesQuery(query, row);
+        });
+    }
+
+    std::unique_lock<ProfiledSharedMutex> WriteLock() const {
+        return PerfTimedLock<std::unique_lock<ProfiledSharedMutex>>(mutex_, writeWait_);
+    }
+
+    std::shared_lock<ProfiledSharedMutex> ReadLock() const {
+        return PerfTimedLock<std::shared_lock<ProfiledSharedMutex>>(mutex_, readWait_);
+    }
+
+    mutable ProfiledSharedMutex mutex_;
+    PerfDuration* writeWait_ = nullptr;
+    PerfDuration* readWait_ = nullptr;
+    Cache cache_;
+    std::atomic<std::uint64_t> generation_{0};
+    mutable ResultCache results_;
+};
+
+} // namespace db
@@ -0,0 +1,434 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#if defined(KS_LOCK_PROFILING) && defined(__GNUC__) && !defined(__EMSCRIPTEN__)
+#define KS_LOCK_PROFILING_CALL_SITES 1
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <cstdlib>
+#endif
+
+namespace db {
+
+/**
+ * @brief Compile-time lock contention profiler
+ *
+ * ProfiledMutex / ProfiledSharedMutex are drop-in replacements for std::mutex /
+ * std::shared_mutex that take a name. Without KS_LOCK_PROFILING (CMake option
+ * KITCHENSINK_LOCK_PROFILING) they are the std types plus an ignored constructor
+ * argument, so the instrumentation costs nothing in normal builds.
+ *
+ * With profiling enabled every acquisition is classified as uncontended (try_lock
+ * succeeded) or contended, and per lock *name* (instances sharing a name, e.g. the
+ * collection's submaps, are aggregated) the profiler keeps:
+ * - acquisitions (exclusive and shared) and contended acquisitions
+ * - a log2 histogram of wait times, total and max wait
+ * - exclusive hold times (total and max)
+ * - the call sites with the most contended waits (return address of lock(),
+ *   symbolized with dladdr when the report is generated)
+ *
+ * LockProfiler::Get().Report() renders a table sorted by total wait time, which is
+ * the order in which locks are worth attacking.
+ */
+#ifdef KS_LOCK_PROFILING
+inline constexpr bool kLockProfilingEnabled = true;
+#else
+inline constexpr bool kLockProfilingEnabled = false;
+#endif
+
+class LockStats {
+public:
+    static constexpr std::size_t kHistogramBuckets = 40; // bucket i: wait in [2^i, 2^(i+1)) ns
+    static constexpr std::size_t kCallSiteSlots = 64;
+
+    explicit LockStats(std::string name) : m_name(std::move(name)) {}
+
+    const std::string& Name() const { return m_name; }
+
+    void RecordAcquire(bool shared, bool contended, std::uint64_t waitNs, const void* site) {
+        (shared ? m_sharedAcquisitions : m_acquisitions).fetch_add(1, std::memory_order_relaxed);
+        if (!contended) {
+            return;
+        }
+        m_contended.fetch_add(1, std::memory_order_relaxed);
+        m_waitNs.fetch_add(waitNs, std::memory_order_relaxed);
+        AtomicMax(m_maxWaitNs, waitNs);
+        m_waitHistogram[Bucket(waitNs)].fetch_add(1, std::memory_order_relaxed);
+        RecordSite(site, waitNs);
+    }
+
+    void RecordHold(std::uint64_t holdNs) {
+        m_holdNs.fetch_add(holdNs, std::memory_order_relaxed);
+        AtomicMax(m_maxHoldNs, holdNs);
+    }
+
+    struct CallSite {
+        const void* address = nullptr;
+        std::uint64_t contended = 0;
+        std::uint64_t waitNs = 0;
+    };
+
+    struct Snapshot {
+        std::string name;
+        std::uint64_t acquisitions = 0;
+        std::uint64_t sharedAcquisitions = 0;
+        std::uint64_t contended = 0;
+        std::uint64_t waitNs = 0;
+        std::uint64_t maxWaitNs = 0;
+        std::uint64_t holdNs = 0;
+        std::uint64_t maxHoldNs = 0;
+        std::array<std::uint64_t, kHistogramBuckets> waitHistogram{};
+        std::vector<CallSite> sites; // sorted by wait time, descending
+
+        /// Approximate wait percentile (upper bound of the histogram bucket), in ns
+        std::uint64_t WaitPercentileNs(double p) const {
+            if (contended == 0) return 0;
+            const auto target = static_cast<std::uint64_t>(p * static_cast<double>(contended));
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < kHistogramBuckets; ++i) {
+                seen += waitHistogram[i];
+                if (seen > target) return (std::uint64_t{2} << i) - 1;
+            }
+            return maxWaitNs;
+        }
+    };
+
+    Snapshot Take() const {
+        Snapshot s;
+        s.name = m_name;
+        s.acquisitions = m_acquisitions.load(std::memory_order_relaxed);
+        s.sharedAcquisitions = m_sharedAcquisitions.load(std::memory_order_relaxed);
+        s.contended = m_contended.load(std::memory_order_relaxed);
+        s.waitNs = m_waitNs.load(std::memory_order_relaxed);
+        s.maxWaitNs = m_maxWaitNs.load(std::memory_order_relaxed);
+        s.holdNs = m_holdNs.load(std::memory_order_relaxed);
+        s.maxHoldNs = m_maxHoldNs.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < kHistogramBuckets; ++i) {
+            s.waitHistogram[i] = m_waitHistogram[i].load(std::memory_order_relaxed);
+        }
+        for (const auto& slot : m_sites) {
+            auto addr = slot.address.load(std::memory_order_acquire);
+            if (addr == 0) continue;
+            s.sites.push_back({reinterpret_cast<const void*>(addr), slot.contended.load(std::memory_order_relaxed),
+                               slot.waitNs.load(std::memory_order_relaxed)});
+        }
+        std::sort(s.sites.begin(), s.sites.end(), [](const CallSite& a, const CallSite& b) { return a.waitNs > b.waitNs; });
+        return s;
+    }
+
+    void Reset() {
+        m_acquisitions.store(0, std::memory_order_relaxed);
+        m_sharedAcquisitions.store(0, std::memory_order_relaxed);
+        m_contended.store(0, std::memory_order_relaxed);
+        m_waitNs.store(0, std::memory_order_relaxed);
+        m_maxWaitNs.store(0, std::memory_order_relaxed);
+        m_holdNs.store(0, std::memory_order_relaxed);
+        m_maxHoldNs.store(0, std::memory_order_relaxed);
+        for (auto& b : m_waitHistogram) b.store(0, std::memory_order_relaxed);
+        for (auto& slot : m_sites) {
+            slot.contended.store(0, std::memory_order_relaxed);
+            slot.waitNs.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct SiteSlot {
+        std::atomic<std::uintptr_t> address{0};
+        std::atomic<std::uint64_t> contended{0};
+        std::atomic<std::uint64_t> waitNs{0};
+    };
+
+    static std::size_t Bucket(std::uint64_t ns) {
+        std::size_t b = 0;
+        while (ns > 1 && b + 1 < kHistogramBuckets) {
+            ns >>= 1;
+            ++b;
+        }
+        return b;
+    }
+
+    static void AtomicMax(std::atomic<std::uint64_t>& target, std::uint64_t v) {
+        std::uint64_t prev = target.load(std::memory_order_relaxed);
+        while (v > prev && !target.compare_exchange_weak(prev, v, std::memory_order_relaxed)) {
+        }
+    }
+
+    // Lock-free open addressing keyed by return address; sites beyond the table are dropped
+    void RecordSite(const void* site, std::uint64_t waitNs) {
+        const auto key = reinterpret_cast<std::uintptr_t>(site);
+        if (key == 0) return;
+        std::size_t idx = static_cast<std::size_t>((key >> 4) * 0x9E3779B97F4A7C15ull) % kCallSiteSlots;
+        for (std::size_t probe = 0; probe < kCallSiteSlots; ++probe) {
+            SiteSlot& slot = m_sites[(idx + probe) % kCallSiteSlots];
+            std::uintptr_t current = slot.address.load(std::memory_order_acquire);
+            if (current == 0 &&
+                slot.address.compare_exchange_strong(current, key, std::memory_order_acq_rel)) {
+                current = key;
+            }
+            if (current == key) {
+                slot.contended.fetch_add(1, std::memory_order_relaxed);
+                slot.waitNs.fetch_add(waitNs, std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+
+    std::string m_name;
+    std::atomic<std::uint64_t> m_acquisitions{0};
+    std::atomic<std::uint64_t> m_sharedAcquisitions{0};
+    std::atomic<std::uint64_t> m_contended{0};
+    std::atomic<std::uint64_t> m_waitNs{0};
+    std::atomic<std::uint64_t> m_maxWaitNs{0};
+    std::atomic<std::uint64_t> m_holdNs{0};
+    std::atomic<std::uint64_t> m_maxHoldNs{0};
+    std::array<std::atomic<std::uint64_t>, kHistogramBuckets> m_waitHistogram{};
+    std::array<SiteSlot, kCallSiteSlots> m_sites{};
+};
+
+/**
+ * @brief Registry of LockStats by name, plus the text report
+ */
+class LockProfiler {
+public:
+    static LockProfiler& Get() {
+        static LockProfiler* instance = new LockProfiler(); // leaked: mutexes may outlive statics
+        return *instance;
+    }
+
+    /// Stats shared by all locks with this name (stable reference)
+    LockStats& Stats(const char* name) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& s : m_stats) {
+            if (s.Name() == name) return s;
+        }
+        return m_stats.emplace_back(name);
+    }
+
+    std::vector<LockStats::Snapshot> Snapshot() const {
+        std::vector<LockStats::Snapshot> out;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const auto& s : m_stats) out.push_back(s.Take());
+        }
+        std::sort(out.begin(), out.end(),
+                  [](const LockStats::Snapshot& a, const LockStats::Snapshot& b) { return a.waitNs > b.waitNs; });
+        return out;
+    }
+
+    void Reset() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& s : m_stats) s.Reset();
+    }
+
+    /**
+     * @brief Human-readable contention report, most total wait first
+     * @param topSites Call sites listed per lock
+     */
+    std::string Report(std::size_t topSites = 3) const {
+        if constexpr (!kLockProfilingEnabled) {
+            return "Lock profiling disabled (configure with -DKITCHENSINK_LOCK_PROFILING=ON)\n";
+        }
+        std::string out;
+        char line[256];
+        std::snprintf(line, sizeof(line), "%-40s %12s %10s %8s %11s %9s %9s %9s %10s %10s\n", "lock", "acquired",
+                      "shared", "cont%", "wait ms", "p50 us", "p99 us", "max us", "hold ms", "max hold");
+        out += line;
+        for (const auto& s : Snapshot()) {
+            const std::uint64_t total = s.acquisitions + s.sharedAcquisitions;
+            if (total == 0) continue;
+            std::snprintf(line, sizeof(line), "%-40.40s %12llu %10llu %7.2f%% %11.3f %9.1f %9.1f %9.1f %10.3f %8.1fus\n",
+                          s.name.c_str(), static_cast<unsigned long long>(total),
+                          static_cast<unsigned long long>(s.sharedAcquisitions),
+                          100.0 * static_cast<double>(s.contended) / static_cast<double>(total), s.waitNs / 1e6,
+                          s.WaitPercentileNs(0.50) / 1e3, s.WaitPercentileNs(0.99) / 1e3, s.maxWaitNs / 1e3,
+                          s.holdNs / 1e6, s.maxHoldNs / 1e3);
+            out += line;
+            for (std::size_t i = 0; i < s.sites.size() && i < topSites; ++i) {
+                std::snprintf(line, sizeof(line), "    %8llu waits %11.3f ms  at %s\n",
+                              static_cast<unsigned long long>(s.sites[i].contended), s.sites[i].waitNs / 1e6,
+                              Symbolize(s.sites[i].address).c_str());
+                out += line;
+            }
+        }
+        return out;
+    }
+
+    /// Best-effort "function+0xoffset" for a code address
+    static std::string Symbolize(const void* address) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%p", address);
+        std::string fallback = buf;
+#ifdef KS_LOCK_PROFILING_CALL_SITES
+        Dl_info info{};
+        if (dladdr(address, &info) && info.dli_sname) {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            std::string name = (status == 0 && demangled) ? demangled : info.dli_sname;
+            std::free(demangled);
+            if (name.size() > 120) name = name.substr(0, 117) + "...";
+            std::snprintf(buf, sizeof(buf), "+0x%llx",
+                          static_cast<unsigned long long>(static_cast<const char*>(address) -
+                                                          static_cast<const char*>(info.dli_saddr)));
+            return name + buf;
+        }
+        if (info.dli_fname && info.dli_fbase) {
+            // No exported symbol (static/inlined code): module offset, usable with addr2line -e
+            std::snprintf(buf, sizeof(buf), "+0x%llx",
+                          static_cast<unsigned long long>(static_cast<const char*>(address) -
+                                                          static_cast<const char*>(info.dli_fbase)));
+            return std::string(info.dli_fname) + buf;
+        }
+#endif
+        return fallback;
+    }
+
+private:
+    LockProfiler() = default;
+
+    mutable std::mutex m_mutex;
+    std::deque<LockStats> m_stats; // deque: stable references
+};
+
+#ifdef KS_LOCK_PROFILING
+
+namespace lock_detail {
+inline std::uint64_t NowNs() {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+} // namespace lock_detail
+
+#ifdef KS_LOCK_PROFILING_CALL_SITES
+#define KS_LOCK_CALLER() __builtin_extract_return_addr(__builtin_return_address(0))
+#define KS_LOCK_NOINLINE [[gnu::noinline]]
+#else
+#define KS_LOCK_CALLER() nullptr
+#define KS_LOCK_NOINLINE
+#endif
+
+/**
+ * @brief std::mutex with contention accounting (profiling builds)
+ */
+class ProfiledMutex {
+public:
+    explicit ProfiledMutex(const char* name = "unnamed mutex") : m_stats(&LockProfiler::Get().Stats(name)) {}
+    ProfiledMutex(const ProfiledMutex&) = delete;
+    ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+    KS_LOCK_NOINLINE void lock() {
+        if (m_mutex.try_lock()) {
+            m_stats->RecordAcquire(false, false, 0, nullptr);
+        } else {
+            const std::uint64_t start = lock_detail::NowNs();
+            m_mutex.lock();
+            m_stats->RecordAcquire(false, true, lock_detail::NowNs() - start, KS_LOCK_CALLER());
+        }
+        m_acquiredNs = lock_detail::NowNs();
+    }
+
+    bool try_lock() {
+        if (!m_mutex.try_lock()) return false;
+        m_stats->RecordAcquire(false, false, 0, nullptr);
+        m_acquiredNs = lock_detail::NowNs();
+        return true;
+    }
+
+    void unlock() {
+        m_stats->RecordHold(lock_detail::NowNs() - m_acquiredNs);
+        m_mutex.unlock();
+    }
+
+private:
+    std::mutex m_mutex;
+    LockStats* m_stats;
+    std::uint64_t m_acquiredNs = 0; // written by the owner only
+};
+
+/**
+ * @brief std::shared_mutex with contention accounting (profiling builds)
+ *
+ * Hold time is tracked for exclusive ownership only.
+ */
+class ProfiledSharedMutex {
+public:
+    explicit ProfiledSharedMutex(const char* name = "unnamed shared_mutex") : m_stats(&LockProfiler::Get().Stats(name)) {}
+    ProfiledSharedMutex(const ProfiledSharedMutex&) = delete;
+    ProfiledSharedMutex& operator=(const ProfiledSharedMutex&) = delete;
+
+    KS_LOCK_NOINLINE void lock() {
+        if (m_mutex.try_lock()) {
+            m_stats->RecordAcquire(false, false, 0, nullptr);
+        } else {
+            const std::uint64_t start = lock_detail::NowNs();
+            m_mutex.lock();
+            m_stats->RecordAcquire(false, true, lock_detail::NowNs() - start, KS_LOCK_CALLER());
+        }
+        m_acquiredNs = lock_detail::NowNs();
+    }
+
+    bool try_lock() {
+        if (!m_mutex.try_lock()) return false;
+        m_stats->RecordAcquire(false, false, 0, nullptr);
+        m_acquiredNs = lock_detail::NowNs();
+        return true;
+    }
+
+    void unlock() {
+        m_stats->RecordHold(lock_detail::NowNs() - m_acquiredNs);
+        m_mutex.unlock();
+    }
+
+    KS_LOCK_NOINLINE void lock_shared() {
+        if (m_mutex.try_lock_shared()) {
+            m_stats->RecordAcquire(true, false, 0, nullptr);
+            return;
+        }
+        const std::uint64_t start = lock_detail::NowNs();
+        m_mutex.lock_shared();
+        m_stats->RecordAcquire(true, true, lock_detail::NowNs() - start, KS_LOCK_CALLER());
+    }
+
+    bool try_lock_shared() {
+        if (!m_mutex.try_lock_shared()) return false;
+        m_stats->RecordAcquire(true, false, 0, nullptr);
+        return true;
+    }
+
+    void unlock_shared() { m_mutex.unlock_shared(); }
+
+private:
+    std::shared_mutex m_mutex;
+    LockStats* m_stats;
+    std::uint64_t m_acquiredNs = 0;
+};
+
+#undef KS_LOCK_CALLER
+#undef KS_LOCK_NOINLINE
+
+#else // !KS_LOCK_PROFILING
+
+class ProfiledMutex : public std::mutex {
+public:
+    explicit ProfiledMutex(const char* = nullptr) noexcept {}
+};
+
+class ProfiledSharedMutex : public std::shared_mutex {
+public:
+    explicit ProfiledSharedMutex(const char* = nullptr) {}
+};
+
+#endif // KS_LOCK_PROFILING
+
+} // namespace db
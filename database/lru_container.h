@@ -0,0 +1,214 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+
+#include <boost/mpl/push_front.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
+#include <boost/multi_index_container.hpp>
+
+namespace db {
+
+enum class EvictionPolicy {
+    Lru,   // exact: every find() moves the entry to the front (needs exclusive access)
+    Clock, // approximate (second chance): find() only sets an atomic reference bit
+};
+
+/**
+ * @brief Cached value plus its CLOCK reference bit
+ *
+ * Derives from Value so the user's boost::multi_index key extractors (member<Value, ...>,
+ * composite_key<Value, ...>) apply unchanged. The bit is mutable/atomic so lookups can set
+ * it through const iterators while holding only a shared lock.
+ */
+template <typename Value>
+struct LruEntry : Value {
+    mutable std::atomic<bool> referenced{false};
+
+    explicit LruEntry(Value v) : Value(std::move(v)) {}
+    LruEntry(const LruEntry& other) : Value(other), referenced(other.referenced.load(std::memory_order_relaxed)) {}
+    LruEntry& operator=(const LruEntry&) = delete;
+};
+
+/**
+ * @brief Capacity-bounded multi-index cache with a selectable eviction policy
+ *
+ * Mirrors the multi_index_lru::Container API (insert / erase<Tag> / find<Tag> /
+ * find_no_update<Tag> / end<Tag> / get_container), plus in-place modify<Tag> / upsert<Tag>,
+ * with index 0 a sequenced list:
+ *
+ * - EvictionPolicy::Lru: index 0 is most-recent-first; find() relocates, so lookups
+ *   that should count as a use must hold the writer lock.
+ * - EvictionPolicy::Clock (second-chance FIFO): index 0 is newest-inserted-first and lookups
+ *   never reorder it. touch()/find_shared() set the entry's reference bit atomically and
+ *   are safe under a shared lock (concurrently with other readers, never with writers).
+ *   Eviction (inside insert(), writer lock) looks at the oldest entry: if its bit is set it
+ *   is cleared and the entry moves to the front, otherwise it is evicted. A read-mostly
+ *   working set therefore survives without readers ever serializing on the recency list,
+ *   and index 0 stays a meaningful "most recent first" order for both policies.
+ *
+ * Not internally synchronized; callers provide the shared/exclusive locking.
+ */
+template <typename Value, typename Indices>
+class LruContainer {
+public:
+    using value_type = Value;
+    using entry_type = LruEntry<Value>;
+    using indices_t = typename boost::mpl::push_front<Indices, boost::multi_index::sequenced<>>::type;
+    using container_t = boost::multi_index_container<entry_type, indices_t>;
+
+    explicit LruContainer(std::size_t capacity, EvictionPolicy policy = EvictionPolicy::Lru)
+        : capacity_(capacity), policy_(policy) {}
+
+    LruContainer(const LruContainer&) = delete;
+    LruContainer& operator=(const LruContainer&) = delete;
+
+    /**
+     * @brief Insert value, evicting as needed
+     * @return false if an entry with an equal unique key exists (it counts as used instead)
+     */
+    bool insert(Value value) {
+        auto& seq = c_.template get<0>();
+        auto result = seq.push_front(entry_type(std::move(value)));
+        if (!result.second) {
+            if (policy_ == EvictionPolicy::Clock) {
+                touch(*result.first);
+            } else {
+                seq.relocate(seq.begin(), result.first);
+            }
+            return false;
+        }
+        while (c_.size() > capacity_) EvictOne(result.first);
+        return true;
+    }
+
+    template <typename Tag, typename Key>
+    bool erase(const Key& key) {
+        auto& idx = c_.template get<Tag>();
+        auto it = idx.find(key);
+        if (it == idx.end()) return false;
+        idx.erase(it);
+        return true;
+    }
+
+    /**
+     * @brief Modify the entry found by key in place and count it as a use
+     *
+     * Built on boost::multi_index modify(): the node is kept and each index only relinks
+     * the entry if the change broke its order there (checked against the neighbours), so
+     * a price tick repositions the price index alone. Recency is updated like find().
+     * If the change makes a unique key collide with another entry, boost drops the entry
+     * and this returns false.
+     *
+     * @param mod `void(Value&)`
+     * @return false if no entry has key
+     */
+    template <typename Tag, typename Key, typename Modifier>
+    bool modify(const Key& key, Modifier&& mod) {
+        auto& idx = c_.template get<Tag>();
+        auto it = idx.find(key);
+        return it != idx.end() && ModifyAt(idx, it, mod);
+    }
+
+    /**
+     * @brief Replace the entry with value's Tag key in place, or insert value
+     *
+     * Same result as erase<Tag>() + insert() without reallocating the node or relinking
+     * the indices whose keys did not change.
+     */
+    template <typename Tag>
+    bool upsert(Value value) {
+        auto& idx = c_.template get<Tag>();
+        auto it = idx.find(idx.key_extractor()(value));
+        if (it == idx.end()) return insert(std::move(value));
+        return ModifyAt(idx, it, [&](Value& entry) { entry = std::move(value); });
+    }
+
+    /**
+     * @brief Look up and count as a use (Lru: relocates, needs exclusive access)
+     */
+    template <typename Tag, typename Key>
+    auto find(const Key& key) {
+        auto& idx = c_.template get<Tag>();
+        auto it = idx.find(key);
+        if (it != idx.end()) MarkUsed(it);
+        return it;
+    }
+
+    /**
+     * @brief Look up under a shared lock; counts as a use only with EvictionPolicy::Clock
+     */
+    template <typename Tag, typename Key>
+    auto find_shared(const Key& key) const {
+        auto it = c_.template get<Tag>().find(key);
+        if (it != c_.template get<Tag>().end() && policy_ == EvictionPolicy::Clock) touch(*it);
+        return it;
+    }
+
+    template <typename Tag, typename Key>
+    auto find_no_update(const Key& key) const {
+        return c_.template get<Tag>().find(key);
+    }
+
+    /// Set the CLOCK reference bit (no-op store when already set; safe under a shared lock)
+    static void touch(const entry_type& entry) {
+        if (!entry.referenced.load(std::memory_order_relaxed)) entry.referenced.store(true, std::memory_order_relaxed);
+    }
+
+    template <typename Tag>
+    auto end() const {
+        return c_.template get<Tag>().end();
+    }
+
+    std::size_t size() const { return c_.size(); }
+    std::size_t capacity() const { return capacity_; }
+    EvictionPolicy policy() const { return policy_; }
+    const container_t& get_container() const { return c_; }
+
+    /// Entries evicted so far
+    std::size_t evictions() const { return evictions_; }
+
+private:
+    template <typename Index, typename Modifier>
+    bool ModifyAt(Index& idx, typename Index::iterator it, Modifier&& mod) {
+        if (!idx.modify(it, [&](entry_type& entry) { mod(static_cast<Value&>(entry)); })) return false;
+        MarkUsed(it);
+        return true;
+    }
+
+    template <typename Iterator>
+    void MarkUsed(Iterator it) {
+        if (policy_ == EvictionPolicy::Clock) {
+            touch(*it);
+        } else {
+            c_.template get<0>().relocate(c_.template get<0>().begin(), c_.template project<0>(it));
+        }
+    }
+
+    using seq_iterator = typename container_t::template nth_index<0>::type::iterator;
+
+    /// Evict one entry; with Clock, `fresh` (just inserted) is only taken when it is the last one
+    void EvictOne(seq_iterator fresh) {
+        auto& seq = c_.template get<0>();
+        if (policy_ == EvictionPolicy::Clock) {
+            // One pass over the list clears every bit, so this terminates
+            for (auto it = std::prev(seq.end());
+                 seq.size() > 1 && (it == fresh || it->referenced.load(std::memory_order_relaxed));
+                 it = std::prev(seq.end())) {
+                it->referenced.store(false, std::memory_order_relaxed);
+                seq.relocate(seq.begin(), it);
+            }
+        }
+        seq.pop_back();
+        evictions_++;
+    }
+
+    std::size_t capacity_;
+    EvictionPolicy policy_;
+    container_t c_;
+    std::size_t evictions_ = 0;
+};
+
+} // namespace db
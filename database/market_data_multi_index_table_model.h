@@ -2,12 +2,15 @@
 
 #include <algorithm>
 #include <any>
+#include <atomic>
+#include <charconv>
 #include <cstdint>
 #include <limits>
 #include <mutex>
 #include <optional>
 #include <shared_mutex>
 #include <string>
+#include <system_error>
 #include <utility>
 #include <vector>
 
@@ -16,9 +19,11 @@
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/tag.hpp>
 
-#include <multi_index_lru/container.hpp>
-
 #include "async_table_widget.h"
+#include "indexed_model_core.h"
+#include "lru_container.h"
+#include "query_result_cache.h"
+#include "trace.h"
 
 namespace db {
 
@@ -36,7 +41,9 @@ struct MdByPriceTag {};
 struct MdBySymbolVenueTsTag {};
 struct MdBySymbolTsTag {};
 
-using MarketDataCache = multi_index_lru::Container<
+// Every ordered index ends in id, so rows with equal ts/price/symbol still have one order,
+// independent of insertion history (the sharded model's k-way merge relies on this)
+using MarketDataCache = LruContainer<
     MarketDataCacheEntry,
     boost::multi_index::indexed_by<
         boost::multi_index::ordered_unique<
@@ -44,23 +51,31 @@ using MarketDataCache = multi_index_lru::Container<
             boost::multi_index::member<MarketDataCacheEntry, std::int64_t, &MarketDataCacheEntry::id>>,
         boost::multi_index::ordered_non_unique<
             boost::multi_index::tag<MdByTsTag>,
-            boost::multi_index::member<MarketDataCacheEntry, std::int64_t, &MarketDataCacheEntry::ts>>,
+            boost::multi_index::composite_key<
+                MarketDataCacheEntry,
+                boost::multi_index::member<MarketDataCacheEntry, std::int64_t, &MarketDataCacheEntry::ts>,
+                boost::multi_index::member<MarketDataCacheEntry, std::int64_t, &MarketDataCacheEntry::id>>>,
         boost::multi_index::ordered_non_unique<
             boost::multi_index::tag<MdByPriceTag>,
-            boost::multi_index::member<MarketDataCacheEntry, double, &MarketDataCacheEntry::price>>,
+            boost::multi_index::composite_key<
+                MarketDataCacheEntry,
+                boost::multi_index::member<MarketDataCacheEntry, double, &MarketDataCacheEntry::price>,
+                boost::multi_index::member<MarketDataCacheEntry, std::int64_t, &MarketDataCacheEntry::id>>>,
         boost::multi_index::ordered_non_unique<
             boost::multi_index::tag<MdBySymbolVenueTsTag>,
             boost::multi_index::composite_key<
                 MarketDataCacheEntry,
                 boost::multi_index::member<MarketDataCacheEntry, std::string, &MarketDataCacheEntry::symbol>,
                 boost::multi_index::member<MarketDataCacheEntry, std::string, &MarketDataCacheEntry::venue>,
-                boost::multi_index::member<MarketDataCacheEntry, std::int64_t, &MarketDataCacheEntry::ts>>>,
+                boost::multi_index::member<MarketDataCacheEntry, std::int64_t, &MarketDataCacheEntry::ts>,
+                boost::multi_index::member<MarketDataCacheEntry, std::int64_t, &MarketDataCacheEntry::id>>>,
         boost::multi_index::ordered_non_unique<
             boost::multi_index::tag<MdBySymbolTsTag>,
             boost::multi_index::composite_key<
                 MarketDataCacheEntry,
                 boost::multi_index::member<MarketDataCacheEntry, std::string, &MarketDataCacheEntry::symbol>,
-                boost::multi_index::member<MarketDataCacheEntry, std::int64_t, &MarketDataCacheEntry::ts>>>>>;
+                boost::multi_index::member<MarketDataCacheEntry, std::int64_t, &MarketDataCacheEntry::ts>,
+                boost::multi_index::member<MarketDataCacheEntry, std::int64_t, &MarketDataCacheEntry::id>>>>>;
 
 struct MarketDataTypedData {
     std::int64_t id{};
@@ -92,25 +107,29 @@ public:
         Order order = Order::TsDesc;
         std::size_t offset = 0;
         std::size_t limit = 0;
+
+        bool operator==(const Query&) const = default;
     };
 
-    explicit MarketDataMultiIndexTableModel(std::size_t capacity) : cache_(capacity) {}
+    /**
+     * @param policy EvictionPolicy::Clock lets FindById() count as a use under the shared lock
+     */
+    explicit MarketDataMultiIndexTableModel(std::size_t capacity, EvictionPolicy policy = EvictionPolicy::Lru)
+        : core_(capacity, policy, "MarketDataMultiIndexTableModel::mutex_") {}
 
-    bool Upsert(MarketDataCacheEntry row) {
-        std::unique_lock lock(mutex_);
-        cache_.erase<MdByIdTag>(row.id);
-        return cache_.insert(std::move(row));
-    }
+    bool Upsert(MarketDataCacheEntry row) { return core_.Upsert(std::move(row)); }
 
-    bool EraseById(std::int64_t id) {
-        std::unique_lock lock(mutex_);
-        return cache_.erase<MdByIdTag>(id);
-    }
+    bool EraseById(std::int64_t id) { return core_.EraseById(id); }
 
-    std::size_t Size() const {
-        std::shared_lock lock(mutex_);
-        return cache_.size();
-    }
+    /// Look up by id and count it as a use for eviction (see IndexedModelCore::FindById)
+    std::optional<MarketDataCacheEntry> FindById(std::int64_t id) { return core_.FindById(id); }
+
+    std::size_t Size() const { return core_.Size(); }
+
+    /**
+     * @brief Publish lock wait times to the PerfRegistry ("Locks" category) under this name
+     */
+    void SetPerfName(const std::string& name) { core_.SetPerfName(name); }
 
     static void ConfigureAsyncTableColumns(AsyncTableWidget& table) {
         table.AddColumn("ID", 80.0f);
@@ -153,29 +172,67 @@ public:
         });
     }
 
+    /**
+     * @brief Query filters (everything except order/offset/limit)
+     */
+    static bool MatchesQuery(const Query& query, const MarketDataCacheEntry& entry) {
+        if (query.symbolEq && entry.symbol != *query.symbolEq) {
+            return false;
+        }
+        if (query.venueEq && entry.venue != *query.venueEq) {
+            return false;
+        }
+        if (query.minTs && entry.ts < *query.minTs) {
+            return false;
+        }
+        if (query.maxTs && entry.ts > *query.maxTs) {
+            return false;
+        }
+        if (query.minPrice && entry.price < *query.minPrice) {
+            return false;
+        }
+        if (query.maxPrice && entry.price > *query.maxPrice) {
+            return false;
+        }
+        return true;
+    }
+
+    static AsyncTableWidget::Row MakeAsyncRow(const MarketDataCacheEntry& entry) {
+        return AsyncTableWidget::Row{{std::to_string(entry.id),
+                                      entry.symbol,
+                                      entry.venue,
+                                      std::to_string(entry.ts),
+                                      FormatPrice(entry.price)},
+                                     MarketDataTypedData{entry.id, entry.symbol, entry.venue, entry.ts, entry.price}};
+    }
+
+    /**
+     * @brief Rows for query; repeated queries are served from the result cache until a
+     * write that can change their result
+     */
     void BuildAsyncRows(std::vector<AsyncTableWidget::Row>& out, const Query& query) const {
-        out.clear();
-        std::shared_lock lock(mutex_);
+        core_.BuildAsyncRows(*this, out, query);
+    }
+
+    /**
+     * @brief Incremented by every write (a cheap "did anything change" check for refreshes)
+     */
+    std::uint64_t GetGeneration() const { return core_.GetGeneration(); }
+
+    /**
+     * @brief Number of recent queries whose results are kept (default 8, 0 disables)
+     */
+    void SetResultCacheCapacity(std::size_t capacity) { core_.SetResultCacheCapacity(capacity); }
+
+    const QueryResultCache<Query, AsyncTableWidget::Row>& GetResultCache() const { return core_.GetResultCache(); }
 
+private:
+    void CollectMatches(std::vector<const MarketDataCacheEntry*>& out, const Query& query) const {
+        const auto& rows = core_.GetCache().get_container();
         std::size_t seen = 0;
         std::size_t emitted = 0;
         auto pushIfMatch = [&](const MarketDataCacheEntry& entry) {
-            if (query.symbolEq && entry.symbol != *query.symbolEq) {
-                return;
-            }
-            if (query.venueEq && entry.venue != *query.venueEq) {
-                return;
-            }
-            if (query.minTs && entry.ts < *query.minTs) {
-                return;
-            }
-            if (query.maxTs && entry.ts > *query.maxTs) {
-                return;
-            }
-            if (query.minPrice && entry.price < *query.minPrice) {
-                return;
-            }
-            if (query.maxPrice && entry.price > *query.maxPrice) {
+            if (!MatchesQuery(query, entry)) {
                 return;
             }
             if (seen++ < query.offset) {
@@ -184,22 +241,12 @@ public:
             if (query.limit != 0 && emitted >= query.limit) {
                 return;
             }
-
-            out.push_back(AsyncTableWidget::Row{{std::to_string(entry.id),
-                                                entry.symbol,
-                                                entry.venue,
-                                                std::to_string(entry.ts),
-                                                FormatPrice(entry.price)},
-                                               MarketDataTypedData{entry.id,
-                                                                   entry.symbol,
-                                                                   entry.venue,
-                                                                   entry.ts,
-                                                                   entry.price}});
+            out.push_back(&entry);
             ++emitted;
         };
 
         if (query.symbolEq && query.venueEq && (query.order == Order::TsAsc || query.order == Order::TsDesc)) {
-            const auto& idx = cache_.get_container().template get<MdBySymbolVenueTsTag>();
+            const auto& idx = rows.template get<MdBySymbolVenueTsTag>();
             const auto minTs = query.minTs.value_or(std::numeric_limits<std::int64_t>::lowest());
             const auto maxTs = query.maxTs.value_or(std::numeric_limits<std::int64_t>::max());
             auto begin = idx.lower_bound(boost::make_tuple(*query.symbolEq, *query.venueEq, minTs));
@@ -219,49 +266,49 @@ public:
 
         switch (query.order) {
             case Order::LruMostRecentFirst: {
-                const auto& lru = cache_.get_container().template get<0>();
+                const auto& lru = rows.template get<0>();
                 for (const auto& entry : lru) {
                     pushIfMatch(entry);
                 }
                 break;
             }
             case Order::TsAsc: {
-                const auto& idx = cache_.get_container().template get<MdByTsTag>();
+                const auto& idx = rows.template get<MdByTsTag>();
                 for (const auto& entry : idx) {
                     pushIfMatch(entry);
                 }
                 break;
             }
             case Order::TsDesc: {
-                const auto& idx = cache_.get_container().template get<MdByTsTag>();
+                const auto& idx = rows.template get<MdByTsTag>();
                 for (auto it = idx.rbegin(); it != idx.rend(); ++it) {
                     pushIfMatch(*it);
                 }
                 break;
             }
             case Order::PriceAsc: {
-                const auto& idx = cache_.get_container().template get<MdByPriceTag>();
+                const auto& idx = rows.template get<MdByPriceTag>();
                 for (const auto& entry : idx) {
                     pushIfMatch(entry);
                 }
                 break;
             }
             case Order::PriceDesc: {
-                const auto& idx = cache_.get_container().template get<MdByPriceTag>();
+                const auto& idx = rows.template get<MdByPriceTag>();
                 for (auto it = idx.rbegin(); it != idx.rend(); ++it) {
                     pushIfMatch(*it);
                 }
                 break;
             }
             case Order::SymbolAsc: {
-                const auto& idx = cache_.get_container().template get<MdBySymbolTsTag>();
+                const auto& idx = rows.template get<MdBySymbolTsTag>();
                 for (const auto& entry : idx) {
                     pushIfMatch(entry);
                 }
                 break;
             }
             case Order::SymbolDesc: {
-                const auto& idx = cache_.get_container().template get<MdBySymbolTsTag>();
+                const auto& idx = rows.template get<MdBySymbolTsTag>();
                 for (auto it = idx.rbegin(); it != idx.rend(); ++it) {
                     pushIfMatch(*it);
                 }
@@ -270,13 +317,20 @@ public:
         }
     }
 
-private:
+    // Same text as std::to_string(double) ("%f"), without printf's locale and format parsing
     static std::string FormatPrice(double value) {
-        return std::to_string(value);
+        char buf[64];
+        auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::fixed, 6);
+        if (ec != std::errc{}) {
+            return std::to_string(value);
+        }
+        return std::string(buf, end);
     }
 
-    mutable std::shared_mutex mutex_;
-    MarketDataCache cache_;
+    using Core = IndexedModelCore<MarketDataMultiIndexTableModel, MarketDataCacheEntry, MarketDataCache, MdByIdTag, Query>;
+    friend Core; // calls CollectMatches under its read lock
+
+    Core core_;
 };
 
 } // namespace db
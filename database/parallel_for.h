@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "trace.h"
+
+namespace db {
+
+/**
+ * @brief Process-wide pool of worker threads for data-parallel loops
+ *
+ * Workers (hardware_concurrency - 1, started on first use) sleep until For() hands them
+ * a job. The calling thread also takes chunks. Only one job runs at a time. A For() that
+ * finds the pool busy runs its loop on the calling thread instead of waiting, so
+ * concurrent readers never queue behind each other's jobs.
+ */
+class ParallelPool {
+public:
+    static ParallelPool& Get() {
+        static ParallelPool instance;
+        return instance;
+    }
+
+    ParallelPool(const ParallelPool&) = delete;
+    ParallelPool& operator=(const ParallelPool&) = delete;
+
+    ~ParallelPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+
+    unsigned WorkerCount() const { return static_cast<unsigned>(workers_.size()); }
+
+    /**
+     * @brief Call fn(begin, end) for consecutive chunks of [0, count); returns when all ran
+     *
+     * @param grain Chunk size; counts up to one grain run on the calling thread
+     */
+    void For(std::size_t count, std::size_t grain, const std::function<void(std::size_t, std::size_t)>& fn) {
+        grain = std::max<std::size_t>(1, grain);
+        std::unique_lock<std::mutex> submit(submitMutex_, std::try_to_lock);
+        if (count <= grain || workers_.empty() || !submit.owns_lock()) {
+            if (count > 0) fn(0, count);
+            return;
+        }
+
+        auto job = std::make_shared<Job>(fn, count, grain);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = job;
+            jobSeq_++;
+        }
+        wake_.notify_all();
+        RunChunks(*job);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [&] { return job->finished.load(std::memory_order_acquire) == count; });
+        job_.reset();
+    }
+
+private:
+    struct Job {
+        Job(const std::function<void(std::size_t, std::size_t)>& f, std::size_t n, std::size_t g)
+            : fn(f), count(n), grain(g) {}
+
+        const std::function<void(std::size_t, std::size_t)>& fn;
+        std::size_t count;
+        std::size_t grain;
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> finished{0};
+    };
+
+    ParallelPool() {
+        unsigned threads = std::thread::hardware_concurrency();
+#ifdef __EMSCRIPTEN__
+        threads = 1;
+#endif
+        for (unsigned i = 1; i < threads; ++i) {
+            workers_.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    void RunChunks(Job& job) {
+        for (;;) {
+            const std::size_t begin = job.next.fetch_add(job.grain, std::memory_order_relaxed);
+            if (begin >= job.count) return;
+            const std::size_t end = std::min(job.count, begin + job.grain);
+            job.fn(begin, end);
+            if (job.finished.fetch_add(end - begin, std::memory_order_acq_rel) + (end - begin) == job.count) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                done_.notify_all();
+            }
+        }
+    }
+
+    void WorkerLoop() {
+        Trace::SetThreadName("parallel pool");
+        std::uint64_t seen = 0;
+        for (;;) {
+            std::shared_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stop_ || jobSeq_ != seen; });
+                if (stop_) return;
+                seen = jobSeq_;
+                job = job_;
+            }
+            if (job) RunChunks(*job);
+        }
+    }
+
+    std::mutex submitMutex_; // held by the one For() using the workers
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::shared_ptr<Job> job_;
+    std::uint64_t jobSeq_ = 0;
+    bool stop_ = false;
+    std::vector<std::thread> workers_;
+};
+
+/**
+ * @brief Copy *items[i] into storage and point items at the copies
+ *
+ * Lets a result build release the lock that guards the originals before formatting:
+ * collect pointers and detach them under the lock, then ParallelMaterialize() without it.
+ */
+template <typename T>
+void DetachMatches(std::vector<const T*>& items, std::vector<T>& storage) {
+    KS_TRACE_SCOPE("model", "DetachMatches");
+    storage.clear();
+    storage.reserve(items.size());
+    for (const T* item : items) storage.push_back(*item);
+    for (std::size_t i = 0; i < items.size(); ++i) items[i] = &storage[i];
+}
+
+/**
+ * @brief out[i] = make(*items[i]), formatted on the ParallelPool above `threshold` items
+ *
+ * Second phase of a two-phase result build: the caller first collects the matching
+ * entries (cheap, under its lock, see DetachMatches), then the row formatting is spread out.
+ */
+template <typename T, typename Out, typename MakeFn>
+void ParallelMaterialize(const std::vector<const T*>& items, std::vector<Out>& out, MakeFn&& make,
+                         std::size_t threshold = 4096) {
+    KS_TRACE_SCOPE("model", "Materialize");
+    out.resize(items.size());
+    auto run = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) out[i] = make(*items[i]);
+    };
+    if (items.size() < threshold) {
+        run(0, items.size());
+        return;
+    }
+    ParallelPool::Get().For(items.size(), 1024, run);
+}
+
+} // namespace db
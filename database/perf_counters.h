@@ -0,0 +1,231 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace db {
+
+/**
+ * @brief Low-overhead performance counters shared by all subsystems
+ *
+ * Subsystems register named metrics once (mutex-protected, cold path) and then
+ * update them with relaxed atomics only (hot path). Readers such as the
+ * PerfHudPanel sample the registry periodically from the GUI thread.
+ *
+ * Metric kinds:
+ * - PerfCounter:  monotonic event count (messages received, rows upserted)
+ * - PerfGauge:    current value set by the owner (queue depth, cache size)
+ * - PerfDuration: timing samples (refresh time, lock wait); interval count/sum/max
+ *                 are drained by the reader so each sample covers one interval
+ * - Polled gauge: callback evaluated by the reader (e.g. model->Size())
+ *
+ * Every metric carries a category ("Refresh", "Queues", "Caches", "Memory", "Locks", ...)
+ * used for grouping in the HUD.
+ *
+ * Example:
+ *   auto& refresh = db::PerfRegistry::Get().Duration("Refresh", "Foo table");
+ *   {
+ *       db::PerfScopedTimer t(&refresh);
+ *       widget.Refresh();
+ *   }
+ */
+class PerfCounter {
+public:
+    void Add(std::uint64_t n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+    std::uint64_t Load() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::uint64_t> m_value{0};
+};
+
+class PerfGauge {
+public:
+    void Set(double v) { m_value.store(v, std::memory_order_relaxed); }
+    double Load() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> m_value{0.0};
+};
+
+class PerfDuration {
+public:
+    struct Interval {
+        std::uint64_t count = 0;
+        double totalMs = 0.0;
+        double maxMs = 0.0;
+        double AvgMs() const { return count ? totalMs / static_cast<double>(count) : 0.0; }
+    };
+
+    void Record(std::chrono::nanoseconds d) {
+        auto ns = static_cast<std::uint64_t>(d.count() < 0 ? 0 : d.count());
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_totalNs.fetch_add(ns, std::memory_order_relaxed);
+        std::uint64_t prev = m_maxNs.load(std::memory_order_relaxed);
+        while (ns > prev && !m_maxNs.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {
+        }
+        m_lastNs.store(ns, std::memory_order_relaxed);
+    }
+
+    // Reader side: take and reset the accumulated interval
+    Interval Drain() {
+        Interval out;
+        out.count = m_count.exchange(0, std::memory_order_relaxed);
+        out.totalMs = static_cast<double>(m_totalNs.exchange(0, std::memory_order_relaxed)) / 1e6;
+        out.maxMs = static_cast<double>(m_maxNs.exchange(0, std::memory_order_relaxed)) / 1e6;
+        return out;
+    }
+
+    double LastMs() const { return static_cast<double>(m_lastNs.load(std::memory_order_relaxed)) / 1e6; }
+
+private:
+    std::atomic<std::uint64_t> m_count{0};
+    std::atomic<std::uint64_t> m_totalNs{0};
+    std::atomic<std::uint64_t> m_maxNs{0};
+    std::atomic<std::uint64_t> m_lastNs{0};
+};
+
+/**
+ * @brief RAII timer feeding a PerfDuration (no-op when stat is null)
+ */
+class PerfScopedTimer {
+public:
+    explicit PerfScopedTimer(PerfDuration* stat) : m_stat(stat) {
+        if (m_stat) m_start = std::chrono::steady_clock::now();
+    }
+    ~PerfScopedTimer() {
+        if (m_stat) m_stat->Record(std::chrono::steady_clock::now() - m_start);
+    }
+    PerfScopedTimer(const PerfScopedTimer&) = delete;
+    PerfScopedTimer& operator=(const PerfScopedTimer&) = delete;
+
+private:
+    PerfDuration* m_stat;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+/**
+ * @brief Acquire a lock, recording the time spent waiting into stat (if non-null)
+ *
+ * Example:
+ *   auto lock = PerfTimedLock<std::unique_lock<std::shared_mutex>>(mutex_, writeWait_);
+ */
+template <typename Lock, typename Mutex>
+Lock PerfTimedLock(Mutex& mutex, PerfDuration* stat) {
+    if (!stat) {
+        return Lock(mutex);
+    }
+    auto start = std::chrono::steady_clock::now();
+    Lock lock(mutex);
+    stat->Record(std::chrono::steady_clock::now() - start);
+    return lock;
+}
+
+class PerfRegistry {
+public:
+    enum class Kind { Counter, Gauge, Duration, Polled };
+
+    struct Entry {
+        std::string category;
+        std::string name;
+        Kind kind = Kind::Counter;
+        std::unique_ptr<PerfCounter> counter;
+        std::unique_ptr<PerfGauge> gauge;
+        std::unique_ptr<PerfDuration> duration;
+        std::function<double()> poll;
+        bool registered = true; // false after Unregister until registered again
+    };
+
+    static PerfRegistry& Get() {
+        static PerfRegistry instance;
+        return instance;
+    }
+
+    // Registration returns a reference that stays valid for the registry lifetime.
+    // Registering an existing (category, name) returns the existing metric.
+    PerfCounter& Counter(const std::string& category, const std::string& name) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry& e = FindOrCreate(category, name, Kind::Counter);
+        if (!e.counter) e.counter = std::make_unique<PerfCounter>();
+        return *e.counter;
+    }
+
+    PerfGauge& Gauge(const std::string& category, const std::string& name) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry& e = FindOrCreate(category, name, Kind::Gauge);
+        if (!e.gauge) e.gauge = std::make_unique<PerfGauge>();
+        return *e.gauge;
+    }
+
+    PerfDuration& Duration(const std::string& category, const std::string& name) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry& e = FindOrCreate(category, name, Kind::Duration);
+        if (!e.duration) e.duration = std::make_unique<PerfDuration>();
+        return *e.duration;
+    }
+
+    // Polled gauges are evaluated on the reader thread; the callback must be thread-safe
+    // and must be unregistered before whatever it captures is destroyed.
+    void Polled(const std::string& category, const std::string& name, std::function<double()> poll) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry& e = FindOrCreate(category, name, Kind::Polled);
+        e.poll = std::move(poll);
+    }
+
+    // Hides the metric from ForEach (the HUD drops its series on the next sample)
+    void Unregister(const std::string& category, const std::string& name) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& e : m_entries) {
+            if (e.category == category && e.name == name) {
+                e.poll = nullptr; // storage stays alive so outstanding references remain valid
+                e.registered = false;
+            }
+        }
+    }
+
+    /**
+     * @brief Visit all metrics (reader side, holds the registration mutex)
+     */
+    template <typename Fn>
+    void ForEach(Fn&& fn) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& e : m_entries) {
+            if (!e.registered || (e.kind == Kind::Polled && !e.poll)) continue;
+            fn(e);
+        }
+    }
+
+    std::size_t Size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+private:
+    PerfRegistry() = default;
+    PerfRegistry(const PerfRegistry&) = delete;
+    PerfRegistry& operator=(const PerfRegistry&) = delete;
+
+    Entry& FindOrCreate(const std::string& category, const std::string& name, Kind kind) {
+        for (auto& e : m_entries) {
+            if (e.category == category && e.name == name && e.kind == kind) {
+                e.registered = true;
+                return e;
+            }
+        }
+        Entry& e = m_entries.emplace_back();
+        e.category = category;
+        e.name = name;
+        e.kind = kind;
+        return e;
+    }
+
+    mutable std::mutex m_mutex;
+    std::deque<Entry> m_entries; // deque: stable references on growth
+};
+
+} // namespace db
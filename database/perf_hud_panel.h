@@ -0,0 +1,287 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "imgui.h"
+#include "lock_profiler.h"
+#include "perf_counters.h"
+
+#if defined(__EMSCRIPTEN__)
+#include <emscripten/heap.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+namespace db {
+
+/**
+ * @brief ImGui panel displaying the PerfRegistry plus frame timing and process memory
+ *
+ * Shows:
+ * - Frame time percentiles (p50/p90/p99/max) over the last kFrameHistory frames
+ * - One row per registered metric, grouped by category, with current value,
+ *   window max and a sparkline of the last kHistory samples
+ * - Resident memory ("Memory" category, sampled by the panel itself)
+ *
+ * Sampling happens on the GUI thread at a fixed interval (default 250 ms) so the
+ * cost is independent of frame rate. Counters are shown as per-second rates,
+ * durations as the average over the interval (tooltip shows the interval max).
+ *
+ * Usage:
+ *   static db::PerfHudPanel hud;
+ *   hud.Tick();   // every frame
+ *   if (ImGui::CollapsingHeader("Performance HUD")) hud.Render();
+ */
+class PerfHudPanel {
+public:
+    static constexpr int kFrameHistory = 600;
+    static constexpr int kHistory = 120;
+
+    void SetSampleInterval(float seconds) { m_sampleInterval = seconds; }
+
+    /**
+     * @brief Record the frame time and sample the registry when due.
+     * Call once per frame, even while the panel is hidden, so history stays continuous.
+     */
+    void Tick() {
+        RecordFrame(ImGui::GetIO().DeltaTime * 1000.0f);
+
+        auto now = std::chrono::steady_clock::now();
+        bool first = m_lastSample.time_since_epoch().count() == 0;
+        float elapsed = std::chrono::duration<float>(now - m_lastSample).count();
+        if (first || elapsed >= m_sampleInterval) {
+            Sample(first ? m_sampleInterval : elapsed);
+            m_lastSample = now;
+        }
+    }
+
+    /**
+     * @brief Draw the panel (GUI thread)
+     */
+    void Render() {
+        RenderFrameSection();
+
+        if (ImGui::BeginTable("PerfHudMetrics", 4,
+                              ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+            ImGui::TableSetupColumn("Metric", ImGuiTableColumnFlags_WidthStretch, 2.0f);
+            ImGui::TableSetupColumn("Current", ImGuiTableColumnFlags_WidthFixed, 110.0f);
+            ImGui::TableSetupColumn("Window Max", ImGuiTableColumnFlags_WidthFixed, 110.0f);
+            ImGui::TableSetupColumn("History", ImGuiTableColumnFlags_WidthStretch, 3.0f);
+            ImGui::TableHeadersRow();
+
+            for (const auto& category : m_categoryOrder) {
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::TextDisabled("%s", category.c_str());
+
+                for (const auto& key : m_seriesOrder) {
+                    const Series& s = m_series[key];
+                    if (s.category != category) continue;
+                    RenderSeriesRow(key, s);
+                }
+            }
+            ImGui::EndTable();
+        }
+
+        if constexpr (kLockProfilingEnabled) {
+            if (ImGui::TreeNode("Lock contention profile")) {
+                if (ImGui::Button("Reset lock stats")) {
+                    LockProfiler::Get().Reset();
+                }
+                const std::string report = LockProfiler::Get().Report();
+                ImGui::TextUnformatted(report.c_str());
+                ImGui::TreePop();
+            }
+        }
+    }
+
+private:
+    struct Series {
+        std::string category;
+        std::string name;
+        const char* unit = "";
+        std::array<float, kHistory> values{};
+        int head = 0;
+        int count = 0;
+        float last = 0.0f;
+        float lastIntervalMax = 0.0f;
+        std::uint64_t lastCounter = 0;
+        bool hasCounterBase = false;
+        std::uint64_t lastSample = 0; // m_sampleSeq of the last Sample that saw this metric
+
+        void Push(float v) {
+            values[head] = v;
+            head = (head + 1) % kHistory;
+            count = std::min(count + 1, kHistory);
+            last = v;
+        }
+
+        float WindowMax() const {
+            float m = 0.0f;
+            for (int i = 0; i < count; i++) m = std::max(m, values[i]);
+            return m;
+        }
+    };
+
+    void RecordFrame(float ms) {
+        m_frameMs[m_frameHead] = ms;
+        m_frameHead = (m_frameHead + 1) % kFrameHistory;
+        m_frameCount = std::min(m_frameCount + 1, kFrameHistory);
+    }
+
+    Series& GetSeries(const std::string& category, const std::string& name, const char* unit) {
+        std::string key = category + '\x1f' + name;
+        auto it = m_series.find(key);
+        if (it == m_series.end()) {
+            it = m_series.emplace(key, Series{}).first;
+            it->second.category = category;
+            it->second.name = name;
+            it->second.unit = unit;
+            m_seriesOrder.push_back(key);
+            if (std::find(m_categoryOrder.begin(), m_categoryOrder.end(), category) == m_categoryOrder.end()) {
+                m_categoryOrder.push_back(category);
+            }
+        }
+        it->second.lastSample = m_sampleSeq;
+        return it->second;
+    }
+
+    // Series whose metric was unregistered (or Memory, if it stopped reporting) are dropped,
+    // along with categories left empty
+    void PruneSeries() {
+        auto stale = [this](const std::string& key) {
+            auto it = m_series.find(key);
+            if (it->second.lastSample == m_sampleSeq) return false;
+            m_series.erase(it);
+            return true;
+        };
+        m_seriesOrder.erase(std::remove_if(m_seriesOrder.begin(), m_seriesOrder.end(), stale), m_seriesOrder.end());
+        auto empty = [this](const std::string& category) {
+            return std::none_of(m_series.begin(), m_series.end(),
+                                [&](const auto& kv) { return kv.second.category == category; });
+        };
+        m_categoryOrder.erase(std::remove_if(m_categoryOrder.begin(), m_categoryOrder.end(), empty),
+                              m_categoryOrder.end());
+    }
+
+    void Sample(float intervalSec) {
+        m_sampleSeq++;
+        PerfRegistry::Get().ForEach([&](PerfRegistry::Entry& e) {
+            switch (e.kind) {
+            case PerfRegistry::Kind::Counter: {
+                Series& s = GetSeries(e.category, e.name, "/s");
+                std::uint64_t v = e.counter->Load();
+                float rate = s.hasCounterBase ? static_cast<float>(v - s.lastCounter) / intervalSec : 0.0f;
+                s.lastCounter = v;
+                s.hasCounterBase = true;
+                s.Push(rate);
+                break;
+            }
+            case PerfRegistry::Kind::Gauge:
+                GetSeries(e.category, e.name, "").Push(static_cast<float>(e.gauge->Load()));
+                break;
+            case PerfRegistry::Kind::Duration: {
+                Series& s = GetSeries(e.category, e.name, "ms");
+                auto interval = e.duration->Drain();
+                s.lastIntervalMax = static_cast<float>(interval.maxMs);
+                s.Push(static_cast<float>(interval.AvgMs()));
+                break;
+            }
+            case PerfRegistry::Kind::Polled:
+                GetSeries(e.category, e.name, "").Push(static_cast<float>(e.poll()));
+                break;
+            }
+        });
+
+        double rssMb = ResidentMemoryMb();
+        if (rssMb >= 0.0) {
+            GetSeries("Memory", "Resident set", "MB").Push(static_cast<float>(rssMb));
+        }
+        PruneSeries();
+    }
+
+    void RenderFrameSection() {
+        if (m_frameCount == 0) return;
+
+        m_sortScratch.assign(m_frameMs.begin(), m_frameMs.begin() + m_frameCount);
+        std::sort(m_sortScratch.begin(), m_sortScratch.end());
+        auto pct = [&](double p) {
+            size_t idx = static_cast<size_t>(p * static_cast<double>(m_sortScratch.size() - 1));
+            return m_sortScratch[idx];
+        };
+        float p50 = pct(0.50), p90 = pct(0.90), p99 = pct(0.99);
+        float maxMs = m_sortScratch.back();
+
+        ImGui::Text("Frame: p50 %.2f ms | p90 %.2f ms | p99 %.2f ms | max %.2f ms | %.0f FPS",
+                    p50, p90, p99, maxMs, ImGui::GetIO().Framerate);
+
+        char overlay[32];
+        std::snprintf(overlay, sizeof(overlay), "%.2f ms", m_frameMs[(m_frameHead + kFrameHistory - 1) % kFrameHistory]);
+        int offset = m_frameCount < kFrameHistory ? 0 : m_frameHead;
+        ImGui::PlotLines("##frame_times", m_frameMs.data(), m_frameCount, offset, overlay,
+                         0.0f, std::max(p99 * 1.5f, 1.0f), ImVec2(-1.0f, 50.0f));
+    }
+
+    void RenderSeriesRow(const std::string& key, const Series& s) {
+        ImGui::TableNextRow();
+
+        ImGui::TableSetColumnIndex(0);
+        ImGui::Text("  %s", s.name.c_str());
+
+        ImGui::TableSetColumnIndex(1);
+        ImGui::Text("%.2f %s", s.last, s.unit);
+        if (s.lastIntervalMax > 0.0f && ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("interval max %.3f ms", s.lastIntervalMax);
+        }
+
+        float windowMax = s.WindowMax();
+        ImGui::TableSetColumnIndex(2);
+        ImGui::Text("%.2f %s", windowMax, s.unit);
+
+        ImGui::TableSetColumnIndex(3);
+        ImGui::PushID(key.c_str());
+        int offset = s.count < kHistory ? 0 : s.head;
+        ImGui::PlotLines("##spark", s.values.data(), s.count, offset, nullptr,
+                         0.0f, std::max(windowMax * 1.1f, 1e-3f), ImVec2(-1.0f, 20.0f));
+        ImGui::PopID();
+    }
+
+    static double ResidentMemoryMb() {
+#if defined(__EMSCRIPTEN__)
+        return static_cast<double>(emscripten_get_heap_size()) / (1024.0 * 1024.0);
+#elif defined(__linux__)
+        FILE* f = std::fopen("/proc/self/statm", "r");
+        if (!f) return -1.0;
+        long pages = 0, resident = 0;
+        int n = std::fscanf(f, "%ld %ld", &pages, &resident);
+        std::fclose(f);
+        if (n != 2) return -1.0;
+        return static_cast<double>(resident) * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+#else
+        return -1.0;
+#endif
+    }
+
+    // Frame timing ring (GUI thread only)
+    std::array<float, kFrameHistory> m_frameMs{};
+    int m_frameHead = 0;
+    int m_frameCount = 0;
+    std::vector<float> m_sortScratch;
+
+    // Metric history (GUI thread only)
+    std::unordered_map<std::string, Series> m_series;
+    std::vector<std::string> m_seriesOrder;
+    std::vector<std::string> m_categoryOrder;
+    std::uint64_t m_sampleSeq = 0;
+
+    float m_sampleInterval = 0.25f;
+    std::chrono::steady_clock::time_point m_lastSample{};
+};
+
+} // namespace db
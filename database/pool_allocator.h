@@ -0,0 +1,257 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace db {
+
+/// Slot usage of one NodePool size class
+struct PoolStats {
+    std::size_t slotSize = 0;
+    std::size_t slabs = 0;
+    std::size_t capacity = 0; // slots carved from slabs
+    std::size_t live = 0;     // slots handed out and not yet returned
+    std::size_t free = 0;     // capacity - live (global free list + thread caches)
+    std::size_t cached = 0;   // free slots parked in thread caches
+};
+
+/**
+ * @brief Fixed-size slot pool for node-based containers, one instance per (size, alignment)
+ *
+ * Slots are carved from 64 KiB slabs. Each thread keeps a small cache of free slots, so
+ * allocate/deallocate are a pointer pop/push without locking; only refilling an empty cache
+ * or spilling a full one takes the pool mutex, and moves a batch. A slot freed on another
+ * thread than the one that allocated it just joins that thread's cache.
+ *
+ * Slabs are never given back: after churn the pool plateaus at the high-water mark and
+ * reuses freed slots instead of fragmenting the general heap. The pool itself is never
+ * destroyed, and once a thread's cache has been destroyed (thread exit, including the main
+ * thread's thread_locals before static destructors run) that thread allocates from and
+ * frees to the shared free list under the mutex, so containers with static or thread
+ * storage duration can still free into it at exit.
+ */
+template <std::size_t SlotSize, std::size_t Align>
+class NodePool {
+public:
+    static NodePool& Get() {
+        static NodePool* instance = new NodePool(); // intentionally immortal
+        return *instance;
+    }
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    void* Allocate() {
+        ThreadCache* local = Local();
+        if (!local) return AllocateShared();
+        ThreadCache& cache = *local;
+        if (!cache.head) Refill(cache);
+        FreeSlot* slot = cache.head;
+        cache.head = slot->next;
+        cache.SetCount(cache.Count() - 1);
+        cache.allocs.store(cache.allocs.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return slot;
+    }
+
+    void Deallocate(void* p) noexcept {
+        ThreadCache* local = Local();
+        if (!local) return DeallocateShared(p);
+        ThreadCache& cache = *local;
+        auto* slot = static_cast<FreeSlot*>(p);
+        slot->next = cache.head;
+        cache.head = slot;
+        cache.SetCount(cache.Count() + 1);
+        cache.frees.store(cache.frees.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (cache.Count() > kCacheMax) Spill(cache, kBatch);
+    }
+
+    PoolStats Stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        PoolStats s;
+        s.slotSize = kSlotSize;
+        s.slabs = slabs_.size();
+        s.capacity = slabs_.size() * kSlotsPerSlab;
+        std::int64_t live = retiredLive_;
+        for (const ThreadCache* cache : caches_) {
+            live += static_cast<std::int64_t>(cache->allocs.load(std::memory_order_relaxed)) -
+                    static_cast<std::int64_t>(cache->frees.load(std::memory_order_relaxed));
+            s.cached += cache->Count();
+        }
+        s.live = static_cast<std::size_t>(std::max<std::int64_t>(0, live));
+        s.free = s.capacity - std::min(s.capacity, s.live);
+        return s;
+    }
+
+private:
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    static constexpr std::size_t kAlign = std::max(Align, alignof(FreeSlot));
+    static constexpr std::size_t kSlotSize = (std::max(SlotSize, sizeof(FreeSlot)) + kAlign - 1) / kAlign * kAlign;
+    static constexpr std::size_t kSlabBytes = 64 * 1024;
+    static constexpr std::size_t kSlotsPerSlab = std::max<std::size_t>(1, kSlabBytes / kSlotSize);
+    static constexpr std::size_t kBatch = 64;          // slots moved per refill/spill
+    static constexpr std::size_t kCacheMax = 2 * kBatch; // per-thread free slots before spilling
+
+    // Per-thread free list; the counters are atomic only so Stats() can read them, and are
+    // written by the owning thread alone
+    struct ThreadCache {
+        explicit ThreadCache(NodePool& p) : pool(p) { pool.Register(this); }
+        ~ThreadCache() {
+            pool.Retire(this);
+            tRetired_ = true;
+        }
+
+        std::size_t Count() const { return count.load(std::memory_order_relaxed); }
+        void SetCount(std::size_t n) { count.store(n, std::memory_order_relaxed); }
+
+        NodePool& pool;
+        FreeSlot* head = nullptr;
+        std::atomic<std::size_t> count{0};
+        std::atomic<std::uint64_t> allocs{0};
+        std::atomic<std::uint64_t> frees{0};
+    };
+
+    NodePool() = default;
+
+    // Null once this thread's cache is gone; the flag is trivially destructible, so it can
+    // still be read from later thread_local and static destructors
+    ThreadCache* Local() {
+        if (tRetired_) return nullptr;
+        static thread_local ThreadCache cache(*this);
+        return &cache;
+    }
+
+    // Slow paths for threads whose cache was destroyed
+    void* AllocateShared() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!free_) CarveSlab();
+        FreeSlot* slot = free_;
+        free_ = slot->next;
+        retiredLive_++;
+        return slot;
+    }
+
+    void DeallocateShared(void* p) noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto* slot = static_cast<FreeSlot*>(p);
+        slot->next = free_;
+        free_ = slot;
+        retiredLive_--;
+    }
+
+    void Register(ThreadCache* cache) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        caches_.push_back(cache);
+    }
+
+    // Thread exit: hand the cached slots back and keep its live count
+    void Retire(ThreadCache* cache) {
+        Spill(*cache, cache->Count());
+        std::lock_guard<std::mutex> lock(mutex_);
+        retiredLive_ += static_cast<std::int64_t>(cache->allocs.load(std::memory_order_relaxed)) -
+                        static_cast<std::int64_t>(cache->frees.load(std::memory_order_relaxed));
+        caches_.erase(std::remove(caches_.begin(), caches_.end(), cache), caches_.end());
+    }
+
+    void Refill(ThreadCache& cache) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!free_) CarveSlab();
+        for (std::size_t i = 0; i < kBatch && free_; ++i) {
+            FreeSlot* slot = free_;
+            free_ = slot->next;
+            slot->next = cache.head;
+            cache.head = slot;
+            cache.SetCount(cache.Count() + 1);
+        }
+    }
+
+    void Spill(ThreadCache& cache, std::size_t n) noexcept {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (std::size_t i = 0; i < n && cache.head; ++i) {
+            FreeSlot* slot = cache.head;
+            cache.head = slot->next;
+            cache.SetCount(cache.Count() - 1);
+            slot->next = free_;
+            free_ = slot;
+        }
+    }
+
+    // Caller holds mutex_
+    void CarveSlab() {
+        auto* slab = static_cast<std::byte*>(::operator new(kSlotsPerSlab * kSlotSize, std::align_val_t{kAlign}));
+        slabs_.push_back(slab);
+        for (std::size_t i = kSlotsPerSlab; i-- > 0;) {
+            auto* slot = reinterpret_cast<FreeSlot*>(slab + i * kSlotSize);
+            slot->next = free_;
+            free_ = slot;
+        }
+    }
+
+    mutable std::mutex mutex_;
+    FreeSlot* free_ = nullptr;
+    std::vector<std::byte*> slabs_;
+    std::vector<ThreadCache*> caches_;
+    std::int64_t retiredLive_ = 0; // live slots of exited threads and of the shared slow paths
+
+    static inline thread_local bool tRetired_ = false;
+};
+
+/**
+ * @brief Stateless allocator drawing single objects from NodePool<sizeof(T), alignof(T)>
+ *
+ * Array allocations (n != 1, e.g. hash table slot arrays) go to std::allocator.
+ */
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+    using pool_type = NodePool<sizeof(T), alignof(T)>;
+
+    PoolAllocator() noexcept = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if (n == 1) return static_cast<T*>(pool_type::Get().Allocate());
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        if (n == 1) {
+            pool_type::Get().Deallocate(p);
+        } else {
+            std::allocator<T>().deallocate(p, n);
+        }
+    }
+
+    /// Usage of the size class T's nodes share with every other type of the same size/alignment
+    static PoolStats Stats() { return pool_type::Get().Stats(); }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+};
+
+/// Allocator policies for the reactive collections' node maps
+struct StdAllocPolicy {
+    template <typename T>
+    using allocator = std::allocator<T>;
+    static constexpr bool pooled = false;
+};
+
+struct PoolAllocPolicy {
+    template <typename T>
+    using allocator = PoolAllocator<T>;
+    static constexpr bool pooled = true;
+};
+
+} // namespace db
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace db {
+
+/**
+ * @brief Small LRU of recent (query -> result rows) pairs for an in-memory model
+ *
+ * The owning model looks results up while holding its read lock and calls Invalidate()
+ * under its write lock before each mutation, passing a predicate that tells which cached
+ * queries the write can change (typically "the old or new row matches the query's
+ * filters"). Unaffected entries stay valid across unrelated writes.
+ *
+ * A result is only stored the second time its query is seen, so one-off queries never
+ * pay for the copy. Internally locked: readers of the model run concurrently.
+ */
+template <typename Query, typename Row>
+class QueryResultCache {
+public:
+    using Rows = std::vector<Row>;
+
+    /**
+     * @param capacity Cached queries (0 disables the cache)
+     * @param maxRows Results with more rows than this are not stored
+     */
+    explicit QueryResultCache(std::size_t capacity = 8, std::size_t maxRows = 50000)
+        : capacity_(capacity), maxRows_(maxRows) {}
+
+    void SetCapacity(std::size_t capacity) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity;
+        Trim();
+    }
+
+    /**
+     * @brief Cached rows for query, or null
+     *
+     * On a miss, `admit` tells whether the caller should Store() the result it computes.
+     */
+    std::shared_ptr<const Rows> Find(const Query& query, bool& admit) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        admit = false;
+        if (capacity_ == 0) return nullptr;
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (!(it->query == query)) continue;
+            entries_.splice(entries_.begin(), entries_, it);
+            if (it->rows) {
+                hits_++;
+                return it->rows;
+            }
+            misses_++;
+            admit = true;
+            return nullptr;
+        }
+        misses_++;
+        entries_.push_front(Entry{query, nullptr});
+        Trim();
+        return nullptr;
+    }
+
+    void Store(const Query& query, const Rows& rows) {
+        if (rows.size() > maxRows_) return;
+        auto stored = std::make_shared<const Rows>(rows);
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : entries_) {
+            if (entry.query == query) {
+                if (!entry.rows) cached_++;
+                entry.rows = std::move(stored);
+                return;
+            }
+        }
+    }
+
+    /// Any stored results? (Lets writers skip collecting what Invalidate() needs.)
+    bool HasResults() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cached_ != 0;
+    }
+
+    /**
+     * @brief Drop the stored results of queries a write may change
+     *
+     * @param affects `bool(const Query&)`
+     */
+    template <typename AffectsFn>
+    void Invalidate(AffectsFn&& affects) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (cached_ == 0) return;
+        for (auto& entry : entries_) {
+            if (entry.rows && affects(entry.query)) {
+                entry.rows.reset();
+                cached_--;
+                invalidations_++;
+            }
+        }
+    }
+
+    void Clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        cached_ = 0;
+    }
+
+    std::uint64_t Hits() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return hits_;
+    }
+
+    std::uint64_t Misses() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return misses_;
+    }
+
+    std::uint64_t Invalidations() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return invalidations_;
+    }
+
+private:
+    struct Entry {
+        Query query;
+        std::shared_ptr<const Rows> rows; // null = seen once, not stored yet
+    };
+
+    void Trim() {
+        while (entries_.size() > capacity_) {
+            if (entries_.back().rows) cached_--;
+            entries_.pop_back();
+        }
+    }
+
+    mutable std::mutex mutex_;
+    std::list<Entry> entries_; // most recently used first
+    std::size_t capacity_;
+    std::size_t maxRows_;
+    std::size_t cached_ = 0;
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+    std::uint64_t invalidations_ = 0;
+};
+
+} // namespace db
@@ -0,0 +1,743 @@
+#pragma once
+/*
+  reactive_field_collection.h
+
+  Reactive N-field collection (single-file header).
+
+  Generalizes ReactiveTwoFieldCollection: an element is a compile-time tuple of fields
+  (Fields<double, long, double, double> for price, qty, fees, margin) and the collection
+  maintains any number of totals (Totals<...>), each with its own delta/apply/extract policy.
+  One id map entry, one monitor and one ordered-index node serve all fields of an element,
+  instead of one per parallel two-field collection kept in sync by hand.
+
+  Same concurrency model as ReactiveTwoFieldCollection: phmap parallel_node_hash_map for the
+  id/monitor/key maps (nodes from AllocPolicy), db::ProfiledSharedMutex for the ordered index.
+*/
+
+//==============================================================================
+// INCLUDES
+//==============================================================================
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+#include <reaction/reaction.h>
+#include <parallel_hashmap/phmap.h>
+#include "lock_profiler.h"
+#include "pool_allocator.h"
+#include "reactive_two_field_collection.h"
+#include "trace.h"
+
+namespace reactive {
+
+//==============================================================================
+// FIELD / TOTAL DESCRIPTORS
+//==============================================================================
+
+// Element fields, in order; values are exchanged as std::tuple<Ts...>
+template <typename... Ts>
+struct Fields {
+    using tuple_type = std::tuple<Ts...>;
+};
+
+// Totals maintained by the collection, each a TotalPolicy<...>
+template <typename... Policies>
+struct Totals {};
+
+// Extract field I of an element
+template <std::size_t I, typename TotalT>
+struct FieldExtract {
+    template <typename Tuple>
+    constexpr TotalT operator()(const Tuple &v) const noexcept {
+        return static_cast<TotalT>(std::get<I>(v));
+    }
+};
+
+// Extract field I * field J of an element (e.g. notional = price * qty)
+template <std::size_t I, std::size_t J, typename TotalT>
+struct ProductExtract {
+    template <typename Tuple>
+    constexpr TotalT operator()(const Tuple &v) const noexcept {
+        return static_cast<TotalT>(std::get<I>(v)) * static_cast<TotalT>(std::get<J>(v));
+    }
+};
+
+// Default delta: Δ = extract(new) - extract(old)
+template <typename TotalT, typename ExtractFn>
+struct ExtractDelta {
+    using DeltaType = TotalT;
+    ExtractFn extract{};
+    template <typename Tuple>
+    constexpr DeltaType operator()(const Tuple &new_values, const Tuple &old_values) const noexcept {
+        return static_cast<DeltaType>(extract(new_values) - extract(old_values));
+    }
+};
+
+/*
+  One total of a ReactiveFieldCollection.
+    Add mode     : total is folded with apply(total, delta(new, old)) on every change
+    Min/Max mode : total is the min/max of extract(values) over all elements (count map)
+  Delta functors take (new_values, old_values) tuples; a push passes a value-initialized old
+  tuple and an erase a value-initialized new tuple, as in ReactiveTwoFieldCollection.
+*/
+template <typename TotalT, typename ExtractFn, AggMode Mode = AggMode::Add,
+          typename DeltaFn = ExtractDelta<TotalT, ExtractFn>,
+          typename ApplyFn = detail::DefaultApplyAdd<TotalT, detail::deduced_delta_t<TotalT, DeltaFn>>>
+struct TotalPolicy {
+    using total_type = TotalT;
+    using delta_type = detail::deduced_delta_t<TotalT, DeltaFn>;
+    static constexpr AggMode mode = Mode;
+    static constexpr bool default_add = std::is_same_v<ApplyFn, detail::DefaultApplyAdd<TotalT, delta_type>>;
+
+    ExtractFn extract{};
+    DeltaFn delta{};
+    ApplyFn apply{};
+};
+
+template <std::size_t I, typename TotalT>
+using SumOf = TotalPolicy<TotalT, FieldExtract<I, TotalT>>;
+template <std::size_t I, std::size_t J, typename TotalT>
+using SumOfProduct = TotalPolicy<TotalT, ProductExtract<I, J, TotalT>>;
+template <std::size_t I, typename TotalT>
+using MinOf = TotalPolicy<TotalT, FieldExtract<I, TotalT>, AggMode::Min>;
+template <std::size_t I, typename TotalT>
+using MaxOf = TotalPolicy<TotalT, FieldExtract<I, TotalT>, AggMode::Max>;
+
+// Default comparator: lexicographic over the field tuple
+struct LexicographicCompare {
+    template <typename Tuple>
+    bool operator()(const Tuple &a, const Tuple &b) const noexcept {
+        return a < b;
+    }
+};
+
+//==============================================================================
+// MAIN CLASS - REACTIVE N-FIELD COLLECTION
+//==============================================================================
+
+template <
+    typename FieldsT,
+    typename TotalsT = Totals<>,
+    typename KeyT = std::monostate,
+    bool MaintainOrderedIndex = false,
+    typename CompareFn = LexicographicCompare,
+    typename AllocPolicy = db::StdAllocPolicy
+>
+class ReactiveFieldCollection;
+
+template <typename... FieldTs, typename... Policies, typename KeyT, bool MaintainOrderedIndex, typename CompareFn,
+          typename AllocPolicy>
+class ReactiveFieldCollection<Fields<FieldTs...>, Totals<Policies...>, KeyT, MaintainOrderedIndex, CompareFn,
+                              AllocPolicy> {
+public:
+    using values_type = std::tuple<FieldTs...>;
+    using policies_type = std::tuple<Policies...>;
+    using id_type = std::size_t;
+    using key_type = KeyT;
+
+    static constexpr std::size_t field_count = sizeof...(FieldTs);
+    static constexpr std::size_t total_count = sizeof...(Policies);
+    static constexpr bool has_keys = !std::is_same_v<KeyT, std::monostate>;
+
+    template <std::size_t I> using field_type = std::tuple_element_t<I, values_type>;
+    template <std::size_t I> using policy_type = std::tuple_element_t<I, policies_type>;
+    template <std::size_t I> using total_type = typename policy_type<I>::total_type;
+
+    static_assert(field_count > 0, "ReactiveFieldCollection needs at least one field");
+    static_assert((std::is_default_constructible_v<FieldTs> && ...), "fields must be default-constructible");
+
+    // runtime comparator function type (whole-element tuples)
+    using compare_fn_t = std::function<bool(const values_type&, const values_type&)>;
+
+    // Lock-free element reads: every field fits a relaxed atomic load
+    static constexpr bool lock_free_reads = (detail::seqlock_word_v<FieldTs> && ...);
+
+    // Snapshot of ElemRecord data for ordered iteration (no reactive vars)
+    struct ElemRecordSnapshot {
+        values_type last;
+        KeyT key;
+    };
+
+    // Per-element record: one Var per field, last seen values and the key
+    struct ElemRecord {
+        std::tuple<reaction::Var<FieldTs>...> vars;
+        values_type last{};
+        KeyT key{};                             // immutable after insertion
+        detail::SeqLock<lock_free_reads> seq;   // guards last
+
+        // Writer side: caller holds the element's submap lock
+        void store_last(const values_type &values) {
+            seq.write([&] { store_fields(values, std::index_sequence_for<FieldTs...>{}); });
+        }
+
+        // Consistent copy of last without the submap lock
+        values_type load_last() const {
+            return seq.read([this] { return load_fields(std::index_sequence_for<FieldTs...>{}); });
+        }
+
+        ElemRecordSnapshot snapshot() const { return {load_last(), key}; }
+
+    private:
+        template <std::size_t... Is>
+        void store_fields(const values_type &values, std::index_sequence<Is...>) {
+            (detail::seq_store(std::get<Is>(last), std::get<Is>(values)), ...);
+        }
+        template <std::size_t... Is>
+        values_type load_fields(std::index_sequence<Is...>) const {
+            return values_type(detail::seq_load(std::get<Is>(last))...);
+        }
+    };
+
+private:
+#ifdef __EMSCRIPTEN__
+    using map_mutex_type = phmap::NullMutex;
+#else
+    struct map_mutex_type : db::ProfiledMutex {
+        map_mutex_type() : db::ProfiledMutex("ReactiveFieldCollection submap") {}
+    };
+#endif
+    // Node allocator from AllocPolicy (db::PoolAllocPolicy: per-size slab pools with thread caches)
+    template<typename K, typename V>
+    using concurrent_map_t = phmap::parallel_node_hash_map<
+        K, V, std::hash<K>, std::equal_to<K>,
+        typename AllocPolicy::template allocator<std::pair<const K, V>>, 4, map_mutex_type>;
+public:
+    using elem_map_type = concurrent_map_t<id_type, ElemRecord>;
+    using monitor_map_type = concurrent_map_t<id_type, reaction::Action<>>;
+    using key_index_map_type = concurrent_map_t<KeyT, id_type>;
+
+    // Pool slot usage of the node maps (all zero with db::StdAllocPolicy). Pools are per node
+    // size class, so other containers with the same node size are included in the numbers.
+    struct AllocStats {
+        db::PoolStats elems;
+        db::PoolStats monitors;
+        db::PoolStats keys;
+    };
+    static AllocStats allocator_stats() {
+        if constexpr (AllocPolicy::pooled) {
+            return {AllocPolicy::template allocator<typename elem_map_type::value_type>::Stats(),
+                    AllocPolicy::template allocator<typename monitor_map_type::value_type>::Stats(),
+                    AllocPolicy::template allocator<typename key_index_map_type::value_type>::Stats()};
+        } else {
+            return {};
+        }
+    }
+
+    using iterator = typename elem_map_type::iterator;
+    using const_iterator = typename elem_map_type::const_iterator;
+    using lock_type = std::unique_lock<db::ProfiledMutex>;
+
+    // Ordered-index node: the id plus its record (alive while linked; erase() unlinks first)
+    struct OrderedEntry {
+        id_type id;
+        const ElemRecord *rec;
+    };
+
+    // IdComparator: calls runtime compare_fn_t on seqlock snapshots of the records; tie-break by id
+    struct IdComparator {
+        compare_fn_t cmp;
+        IdComparator() : cmp() {}
+        explicit IdComparator(compare_fn_t c) : cmp(std::move(c)) {}
+        bool operator()(const OrderedEntry &a, const OrderedEntry &b) const {
+            if (a.id == b.id) return false;
+            const values_type va = a.rec->load_last();
+            const values_type vb = b.rec->load_last();
+            if (cmp(va, vb)) return true;
+            if (cmp(vb, va)) return false;
+            return a.id < b.id;
+        }
+    };
+    using ordered_set_type = std::set<OrderedEntry, IdComparator>;
+
+    /*
+      Constructor:
+        policies : per-total functor state (default-constructed policies otherwise)
+        combined_atomic : if true, all totals of one change are applied together and notify once
+        coarse_lock : serialize every public operation on one mutex
+    */
+    explicit ReactiveFieldCollection(policies_type policies = policies_type{},
+                                     bool combined_atomic = false,
+                                     bool coarse_lock = false)
+        : totals_(reaction::var(typename Policies::total_type{})...),
+          policies_(std::move(policies)),
+          cmp_(CompareFn{}),
+          coarse_lock_enabled_(coarse_lock),
+          combined_atomic_(combined_atomic),
+          nextId_(1)
+    {
+        if constexpr (MaintainOrderedIndex) {
+            std::unique_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
+            ordered_index_.emplace(IdComparator(cmp_));
+        }
+    }
+
+    // Destructor: explicit teardown to avoid comparator use-after-free during implicit member destruction.
+    ~ReactiveFieldCollection() {
+        try {
+            monitors_.clear();
+        } catch (...) {}
+        try {
+            std::unique_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
+            ordered_index_.reset();
+        } catch (...) {}
+        if constexpr (has_keys) {
+            try { key_index_.clear(); } catch (...) {}
+        }
+    }
+
+    ReactiveFieldCollection(const ReactiveFieldCollection&) = delete;
+    ReactiveFieldCollection& operator=(const ReactiveFieldCollection&) = delete;
+
+    // Replace the stored comparator and rebuild the ordered index atomically.
+    template <typename NewCompare>
+    void set_compare(NewCompare new_cmp) {
+        {
+            auto lk = maybe_lock();
+            cmp_ = compare_fn_t(new_cmp);
+        }
+        rebuild_ordered_index();
+    }
+
+    // Rebuild the ordered index using the current runtime comparator (cmp_).
+    void rebuild_ordered_index() {
+        if constexpr (!MaintainOrderedIndex) return;
+        std::unique_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
+        std::optional<ordered_set_type> new_set;
+        new_set.emplace(IdComparator(cmp_));
+        for (typename elem_map_type::const_iterator it = elems_.begin(); it != elems_.end(); ++it) {
+            new_set->insert(OrderedEntry{it->first, &it->second});
+        }
+        ordered_index_.swap(new_set);
+    }
+
+    // Acquire coarse-grained lock (owns the lock only if coarse locking active)
+    lock_type lock_public() { return maybe_lock(); }
+
+    // push
+    id_type push_back(const values_type &values) {
+        auto lk = maybe_lock();
+        return push_one(values, KeyT{});
+    }
+    // push with key
+    id_type push_back(const values_type &values, KeyT key) {
+        auto lk = maybe_lock();
+        return push_one(values, std::move(key));
+    }
+
+    // batch push
+    void push_back(const std::vector<values_type> &vals, const std::vector<key_type> *keys = nullptr) {
+        auto lk = maybe_lock();
+        if (vals.empty()) return;
+        KS_TRACE_SCOPE("collection", "push_batch");
+        reaction::batchExecute([this, &vals, keys]() {
+            for (std::size_t i = 0; i < vals.size(); ++i) {
+                KeyT k = (keys && i < keys->size()) ? (*keys)[i] : KeyT{};
+                (void)push_one(vals[i], std::move(k));
+            }
+        });
+    }
+
+    // Set every field of an element in one batch, so its monitor runs once
+    void assign(id_type id, const values_type &values) {
+        auto lk = maybe_lock();
+        std::tuple<reaction::Var<FieldTs>...> *vars = nullptr;
+        elems_.modify_if(id, [&](auto &pair) { vars = &pair.second.vars; });
+        if (!vars) throw std::out_of_range("assign: id not found");
+        reaction::batchExecute([&]() {
+            assign_vars(*vars, values, std::index_sequence_for<FieldTs...>{});
+        });
+    }
+
+    // erase by id
+    void erase(id_type id) {
+        auto lk = maybe_lock();
+
+        values_type old{};
+        KeyT key_to_erase{};
+        bool found = false;
+        elems_.if_contains(id, [&](const auto &pair) {
+            old = pair.second.last;
+            if constexpr (has_keys) key_to_erase = pair.second.key;
+            found = true;
+        });
+        if (!found) return;
+
+        if constexpr (MaintainOrderedIndex) {
+            std::unique_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
+            unlink_ordered(id);
+        }
+
+        apply_change(&old, nullptr);
+
+        if constexpr (has_keys) key_index_.erase(key_to_erase);
+
+        monitors_.erase_if(id, [](auto &pair) { pair.second.close(); return true; });
+        elems_.erase(id);
+        elem_count_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // erase by key (erase() takes the coarse lock)
+    template <typename K = KeyT>
+    std::enable_if_t<!std::is_same_v<K, std::monostate>, void>
+    erase_by_key(const K &k) {
+        if (auto id = find_by_key(k)) erase(*id);
+    }
+
+    // find_by_key
+    template <typename K = KeyT>
+    [[nodiscard]] std::enable_if_t<!std::is_same_v<K, std::monostate>, std::optional<id_type>>
+    find_by_key(const K &k) const {
+        std::optional<id_type> res;
+        key_index_.if_contains(k, [&](const auto &pair) { res = pair.second; });
+        return res;
+    }
+
+    // Var accessor for field I — node-based map guarantees pointer stability after rehash
+    template <std::size_t I>
+    reaction::Var<field_type<I>> &fieldVar(id_type id) {
+        auto lk = maybe_lock();
+        reaction::Var<field_type<I>> *ptr = nullptr;
+        elems_.modify_if(id, [&](auto &pair) { ptr = &std::get<I>(pair.second.vars); });
+        if (ptr) return *ptr;
+        throw std::out_of_range("fieldVar: id not found");
+    }
+
+    // Last values seen by the element's monitor
+    [[nodiscard]] std::optional<values_type> values(id_type id) const {
+        std::optional<values_type> res;
+        elems_.if_contains(id, [&](const auto &pair) { res = pair.second.last; });
+        return res;
+    }
+
+    // totals
+    template <std::size_t I>
+    [[nodiscard]] total_type<I> total() const {
+        if (coarse_lock_enabled_) {
+            std::lock_guard<db::ProfiledMutex> g(coarse_mtx_);
+            return std::get<I>(totals_).get();
+        }
+        return std::get<I>(totals_).get();
+    }
+    template <std::size_t I>
+    [[nodiscard]] reaction::Var<total_type<I>> &totalVar() { return std::get<I>(totals_); }
+
+    // size / empty - lock-free using atomic counter
+    [[nodiscard]] std::size_t size() const noexcept { return elem_count_.load(std::memory_order_relaxed); }
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+    // Basic iteration over the underlying map (id -> ElemRecord)
+    iterator begin() { return elems_.begin(); }
+    iterator end() { return elems_.end(); }
+    const_iterator begin() const { return elems_.begin(); }
+    const_iterator end() const { return elems_.end(); }
+
+    //==============================================================================
+    // ORDERED INDEX ITERATORS
+    //==============================================================================
+
+    // Iterator over the ordered index yielding (id, snapshot) pairs
+    template <typename UnderlyingIt>
+    class OrderedIteratorT {
+        UnderlyingIt it_;
+        const ReactiveFieldCollection *parent_;
+    public:
+        OrderedIteratorT() : it_(), parent_(nullptr) {}
+        OrderedIteratorT(const ReactiveFieldCollection *p, UnderlyingIt it) : it_(it), parent_(p) {}
+
+        OrderedIteratorT& operator++() { ++it_; return *this; }
+        OrderedIteratorT operator++(int) { OrderedIteratorT tmp = *this; ++it_; return tmp; }
+
+        bool operator==(const OrderedIteratorT &o) const {
+            if (parent_ == nullptr && o.parent_ == nullptr) return true;
+            if (parent_ != o.parent_) return false;
+            return it_ == o.it_;
+        }
+        bool operator!=(const OrderedIteratorT &o) const { return !(*this == o); }
+
+        std::pair<id_type, ElemRecordSnapshot> operator*() const {
+            return { it_->id, it_->rec->snapshot() };
+        }
+    };
+    using OrderedConstIterator = OrderedIteratorT<typename ordered_set_type::const_iterator>;
+    using OrderedConstReverseIterator = OrderedIteratorT<typename ordered_set_type::const_reverse_iterator>;
+
+    [[nodiscard]] OrderedConstIterator ordered_begin() const {
+        if constexpr (!MaintainOrderedIndex) return OrderedConstIterator();
+        std::shared_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
+        if (!ordered_index_) return OrderedConstIterator();
+        return OrderedConstIterator(this, ordered_index_->cbegin());
+    }
+    [[nodiscard]] OrderedConstIterator ordered_end() const {
+        if constexpr (!MaintainOrderedIndex) return OrderedConstIterator();
+        std::shared_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
+        if (!ordered_index_) return OrderedConstIterator();
+        return OrderedConstIterator(this, ordered_index_->cend());
+    }
+    [[nodiscard]] OrderedConstReverseIterator ordered_rbegin() const {
+        if constexpr (!MaintainOrderedIndex) return OrderedConstReverseIterator();
+        std::shared_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
+        if (!ordered_index_) return OrderedConstReverseIterator();
+        return OrderedConstReverseIterator(this, ordered_index_->crbegin());
+    }
+    [[nodiscard]] OrderedConstReverseIterator ordered_rend() const {
+        if constexpr (!MaintainOrderedIndex) return OrderedConstReverseIterator();
+        std::shared_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
+        if (!ordered_index_) return OrderedConstReverseIterator();
+        return OrderedConstReverseIterator(this, ordered_index_->crend());
+    }
+
+    // top_k / bottom_k helpers (ids)
+    [[nodiscard]] std::vector<id_type> top_k(std::size_t k) const {
+        std::vector<id_type> out;
+        if constexpr (!MaintainOrderedIndex) return out;
+        std::shared_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
+        if (!ordered_index_) return out;
+        for (auto it = ordered_index_->rbegin(); it != ordered_index_->rend() && out.size() < k; ++it) out.push_back(it->id);
+        return out;
+    }
+    [[nodiscard]] std::vector<id_type> bottom_k(std::size_t k) const {
+        std::vector<id_type> out;
+        if constexpr (!MaintainOrderedIndex) return out;
+        std::shared_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
+        if (!ordered_index_) return out;
+        for (auto it = ordered_index_->begin(); it != ordered_index_->end() && out.size() < k; ++it) out.push_back(it->id);
+        return out;
+    }
+
+    // Visit (id, snapshot) in comparator order under the shared ordered lock
+    template <typename Fn>
+    void for_each_ordered(Fn &&fn) const {
+        if constexpr (!MaintainOrderedIndex) return;
+        std::shared_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
+        if (!ordered_index_) return;
+        for (const OrderedEntry &e : *ordered_index_) fn(e.id, e.rec->snapshot());
+    }
+
+private:
+    lock_type maybe_lock() const {
+        return coarse_lock_enabled_ ? lock_type(coarse_mtx_) : lock_type(coarse_mtx_, std::defer_lock);
+    }
+
+    template <std::size_t... Is>
+    static void assign_vars(std::tuple<reaction::Var<FieldTs>...> &vars, const values_type &values,
+                            std::index_sequence<Is...>) {
+        (std::get<Is>(vars).value(std::get<Is>(values)), ...);
+    }
+
+    //==============================================================================
+    // TOTALS
+    //==============================================================================
+
+    // Min/Max: count-map of extractor values, top is the total
+    template <std::size_t I>
+    void update_index(const values_type *old_values, const values_type *new_values) {
+        auto &policy = std::get<I>(policies_);
+        auto &idx = std::get<I>(idx_);
+        if (old_values) {
+            auto it = idx.find(policy.extract(*old_values));
+            if (it != idx.end() && --(it->second) == 0) idx.erase(it);
+        }
+        if (new_values) ++idx[policy.extract(*new_values)];
+    }
+
+    template <std::size_t I>
+    total_type<I> top_index() const {
+        const auto &idx = std::get<I>(idx_);
+        if (idx.empty()) return total_type<I>{};
+        if constexpr (policy_type<I>::mode == AggMode::Min) return idx.begin()->first;
+        else return idx.rbegin()->first;
+    }
+
+    // Fold one change into total I; returns whether cur changed. Caller holds totals_mtx_.
+    template <std::size_t I>
+    bool fold_total(total_type<I> &cur, const values_type *old_values, const values_type *new_values) {
+        using P = policy_type<I>;
+        if constexpr (P::mode == AggMode::Add) {
+            const auto &policy = std::get<I>(policies_);
+            const values_type zero{};
+            auto d = policy.delta(new_values ? *new_values : zero, old_values ? *old_values : zero);
+            if constexpr (P::default_add) {
+                cur += d;
+                return true;
+            } else {
+                return policy.apply(cur, d);
+            }
+        } else {
+            update_index<I>(old_values, new_values);
+            total_type<I> top = top_index<I>();
+            if (cur == top) return false;
+            cur = top;
+            return true;
+        }
+    }
+
+    template <std::size_t I>
+    void apply_total(const values_type *old_values, const values_type *new_values) {
+        using P = policy_type<I>;
+        auto &var = std::get<I>(totals_);
+        if constexpr (P::mode == AggMode::Add && P::default_add) {
+            const values_type zero{};
+            var += std::get<I>(policies_).delta(new_values ? *new_values : zero, old_values ? *old_values : zero);
+        } else {
+            std::lock_guard<db::ProfiledMutex> g(totals_mtx_);
+            total_type<I> cur = var.get();
+            if (fold_total<I>(cur, old_values, new_values)) var.value(cur);
+        }
+    }
+
+    // Apply one element change (null old = push, null new = erase) to every total
+    void apply_change(const values_type *old_values, const values_type *new_values) {
+        apply_change(old_values, new_values, std::index_sequence_for<Policies...>{});
+    }
+
+    template <std::size_t... Is>
+    void apply_change(const values_type *old_values, const values_type *new_values, std::index_sequence<Is...>) {
+        if constexpr (sizeof...(Is) > 0) {
+            if (!combined_atomic_) {
+                (apply_total<Is>(old_values, new_values), ...);
+                return;
+            }
+
+            // Combined-atomic path: fold every total under one mutex and write them in one batch
+            std::lock_guard<db::ProfiledMutex> g(totals_mtx_);
+            std::tuple<typename Policies::total_type...> cur{std::get<Is>(totals_).get()...};
+            bool changed[] = {fold_total<Is>(std::get<Is>(cur), old_values, new_values)...};
+            reaction::batchExecute([&] {
+                ([&] { if (changed[Is]) std::get<Is>(totals_).value(std::get<Is>(cur)); }(), ...);
+            });
+        }
+    }
+
+    //==============================================================================
+    // ELEMENT INSERTION & MODIFICATION
+    //==============================================================================
+
+    [[nodiscard]] id_type push_one(const values_type &values, KeyT key) {
+        id_type id = nextId_.fetch_add(1, std::memory_order_relaxed);
+
+        ElemRecord rec;
+        rec.vars = make_vars(values, std::index_sequence_for<FieldTs...>{});
+        rec.last = values;
+        if constexpr (has_keys) {
+            key_index_.insert(std::make_pair(key, id));
+            rec.key = std::move(key);
+        }
+        elems_.insert(std::make_pair(id, std::move(rec)));
+        elem_count_.fetch_add(1, std::memory_order_relaxed);
+
+        // Stable record pointer (node-based map guarantees pointer stability)
+        ElemRecord *rec_ptr = nullptr;
+        elems_.modify_if(id, [&](auto &pair) { rec_ptr = &pair.second; });
+        if (!rec_ptr) {
+            throw std::runtime_error("push_one: element not found after insert");
+        }
+
+        if constexpr (MaintainOrderedIndex) {
+            std::unique_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
+            if (ordered_index_) ordered_index_->insert(OrderedEntry{id, rec_ptr});
+        }
+
+        apply_change(nullptr, &values);
+
+        monitors_.insert(std::make_pair(id, make_monitor(id, rec_ptr->vars, std::index_sequence_for<FieldTs...>{})));
+        return id;
+    }
+
+    template <std::size_t... Is>
+    static std::tuple<reaction::Var<FieldTs>...> make_vars(const values_type &values, std::index_sequence<Is...>) {
+        return std::tuple<reaction::Var<FieldTs>...>(reaction::var(std::get<Is>(values))...);
+    }
+
+    // One monitor observes every field of the element
+    template <std::size_t... Is>
+    auto make_monitor(id_type id, std::tuple<reaction::Var<FieldTs>...> &vars, std::index_sequence<Is...>) {
+        return reaction::action(
+            [this, id](FieldTs... new_values) {
+                on_change(id, values_type(std::move(new_values)...));
+            },
+            std::get<Is>(vars)...);
+    }
+
+    void on_change(id_type id, const values_type &new_values) {
+        KS_TRACE_SCOPE("collection", "monitor");
+        values_type old_values{};
+        bool found = false;
+        auto store = [&](auto &pair) {
+            old_values = pair.second.last;
+            pair.second.store_last(new_values);
+            found = true;
+        };
+
+        bool need_reinsert = false;
+        if constexpr (MaintainOrderedIndex) {
+            elems_.if_contains(id, [&](const auto &pair) {
+                const values_type &cur = pair.second.last;
+                need_reinsert = cmp_(cur, new_values) || cmp_(new_values, cur);
+            });
+        }
+
+        if (need_reinsert && ordered_index_) {
+            // The set finds the entry by its current values, so unlink it before they change
+            std::unique_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
+            const ElemRecord *rec = unlink_ordered(id);
+            elems_.modify_if(id, store);
+            if (rec && found) ordered_index_->insert(OrderedEntry{id, rec});
+        } else {
+            elems_.modify_if(id, store);
+        }
+        if (!found) return;
+
+        apply_change(&old_values, &new_values);
+    }
+
+    // Remove id from the ordered index; caller holds ordered_mtx_ exclusively.
+    // Returns the record if it was linked (alive while ordered_mtx_ is held), else null.
+    const ElemRecord *unlink_ordered(id_type id) {
+        const ElemRecord *rec = nullptr;
+        elems_.if_contains(id, [&](const auto &pair) { rec = &pair.second; });
+        if (!rec || !ordered_index_ || ordered_index_->erase(OrderedEntry{id, rec}) == 0) return nullptr;
+        return rec;
+    }
+
+    //==============================================================================
+    // MEMBER VARIABLES
+    //==============================================================================
+
+    // Members (order chosen so elems_ outlives ordered_index_ on destruction)
+    std::tuple<reaction::Var<typename Policies::total_type>...> totals_;
+    policies_type policies_;
+    std::tuple<std::map<typename Policies::total_type, std::size_t>...> idx_;
+
+    // runtime comparator (stores any callable convertible to compare_fn_t)
+    compare_fn_t cmp_;
+
+    elem_map_type elems_;
+    monitor_map_type monitors_;
+
+    std::optional<ordered_set_type> ordered_index_;
+    mutable db::ProfiledSharedMutex ordered_mtx_{"ReactiveFieldCollection::ordered_mtx_"};
+
+    db::ProfiledMutex totals_mtx_{"ReactiveFieldCollection::totals_mtx_"};
+    mutable db::ProfiledMutex coarse_mtx_{"ReactiveFieldCollection::coarse_mtx_"};
+    bool coarse_lock_enabled_;
+
+    key_index_map_type key_index_{};
+
+    bool combined_atomic_;
+
+    std::atomic<id_type> nextId_;
+    std::atomic<std::size_t> elem_count_{0};
+};
+
+} // namespace reactive
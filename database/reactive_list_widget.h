@@ -9,8 +9,13 @@
 #include <sstream>
 #include <iomanip>
 #include <cstring>
+#include <memory>
+#include <optional>
 #include <type_traits>
 #include "imgui.h"
+#include "perf_counters.h"
+#include "style_rules.h"
+#include "trace.h"
 
 namespace db {
 
@@ -51,7 +56,7 @@ concept ReactiveCollection = requires(const C& c) {
  * - ImGuiListClipper for virtualized large lists
  * - Frozen header row
  * - Row selection (ImGui MultiSelect API)
- * - Per-row and per-cell background color callbacks
+ * - Per-row and per-cell colors: rule-based (precomputed in Refresh) or callbacks
  * - Right-click context menu callback
  * - Filter/search bar
  * - Scroll-to-row support
@@ -147,6 +152,24 @@ public:
     void SetCellColorCallback(CellColorCallback cb)     { m_cellColorCb = std::move(cb); }
     void SetContextMenuCallback(ContextMenuCallback cb) { m_contextMenuCb = std::move(cb); }
 
+    /**
+     * @brief Style rows/cells by value rules on the typed columns (0 = ID, 1 = Elem1, 2 = Elem2)
+     *
+     * Evaluated once per row in Refresh(); Render() only indexes the result. The color
+     * callbacks remain as a fallback for rows and cells no rule styled. Safe to call from
+     * any thread; applies from the next Refresh().
+     */
+    void SetStyleRules(std::vector<StyleRule> rules) { m_styler.SetRules(std::move(rules)); }
+
+    // ---- Diagnostics ----
+
+    /// Publish Refresh()/Render() durations to the PerfRegistry under this name
+    void SetPerfName(const std::string& name) {
+        m_perfRefresh = &PerfRegistry::Get().Duration("Refresh", name);
+        m_perfRender  = &PerfRegistry::Get().Duration("Render", name);
+        m_perfName    = name;
+    }
+
     // ---- Scroll / selection ----
 
     void ScrollToRow(int rowIndex) { m_scrollToRow = rowIndex; }
@@ -180,6 +203,9 @@ public:
      * Call from a background thread or before Render().
      */
     void Refresh(const CollectionT& collection) {
+        PerfScopedTimer perfTimer(m_perfRefresh);
+        KS_TRACE_SCOPE("widget", "Refresh", m_perfName);
+
         int currentFront = m_frontIndex.load(std::memory_order_relaxed);
         int backIdx = 1 - currentFront;
 
@@ -192,8 +218,15 @@ public:
         for (auto it = collection.begin(); it != collection.end(); ++it) {
             SnapshotRow row;
             row.id    = it->first;
-            row.elem1 = it->second.lastElem1;
-            row.elem2 = it->second.lastElem2;
+            if constexpr (requires { it->second.load_last(); }) {
+                // Seqlock read: consistent pair without blocking the feed's monitor updates
+                auto [elem1, elem2] = it->second.load_last();
+                row.elem1 = elem1;
+                row.elem2 = elem2;
+            } else {
+                row.elem1 = it->second.lastElem1;
+                row.elem2 = it->second.lastElem2;
+            }
             row.idStr    = FormatId(row.id);
             row.elem1Str = FormatElem1(row.elem1);
             row.elem2Str = FormatElem2(row.elem2);
@@ -210,6 +243,11 @@ public:
         // Apply sorting
         ApplySort(backRows);
 
+        // Precompute rule-based styles for the sorted rows
+        m_styleBuffers[backIdx] = m_styler.Apply(backRows.size(), 3, [&backRows](size_t row, int col) {
+            return NumericField(backRows[row], col);
+        });
+
         // Atomic swap
         m_frontIndex.store(backIdx, std::memory_order_release);
     }
@@ -219,9 +257,13 @@ public:
      * Lock-free — reads only the front buffer.
      */
     void Render() {
+        PerfScopedTimer perfTimer(m_perfRender);
+        KS_TRACE_SCOPE("widget", "Render", m_perfName);
+
         int frontIdx = m_frontIndex.load(std::memory_order_acquire);
         const auto& rows   = m_rowBuffers[frontIdx];
         const auto& totals = m_totalsBuffers[frontIdx];
+        const StyleSnapshot* styles = m_styleBuffers[frontIdx].get();
 
         // Filter bar
         if (m_filterEnabled) {
@@ -308,20 +350,34 @@ public:
 
                 ImGui::TableNextRow();
 
-                // Per-row color
-                if (m_rowColorCb) {
+                // Per-row color (precomputed style, else callback)
+                const CellStyle rowStyle = styles ? styles->Row(dataIdx) : CellStyle{};
+                if (rowStyle.bg != 0) {
+                    ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg1, rowStyle.bg);
+                } else if (m_rowColorCb) {
                     ImU32 color = m_rowColorCb(row, dataIdx);
                     if (color != 0) {
                         ImGui::TableSetBgColor(ImGuiTableBgTarget_RowBg1, color);
                     }
                 }
 
+                // Per-cell color and text color; returns true if a text color was pushed
+                auto beginCell = [&](int col) {
+                    ImGui::TableSetColumnIndex(col);
+                    const CellStyle cellStyle = styles ? styles->Cell(dataIdx, col) : CellStyle{};
+                    if (cellStyle.bg != 0) {
+                        ImGui::TableSetBgColor(ImGuiTableBgTarget_CellBg, cellStyle.bg);
+                    } else if (m_cellColorCb) {
+                        ImU32 cc = m_cellColorCb(row, dataIdx, col);
+                        if (cc != 0) ImGui::TableSetBgColor(ImGuiTableBgTarget_CellBg, cc);
+                    }
+                    const ImU32 textColor = cellStyle.text != 0 ? cellStyle.text : rowStyle.text;
+                    if (textColor != 0) ImGui::PushStyleColor(ImGuiCol_Text, textColor);
+                    return textColor != 0;
+                };
+
                 // Column 0: ID
-                ImGui::TableSetColumnIndex(0);
-                if (m_cellColorCb) {
-                    ImU32 cc = m_cellColorCb(row, dataIdx, 0);
-                    if (cc != 0) ImGui::TableSetBgColor(ImGuiTableBgTarget_CellBg, cc);
-                }
+                bool pushedText = beginCell(0);
                 if (m_selectionEnabled) {
                     ImGuiID selectionId = static_cast<ImGuiID>(row.id);
                     ImGui::SetNextItemSelectionUserData(selectionId);
@@ -341,22 +397,17 @@ public:
                     ImGui::SameLine(0.0f, 0.0f);
                 }
                 ImGui::TextUnformatted(row.idStr.c_str());
+                if (pushedText) ImGui::PopStyleColor();
 
                 // Column 1: Elem1
-                ImGui::TableSetColumnIndex(1);
-                if (m_cellColorCb) {
-                    ImU32 cc = m_cellColorCb(row, dataIdx, 1);
-                    if (cc != 0) ImGui::TableSetBgColor(ImGuiTableBgTarget_CellBg, cc);
-                }
+                pushedText = beginCell(1);
                 ImGui::TextUnformatted(row.elem1Str.c_str());
+                if (pushedText) ImGui::PopStyleColor();
 
                 // Column 2: Elem2
-                ImGui::TableSetColumnIndex(2);
-                if (m_cellColorCb) {
-                    ImU32 cc = m_cellColorCb(row, dataIdx, 2);
-                    if (cc != 0) ImGui::TableSetBgColor(ImGuiTableBgTarget_CellBg, cc);
-                }
+                pushedText = beginCell(2);
                 ImGui::TextUnformatted(row.elem2Str.c_str());
+                if (pushedText) ImGui::PopStyleColor();
 
                 // Context menu for non-selection mode
                 if (!m_selectionEnabled && m_contextMenuCb) {
@@ -466,6 +517,26 @@ private:
         }
     }
 
+    // ---- Styling ----
+
+    template <typename T>
+    static std::optional<double> NumericValue(const T& v) {
+        if constexpr (std::is_arithmetic_v<T>) {
+            return static_cast<double>(v);
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    static std::optional<double> NumericField(const SnapshotRow& row, int col) {
+        switch (col) {
+            case 0: return NumericValue(row.id);
+            case 1: return NumericValue(row.elem1);
+            case 2: return NumericValue(row.elem2);
+            default: return std::nullopt;
+        }
+    }
+
     // ---- Sorting ----
 
     void ApplySort(std::vector<SnapshotRow>& rows) {
@@ -513,6 +584,7 @@ private:
     // Double buffers
     std::vector<SnapshotRow> m_rowBuffers[2];
     SnapshotTotals           m_totalsBuffers[2];
+    std::shared_ptr<const StyleSnapshot> m_styleBuffers[2]; // null when no style rules
     std::atomic<int>         m_frontIndex{0};
 
     // Table config
@@ -548,6 +620,14 @@ private:
     CellColorCallback   m_cellColorCb;
     ContextMenuCallback m_contextMenuCb;
 
+    // Rule-based styling (evaluated in Refresh)
+    RowStyler m_styler;
+
+    // Optional perf counters (registered via SetPerfName)
+    PerfDuration* m_perfRefresh = nullptr;
+    PerfDuration* m_perfRender  = nullptr;
+    std::string   m_perfName; // also used as the trace span detail
+
     // Scroll
     int m_scrollToRow = -1;
 
@@ -6,6 +6,12 @@
 
   Phase 2: Uses parallel-hashmap (phmap) parallel_node_hash_map for concurrent map operations.
   Phase 3: Uses std::shared_mutex for concurrent ordered index (multiple readers, single writer).
+  Phase 4: Per-record seqlock on lastElem1/lastElem2; the ordered index, its iterators and the
+           list widget read records without taking submap locks.
+  Phase 5: AllocPolicy template parameter for the node maps; db::PoolAllocPolicy serves nodes
+           from per-size slab pools with per-thread caches (database/pool_allocator.h).
+  Phase 6: Change stream (set_change_listener) and bulk_load() restore on db::ParallelPool, used by
+           db::CollectionPersistence (database/collection_persistence.h).
 */
 
 //==============================================================================
@@ -16,6 +22,7 @@
 #include <atomic>
 #include <vector>
 #include <cstddef>
+#include <cstdint>
 #include <type_traits>
 #include <utility>
 #include <unordered_map>
@@ -28,8 +35,13 @@
 #include <memory>
 #include <limits>
 #include <functional>
+#include <thread>
 #include <reaction/reaction.h>
 #include <parallel_hashmap/phmap.h>
+#include "lock_profiler.h"
+#include "parallel_for.h"
+#include "pool_allocator.h"
+#include "trace.h"
 
 namespace reactive {
 
@@ -39,6 +51,9 @@ namespace reactive {
 
 enum class AggMode { Add, Min, Max };
 
+// Kind of element change reported to a collection's change listener
+enum class ChangeKind : std::uint8_t { Insert, Update, Erase };
+
 //==============================================================================
 // DETAIL NAMESPACE - HELPER FUNCTORS & UTILITIES
 //==============================================================================
@@ -130,6 +145,86 @@ using deduced_delta_t = std::conditional_t<
     typename DeltaFn::DeltaType,
     TotalT>;
 
+// Values a seqlock reader can copy with relaxed atomic loads (no torn reads, no data race)
+template <typename T, typename = void>
+inline constexpr bool seqlock_word_v = false;
+template <typename T>
+inline constexpr bool seqlock_word_v<T, std::enable_if_t<std::is_trivially_copyable_v<T>>> =
+    std::atomic_ref<T>::is_always_lock_free && alignof(T) >= std::atomic_ref<T>::required_alignment;
+
+template <typename T>
+void seq_store(T &dst, const T &v) {
+    if constexpr (seqlock_word_v<T>) std::atomic_ref<T>(dst).store(v, std::memory_order_relaxed);
+    else dst = v;
+}
+template <typename T>
+T seq_load(const T &src) {
+    if constexpr (seqlock_word_v<T>) return std::atomic_ref<T>(const_cast<T &>(src)).load(std::memory_order_relaxed);
+    else return src;
+}
+
+/*
+  Per-record seqlock for the last-seen element values.
+    Optimistic (every guarded field is a seqlock word): writers, already serialized by the
+      submap lock, make the version odd, store with seq_store and make it even again; readers
+      copy with seq_load and retry until they saw one even version, so they never block.
+    Otherwise the version doubles as a spinlock taken by readers and writers alike.
+*/
+template <bool Optimistic>
+class SeqLock {
+public:
+    SeqLock() = default;
+    SeqLock(const SeqLock &) noexcept {}
+    SeqLock &operator=(const SeqLock &) noexcept { return *this; }
+
+    template <typename WriteFn>
+    void write(WriteFn &&fn) {
+        if constexpr (Optimistic) {
+            const std::uint32_t v = version_.load(std::memory_order_relaxed);
+            version_.store(v + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            fn();
+            version_.store(v + 2, std::memory_order_release);
+        } else {
+            lock();
+            fn();
+            version_.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    template <typename ReadFn>
+    auto read(ReadFn &&fn) const {
+        if constexpr (Optimistic) {
+            for (;;) {
+                const std::uint32_t v = version_.load(std::memory_order_acquire);
+                if (v & 1u) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                auto result = fn();
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (version_.load(std::memory_order_relaxed) == v) return result;
+            }
+        } else {
+            lock();
+            auto result = fn();
+            version_.fetch_add(1, std::memory_order_release);
+            return result;
+        }
+    }
+
+private:
+    void lock() const {
+        for (;;) {
+            std::uint32_t v = version_.load(std::memory_order_relaxed);
+            if (!(v & 1u) && version_.compare_exchange_weak(v, v + 1, std::memory_order_acquire)) return;
+            std::this_thread::yield();
+        }
+    }
+
+    mutable std::atomic<std::uint32_t> version_{0}; // odd while a writer (or locking reader) is inside
+};
+
 } // namespace detail
 
 // ============================================================================
@@ -181,7 +276,8 @@ template <
     bool RequireCoarseLock = false,
     bool MaintainOrderedIndex = false,
     typename CompareFn = DefaultCompare<Elem1T, Elem2T>,
-    template <typename...> class MapType = std::unordered_map
+    template <typename...> class MapType = std::unordered_map,
+    typename AllocPolicy = db::StdAllocPolicy
 >
 class ReactiveTwoFieldCollection {
 public:
@@ -201,6 +297,16 @@ public:
     // runtime comparator function type (accepts elem1, elem2 pairs for two elements)
     using compare_fn_t = std::function<bool(const elem1_type&, const elem2_type&, const elem1_type&, const elem2_type&)>;
 
+    // Lock-free element reads: both element types fit a relaxed atomic load
+    static constexpr bool lock_free_reads = detail::seqlock_word_v<elem1_type> && detail::seqlock_word_v<elem2_type>;
+
+    // Snapshot of ElemRecord data for ordered iteration (no reactive vars)
+    struct ElemRecordSnapshot {
+        elem1_type lastElem1;
+        elem2_type lastElem2;
+        KeyT key;
+    };
+
     // Per-element record
     struct ElemRecord {
         reaction::Var<elem1_type> elem1Var;
@@ -208,38 +314,72 @@ public:
         elem1_type lastElem1{};
         elem2_type lastElem2{};
         using key_storage_t = KeyT;  // KeyT is now always monostate or a real type
-        key_storage_t key{};
+        key_storage_t key{};         // immutable after insertion
+        detail::SeqLock<lock_free_reads> seq;  // guards lastElem1/lastElem2
 
         ElemRecord() = default;
         ElemRecord(reaction::Var<elem1_type> a, reaction::Var<elem2_type> b, key_storage_t k = key_storage_t{})
             : elem1Var(std::move(a)), elem2Var(std::move(b)),
               lastElem1(elem1Var.get()), lastElem2(elem2Var.get()), key(std::move(k)) {}
-    };
 
-    // Snapshot of ElemRecord data for ordered iteration (no reactive vars)
-    struct ElemRecordSnapshot {
-        elem1_type lastElem1;
-        elem2_type lastElem2;
-        typename ElemRecord::key_storage_t key;
+        // Writer side: caller holds the element's submap lock
+        void store_last(const elem1_type &e1, const elem2_type &e2) {
+            seq.write([&] {
+                detail::seq_store(lastElem1, e1);
+                detail::seq_store(lastElem2, e2);
+            });
+        }
+
+        // Consistent (e1, e2) copy without the submap lock
+        std::pair<elem1_type, elem2_type> load_last() const {
+            return seq.read([this] {
+                return std::pair<elem1_type, elem2_type>(detail::seq_load(lastElem1), detail::seq_load(lastElem2));
+            });
+        }
+
+        ElemRecordSnapshot snapshot() const {
+            auto [e1, e2] = load_last();
+            return {std::move(e1), std::move(e2), key};
+        }
     };
 
     // Concurrent map type: parallel_node_hash_map preserves pointer/reference stability on rehash.
-    // Uses std::mutex for native builds, phmap::NullMutex for single-threaded WASM.
+    // Uses std::mutex (db::ProfiledMutex) for native builds, phmap::NullMutex for single-threaded WASM.
 private:
 #ifdef __EMSCRIPTEN__
     using map_mutex_type = phmap::NullMutex;
 #else
-    using map_mutex_type = std::mutex;
+    struct map_mutex_type : db::ProfiledMutex {
+        map_mutex_type() : db::ProfiledMutex("ReactiveTwoFieldCollection submap") {}
+    };
 #endif
+    // Node allocator from AllocPolicy (db::PoolAllocPolicy: per-size slab pools with thread caches)
     template<typename K, typename V>
     using concurrent_map_t = phmap::parallel_node_hash_map<
         K, V, std::hash<K>, std::equal_to<K>,
-        std::allocator<std::pair<const K, V>>, 4, map_mutex_type>;
+        typename AllocPolicy::template allocator<std::pair<const K, V>>, 4, map_mutex_type>;
 public:
     using elem_map_type = concurrent_map_t<id_type, ElemRecord>;
     using monitor_map_type = concurrent_map_t<id_type, reaction::Action<>>;
     using key_index_map_type = concurrent_map_t<KeyT, id_type>;
 
+    // Pool slot usage of the node maps (all zero with db::StdAllocPolicy). Pools are per node
+    // size class, so other containers with the same node size are included in the numbers.
+    struct AllocStats {
+        db::PoolStats elems;
+        db::PoolStats monitors;
+        db::PoolStats keys;
+    };
+    static AllocStats allocator_stats() {
+        if constexpr (AllocPolicy::pooled) {
+            return {AllocPolicy::template allocator<typename elem_map_type::value_type>::Stats(),
+                    AllocPolicy::template allocator<typename monitor_map_type::value_type>::Stats(),
+                    AllocPolicy::template allocator<typename key_index_map_type::value_type>::Stats()};
+        } else {
+            return {};
+        }
+    }
+
     // Helper to check if keys are used (not monostate)
     static constexpr bool has_keys = !std::is_same_v<KeyT, std::monostate>;
 
@@ -247,34 +387,31 @@ public:
     using map_type = elem_map_type;
     using iterator = typename elem_map_type::iterator;
     using const_iterator = typename elem_map_type::const_iterator;
-    using lock_type = std::unique_lock<std::mutex>;
+    using lock_type = std::unique_lock<db::ProfiledMutex>;
 
     // -------- Ordered-index support types (must be declared early) ----------
-    // IdComparator: calls runtime compare_fn_t on element snapshots; tie-break by id
+    // Ordered-index node: the id plus its record, whose address is stable (node-based map) for
+    // as long as the entry is in the index (erase() unlinks it before freeing the record)
+    struct OrderedEntry {
+        id_type id;
+        const ElemRecord *rec;
+    };
+
+    // IdComparator: calls runtime compare_fn_t on seqlock snapshots of the records; tie-break by id
     struct IdComparator {
-        const ReactiveTwoFieldCollection *parent;
         compare_fn_t cmp;
-        IdComparator() : parent(nullptr), cmp() {}
-        IdComparator(const ReactiveTwoFieldCollection *p, compare_fn_t c) : parent(p), cmp(std::move(c)) {}
-        bool operator()(const id_type &a, const id_type &b) const {
-            if (a == b) return false;
-            // Snapshot element data via sequential if_contains (avoids nested locks on same submap)
-            elem1_type a1{}, b1{};
-            elem2_type a2{}, b2{};
-            bool found_a = false, found_b = false;
-            parent->elems_.if_contains(a, [&](const auto &pair) {
-                a1 = pair.second.lastElem1; a2 = pair.second.lastElem2; found_a = true;
-            });
-            parent->elems_.if_contains(b, [&](const auto &pair) {
-                b1 = pair.second.lastElem1; b2 = pair.second.lastElem2; found_b = true;
-            });
-            if (!found_a || !found_b) return a < b;
+        IdComparator() : cmp() {}
+        explicit IdComparator(compare_fn_t c) : cmp(std::move(c)) {}
+        bool operator()(const OrderedEntry &a, const OrderedEntry &b) const {
+            if (a.id == b.id) return false;
+            auto [a1, a2] = a.rec->load_last();
+            auto [b1, b2] = b.rec->load_last();
             if (cmp(a1, a2, b1, b2)) return true;
             if (cmp(b1, b2, a1, a2)) return false;
-            return a < b;
+            return a.id < b.id;
         }
     };
-    using ordered_set_type = std::set<id_type, IdComparator>;
+    using ordered_set_type = std::set<OrderedEntry, IdComparator>;
     // -----------------------------------------------------------------------
 
     /*
@@ -301,8 +438,8 @@ public:
         // Initialize ordered index after elems_ exists (ordered_index_ declared after elems_).
         // Phase 3: std::shared_mutex allows concurrent reads
         if constexpr (MaintainOrderedIndex) {
-            std::unique_lock<std::shared_mutex> lock(ordered_mtx_);
-            ordered_index_.emplace(IdComparator(this, cmp_));
+            std::unique_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
+            ordered_index_.emplace(IdComparator(cmp_));
         }
     }
 
@@ -316,7 +453,7 @@ public:
         // Destroy ordered index while elems_ and other members are still alive.
         // Phase 3: Use unique_lock for destruction
         try {
-            std::unique_lock<std::shared_mutex> lock(ordered_mtx_);
+            std::unique_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
             ordered_index_.reset();
         } catch (...) {}
 
@@ -331,11 +468,11 @@ public:
     void set_compare(NewCompare new_cmp) {
         // Update stored comparator with the same coarse-lock policy used elsewhere
         if constexpr (RequireCoarseLock) {
-            std::lock_guard<std::mutex> g(coarse_mtx_);
+            std::lock_guard<db::ProfiledMutex> g(coarse_mtx_);
             cmp_ = compare_fn_t(new_cmp);
         } else {
             if (coarse_lock_enabled_) {
-                std::lock_guard<std::mutex> g(coarse_mtx_);
+                std::lock_guard<db::ProfiledMutex> g(coarse_mtx_);
                 cmp_ = compare_fn_t(new_cmp);
             } else {
                 cmp_ = compare_fn_t(new_cmp);
@@ -344,11 +481,11 @@ public:
 
         if constexpr (MaintainOrderedIndex) {
             // Phase 3: unique_lock for write operations
-            std::unique_lock<std::shared_mutex> lock(ordered_mtx_);
+            std::unique_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
             std::optional<ordered_set_type> new_set;
-            new_set.emplace(IdComparator(this, cmp_));
+            new_set.emplace(IdComparator(cmp_));
             for (typename elem_map_type::const_iterator it = elems_.begin(); it != elems_.end(); ++it) {
-                new_set->insert(it->first);
+                new_set->insert(OrderedEntry{it->first, &it->second});
             }
             ordered_index_.swap(new_set);
             // new_set (previous ordered_index_) destructs here
@@ -360,11 +497,11 @@ public:
     void rebuild_ordered_index() {
         if constexpr (!MaintainOrderedIndex) return;
         // Phase 3: unique_lock for write operations
-        std::unique_lock<std::shared_mutex> lock(ordered_mtx_);
+        std::unique_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
         std::optional<ordered_set_type> new_set;
-        new_set.emplace(IdComparator(this, cmp_));
+        new_set.emplace(IdComparator(cmp_));
         for (typename elem_map_type::const_iterator it = elems_.begin(); it != elems_.end(); ++it) {
-            new_set->insert(it->first);
+            new_set->insert(OrderedEntry{it->first, &it->second});
         }
         ordered_index_.swap(new_set);
     }
@@ -394,6 +531,7 @@ public:
     void push_back(const std::vector<std::pair<elem1_type, elem2_type>> &vals, const std::vector<key_type> *keys = nullptr) {
         auto lk = maybe_lock();
         if (vals.empty()) return;
+        KS_TRACE_SCOPE("collection", "push_batch");
         reaction::batchExecute([this, &vals, keys]() {
             for (size_t i = 0; i < vals.size(); ++i) {
                 if constexpr (std::is_same_v<KeyT, std::monostate>) {
@@ -416,9 +554,13 @@ public:
         delta1_type rem1{};
         delta2_type rem2{};
         typename ElemRecord::key_storage_t key_to_erase{};
+        elem1_type last1{};
+        elem2_type last2{};
         bool found = false;
         elems_.if_contains(id, [&](const auto &pair) {
             const ElemRecord &rec = pair.second;
+            last1 = rec.lastElem1;
+            last2 = rec.lastElem2;
             if constexpr (Total1Mode != AggMode::Add) old_ext1 = extract1_(rec.lastElem1, rec.lastElem2);
             if constexpr (Total2Mode != AggMode::Add) old_ext2 = extract2_(rec.lastElem1, rec.lastElem2);
             rem1 = delta1_(elem1_type{}, elem2_type{}, rec.lastElem1, rec.lastElem2);
@@ -432,10 +574,8 @@ public:
 
         if constexpr (MaintainOrderedIndex) {
             // Phase 3: unique_lock for write operations
-            std::unique_lock<std::shared_mutex> lock(ordered_mtx_);
-            if (ordered_index_) {
-                ordered_index_->erase(id);
-            }
+            std::unique_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
+            unlink_ordered(id);
         }
 
         apply_pair(rem1, rem2,
@@ -456,6 +596,8 @@ public:
 
         // Decrement atomic element counter
         elem_count_.fetch_sub(1, std::memory_order_relaxed);
+
+        if (change_listener_) change_listener_(Change{ChangeKind::Erase, id, last1, last2, &key_to_erase});
     }
 
     // erase by key (enabled if KeyT != void)
@@ -513,11 +655,11 @@ public:
     // totals - optimized: when coarse lock not enabled, direct read (reaction::Var handles thread-safety)
     [[nodiscard]] total1_type total1() const {
         if constexpr (RequireCoarseLock) {
-            std::lock_guard<std::mutex> g(coarse_mtx_);
+            std::lock_guard<db::ProfiledMutex> g(coarse_mtx_);
             return total1_.get();
         } else {
             if (coarse_lock_enabled_) {
-                std::lock_guard<std::mutex> g(coarse_mtx_);
+                std::lock_guard<db::ProfiledMutex> g(coarse_mtx_);
                 return total1_.get();
             } else {
                 // Lock-free fast path - reaction::Var is thread-safe
@@ -527,11 +669,11 @@ public:
     }
     [[nodiscard]] total2_type total2() const {
         if constexpr (RequireCoarseLock) {
-            std::lock_guard<std::mutex> g(coarse_mtx_);
+            std::lock_guard<db::ProfiledMutex> g(coarse_mtx_);
             return total2_.get();
         } else {
             if (coarse_lock_enabled_) {
-                std::lock_guard<std::mutex> g(coarse_mtx_);
+                std::lock_guard<db::ProfiledMutex> g(coarse_mtx_);
                 return total2_.get();
             } else {
                 // Lock-free fast path - reaction::Var is thread-safe
@@ -554,10 +696,162 @@ public:
     // Basic iteration over the underlying map (id -> ElemRecord)
     iterator begin() { auto lk = maybe_lock(); return elems_.begin(); }
     iterator end()   { auto lk = maybe_lock(); return elems_.end(); }
-    const_iterator begin() const { if constexpr (RequireCoarseLock) std::lock_guard<std::mutex> g(coarse_mtx_); return elems_.begin(); }
-    const_iterator end()   const { if constexpr (RequireCoarseLock) std::lock_guard<std::mutex> g(coarse_mtx_); return elems_.end(); }
-    const_iterator cbegin() const { if constexpr (RequireCoarseLock) std::lock_guard<std::mutex> g(coarse_mtx_); return elems_.cbegin(); }
-    const_iterator cend()   const { if constexpr (RequireCoarseLock) std::lock_guard<std::mutex> g(coarse_mtx_); return elems_.cend(); }
+    const_iterator begin() const { if constexpr (RequireCoarseLock) std::lock_guard<db::ProfiledMutex> g(coarse_mtx_); return elems_.begin(); }
+    const_iterator end()   const { if constexpr (RequireCoarseLock) std::lock_guard<db::ProfiledMutex> g(coarse_mtx_); return elems_.end(); }
+    const_iterator cbegin() const { if constexpr (RequireCoarseLock) std::lock_guard<db::ProfiledMutex> g(coarse_mtx_); return elems_.cbegin(); }
+    const_iterator cend()   const { if constexpr (RequireCoarseLock) std::lock_guard<db::ProfiledMutex> g(coarse_mtx_); return elems_.cend(); }
+
+    //==============================================================================
+    // CHANGE STREAM & BULK LOAD
+    //==============================================================================
+
+    // One element change. Insert and Erase carry the key (valid for the duration of the call);
+    // Update leaves it null. Erase carries the element's last values.
+    struct Change {
+        ChangeKind kind;
+        id_type id;
+        elem1_type elem1;
+        elem2_type elem2;
+        const key_type *key;
+    };
+    using change_listener_t = std::function<void(const Change &)>;
+
+    // Called after every push_back, element Var change and erase, on the mutating thread and
+    // outside the submap locks. Changes to one element are reported in order as long as that
+    // element is written from one thread at a time. Install (or clear with nullptr) only while
+    // no other thread mutates the collection.
+    void set_change_listener(change_listener_t listener) {
+        auto lk = maybe_lock();
+        change_listener_ = std::move(listener);
+    }
+
+    // Element as stored by a persistence layer
+    struct LoadRecord {
+        id_type id;
+        elem1_type elem1;
+        elem2_type elem2;
+        key_type key{};
+    };
+
+    // Restore records into an empty collection, keeping their ids (later push_back ids continue
+    // after the largest one). Node map and key index inserts, totals and the ordered index are
+    // computed on db::ParallelPool; the reaction Vars and monitors are created on the calling
+    // thread. No change events are emitted. Keys are expected to be unique.
+    // Throws std::runtime_error if the collection is not empty or an id repeats.
+    void bulk_load(std::vector<LoadRecord> records) {
+        auto lk = maybe_lock();
+        if (!empty()) throw std::runtime_error("bulk_load: collection is not empty");
+        if (records.empty()) return;
+        KS_TRACE_SCOPE("collection", "bulk_load");
+
+        const std::size_t n = records.size();
+        constexpr std::size_t grain = 4096;
+        const std::size_t chunks = (n + grain - 1) / grain;
+
+        // reaction Vars are graph nodes, so they are made here rather than on the pool
+        std::vector<ElemRecord> staged;
+        staged.reserve(n);
+        for (LoadRecord &r : records) {
+            staged.emplace_back(reaction::var(r.elem1), reaction::var(r.elem2), std::move(r.key));
+        }
+
+        // Per-chunk partial totals, merged below in chunk order
+        struct Partial {
+            delta1_type d1{};
+            delta2_type d2{};
+            std::map<total1_type, std::size_t> idx1;
+            std::map<total2_type, std::size_t> idx2;
+            id_type max_id = 0;
+        };
+        std::vector<Partial> partials(chunks);
+        std::vector<ElemRecord *> recs(n, nullptr);
+        std::atomic<bool> duplicate{false};
+
+        elems_.reserve(n);
+        db::ParallelPool::Get().For(n, grain, [&](std::size_t begin, std::size_t end) {
+            Partial &p = partials[begin / grain];
+            auto delta1 = delta1_;
+            auto delta2 = delta2_;
+            auto extract1 = extract1_;
+            auto extract2 = extract2_;
+            for (std::size_t i = begin; i < end; ++i) {
+                const id_type id = records[i].id;
+                if (!elems_.insert(std::make_pair(id, std::move(staged[i]))).second) {
+                    duplicate.store(true, std::memory_order_relaxed);
+                    continue;
+                }
+                elems_.modify_if(id, [&](auto &pair) { recs[i] = &pair.second; });
+                const ElemRecord &rec = *recs[i];
+                if constexpr (!std::is_same_v<KeyT, std::monostate>) {
+                    key_index_.insert(std::make_pair(rec.key, id));
+                }
+                if constexpr (Total1Mode == AggMode::Add && apply1_is_default_add()) {
+                    p.d1 += delta1(rec.lastElem1, rec.lastElem2, elem1_type{}, elem2_type{});
+                } else if constexpr (Total1Mode != AggMode::Add) {
+                    ++p.idx1[extract1(rec.lastElem1, rec.lastElem2)];
+                }
+                if constexpr (Total2Mode == AggMode::Add && apply2_is_default_add()) {
+                    p.d2 += delta2(rec.lastElem1, rec.lastElem2, elem1_type{}, elem2_type{});
+                } else if constexpr (Total2Mode != AggMode::Add) {
+                    ++p.idx2[extract2(rec.lastElem1, rec.lastElem2)];
+                }
+                p.max_id = std::max(p.max_id, id);
+            }
+        });
+        if (duplicate.load(std::memory_order_relaxed)) {
+            elems_.clear();
+            if constexpr (!std::is_same_v<KeyT, std::monostate>) key_index_.clear();
+            throw std::runtime_error("bulk_load: duplicate id");
+        }
+
+        // Totals: one write per total
+        total1_type cur1 = total1_.get();
+        total2_type cur2 = total2_.get();
+        id_type max_id = 0;
+        for (Partial &p : partials) {
+            if constexpr (Total1Mode == AggMode::Add && apply1_is_default_add()) cur1 += p.d1;
+            if constexpr (Total2Mode == AggMode::Add && apply2_is_default_add()) cur2 += p.d2;
+            if constexpr (Total1Mode != AggMode::Add) for (const auto &[v, c] : p.idx1) idx1_[v] += c;
+            if constexpr (Total2Mode != AggMode::Add) for (const auto &[v, c] : p.idx2) idx2_[v] += c;
+            max_id = std::max(max_id, p.max_id);
+        }
+        // Non-default apply functors may not be associative, so they see the records in order
+        if constexpr (Total1Mode == AggMode::Add && !apply1_is_default_add()) {
+            for (const ElemRecord *r : recs) apply1_(cur1, delta1_(r->lastElem1, r->lastElem2, elem1_type{}, elem2_type{}));
+        }
+        if constexpr (Total2Mode == AggMode::Add && !apply2_is_default_add()) {
+            for (const ElemRecord *r : recs) apply2_(cur2, delta2_(r->lastElem1, r->lastElem2, elem1_type{}, elem2_type{}));
+        }
+        if constexpr (Total1Mode != AggMode::Add) cur1 = top_index1().value_or(total1_type{});
+        if constexpr (Total2Mode != AggMode::Add) cur2 = top_index2().value_or(total2_type{});
+        reaction::batchExecute([&] {
+            total1_.value(cur1);
+            total2_.value(cur2);
+        });
+
+        // Ordered index: chunks sorted on the pool, merged, then linked in order (linear for sorted input)
+        if constexpr (MaintainOrderedIndex) {
+            std::vector<OrderedEntry> entries(n);
+            for (std::size_t i = 0; i < n; ++i) entries[i] = OrderedEntry{records[i].id, recs[i]};
+            db::ParallelPool::Get().For(n, grain, [&](std::size_t begin, std::size_t end) {
+                std::sort(entries.begin() + begin, entries.begin() + end, IdComparator(cmp_));
+            });
+            for (std::size_t width = grain; width < n; width *= 2) {
+                for (std::size_t lo = 0; lo + width < n; lo += 2 * width) {
+                    std::inplace_merge(entries.begin() + lo, entries.begin() + lo + width,
+                                       entries.begin() + std::min(n, lo + 2 * width), IdComparator(cmp_));
+                }
+            }
+            std::unique_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
+            ordered_index_.emplace(entries.begin(), entries.end(), IdComparator(cmp_));
+        }
+
+        for (std::size_t i = 0; i < n; ++i) install_monitor(records[i].id, recs[i]);
+
+        elem_count_.fetch_add(n, std::memory_order_relaxed);
+        id_type next = nextId_.load(std::memory_order_relaxed);
+        while (next <= max_id && !nextId_.compare_exchange_weak(next, max_id + 1, std::memory_order_relaxed)) {}
+    }
 
     //==============================================================================
     // ORDERED INDEX ITERATORS
@@ -587,12 +881,7 @@ public:
         bool operator!=(const OrderedConstIterator &o) const { return !(*this == o); }
 
         std::pair<id_type, ElemRecordSnapshot> operator*() const {
-            id_type id = *it_;
-            ElemRecordSnapshot snap{};
-            parent_->elems_.if_contains(id, [&](const auto &pair) {
-                snap = {pair.second.lastElem1, pair.second.lastElem2, pair.second.key};
-            });
-            return { id, snap };
+            return { it_->id, it_->rec->snapshot() };
         }
     };
 
@@ -615,12 +904,7 @@ public:
         bool operator!=(const OrderedIterator &o) const { return !(*this == o); }
 
         std::pair<id_type, ElemRecordSnapshot> operator*() const {
-            id_type id = *it_;
-            ElemRecordSnapshot snap{};
-            parent_->elems_.if_contains(id, [&](const auto &pair) {
-                snap = {pair.second.lastElem1, pair.second.lastElem2, pair.second.key};
-            });
-            return { id, snap };
+            return { it_->id, it_->rec->snapshot() };
         }
     };
 
@@ -643,12 +927,7 @@ public:
         bool operator!=(const OrderedConstReverseIterator &o) const { return !(*this == o); }
 
         std::pair<id_type, ElemRecordSnapshot> operator*() const {
-            id_type id = *it_;
-            ElemRecordSnapshot snap{};
-            parent_->elems_.if_contains(id, [&](const auto &pair) {
-                snap = {pair.second.lastElem1, pair.second.lastElem2, pair.second.key};
-            });
-            return { id, snap };
+            return { it_->id, it_->rec->snapshot() };
         }
     };
 
@@ -670,38 +949,33 @@ public:
         bool operator!=(const OrderedReverseIterator &o) const { return !(*this == o); }
 
         std::pair<id_type, ElemRecordSnapshot> operator*() const {
-            id_type id = *it_;
-            ElemRecordSnapshot snap{};
-            parent_->elems_.if_contains(id, [&](const auto &pair) {
-                snap = {pair.second.lastElem1, pair.second.lastElem2, pair.second.key};
-            });
-            return { id, snap };
+            return { it_->id, it_->rec->snapshot() };
         }
     };
 
     // Ordered iterator accessors (const)
     [[nodiscard]] OrderedConstIterator ordered_begin() const {
         if constexpr (!MaintainOrderedIndex) return OrderedConstIterator();
-        std::shared_lock<std::shared_mutex> lock(ordered_mtx_);
+        std::shared_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
         if (!ordered_index_) return OrderedConstIterator();
         return OrderedConstIterator(this, ordered_index_->cbegin());
     }
     [[nodiscard]] OrderedConstIterator ordered_end() const {
         if constexpr (!MaintainOrderedIndex) return OrderedConstIterator();
-        std::shared_lock<std::shared_mutex> lock(ordered_mtx_);
+        std::shared_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
         if (!ordered_index_) return OrderedConstIterator();
         return OrderedConstIterator(this, ordered_index_->cend());
     }
 
     OrderedConstReverseIterator ordered_rbegin() const {
         if constexpr (!MaintainOrderedIndex) return OrderedConstReverseIterator();
-        std::shared_lock<std::shared_mutex> lock(ordered_mtx_);
+        std::shared_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
         if (!ordered_index_) return OrderedConstReverseIterator();
         return OrderedConstReverseIterator(this, ordered_index_->crbegin());
     }
     OrderedConstReverseIterator ordered_rend() const {
         if constexpr (!MaintainOrderedIndex) return OrderedConstReverseIterator();
-        std::shared_lock<std::shared_mutex> lock(ordered_mtx_);
+        std::shared_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
         if (!ordered_index_) return OrderedConstReverseIterator();
         return OrderedConstReverseIterator(this, ordered_index_->crend());
     }
@@ -709,25 +983,25 @@ public:
     // Ordered iterator accessors (mutable)
     [[nodiscard]] OrderedIterator ordered_begin() {
         if constexpr (!MaintainOrderedIndex) return OrderedIterator();
-        std::shared_lock<std::shared_mutex> lock(ordered_mtx_);
+        std::shared_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
         if (!ordered_index_) return OrderedIterator();
         return OrderedIterator(this, ordered_index_->begin());
     }
     [[nodiscard]] OrderedIterator ordered_end() {
         if constexpr (!MaintainOrderedIndex) return OrderedIterator();
-        std::shared_lock<std::shared_mutex> lock(ordered_mtx_);
+        std::shared_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
         if (!ordered_index_) return OrderedIterator();
         return OrderedIterator(this, ordered_index_->end());
     }
     OrderedReverseIterator ordered_rbegin() {
         if constexpr (!MaintainOrderedIndex) return OrderedReverseIterator();
-        std::shared_lock<std::shared_mutex> lock(ordered_mtx_);
+        std::shared_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
         if (!ordered_index_) return OrderedReverseIterator();
         return OrderedReverseIterator(this, ordered_index_->rbegin());
     }
     OrderedReverseIterator ordered_rend() {
         if constexpr (!MaintainOrderedIndex) return OrderedReverseIterator();
-        std::shared_lock<std::shared_mutex> lock(ordered_mtx_);
+        std::shared_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
         if (!ordered_index_) return OrderedReverseIterator();
         return OrderedReverseIterator(this, ordered_index_->rend());
     }
@@ -736,20 +1010,30 @@ public:
     [[nodiscard]] std::vector<id_type> top_k(size_t k) const {
         std::vector<id_type> out;
         if constexpr (!MaintainOrderedIndex) return out;
-        std::shared_lock<std::shared_mutex> lock(ordered_mtx_);
+        std::shared_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
         if (!ordered_index_) return out;
-        for (auto it = ordered_index_->rbegin(); it != ordered_index_->rend() && out.size() < k; ++it) out.push_back(*it);
+        for (auto it = ordered_index_->rbegin(); it != ordered_index_->rend() && out.size() < k; ++it) out.push_back(it->id);
         return out;
     }
     [[nodiscard]] std::vector<id_type> bottom_k(size_t k) const {
         std::vector<id_type> out;
         if constexpr (!MaintainOrderedIndex) return out;
-        std::shared_lock<std::shared_mutex> lock(ordered_mtx_);
+        std::shared_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
         if (!ordered_index_) return out;
-        for (auto it = ordered_index_->begin(); it != ordered_index_->end() && out.size() < k; ++it) out.push_back(*it);
+        for (auto it = ordered_index_->begin(); it != ordered_index_->end() && out.size() < k; ++it) out.push_back(it->id);
         return out;
     }
 
+    // Visit (id, snapshot) in comparator order under the shared ordered lock; safe against
+    // concurrent erase, and the snapshots themselves take no submap lock
+    template <typename Fn>
+    void for_each_ordered(Fn &&fn) const {
+        if constexpr (!MaintainOrderedIndex) return;
+        std::shared_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
+        if (!ordered_index_) return;
+        for (const OrderedEntry &e : *ordered_index_) fn(e.id, e.rec->snapshot());
+    }
+
 private:
     static constexpr bool apply1_is_default_add() {
         using default_t = detail::DefaultApplyAdd<Total1T, delta1_type>;
@@ -841,7 +1125,7 @@ private:
         }
 
         // Combined-atomic path: update indices or apply delta under combined mutex and write both totals in one batch
-        std::lock_guard<std::mutex> g(combined_mtx_);
+        std::lock_guard<db::ProfiledMutex> g(combined_mtx_);
         total1_type cur1 = total1_.get();
         total2_type cur2 = total2_.get();
 
@@ -905,7 +1189,7 @@ private:
                 bool changed = apply1_(cur, d);
                 if (changed) total1_.value(cur);
             } else {
-                std::lock_guard<std::mutex> g(total1_mtx_);
+                std::lock_guard<db::ProfiledMutex> g(total1_mtx_);
                 total1_type cur = total1_.get();
                 bool changed = apply1_(cur, d);
                 if (changed) total1_.value(cur);
@@ -922,7 +1206,7 @@ private:
                 bool changed = apply2_(cur, d);
                 if (changed) total2_.value(cur);
             } else {
-                std::lock_guard<std::mutex> g(total2_mtx_);
+                std::lock_guard<db::ProfiledMutex> g(total2_mtx_);
                 total2_type cur = total2_.get();
                 bool changed = apply2_(cur, d);
                 if (changed) total2_.value(cur);
@@ -950,18 +1234,23 @@ private:
         // Increment atomic element counter
         elem_count_.fetch_add(1, std::memory_order_relaxed);
 
+        // Stable record pointer (node-based map guarantees pointer stability)
+        ElemRecord *rec_ptr = nullptr;
+        elems_.modify_if(id, [&](auto &pair) { rec_ptr = &pair.second; });
+        if (!rec_ptr) {
+            throw std::runtime_error("push_one: element not found after insert");
+        }
+
         if constexpr (!std::is_same_v<KeyT, std::monostate>) {
-            // Copy key outside callback to avoid nested cross-map locks
-            typename ElemRecord::key_storage_t inserted_key{};
-            elems_.if_contains(id, [&](const auto &pair) { inserted_key = pair.second.key; });
-            key_index_.insert(std::make_pair(std::move(inserted_key), id));
+            // key is immutable after insertion, so it can be read without the submap lock
+            key_index_.insert(std::make_pair(rec_ptr->key, id));
         }
 
         if constexpr (MaintainOrderedIndex) {
             // Phase 3: unique_lock for write operations
-            std::unique_lock<std::shared_mutex> lock(ordered_mtx_);
+            std::unique_lock<db::ProfiledSharedMutex> lock(ordered_mtx_);
             if (ordered_index_) {
-                ordered_index_->insert(id);
+                ordered_index_->insert(OrderedEntry{id, rec_ptr});
             }
         }
 
@@ -977,18 +1266,16 @@ private:
                    /*old1*/ false, nullptr, /*new1*/ bool(new_ext1), new_ext1 ? &*new_ext1 : nullptr,
                    /*old2*/ false, nullptr, /*new2*/ bool(new_ext2), new_ext2 ? &*new_ext2 : nullptr);
 
-        // Get stable pointers to the Vars (node-based map guarantees pointer stability)
-        reaction::Var<elem1_type> *var1_ptr = nullptr;
-        reaction::Var<elem2_type> *var2_ptr = nullptr;
-        elems_.modify_if(id, [&](auto &pair) {
-            var1_ptr = &pair.second.elem1Var;
-            var2_ptr = &pair.second.elem2Var;
-        });
-        if (!var1_ptr || !var2_ptr) {
-            throw std::runtime_error("push_one: element not found after insert");
-        }
-        reaction::Var<elem1_type> &var1_ref = *var1_ptr;
-        reaction::Var<elem2_type> &var2_ref = *var2_ptr;
+        install_monitor(id, rec_ptr);
+
+        if (change_listener_) change_listener_(Change{ChangeKind::Insert, id, e1, e2, &rec_ptr->key});
+        return id;
+    }
+
+    // Watch the record's Vars: fold each change into the totals and the ordered index
+    void install_monitor(id_type id, ElemRecord *rec_ptr) {
+        reaction::Var<elem1_type> &var1_ref = rec_ptr->elem1Var;
+        reaction::Var<elem2_type> &var2_ref = rec_ptr->elem2Var;
 
         auto delta1_copy = delta1_;
         auto delta2_copy = delta2_;
@@ -997,28 +1284,21 @@ private:
 
         monitors_.insert(std::make_pair(id, reaction::action(
             [this, id, delta1_copy, delta2_copy, extract1_copy, extract2_copy](elem1_type new1, elem2_type new2) {
+                KS_TRACE_SCOPE("collection", "monitor");
                 elem1_type ne1 = static_cast<elem1_type>(new1);
                 elem2_type ne2 = static_cast<elem2_type>(new2);
 
-                // Compute all values inside modify_if; ordered index & apply_pair stay outside
-                elem1_type old_e1{};
-                elem2_type old_e2{};
-                bool need_reinsert = true;
+                // Compute all values inside modify_if; apply_pair stays outside
                 delta1_type dd1{};
                 delta2_type dd2{};
                 std::optional<total1_type> old_ext1, new_ext1;
                 std::optional<total2_type> old_ext2, new_ext2;
                 bool found = false;
 
-                elems_.modify_if(id, [&](auto &pair) {
+                auto update = [&](auto &pair) {
                     ElemRecord &r = pair.second;
-                    old_e1 = r.lastElem1;
-                    old_e2 = r.lastElem2;
-
-                    if constexpr (MaintainOrderedIndex) {
-                        bool equiv = (!cmp_(old_e1, old_e2, ne1, ne2) && !cmp_(ne1, ne2, old_e1, old_e2));
-                        need_reinsert = !equiv;
-                    }
+                    const elem1_type old_e1 = r.lastElem1;
+                    const elem2_type old_e2 = r.lastElem2;
 
                     dd1 = delta1_copy(ne1, ne2, old_e1, old_e2);
                     dd2 = delta2_copy(ne1, ne2, old_e1, old_e2);
@@ -1032,33 +1312,49 @@ private:
                         new_ext2 = extract2_copy(ne1, ne2);
                     }
 
-                    r.lastElem1 = ne1;
-                    r.lastElem2 = ne2;
+                    r.store_last(ne1, ne2);
                     found = true;
-                });
-                if (!found) return;
+                };
 
-                // Update ordered index outside the element lock
+                bool need_reinsert = false;
                 if constexpr (MaintainOrderedIndex) {
-                    if (ordered_index_) {
-                        if (need_reinsert) {
-                            std::unique_lock<std::shared_mutex> lock(this->ordered_mtx_);
-                            ordered_index_->erase(id);
-                            ordered_index_->insert(id);
-                        }
-                    }
+                    elems_.if_contains(id, [&](const auto &pair) {
+                        auto [old_e1, old_e2] = pair.second.load_last();
+                        need_reinsert = cmp_(old_e1, old_e2, ne1, ne2) || cmp_(ne1, ne2, old_e1, old_e2);
+                    });
+                }
+
+                if (need_reinsert && ordered_index_) {
+                    // The set finds the entry by its current values, so unlink it before they change
+                    std::unique_lock<db::ProfiledSharedMutex> lock(this->ordered_mtx_);
+                    const ElemRecord *r = unlink_ordered(id);
+                    elems_.modify_if(id, update);
+                    if (r && found) ordered_index_->insert(OrderedEntry{id, r});
+                } else {
+                    elems_.modify_if(id, update);
                 }
+                if (!found) return;
 
                 apply_pair(dd1, dd2,
                            /*old1*/ bool(old_ext1), old_ext1 ? &*old_ext1 : nullptr,
                            /*new1*/ bool(new_ext1), new_ext1 ? &*new_ext1 : nullptr,
                            /*old2*/ bool(old_ext2), old_ext2 ? &*old_ext2 : nullptr,
                            /*new2*/ bool(new_ext2), new_ext2 ? &*new_ext2 : nullptr);
+
+                if (change_listener_) change_listener_(Change{ChangeKind::Update, id, ne1, ne2, nullptr});
             },
             var1_ref, var2_ref
         )));
+    }
 
-        return id;
+    // Remove id from the ordered index; caller holds ordered_mtx_ exclusively.
+    // Returns the record if it was linked (it stays alive while ordered_mtx_ is held, since
+    // erase() unlinks before freeing), null if erase() already unlinked it.
+    const ElemRecord *unlink_ordered(id_type id) {
+        const ElemRecord *rec = nullptr;
+        elems_.if_contains(id, [&](const auto &pair) { rec = &pair.second; });
+        if (!rec || !ordered_index_ || ordered_index_->erase(OrderedEntry{id, rec}) == 0) return nullptr;
+        return rec;
     }
 
     [[nodiscard]] id_type push_one_no_batch(const elem1_type &e1, const elem2_type &e2, typename ElemRecord::key_storage_t key) {
@@ -1091,22 +1387,25 @@ private:
     // Ordered index is declared after elems_ so elems_ outlives it during member destruction.
     // Phase 3: std::shared_mutex for concurrent reads (multiple readers, single writer)
     std::optional<ordered_set_type> ordered_index_;
-    mutable std::shared_mutex ordered_mtx_;  // Reader-writer lock
+    mutable db::ProfiledSharedMutex ordered_mtx_{"ReactiveTwoFieldCollection::ordered_mtx_"};  // Reader-writer lock
 
     std::map<total1_type, std::size_t> idx1_;
     std::map<total2_type, std::size_t> idx2_;
 
-    std::mutex total1_mtx_;
-    std::mutex total2_mtx_;
-    std::mutex combined_mtx_;
+    db::ProfiledMutex total1_mtx_{"ReactiveTwoFieldCollection::total1_mtx_"};
+    db::ProfiledMutex total2_mtx_{"ReactiveTwoFieldCollection::total2_mtx_"};
+    db::ProfiledMutex combined_mtx_{"ReactiveTwoFieldCollection::combined_mtx_"};
 
-    mutable std::mutex coarse_mtx_;
+    mutable db::ProfiledMutex coarse_mtx_{"ReactiveTwoFieldCollection::coarse_mtx_"};
     bool coarse_lock_enabled_;
 
     key_index_map_type key_index_{};
 
     bool combined_atomic_;
 
+    // Change stream consumer (persistence); empty when nobody listens
+    change_listener_t change_listener_;
+
     // Lock-free atomic counters (Phase 1 optimization)
     std::atomic<id_type> nextId_;
     std::atomic<size_t> elem_count_{0};
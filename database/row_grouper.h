@@ -0,0 +1,395 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace db {
+
+enum class AggregateOp { Count, Sum, Min, Max, Last };
+
+/**
+ * @brief One aggregate shown in the group header rows, in the column it is computed from
+ */
+struct AggregateSpec {
+    int column = -1;
+    AggregateOp op = AggregateOp::Sum;
+};
+
+/**
+ * @brief Immutable grouped layout of one row snapshot
+ *
+ * Nodes are stored in pre-order; skipping a collapsed node means jumping to its
+ * subtreeEnd, so flattening for display costs O(visible entries).
+ */
+struct GroupSnapshot {
+    struct Node {
+        std::string path;  // group keys joined by '\x1f' (stable id for expansion state)
+        std::string label; // "key (count)"
+        int depth = 0;
+        size_t subtreeEnd = 0;           // index of the first node after this subtree
+        std::vector<std::string> cells;  // aggregate text per column ("" = none)
+        std::vector<size_t> rows;        // leaf groups only: member row indices, in snapshot order
+    };
+    std::vector<Node> nodes;
+    size_t rowCount = 0; // rows in the snapshot the indices refer to
+};
+
+/**
+ * @brief Incremental multi-level group-by with per-group aggregates
+ *
+ * Rows are grouped on the display strings of one or more columns (e.g. symbol, then
+ * venue). Count, sum, min, max and last (value of the most recently inserted/changed
+ * row) are kept for every group at every level.
+ *
+ * Apply() diffs a new snapshot against the previous one by row key: only inserted,
+ * changed, moved or removed rows touch aggregates, and only along their own group path
+ * (O(depth) per row). Count/sum/last are patched in place; min/max (and last, when its
+ * row is removed) are marked dirty and recomputed from that group's members or children
+ * only, never by rescanning every group.
+ *
+ * Not thread-safe: owned by the thread that refreshes the widget.
+ */
+template <typename Row>
+class RowGrouper {
+public:
+    /// Stable row identity (e.g. the primary key); without one rows are keyed by position
+    using RowKeyFn = std::function<uint64_t(const Row&)>;
+    /// Numeric value of an aggregate's column (nullopt = no value)
+    using ValueFn = std::function<std::optional<double>(const Row&)>;
+
+    /**
+     * @param values One entry per aggregate (may be null for AggregateOp::Count)
+     */
+    RowGrouper(std::vector<int> groupColumns, std::vector<AggregateSpec> aggregates, std::vector<ValueFn> values,
+               RowKeyFn rowKey)
+        : groupColumns_(std::move(groupColumns)), aggregates_(std::move(aggregates)), values_(std::move(values)),
+          rowKey_(std::move(rowKey)) {
+        values_.resize(aggregates_.size());
+        root_.depth = -1;
+    }
+
+    const std::vector<int>& GroupColumns() const { return groupColumns_; }
+    const std::vector<AggregateSpec>& Aggregates() const { return aggregates_; }
+
+    /**
+     * @brief Patch the groups to match rows (a full snapshot)
+     */
+    void Apply(const std::vector<Row>& rows) {
+        ++generation_;
+        lastTouched_ = 0;
+        lastRescans_ = 0;
+        ClearDisplayRows(root_);
+
+        std::vector<std::string_view> keys(groupColumns_.size());
+        std::vector<double> values(aggregates_.size());
+        for (size_t i = 0; i < rows.size(); i++) {
+            const Row& row = rows[i];
+            const uint64_t key = rowKey_ ? rowKey_(row) : static_cast<uint64_t>(i);
+            for (size_t g = 0; g < groupColumns_.size(); g++) {
+                const int col = groupColumns_[g];
+                keys[g] = col >= 0 && static_cast<size_t>(col) < row.columns.size()
+                              ? std::string_view(row.columns[static_cast<size_t>(col)])
+                              : std::string_view();
+            }
+            for (size_t a = 0; a < aggregates_.size(); a++) {
+                std::optional<double> v = values_[a] ? values_[a](row) : std::nullopt;
+                values[a] = v ? *v : std::numeric_limits<double>::quiet_NaN();
+            }
+
+            auto [it, inserted] = entries_.try_emplace(key);
+            Entry& entry = it->second;
+            if (inserted) {
+                entry.leaf = FindOrCreate(keys);
+                entry.values = values;
+                entry.seq = ++seq_;
+                AddToPath(entry, key);
+                lastTouched_++;
+            } else if (!SamePath(entry.leaf, keys)) {
+                RemoveFromPath(entry, key);
+                entry.leaf = FindOrCreate(keys);
+                entry.values = values;
+                entry.seq = ++seq_;
+                AddToPath(entry, key);
+                lastTouched_++;
+            } else if (!SameValues(entry.values, values)) {
+                RemoveFromPath(entry, key);
+                entry.values = values;
+                entry.seq = ++seq_;
+                AddToPath(entry, key);
+                lastTouched_++;
+            }
+            entry.generation = generation_;
+            entry.leaf->displayRows.push_back(i);
+        }
+
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if (it->second.generation != generation_) {
+                RemoveFromPath(it->second, it->first);
+                lastTouched_++;
+                it = entries_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        RecomputeDirty();
+        Prune(root_);
+        rowCount_ = rows.size();
+    }
+
+    /**
+     * @brief Render the current groups (pre-order, children sorted by key)
+     */
+    GroupSnapshot BuildSnapshot(size_t columnCount) const {
+        GroupSnapshot snapshot;
+        snapshot.rowCount = rowCount_;
+        for (const auto& [key, child] : root_.children) {
+            Emit(*child, std::string(), columnCount, snapshot);
+        }
+        return snapshot;
+    }
+
+    /// Rows inserted, changed, moved or removed by the last Apply()
+    size_t LastTouchedRows() const { return lastTouched_; }
+    /// Groups whose min/max/last had to be recomputed by the last Apply()
+    size_t LastRescannedGroups() const { return lastRescans_; }
+
+    size_t GroupCount() const { return CountGroups(root_) - 1; }
+
+private:
+    struct Agg {
+        double sum = 0.0;
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+        size_t n = 0; // rows with a value
+        double last = std::numeric_limits<double>::quiet_NaN();
+        uint64_t lastSeq = 0;
+    };
+
+    struct Group {
+        std::string key;
+        Group* parent = nullptr;
+        int depth = 0;
+        std::map<std::string, std::unique_ptr<Group>, std::less<>> children;
+        size_t count = 0;
+        std::vector<Agg> aggs;
+        std::unordered_set<uint64_t> members; // leaf groups only
+        std::vector<size_t> displayRows;      // leaf groups only
+        bool dirty = false;
+    };
+
+    struct Entry {
+        Group* leaf = nullptr;
+        std::vector<double> values;
+        uint64_t seq = 0;
+        uint64_t generation = 0;
+    };
+
+    Group* FindOrCreate(const std::vector<std::string_view>& keys) {
+        Group* g = &root_;
+        for (std::string_view key : keys) {
+            auto it = g->children.find(key);
+            if (it == g->children.end()) {
+                auto child = std::make_unique<Group>();
+                child->key = std::string(key);
+                child->parent = g;
+                child->depth = g->depth + 1;
+                child->aggs.resize(aggregates_.size());
+                it = g->children.emplace(child->key, std::move(child)).first;
+            }
+            g = it->second.get();
+        }
+        return g;
+    }
+
+    static bool SamePath(const Group* leaf, const std::vector<std::string_view>& keys) {
+        for (size_t i = keys.size(); i-- > 0; leaf = leaf->parent) {
+            if (leaf->key != keys[i]) return false;
+        }
+        return true;
+    }
+
+    static bool SameValues(const std::vector<double>& a, const std::vector<double>& b) {
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i] != b[i] && !(std::isnan(a[i]) && std::isnan(b[i]))) return false;
+        }
+        return true;
+    }
+
+    void AddToPath(const Entry& entry, uint64_t key) {
+        entry.leaf->members.insert(key);
+        for (Group* g = entry.leaf; g != &root_; g = g->parent) {
+            g->count++;
+            for (size_t a = 0; a < aggregates_.size(); a++) {
+                const double v = entry.values[a];
+                if (std::isnan(v)) continue;
+                Agg& agg = g->aggs[a];
+                agg.sum += v;
+                agg.n++;
+                agg.min = std::min(agg.min, v);
+                agg.max = std::max(agg.max, v);
+                if (entry.seq >= agg.lastSeq) {
+                    agg.last = v;
+                    agg.lastSeq = entry.seq;
+                }
+            }
+        }
+    }
+
+    void RemoveFromPath(const Entry& entry, uint64_t key) {
+        entry.leaf->members.erase(key);
+        for (Group* g = entry.leaf; g != &root_; g = g->parent) {
+            g->count--;
+            for (size_t a = 0; a < aggregates_.size(); a++) {
+                const double v = entry.values[a];
+                if (std::isnan(v)) continue;
+                Agg& agg = g->aggs[a];
+                agg.sum -= v;
+                agg.n--;
+                if (v <= agg.min || v >= agg.max || entry.seq == agg.lastSeq) MarkDirty(g);
+            }
+        }
+    }
+
+    void MarkDirty(Group* g) {
+        if (!g->dirty) {
+            g->dirty = true;
+            dirty_.push_back(g);
+        }
+    }
+
+    // Deepest groups first so parents recompute from up-to-date children
+    void RecomputeDirty() {
+        std::sort(dirty_.begin(), dirty_.end(), [](const Group* a, const Group* b) { return a->depth > b->depth; });
+        for (Group* g : dirty_) {
+            g->dirty = false;
+            lastRescans_++;
+            for (size_t a = 0; a < aggregates_.size(); a++) {
+                Agg& agg = g->aggs[a];
+                agg.min = std::numeric_limits<double>::infinity();
+                agg.max = -std::numeric_limits<double>::infinity();
+                agg.last = std::numeric_limits<double>::quiet_NaN();
+                agg.lastSeq = 0;
+                if (g->children.empty()) {
+                    for (uint64_t member : g->members) {
+                        const Entry& e = entries_.at(member);
+                        const double v = e.values[a];
+                        if (std::isnan(v)) continue;
+                        Fold(agg, v, v, v, e.seq);
+                    }
+                } else {
+                    for (const auto& [key, child] : g->children) {
+                        const Agg& c = child->aggs[a];
+                        if (c.n == 0) continue;
+                        Fold(agg, c.min, c.max, c.last, c.lastSeq);
+                    }
+                }
+                if (agg.n == 0) agg.sum = 0.0; // drop accumulated rounding once the group is empty
+            }
+        }
+        dirty_.clear();
+    }
+
+    static void Fold(Agg& agg, double min, double max, double last, uint64_t lastSeq) {
+        agg.min = std::min(agg.min, min);
+        agg.max = std::max(agg.max, max);
+        if (lastSeq >= agg.lastSeq) {
+            agg.last = last;
+            agg.lastSeq = lastSeq;
+        }
+    }
+
+    static void Prune(Group& g) {
+        for (auto it = g.children.begin(); it != g.children.end();) {
+            if (it->second->count == 0) {
+                it = g.children.erase(it);
+            } else {
+                Prune(*it->second);
+                ++it;
+            }
+        }
+    }
+
+    static void ClearDisplayRows(Group& g) {
+        g.displayRows.clear();
+        for (auto& [key, child] : g.children) ClearDisplayRows(*child);
+    }
+
+    static size_t CountGroups(const Group& g) {
+        size_t n = 1;
+        for (const auto& [key, child] : g.children) n += CountGroups(*child);
+        return n;
+    }
+
+    void Emit(const Group& g, const std::string& parentPath, size_t columnCount, GroupSnapshot& out) const {
+        const size_t index = out.nodes.size();
+        out.nodes.emplace_back();
+        {
+            GroupSnapshot::Node& node = out.nodes.back();
+            node.path = parentPath.empty() ? g.key : parentPath + '\x1f' + g.key;
+            node.label = (g.key.empty() ? std::string("(empty)") : g.key) + " (" + std::to_string(g.count) + ")";
+            node.depth = g.depth;
+            node.cells.resize(columnCount);
+            for (size_t a = 0; a < aggregates_.size(); a++) {
+                const int col = aggregates_[a].column;
+                if (col < 0 || static_cast<size_t>(col) >= columnCount) continue;
+                std::string text = FormatAggregate(aggregates_[a].op, g.aggs[a], g.count);
+                if (text.empty()) continue;
+                std::string& cell = node.cells[static_cast<size_t>(col)];
+                if (!cell.empty()) cell += "  ";
+                cell += text;
+            }
+            if (g.children.empty()) node.rows = g.displayRows;
+        }
+        const std::string path = out.nodes[index].path;
+        for (const auto& [key, child] : g.children) {
+            Emit(*child, path, columnCount, out);
+        }
+        out.nodes[index].subtreeEnd = out.nodes.size();
+    }
+
+    static std::string FormatAggregate(AggregateOp op, const Agg& agg, size_t count) {
+        const char* name = nullptr;
+        double value = 0.0;
+        switch (op) {
+        case AggregateOp::Count: return "n=" + std::to_string(count);
+        case AggregateOp::Sum: name = "sum"; value = agg.sum; break;
+        case AggregateOp::Min: name = "min"; value = agg.min; break;
+        case AggregateOp::Max: name = "max"; value = agg.max; break;
+        case AggregateOp::Last: name = "last"; value = agg.last; break;
+        }
+        if (agg.n == 0) return {};
+        char buf[48];
+        std::snprintf(buf, sizeof(buf), "%s=%.6g", name, value);
+        return buf;
+    }
+
+    std::vector<int> groupColumns_;
+    std::vector<AggregateSpec> aggregates_;
+    std::vector<ValueFn> values_;
+    RowKeyFn rowKey_;
+
+    Group root_;
+    std::unordered_map<uint64_t, Entry> entries_;
+    std::vector<Group*> dirty_;
+    uint64_t generation_ = 0;
+    uint64_t seq_ = 0;
+    size_t rowCount_ = 0;
+    size_t lastTouched_ = 0;
+    size_t lastRescans_ = 0;
+};
+
+} // namespace db
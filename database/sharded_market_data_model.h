@@ -0,0 +1,358 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "market_data_multi_index_table_model.h"
+#include "parallel_for.h"
+
+namespace db {
+
+/**
+ * @brief MarketDataMultiIndexTableModel split into N independently locked shards
+ *
+ * Each shard has its own lock, LRU/CLOCK list and indices, so writers touching different
+ * shards never contend. A row's shard is chosen from its id (ShardKey::Id) or from its
+ * symbol (ShardKey::Symbol). Symbol sharding sends symbol-filtered queries to a single
+ * shard. It requires that an id never changes symbol, because Upsert() only replaces the
+ * row in the new row's shard.
+ *
+ * BuildAsyncRows() read-locks all shards in index order and k-way merges their index
+ * ranges, so ordered results match the unsharded model. Writers only ever hold one shard
+ * lock, so the ordered acquisition cannot deadlock. Capacity and eviction are per shard
+ * (capacity / N each). Order::LruMostRecentFirst is therefore approximate: the shards'
+ * recency lists are interleaved round-robin.
+ */
+class ShardedMarketDataTableModel {
+public:
+    using Query = MarketDataMultiIndexTableModel::Query;
+    using Order = MarketDataMultiIndexTableModel::Order;
+
+    enum class ShardKey { Id, Symbol };
+
+    /**
+     * @param shardCount 0 = one shard per hardware thread
+     */
+    explicit ShardedMarketDataTableModel(std::size_t capacity, std::size_t shardCount = 0,
+                                         ShardKey shardKey = ShardKey::Id,
+                                         EvictionPolicy policy = EvictionPolicy::Lru)
+        : shardKey_(shardKey) {
+        if (shardCount == 0) {
+            shardCount = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, 64);
+        }
+        const std::size_t perShard = (capacity + shardCount - 1) / shardCount;
+        shards_.reserve(shardCount);
+        for (std::size_t i = 0; i < shardCount; ++i) {
+            shards_.push_back(std::make_unique<Shard>(perShard, policy));
+        }
+    }
+
+    bool Upsert(MarketDataCacheEntry row) {
+        KS_TRACE_SCOPE("model", "Upsert");
+        Shard& shard = *shards_[ShardOf(row)];
+        auto lock = shard.WriteLock(writeWait_);
+        return shard.cache.upsert<MdByIdTag>(std::move(row));
+    }
+
+    /// With ShardKey::Symbol the id's shard is unknown, so every shard is tried
+    bool EraseById(std::int64_t id) {
+        KS_TRACE_SCOPE("model", "EraseById");
+        if (shardKey_ == ShardKey::Id) {
+            Shard& shard = *shards_[ShardOfId(id)];
+            auto lock = shard.WriteLock(writeWait_);
+            return shard.cache.erase<MdByIdTag>(id);
+        }
+        for (auto& shard : shards_) {
+            auto lock = shard->WriteLock(writeWait_);
+            if (shard->cache.erase<MdByIdTag>(id)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Look up by id and count it as a use (shared lock with EvictionPolicy::Clock)
+     */
+    std::optional<MarketDataCacheEntry> FindById(std::int64_t id) {
+        KS_TRACE_SCOPE("model", "FindById");
+        if (shardKey_ == ShardKey::Id) {
+            return FindInShard(*shards_[ShardOfId(id)], id);
+        }
+        for (auto& shard : shards_) {
+            if (auto row = FindInShard(*shard, id)) {
+                return row;
+            }
+        }
+        return std::nullopt;
+    }
+
+    std::size_t Size() const {
+        std::size_t total = 0;
+        for (const auto& shard : shards_) {
+            auto lock = shard->ReadLock(nullptr);
+            total += shard->cache.size();
+        }
+        return total;
+    }
+
+    std::size_t ShardCount() const { return shards_.size(); }
+
+    /**
+     * @brief Publish lock wait times to the PerfRegistry ("Locks" category) under this name
+     */
+    void SetPerfName(const std::string& name) {
+        writeWait_ = &PerfRegistry::Get().Duration("Locks", name + " write wait");
+        readWait_ = &PerfRegistry::Get().Duration("Locks", name + " read wait");
+    }
+
+    static void ConfigureAsyncTableColumns(AsyncTableWidget& table) {
+        MarketDataMultiIndexTableModel::ConfigureAsyncTableColumns(table);
+    }
+
+    void BuildAsyncRows(std::vector<AsyncTableWidget::Row>& out, const Query& query) const {
+        KS_TRACE_SCOPE("model", "BuildAsyncRows");
+        out.clear();
+
+        // Symbol sharding: an equality filter on the symbol touches one shard only
+        std::vector<const Shard*> shards;
+        if (shardKey_ == ShardKey::Symbol && query.symbolEq) {
+            shards.push_back(shards_[ShardOfSymbol(*query.symbolEq)].get());
+        } else {
+            for (const auto& shard : shards_) {
+                shards.push_back(shard.get());
+            }
+        }
+        std::vector<std::shared_lock<ProfiledSharedMutex>> locks;
+        locks.reserve(shards.size());
+        for (const Shard* shard : shards) {
+            locks.push_back(shard->ReadLock(readWait_));
+        }
+
+        // Two phases: merge and copy the matches under the locks, then format them with the
+        // locks released (in parallel when large)
+        std::vector<const MarketDataCacheEntry*> matches;
+        std::vector<MarketDataCacheEntry> snapshot;
+        std::size_t seen = 0;
+        auto pushIfMatch = [&](const MarketDataCacheEntry& entry) {
+            if (query.limit != 0 && matches.size() >= query.limit) {
+                return false;
+            }
+            if (!MarketDataMultiIndexTableModel::MatchesQuery(query, entry) || seen++ < query.offset) {
+                return true;
+            }
+            matches.push_back(&entry);
+            return true;
+        };
+        auto materialize = [&] {
+            DetachMatches(matches, snapshot);
+            locks.clear();
+            ParallelMaterialize(matches, out, [](const MarketDataCacheEntry& entry) {
+                return MarketDataMultiIndexTableModel::MakeAsyncRow(entry);
+            });
+        };
+
+        const bool desc = query.order == Order::TsDesc || query.order == Order::PriceDesc ||
+                          query.order == Order::SymbolDesc;
+        // Same keys as the shard indices, id last, so the merge reproduces the unsharded order
+        auto byTs = [](const MarketDataCacheEntry& a, const MarketDataCacheEntry& b) {
+            return std::tie(a.ts, a.id) < std::tie(b.ts, b.id);
+        };
+        auto byPrice = [](const MarketDataCacheEntry& a, const MarketDataCacheEntry& b) {
+            return std::tie(a.price, a.id) < std::tie(b.price, b.id);
+        };
+        auto bySymbolTs = [](const MarketDataCacheEntry& a, const MarketDataCacheEntry& b) {
+            return std::tie(a.symbol, a.ts, a.id) < std::tie(b.symbol, b.ts, b.id);
+        };
+
+        if (query.symbolEq && query.venueEq && (query.order == Order::TsAsc || query.order == Order::TsDesc)) {
+            const auto minTs = query.minTs.value_or(std::numeric_limits<std::int64_t>::lowest());
+            const auto maxTs = query.maxTs.value_or(std::numeric_limits<std::int64_t>::max());
+            MergeShards<MdBySymbolVenueTsTag>(
+                shards,
+                [&](const auto& idx) {
+                    return std::make_pair(idx.lower_bound(boost::make_tuple(*query.symbolEq, *query.venueEq, minTs)),
+                                          idx.upper_bound(boost::make_tuple(*query.symbolEq, *query.venueEq, maxTs)));
+                },
+                byTs, desc, pushIfMatch);
+            materialize();
+            return;
+        }
+
+        switch (query.order) {
+            case Order::LruMostRecentFirst:
+                InterleaveRecency(shards, pushIfMatch);
+                break;
+            case Order::TsAsc:
+            case Order::TsDesc:
+                MergeShards<MdByTsTag>(shards, FullRange{}, byTs, desc, pushIfMatch);
+                break;
+            case Order::PriceAsc:
+            case Order::PriceDesc:
+                MergeShards<MdByPriceTag>(shards, FullRange{}, byPrice, desc, pushIfMatch);
+                break;
+            case Order::SymbolAsc:
+            case Order::SymbolDesc:
+                MergeShards<MdBySymbolTsTag>(shards, FullRange{}, bySymbolTs, desc, pushIfMatch);
+                break;
+        }
+        materialize();
+    }
+
+private:
+    struct Shard {
+        Shard(std::size_t capacity, EvictionPolicy policy) : cache(capacity, policy) {}
+
+        std::unique_lock<ProfiledSharedMutex> WriteLock(PerfDuration* wait) const {
+            return PerfTimedLock<std::unique_lock<ProfiledSharedMutex>>(mutex, wait);
+        }
+
+        std::shared_lock<ProfiledSharedMutex> ReadLock(PerfDuration* wait) const {
+            return PerfTimedLock<std::shared_lock<ProfiledSharedMutex>>(mutex, wait);
+        }
+
+        mutable ProfiledSharedMutex mutex{"ShardedMarketDataTableModel::Shard::mutex"};
+        MarketDataCache cache;
+    };
+
+    struct FullRange {
+        template <typename Index>
+        auto operator()(const Index& idx) const {
+            return std::make_pair(idx.begin(), idx.end());
+        }
+    };
+
+    /**
+     * @brief Visit the union of one index range per shard in index order
+     *
+     * `range(index)` returns the shard's [begin, end); `less` must match the index's order,
+     * which ends in id, so no two rows tie and the output equals the unsharded model's.
+     * A binary heap holds one cursor per non-empty shard range. `visit` returns false to
+     * stop early (limit reached).
+     */
+    template <typename Tag, typename RangeFn, typename Less, typename Visit>
+    static void MergeShards(const std::vector<const Shard*>& shards, RangeFn&& range, Less less, bool desc,
+                            Visit&& visit) {
+        using Index = typename MarketDataCache::container_t::template index<Tag>::type;
+        using Iter = typename Index::const_iterator;
+        struct Cursor {
+            Iter next;
+            Iter end;
+            std::size_t shard;
+        };
+        std::vector<Cursor> heap;
+        heap.reserve(shards.size());
+        for (std::size_t i = 0; i < shards.size(); ++i) {
+            auto [begin, end] = range(shards[i]->cache.get_container().template get<Tag>());
+            if (begin == end) {
+                continue;
+            }
+            // Descending cursors walk back from the end; `next` then points one past the element
+            heap.push_back(desc ? Cursor{end, begin, i} : Cursor{begin, end, i});
+        }
+        auto current = [desc](const Cursor& c) -> const MarketDataCacheEntry& {
+            return desc ? *std::prev(c.next) : *c.next;
+        };
+        // std heaps keep the largest element on top, so "worse" cursors compare less
+        auto worse = [&](const Cursor& a, const Cursor& b) {
+            const auto& x = current(a);
+            const auto& y = current(b);
+            if (desc ? less(x, y) : less(y, x)) {
+                return true;
+            }
+            if (desc ? less(y, x) : less(x, y)) {
+                return false;
+            }
+            return a.shard > b.shard;
+        };
+        std::make_heap(heap.begin(), heap.end(), worse);
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), worse);
+            Cursor& top = heap.back();
+            if (!visit(current(top))) {
+                return;
+            }
+            if (desc) {
+                --top.next;
+            } else {
+                ++top.next;
+            }
+            if (top.next == top.end) {
+                heap.pop_back();
+            } else {
+                std::push_heap(heap.begin(), heap.end(), worse);
+            }
+        }
+    }
+
+    template <typename Visit>
+    static void InterleaveRecency(const std::vector<const Shard*>& shards, Visit&& visit) {
+        using Iter = typename MarketDataCache::container_t::template nth_index<0>::type::const_iterator;
+        std::vector<std::pair<Iter, Iter>> cursors;
+        for (const Shard* shard : shards) {
+            const auto& lru = shard->cache.get_container().template get<0>();
+            cursors.emplace_back(lru.begin(), lru.end());
+        }
+        for (bool any = true; any;) {
+            any = false;
+            for (auto& [it, end] : cursors) {
+                if (it == end) {
+                    continue;
+                }
+                if (!visit(*it++)) {
+                    return;
+                }
+                any = true;
+            }
+        }
+    }
+
+    std::optional<MarketDataCacheEntry> FindInShard(Shard& shard, std::int64_t id) {
+        if (shard.cache.policy() == EvictionPolicy::Clock) {
+            auto lock = shard.ReadLock(readWait_);
+            auto it = shard.cache.find_shared<MdByIdTag>(id);
+            if (it == shard.cache.end<MdByIdTag>()) {
+                return std::nullopt;
+            }
+            return static_cast<const MarketDataCacheEntry&>(*it);
+        }
+        auto lock = shard.WriteLock(writeWait_);
+        auto it = shard.cache.find<MdByIdTag>(id);
+        if (it == shard.cache.end<MdByIdTag>()) {
+            return std::nullopt;
+        }
+        return static_cast<const MarketDataCacheEntry&>(*it);
+    }
+
+    std::size_t ShardOf(const MarketDataCacheEntry& row) const {
+        return shardKey_ == ShardKey::Symbol ? ShardOfSymbol(row.symbol) : ShardOfId(row.id);
+    }
+
+    std::size_t ShardOfId(std::int64_t id) const {
+        // Fibonacci hashing: sequential ids spread evenly instead of striping
+        const auto h = static_cast<std::uint64_t>(id) * 0x9E3779B97F4A7C15ULL;
+        return static_cast<std::size_t>((h >> 32) % shards_.size());
+    }
+
+    std::size_t ShardOfSymbol(const std::string& symbol) const {
+        return std::hash<std::string>{}(symbol) % shards_.size();
+    }
+
+    ShardKey shardKey_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    PerfDuration* writeWait_ = nullptr;
+    PerfDuration* readWait_ = nullptr;
+};
+
+} // namespace db
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "async_table_widget.h"
+#include "perf_counters.h"
+#include "trace.h"
+
+namespace db {
+
+/**
+ * @brief Refcounted row store shared by several AsyncTableWidget views
+ *
+ * One ingest (the store's refresh callback or Publish()) produces an immutable
+ * snapshot of rows; every attached view keeps only an index permutation, a filter
+ * bitmap and its own selection, so N differently sorted/filtered views cost one copy
+ * of the rows plus 8 bytes per visible row each. A snapshot stays alive while any view
+ * still displays it, so ingest never blocks rendering.
+ *
+ * Usage:
+ *   auto store = std::make_shared<SharedRowStore>();
+ *   store->SetRefreshCallback([](auto& rows) { FooCodec::Query(db, rows); });
+ *   store->AttachView(allRowsWidget);
+ *   store->AttachView(funRowsWidget);
+ *   funRowsWidget.SetRowFilter([](const AsyncTableWidget::Row& r) { ... });
+ *
+ *   // Background thread:
+ *   store->Refresh();          // one query
+ *   allRowsWidget.Refresh();   // re-sort/filter only if the snapshot, sort or filter changed
+ *   funRowsWidget.Refresh();
+ */
+class SharedRowStore : public std::enable_shared_from_this<SharedRowStore> {
+public:
+    using Row = AsyncTableWidget::Row;
+    using Snapshot = AsyncTableWidget::StreamSnapshot;
+
+    /**
+     * @brief Set the ingest callback (called on the thread that calls Refresh())
+     */
+    void SetRefreshCallback(std::function<void(std::vector<Row>&)> callback) { m_refreshCallback = std::move(callback); }
+
+    /**
+     * @brief Run the ingest callback and publish its rows as the new snapshot
+     */
+    void Refresh() {
+        if (!m_refreshCallback) return;
+        PerfScopedTimer perfTimer(m_perfRefresh);
+        KS_TRACE_SCOPE("store", "Refresh", m_perfName);
+        std::vector<Row> rows;
+        rows.reserve(RowCount());
+        m_refreshCallback(rows);
+        Publish(std::move(rows));
+    }
+
+    /**
+     * @brief Replace the store contents (safe to call from any single writer thread)
+     */
+    void Publish(std::vector<Row>&& rows) {
+        auto next = std::make_shared<Snapshot>();
+        next->rowCount = rows.size();
+        next->chunkEnds.push_back(rows.size());
+        next->chunks.push_back(std::make_shared<const std::vector<Row>>(std::move(rows)));
+        next->complete = true;
+        std::atomic_store_explicit(&m_snapshot, std::shared_ptr<const Snapshot>(std::move(next)),
+                                   std::memory_order_release);
+        m_version.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    /// Current snapshot (null before the first publish)
+    std::shared_ptr<const Snapshot> GetSnapshot() const {
+        return std::atomic_load_explicit(&m_snapshot, std::memory_order_acquire);
+    }
+
+    /// Incremented on every publish
+    uint64_t Version() const { return m_version.load(std::memory_order_acquire); }
+
+    size_t RowCount() const {
+        auto snapshot = GetSnapshot();
+        return snapshot ? snapshot->rowCount : 0;
+    }
+
+    /**
+     * @brief Turn widget into a view of this store (the view keeps the store alive)
+     *
+     * The store must be owned by a std::shared_ptr.
+     */
+    void AttachView(AsyncTableWidget& widget) {
+        widget.SetRowSource([self = shared_from_this()] { return self->GetSnapshot(); });
+    }
+
+    /**
+     * @brief Publish Refresh() durations to the PerfRegistry under this name
+     */
+    void SetPerfName(const std::string& name) {
+        m_perfRefresh = &PerfRegistry::Get().Duration("Refresh", name);
+        m_perfName = name;
+    }
+
+private:
+    std::function<void(std::vector<Row>&)> m_refreshCallback;
+    std::shared_ptr<const Snapshot> m_snapshot; // accessed via std::atomic_load/atomic_store
+    std::atomic<uint64_t> m_version{0};
+    PerfDuration* m_perfRefresh = nullptr;
+    std::string m_perfName;
+};
+
+} // namespace db
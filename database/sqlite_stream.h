@@ -0,0 +1,88 @@
+#pragma once
+
+#include <sqlite3.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "async_table_widget.h"
+#include "trace.h"
+
+namespace db {
+
+/**
+ * @brief Step a prepared statement into a streaming AsyncTableWidget refresh
+ *
+ * Each SQLITE_ROW is converted with `makeRow(stmt) -> AsyncTableWidget::Row` and pushed
+ * into the sink, which publishes it to the GUI in chunks. Cancellation is checked
+ * between rows and, through a temporary progress handler, inside long-running steps
+ * (e.g. a sort before the first row), which then return SQLITE_INTERRUPT.
+ *
+ * The statement is reset but not finalized. The progress handler belongs to the whole
+ * connection, not the statement: while a cancelled stream unwinds, any statement another
+ * thread runs on the same connection is interrupted too, and a handler installed by
+ * someone else is removed afterwards. Stream on a read connection of its own
+ * (DatabaseManager::OpenWorkerConnection()), never on the shared GetRawHandle().
+ *
+ * @return false if the stream was cancelled before the last row
+ * @throws std::runtime_error on SQLite errors other than cancellation
+ */
+template <typename MakeRow>
+bool StreamStatement(sqlite3_stmt* stmt, AsyncTableWidget::StreamSink& sink, MakeRow&& makeRow,
+                     int progressInstructions = 10000) {
+    KS_TRACE_SCOPE("sql", "StreamStatement");
+    sqlite3* db = sqlite3_db_handle(stmt);
+    struct ProgressGuard {
+        sqlite3* db;
+        ~ProgressGuard() { sqlite3_progress_handler(db, 0, nullptr, nullptr); }
+    } progressGuard{db};
+    sqlite3_progress_handler(
+        db, progressInstructions,
+        [](void* ctx) -> int { return static_cast<AsyncTableWidget::StreamSink*>(ctx)->Cancelled() ? 1 : 0; },
+        &sink);
+
+    int rc;
+    bool cancelled = false;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (sink.Cancelled()) {
+            cancelled = true;
+            break;
+        }
+        sink.Push(makeRow(stmt));
+    }
+
+    if (cancelled || (rc == SQLITE_INTERRUPT && sink.Cancelled())) {
+        sqlite3_reset(stmt);
+        return false;
+    }
+    if (rc != SQLITE_DONE) {
+        std::string message = std::string("StreamStatement step failed: ") + sqlite3_errmsg(db);
+        sqlite3_reset(stmt);
+        throw std::runtime_error(message);
+    }
+    sqlite3_reset(stmt);
+    return true;
+}
+
+/**
+ * @brief Prepare `sql` on db and stream it (see above); the statement is finalized
+ */
+template <typename MakeRow>
+bool StreamQuery(sqlite3* db, std::string_view sql, AsyncTableWidget::StreamSink& sink, MakeRow&& makeRow) {
+    if (!db) throw std::runtime_error("StreamQuery: no database handle");
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql.data(), static_cast<int>(sql.size()), &stmt, nullptr) != SQLITE_OK) {
+        throw std::runtime_error(std::string("StreamQuery prepare failed: ") + sqlite3_errmsg(db));
+    }
+    try {
+        bool finished = StreamStatement(stmt, sink, std::forward<MakeRow>(makeRow));
+        sqlite3_finalize(stmt);
+        return finished;
+    } catch (...) {
+        sqlite3_finalize(stmt);
+        throw;
+    }
+}
+
+} // namespace db
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "imgui.h"
+
+namespace db {
+
+/**
+ * @brief Background and text color of a row or cell (0 = not styled)
+ */
+struct CellStyle {
+    ImU32 bg = 0;
+    ImU32 text = 0;
+};
+
+/**
+ * @brief Rule-based conditional style: "if column value is in range, color the cell (or row)"
+ *
+ * The value is the column's numeric value (typed extractor / typed field); rows without
+ * one never match. Per target, the first matching rule wins.
+ *
+ * Example:
+ *   StyleRule::Above(3, 100.0, IM_COL32(40, 120, 40, 255))                    // cell
+ *   StyleRule::Between(3, -1.0, 1.0, 0, IM_COL32(128, 128, 128, 255))         // grey text
+ *   StyleRule::Below(4, 0.0, IM_COL32(120, 30, 30, 255)).WholeRow()           // row
+ */
+struct StyleRule {
+    int column = -1;
+    double lo = -std::numeric_limits<double>::infinity();
+    double hi = std::numeric_limits<double>::infinity();
+    bool loOpen = false; // exclude lo
+    bool hiOpen = false; // exclude hi
+    CellStyle style;
+    bool wholeRow = false;
+
+    static StyleRule Above(int column, double threshold, ImU32 bg, ImU32 text = 0) {
+        StyleRule rule;
+        rule.column = column;
+        rule.lo = threshold;
+        rule.loOpen = true;
+        rule.style = {bg, text};
+        return rule;
+    }
+
+    static StyleRule Below(int column, double threshold, ImU32 bg, ImU32 text = 0) {
+        StyleRule rule;
+        rule.column = column;
+        rule.hi = threshold;
+        rule.hiOpen = true;
+        rule.style = {bg, text};
+        return rule;
+    }
+
+    /// Inclusive range [lo, hi]
+    static StyleRule Between(int column, double lo, double hi, ImU32 bg, ImU32 text = 0) {
+        StyleRule rule;
+        rule.column = column;
+        rule.lo = lo;
+        rule.hi = hi;
+        rule.style = {bg, text};
+        return rule;
+    }
+
+    StyleRule& WholeRow() {
+        wholeRow = true;
+        return *this;
+    }
+
+    bool Matches(double v) const {
+        return (loOpen ? v > lo : v >= lo) && (hiOpen ? v < hi : v <= hi);
+    }
+};
+
+/**
+ * @brief Styles precomputed for one row snapshot (indexed like the snapshot's rows)
+ *
+ * `cells` is empty when no rule targets cells, so row-only styling costs 8 bytes per row.
+ */
+struct StyleSnapshot {
+    std::vector<CellStyle> rows;
+    std::vector<CellStyle> cells; // row-major, `columns` per row
+    size_t columns = 0;
+
+    size_t rowCount() const { return rows.size(); }
+
+    CellStyle Row(size_t row) const { return rows[row]; }
+
+    CellStyle Cell(size_t row, size_t col) const {
+        return cells.empty() || col >= columns ? CellStyle{} : cells[row * columns + col];
+    }
+};
+
+/**
+ * @brief Rule list shared between the GUI thread (SetRules) and the refresh thread (Apply)
+ */
+class RowStyler {
+public:
+    using Rules = std::vector<StyleRule>;
+
+    /// Replace the rules; takes effect on the next Apply() (safe to call from any thread)
+    void SetRules(Rules rules) {
+        std::shared_ptr<const Rules> next;
+        if (!rules.empty()) next = std::make_shared<const Rules>(std::move(rules));
+        std::atomic_store_explicit(&rules_, std::move(next), std::memory_order_release);
+    }
+
+    bool HasRules() const { return std::atomic_load_explicit(&rules_, std::memory_order_acquire) != nullptr; }
+
+    /**
+     * @brief Evaluate the rules for rowCount rows
+     *
+     * @param value `value(row, column) -> std::optional<double>`
+     * @return null when no rules are set
+     */
+    template <typename ValueFn>
+    std::shared_ptr<const StyleSnapshot> Apply(size_t rowCount, size_t columns, ValueFn&& value) const {
+        auto rules = std::atomic_load_explicit(&rules_, std::memory_order_acquire);
+        if (!rules) return nullptr;
+
+        auto out = std::make_shared<StyleSnapshot>();
+        out->columns = columns;
+        out->rows.resize(rowCount);
+        bool anyCellRule = false;
+        for (const auto& rule : *rules) anyCellRule = anyCellRule || !rule.wholeRow;
+        if (anyCellRule) out->cells.resize(rowCount * columns);
+
+        for (size_t row = 0; row < rowCount; row++) {
+            bool rowStyled = false;
+            for (const auto& rule : *rules) {
+                if (rule.column < 0 || (size_t)rule.column >= columns) continue;
+                CellStyle& target = rule.wholeRow ? out->rows[row] : out->cells[row * columns + rule.column];
+                if (rule.wholeRow ? rowStyled : (target.bg != 0 || target.text != 0)) continue;
+                std::optional<double> v = value(row, rule.column);
+                if (!v || !rule.Matches(*v)) continue;
+                target = rule.style;
+                if (rule.wholeRow) rowStyled = true;
+            }
+        }
+        return out;
+    }
+
+private:
+    std::shared_ptr<const Rules> rules_; // accessed via std::atomic_load/atomic_store
+};
+
+} // namespace db
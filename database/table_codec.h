@@ -0,0 +1,460 @@
+#pragma once
+
+#include <sqlite3.h>
+#include <sqlpp23/core/basic/table.h>
+#include <sqlpp23/core/basic/table_columns.h>
+#include <sqlpp23/core/type_traits.h>
+#include <any>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "async_table_widget.h"
+#include "sqlite_stream.h"
+#include "trace.h"
+
+namespace db {
+
+namespace codec_detail {
+
+/// C++ storage type for a sqlpp23 data_type (nullable columns use std::optional<data_type>)
+template <typename DataType>
+struct value_of;
+template <>
+struct value_of<sqlpp::integral> {
+    using type = std::int64_t;
+};
+template <>
+struct value_of<sqlpp::unsigned_integral> {
+    using type = std::uint64_t;
+};
+template <>
+struct value_of<sqlpp::floating_point> {
+    using type = double;
+};
+template <>
+struct value_of<sqlpp::text> {
+    using type = std::string;
+};
+template <>
+struct value_of<sqlpp::boolean> {
+    using type = bool;
+};
+template <typename DataType>
+struct value_of<std::optional<DataType>> {
+    using type = std::optional<typename value_of<DataType>::type>;
+};
+
+template <typename T>
+struct is_optional : std::false_type {};
+template <typename T>
+struct is_optional<std::optional<T>> : std::true_type {};
+
+template <typename T>
+struct strip_optional {
+    using type = T;
+};
+template <typename T>
+struct strip_optional<std::optional<T>> {
+    using type = T;
+};
+
+/// Unpacks sqlpp::table_columns<Table, Cols...> into a std::tuple<Cols...>
+template <typename T>
+struct column_pack;
+template <typename Table, typename... Cols>
+struct column_pack<sqlpp::table_columns<Table, Cols...>> {
+    using type = std::tuple<Cols...>;
+};
+
+template <typename Col>
+using column_value_t = typename value_of<typename Col::data_type>::type;
+
+template <typename Tag>
+constexpr std::string_view SqlName() {
+    return std::string_view(Tag::_sqlpp_name_tag::name);
+}
+
+template <typename Tuple, std::size_t... Is>
+constexpr auto ColumnNames(std::index_sequence<Is...>) {
+    return std::array<std::string_view, sizeof...(Is)>{SqlName<std::tuple_element_t<Is, Tuple>>()...};
+}
+
+template <typename Col, typename... Cols>
+constexpr std::size_t IndexOf() {
+    constexpr std::array<bool, sizeof...(Cols)> matches{std::is_same_v<Col, Cols>...};
+    for (std::size_t i = 0; i < matches.size(); ++i) {
+        if (matches[i]) return i;
+    }
+    return sizeof...(Cols);
+}
+
+} // namespace codec_detail
+
+/**
+ * @brief Typed row codec generated from a sqlpp23 table specification
+ *
+ * Reads `Spec::_table_columns` at compile time and derives everything a table widget
+ * needs: a typed Row (a tuple of the column C++ types), SQL column names, a SELECT
+ * statement, header labels, formatters, comparators and typed sort extractors.
+ * Rows are decoded straight from sqlite3_column_* into the typed tuple; display strings
+ * are produced with std::to_chars, without intermediate std::to_string/ostream copies.
+ *
+ * Type mapping: integral -> int64_t, unsigned_integral -> uint64_t, floating_point ->
+ * double, text -> std::string, boolean -> bool; std::optional<X> columns map to
+ * std::optional of the above (SQL NULL -> std::nullopt, rendered as "").
+ *
+ * Usage (one line per table):
+ *   using FooCodec = db::TableCodec<test_db::Foo_>;
+ *
+ *   FooCodec::ConfigureAsyncTableColumns(widget);
+ *   widget.SetRefreshCallback([](auto& rows) {
+ *       FooCodec::Query(DatabaseManager::Get().GetRawHandle(), rows);
+ *   });
+ *   // or progressively, sorted by SQLite, on a connection of its own (see StreamStatement):
+ *   auto reader = std::shared_ptr<sqlite3>(DatabaseManager::Get().OpenWorkerConnection());
+ *   widget.SetStreamingRefreshCallback([reader](auto& sink) {
+ *       FooCodec::Stream(reader.get(), sink);
+ *   });
+ *
+ *   const auto& row = std::any_cast<const FooCodec::Row&>(asyncRow.userData);
+ *   int64_t id = row.get<test_db::Foo_::Id>();
+ */
+template <typename Spec>
+class TableCodec {
+    using Columns = typename codec_detail::column_pack<
+        typename Spec::template _table_columns<sqlpp::table_t<Spec>>>::type;
+
+public:
+    static constexpr std::size_t kColumnCount = std::tuple_size_v<Columns>;
+
+    template <std::size_t I>
+    using Column = std::tuple_element_t<I, Columns>;
+
+    template <std::size_t I>
+    using ValueType = codec_detail::column_value_t<Column<I>>;
+
+    /**
+     * @brief Typed row: one member per table column, in declaration order
+     */
+    struct Row {
+        template <std::size_t... Is>
+        static auto MakeTuple(std::index_sequence<Is...>) -> std::tuple<ValueType<Is>...>;
+        using Tuple = decltype(MakeTuple(std::make_index_sequence<kColumnCount>{}));
+
+        Tuple values;
+
+        template <std::size_t I>
+        auto& get() {
+            return std::get<I>(values);
+        }
+        template <std::size_t I>
+        const auto& get() const {
+            return std::get<I>(values);
+        }
+        template <typename Col>
+        auto& get() {
+            return std::get<IndexOf<Col>()>(values);
+        }
+        template <typename Col>
+        const auto& get() const {
+            return std::get<IndexOf<Col>()>(values);
+        }
+
+        bool operator==(const Row&) const = default;
+    };
+
+    /// Position of a column tag (e.g. test_db::Foo_::Name) in the row
+    template <typename Col>
+    static constexpr std::size_t IndexOf() {
+        return IndexOfImpl<Col>(std::make_index_sequence<kColumnCount>{});
+    }
+
+    static constexpr std::string_view TableName() { return codec_detail::SqlName<Spec>(); }
+
+    /// SQL column names in declaration order
+    static constexpr std::array<std::string_view, kColumnCount> kColumnNames =
+        codec_detail::ColumnNames<Columns>(std::make_index_sequence<kColumnCount>{});
+
+    /// "SELECT col, ... FROM table" in the order ReadRow expects
+    static const std::string& SelectSql() {
+        static const std::string sql = [] {
+            std::string s = "SELECT ";
+            for (std::size_t i = 0; i < kColumnCount; ++i) {
+                if (i) s += ", ";
+                s += kColumnNames[i];
+            }
+            s += " FROM ";
+            s += TableName();
+            return s;
+        }();
+        return sql;
+    }
+
+    /// Header label derived from the SQL name: "has_fun" -> "Has Fun", "id" -> "ID"
+    static std::string HeaderLabel(std::size_t col) {
+        std::string out;
+        std::string_view name = kColumnNames[col];
+        std::size_t start = 0;
+        while (start <= name.size()) {
+            std::size_t end = name.find('_', start);
+            if (end == std::string_view::npos) end = name.size();
+            std::string_view word = name.substr(start, end - start);
+            if (!word.empty()) {
+                if (!out.empty()) out += ' ';
+                if (word == "id") {
+                    out += "ID";
+                } else {
+                    out += static_cast<char>(std::toupper(static_cast<unsigned char>(word[0])));
+                    out.append(word.substr(1));
+                }
+            }
+            start = end + 1;
+        }
+        return out;
+    }
+
+    /**
+     * @brief Decode the current result row of stmt into row
+     *
+     * Column i of the statement must be column i of the table (as produced by SelectSql).
+     * Existing string capacity in row is reused.
+     */
+    static void ReadRow(sqlite3_stmt* stmt, Row& row) {
+        ReadRowImpl(stmt, row, std::make_index_sequence<kColumnCount>{});
+    }
+
+    /// Append the display text of one value to out
+    template <typename T>
+    static void FormatValue(std::string& out, const T& value) {
+        if constexpr (codec_detail::is_optional<T>::value) {
+            if (value) FormatValue(out, *value);
+        } else if constexpr (std::is_same_v<T, bool>) {
+            out += value ? "Yes" : "No";
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            out += value;
+        } else {
+            char buf[32];
+            auto res = std::to_chars(buf, buf + sizeof(buf), value);
+            out.append(buf, res.ptr);
+        }
+    }
+
+    /// Display text of column `col` of row
+    static std::string FormatCell(const Row& row, std::size_t col) {
+        std::string out;
+        VisitColumn(col, [&](auto index) { FormatValue(out, row.template get<decltype(index)::value>()); });
+        return out;
+    }
+
+    /// Three-way comparison of column `col` (NULL sorts first)
+    static int CompareColumn(const Row& a, const Row& b, std::size_t col) {
+        int result = 0;
+        VisitColumn(col, [&](auto index) {
+            constexpr std::size_t I = decltype(index)::value;
+            result = CompareValues(a.template get<I>(), b.template get<I>());
+        });
+        return result;
+    }
+
+    /// Widget row with display strings and the typed Row as userData
+    static AsyncTableWidget::Row ToAsyncRow(Row row) {
+        AsyncTableWidget::Row out(kColumnCount);
+        for (std::size_t i = 0; i < kColumnCount; ++i) {
+            out.columns[i] = FormatCell(row, i);
+        }
+        out.userData = std::move(row);
+        return out;
+    }
+
+    /**
+     * @brief Add one column per table column plus typed sort extractors
+     *
+     * Widths default by type; pass `widths` to override (0 entries keep the default).
+     */
+    static void ConfigureAsyncTableColumns(AsyncTableWidget& table, const std::vector<float>& widths = {}) {
+        ConfigureImpl(table, widths, std::make_index_sequence<kColumnCount>{});
+        table.EnableFilter(true);
+        table.EnableSelection(true);
+    }
+
+    /**
+     * @brief Run SelectSql() + suffix on db and append the decoded rows
+     *
+     * suffix is appended verbatim (e.g. " WHERE has_fun = 1 ORDER BY id").
+     * Throws std::runtime_error on SQLite errors.
+     */
+    static void Query(sqlite3* db, std::vector<AsyncTableWidget::Row>& rows, std::string_view suffix = {}) {
+        KS_TRACE_SCOPE("codec", "Query", TableName());
+        if (!db) throw std::runtime_error("TableCodec::Query: no database handle");
+        std::string sql = SelectSql();
+        sql.append(suffix);
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(db, sql.c_str(), static_cast<int>(sql.size()), &stmt, nullptr) != SQLITE_OK) {
+            throw std::runtime_error(std::string("TableCodec::Query prepare failed: ") + sqlite3_errmsg(db));
+        }
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            Row row;
+            ReadRow(stmt, row);
+            rows.push_back(ToAsyncRow(std::move(row)));
+        }
+        sqlite3_finalize(stmt);
+        if (rc != SQLITE_DONE) {
+            throw std::runtime_error(std::string("TableCodec::Query step failed: ") + sqlite3_errmsg(db));
+        }
+    }
+
+    /**
+     * @brief " ORDER BY ..." for widget sort specs (columns as added by ConfigureAsyncTableColumns)
+     *
+     * Returns an empty string if there are no specs or one names a column outside the table.
+     */
+    static std::string OrderByClause(const std::vector<AsyncTableWidget::SortSpec>& specs) {
+        std::string out;
+        for (const auto& spec : specs) {
+            if (spec.columnIndex < 0 || static_cast<std::size_t>(spec.columnIndex) >= kColumnCount) return {};
+            out += out.empty() ? " ORDER BY " : ", ";
+            out += kColumnNames[static_cast<std::size_t>(spec.columnIndex)];
+            out += spec.direction == ImGuiSortDirection_Descending ? " DESC" : " ASC";
+        }
+        return out;
+    }
+
+    /**
+     * @brief Stream SelectSql() + where + ORDER BY (from the sink's sort specs) into sink
+     *
+     * Sorting is pushed down to SQLite so rows arrive in display order and the widget
+     * does not re-sort the finished result. db must be dedicated to streaming (see
+     * StreamStatement).
+     *
+     * @return false if the stream was cancelled
+     */
+    static bool Stream(sqlite3* db, AsyncTableWidget::StreamSink& sink, std::string_view where = {}) {
+        KS_TRACE_SCOPE("codec", "Stream", TableName());
+        std::string sql = SelectSql();
+        sql.append(where);
+        std::string orderBy = OrderByClause(sink.SortSpecs());
+        if (!orderBy.empty()) {
+            sql += orderBy;
+            sink.SetSortedBySource();
+        }
+        return StreamQuery(db, sql, sink, [](sqlite3_stmt* stmt) {
+            Row row;
+            ReadRow(stmt, row);
+            return ToAsyncRow(std::move(row));
+        });
+    }
+
+private:
+    template <typename Col, std::size_t... Is>
+    static constexpr std::size_t IndexOfImpl(std::index_sequence<Is...>) {
+        constexpr std::size_t index = codec_detail::IndexOf<Col, Column<Is>...>();
+        static_assert(index < kColumnCount, "column does not belong to this table");
+        return index;
+    }
+
+    template <typename Fn>
+    static void VisitColumn(std::size_t col, Fn&& fn) {
+        VisitColumnImpl(col, fn, std::make_index_sequence<kColumnCount>{});
+    }
+
+    template <typename Fn, std::size_t... Is>
+    static void VisitColumnImpl(std::size_t col, Fn& fn, std::index_sequence<Is...>) {
+        ((col == Is ? (fn(std::integral_constant<std::size_t, Is>{}), true) : false) || ...);
+    }
+
+    template <typename T>
+    static int CompareValues(const T& a, const T& b) {
+        if constexpr (codec_detail::is_optional<T>::value) {
+            if (!a || !b) return static_cast<int>(a.has_value()) - static_cast<int>(b.has_value());
+            return CompareValues(*a, *b);
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            int c = a.compare(b);
+            return (c > 0) - (c < 0);
+        } else {
+            return (a > b) - (a < b);
+        }
+    }
+
+    template <typename T>
+    static void ReadValue(sqlite3_stmt* stmt, int col, T& out) {
+        if constexpr (codec_detail::is_optional<T>::value) {
+            if (sqlite3_column_type(stmt, col) == SQLITE_NULL) {
+                out.reset();
+            } else {
+                ReadValue(stmt, col, out.emplace());
+            }
+        } else if constexpr (std::is_same_v<T, std::string>) {
+            const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, col));
+            if (text) {
+                out.assign(text, static_cast<std::size_t>(sqlite3_column_bytes(stmt, col)));
+            } else {
+                out.clear();
+            }
+        } else if constexpr (std::is_same_v<T, bool>) {
+            out = sqlite3_column_int64(stmt, col) != 0;
+        } else if constexpr (std::is_floating_point_v<T>) {
+            out = sqlite3_column_double(stmt, col);
+        } else {
+            out = static_cast<T>(sqlite3_column_int64(stmt, col));
+        }
+    }
+
+    template <std::size_t... Is>
+    static void ReadRowImpl(sqlite3_stmt* stmt, Row& row, std::index_sequence<Is...>) {
+        (ReadValue(stmt, static_cast<int>(Is), row.template get<Is>()), ...);
+    }
+
+    // Sort keys limited to the types AsyncTableWidget compares natively
+    template <typename T>
+    static std::any SortKey(const T& value) {
+        if constexpr (codec_detail::is_optional<T>::value) {
+            return value ? SortKey(*value) : std::any{};
+        } else if constexpr (std::is_same_v<T, std::uint64_t>) {
+            return std::any(static_cast<std::int64_t>(value));
+        } else {
+            return std::any(value);
+        }
+    }
+
+    template <typename T>
+    static constexpr float DefaultWidth() {
+        using Base = typename codec_detail::strip_optional<T>::type;
+        if constexpr (std::is_same_v<Base, std::string>) {
+            return 200.0f;
+        } else if constexpr (std::is_same_v<Base, bool>) {
+            return 100.0f;
+        } else {
+            return 80.0f;
+        }
+    }
+
+    template <std::size_t... Is>
+    static void ConfigureImpl(AsyncTableWidget& table, const std::vector<float>& widths, std::index_sequence<Is...>) {
+        const std::size_t base = table.GetColumnCount();
+        auto add = [&](auto index) {
+            constexpr std::size_t I = decltype(index)::value;
+            float width = I < widths.size() && widths[I] > 0.0f ? widths[I] : DefaultWidth<ValueType<I>>();
+            table.AddColumn(HeaderLabel(I), width);
+            table.SetColumnTypedExtractor(base + I, [](const AsyncTableWidget::Row& row) -> std::any {
+                if (const auto* data = std::any_cast<Row>(&row.userData)) {
+                    return SortKey(data->template get<I>());
+                }
+                return {};
+            });
+        };
+        (add(std::integral_constant<std::size_t, Is>{}), ...);
+    }
+};
+
+} // namespace db
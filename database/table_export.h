@@ -0,0 +1,258 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "trace.h"
+
+namespace db {
+
+enum class ExportFormat {
+    Csv,      // RFC 4180 quoting
+    Tsv,      // tabs/newlines inside cells become spaces
+    Columnar, // binary row groups, see RunTableExport()
+};
+
+/**
+ * @brief Progress/cancel handle of a background table export
+ *
+ * Shared between the GUI (polls progress, may cancel) and the export thread.
+ */
+class ExportJob {
+public:
+    enum class State { Pending, Running, Succeeded, Failed, Cancelled };
+
+    void Cancel() { m_cancelRequested.store(true, std::memory_order_relaxed); }
+    bool IsCancelRequested() const { return m_cancelRequested.load(std::memory_order_relaxed); }
+
+    State GetState() const { return m_state.load(std::memory_order_acquire); }
+    bool IsFinished() const {
+        State s = GetState();
+        return s == State::Succeeded || s == State::Failed || s == State::Cancelled;
+    }
+
+    std::size_t GetProcessed() const { return m_processed.load(std::memory_order_relaxed); }
+    std::size_t GetTotal() const { return m_total.load(std::memory_order_relaxed); }
+    float GetProgress() const {
+        std::size_t total = GetTotal();
+        return total ? static_cast<float>(GetProcessed()) / static_cast<float>(total) : (IsFinished() ? 1.0f : 0.0f);
+    }
+
+    std::uint64_t GetBytesWritten() const { return m_bytes.load(std::memory_order_relaxed); }
+    double GetElapsedMs() const { return m_elapsedMs.load(std::memory_order_relaxed); }
+    const std::string& GetPath() const { return m_path; }
+
+    std::string GetError() const {
+        std::lock_guard<std::mutex> lock(m_errorMutex);
+        return m_error;
+    }
+
+    // ---- Worker side ----
+
+    explicit ExportJob(std::string path = {}) : m_path(std::move(path)) {}
+
+    void SetState(State s) { m_state.store(s, std::memory_order_release); }
+    void SetTotal(std::size_t n) { m_total.store(n, std::memory_order_relaxed); }
+    void AddProcessed(std::size_t n) { m_processed.fetch_add(n, std::memory_order_relaxed); }
+    void AddBytes(std::uint64_t n) { m_bytes.fetch_add(n, std::memory_order_relaxed); }
+    void SetElapsedMs(double ms) { m_elapsedMs.store(ms, std::memory_order_relaxed); }
+    void SetError(std::string error) {
+        std::lock_guard<std::mutex> lock(m_errorMutex);
+        m_error = std::move(error);
+    }
+
+private:
+    std::atomic<State> m_state{State::Pending};
+    std::atomic<bool> m_cancelRequested{false};
+    std::atomic<std::size_t> m_processed{0};
+    std::atomic<std::size_t> m_total{0};
+    std::atomic<std::uint64_t> m_bytes{0};
+    std::atomic<double> m_elapsedMs{0.0};
+    std::string m_path;
+    mutable std::mutex m_errorMutex;
+    std::string m_error;
+};
+
+namespace export_detail {
+
+/**
+ * @brief Append-only output buffer flushed to the file in chunks
+ */
+class ChunkedWriter {
+public:
+    ChunkedWriter(std::FILE* file, std::size_t chunkBytes, ExportJob& job) : m_file(file), m_chunkBytes(chunkBytes), m_job(job) {
+        m_buffer.reserve(chunkBytes + 4096);
+    }
+
+    void Append(std::string_view s) { m_buffer.append(s.data(), s.size()); }
+    void Append(char c) { m_buffer.push_back(c); }
+
+    template <typename T>
+    void AppendPod(T value) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        m_buffer.append(bytes, sizeof(T));
+    }
+
+    /// Write the buffer out once it reaches the chunk size (or always when force is set)
+    bool FlushIfFull(bool force = false) {
+        if (m_buffer.empty() || (!force && m_buffer.size() < m_chunkBytes)) return true;
+        if (std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) != m_buffer.size()) return false;
+        m_job.AddBytes(m_buffer.size());
+        m_buffer.clear();
+        return true;
+    }
+
+private:
+    std::FILE* m_file;
+    std::size_t m_chunkBytes;
+    ExportJob& m_job;
+    std::string m_buffer;
+};
+
+inline void AppendCsvCell(ChunkedWriter& out, std::string_view cell) {
+    if (cell.find_first_of(",\"\r\n") == std::string_view::npos) {
+        out.Append(cell);
+        return;
+    }
+    out.Append('"');
+    for (char c : cell) {
+        if (c == '"') out.Append('"');
+        out.Append(c);
+    }
+    out.Append('"');
+}
+
+inline void AppendTsvCell(ChunkedWriter& out, std::string_view cell) {
+    if (cell.find_first_of("\t\r\n") == std::string_view::npos) {
+        out.Append(cell);
+        return;
+    }
+    for (char c : cell) out.Append(c == '\t' || c == '\r' || c == '\n' ? ' ' : c);
+}
+
+} // namespace export_detail
+
+/// Magic at the start of ExportFormat::Columnar files
+inline constexpr char kColumnarExportMagic[8] = {'K', 'S', 'C', 'O', 'L', '1', '\0', '\0'};
+
+/**
+ * @brief Write rowCount rows to path on the calling thread, reporting into job
+ *
+ * `rowAt(i)` returns the cells of row i and must stay valid for the whole call (the
+ * caller keeps the source snapshot alive). Output is buffered and written in chunks
+ * of chunkBytes; cancellation is checked between rows. The file is written to
+ * `path + ".part"` and renamed on success, so a cancelled or failed export never
+ * leaves a truncated file behind.
+ *
+ * Columnar layout (host byte order):
+ *   magic[8] "KSCOL1", u32 columnCount, u64 rowCount,
+ *   columnCount x (u32 nameLength, name bytes),
+ *   row groups of up to rowGroupRows rows: u32 groupRows, then for each column
+ *   groupRows x u32 cell lengths followed by the concatenated cell bytes.
+ */
+inline void RunTableExport(const std::string& path, ExportFormat format, const std::vector<std::string>& headers,
+                           std::size_t rowCount, const std::function<const std::vector<std::string>&(std::size_t)>& rowAt,
+                           ExportJob& job, std::size_t chunkBytes = 1 << 20, std::size_t rowGroupRows = 4096) {
+    KS_TRACE_SCOPE("export", "RunTableExport", path);
+    const auto start = std::chrono::steady_clock::now();
+    job.SetTotal(rowCount);
+    job.SetState(ExportJob::State::Running);
+
+    const std::string partPath = path + ".part";
+    std::FILE* file = std::fopen(partPath.c_str(), "wb");
+    if (!file) {
+        job.SetError("Cannot open " + partPath + ": " + std::strerror(errno));
+        job.SetState(ExportJob::State::Failed);
+        return;
+    }
+
+    export_detail::ChunkedWriter out(file, chunkBytes, job);
+    const std::size_t columns = headers.size();
+    bool ok = true;
+    bool cancelled = false;
+
+    if (format == ExportFormat::Columnar) {
+        out.Append(std::string_view(kColumnarExportMagic, sizeof(kColumnarExportMagic)));
+        out.AppendPod<std::uint32_t>(static_cast<std::uint32_t>(columns));
+        out.AppendPod<std::uint64_t>(static_cast<std::uint64_t>(rowCount));
+        for (const auto& header : headers) {
+            out.AppendPod<std::uint32_t>(static_cast<std::uint32_t>(header.size()));
+            out.Append(header);
+        }
+        static const std::string kEmpty;
+        for (std::size_t begin = 0; ok && begin < rowCount; begin += rowGroupRows) {
+            if (job.IsCancelRequested()) {
+                cancelled = true;
+                break;
+            }
+            const std::size_t end = std::min(rowCount, begin + rowGroupRows);
+            out.AppendPod<std::uint32_t>(static_cast<std::uint32_t>(end - begin));
+            for (std::size_t col = 0; col < columns; col++) {
+                auto cellAt = [&](std::size_t row) -> const std::string& {
+                    const auto& cells = rowAt(row);
+                    return col < cells.size() ? cells[col] : kEmpty;
+                };
+                for (std::size_t row = begin; row < end; row++) {
+                    out.AppendPod<std::uint32_t>(static_cast<std::uint32_t>(cellAt(row).size()));
+                }
+                for (std::size_t row = begin; row < end; row++) out.Append(cellAt(row));
+                ok = out.FlushIfFull();
+            }
+            job.AddProcessed(end - begin);
+        }
+    } else {
+        const char separator = format == ExportFormat::Csv ? ',' : '\t';
+        auto appendCell = format == ExportFormat::Csv ? export_detail::AppendCsvCell : export_detail::AppendTsvCell;
+        auto appendLine = [&](const std::vector<std::string>& cells) {
+            for (std::size_t col = 0; col < columns; col++) {
+                if (col > 0) out.Append(separator);
+                if (col < cells.size()) appendCell(out, cells[col]);
+            }
+            out.Append('\n');
+        };
+        appendLine(headers);
+        for (std::size_t row = 0; ok && row < rowCount; row++) {
+            if (job.IsCancelRequested()) {
+                cancelled = true;
+                break;
+            }
+            appendLine(rowAt(row));
+            ok = out.FlushIfFull();
+            if ((row & 1023) == 1023) job.AddProcessed(1024);
+        }
+        if (ok && !cancelled) job.AddProcessed(rowCount & 1023);
+    }
+
+    if (ok && !cancelled) ok = out.FlushIfFull(true);
+    if (!ok) job.SetError("Write to " + partPath + " failed: " + std::strerror(errno));
+    ok = (std::fclose(file) == 0) && ok;
+    job.SetElapsedMs(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+    if (cancelled || !ok) {
+        std::remove(partPath.c_str());
+        if (!cancelled && job.GetError().empty()) job.SetError("Closing " + partPath + " failed");
+        job.SetState(cancelled ? ExportJob::State::Cancelled : ExportJob::State::Failed);
+        return;
+    }
+    std::remove(path.c_str());
+    if (std::rename(partPath.c_str(), path.c_str()) != 0) {
+        job.SetError("Cannot rename " + partPath + " to " + path + ": " + std::strerror(errno));
+        std::remove(partPath.c_str());
+        job.SetState(ExportJob::State::Failed);
+        return;
+    }
+    job.SetState(ExportJob::State::Succeeded);
+}
+
+} // namespace db
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace db {
+
+/**
+ * @brief Lightweight cross-thread tracing with Chrome/Perfetto JSON export
+ *
+ * Each thread appends to its own ring buffer, so recording a span takes no locks: two
+ * clock reads, a few relaxed/seq_cst stores on a thread-private cache line. When tracing
+ * is disabled a span costs one atomic load. A thread's ring (kEventsPerThread events,
+ * ~2.9 MB) is only allocated by its first event recorded while tracing is enabled;
+ * naming a thread does not allocate it.
+ *
+ * Event kinds:
+ * - Complete spans ("X") via KS_TRACE_SCOPE / TraceScope
+ * - Instants ("i") via Trace::Instant
+ * - Flow arrows ("s"/"t"/"f") via Trace::Flow, linking work for one item (a tick, a
+ *   message) across threads; the arrow binds to the enclosing span on each thread
+ *
+ * Names and categories must be string literals (only the pointer is stored); dynamic
+ * text goes into the short `detail` argument, which is copied.
+ *
+ * Usage:
+ *   db::Trace::SetEnabled(true);
+ *   {
+ *       KS_TRACE_SCOPE("model", "Upsert");
+ *       ...
+ *   }
+ *   db::Trace::WriteChromeJson("trace.json"); // open in ui.perfetto.dev or chrome://tracing
+ */
+struct TraceEvent {
+    const char* category = nullptr;
+    const char* name = nullptr;
+    std::uint64_t startNs = 0;
+    std::uint64_t durNs = 0;
+    std::uint64_t flowId = 0;
+    char phase = 'X';
+    char detail[47] = {};
+};
+
+class Trace {
+public:
+    static constexpr std::size_t kEventsPerThread = 1u << 15; // ring capacity (power of two)
+
+    static bool Enabled() { return EnabledFlag().load(std::memory_order_relaxed); }
+    static void SetEnabled(bool enabled) { EnabledFlag().store(enabled, std::memory_order_seq_cst); }
+
+    static std::uint64_t NowNs() {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Epoch()).count());
+    }
+
+    /// Name shown for the calling thread in the trace viewer (does not allocate the event ring)
+    static void SetThreadName(std::string name) {
+        ThreadBuffer& buf = Local();
+        std::lock_guard<std::mutex> lock(Registry().mutex);
+        buf.name = std::move(name);
+    }
+
+    static void Complete(const char* category, const char* name, std::uint64_t startNs, std::uint64_t durNs,
+                         std::string_view detail = {}) {
+        Record(category, name, 'X', startNs, durNs, 0, detail);
+    }
+
+    static void Instant(const char* category, const char* name, std::string_view detail = {}) {
+        if (!Enabled()) return;
+        Record(category, name, 'i', NowNs(), 0, 0, detail);
+    }
+
+    /// phase: 's' = flow start, 't' = step, 'f' = finish. id identifies the item across threads.
+    static void Flow(const char* category, const char* name, char phase, std::uint64_t id) {
+        if (!Enabled() || id == 0) return;
+        Record(category, name, phase, NowNs(), 0, id, {});
+    }
+
+    /// Fresh flow id (never 0)
+    static std::uint64_t NextFlowId() {
+        static std::atomic<std::uint64_t> next{1};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Render all buffered events as Chrome trace JSON
+     *
+     * Recording is paused while buffers are copied (in-flight writers are waited for),
+     * then restored.
+     */
+    static std::string ToChromeJson() {
+        struct ThreadSnapshot {
+            std::uint32_t tid;
+            std::string name;
+            std::vector<TraceEvent> events;
+        };
+        std::vector<ThreadSnapshot> snapshot;
+        const bool wasEnabled = EnabledFlag().exchange(false, std::memory_order_seq_cst);
+        {
+            std::lock_guard<std::mutex> lock(Registry().mutex);
+            for (auto& buf : Registry().buffers) {
+                while (buf->writing.load(std::memory_order_seq_cst)) {
+                }
+                std::uint64_t head = buf->head.load(std::memory_order_acquire);
+                std::uint64_t count = buf->events ? std::min<std::uint64_t>(head, kEventsPerThread) : 0;
+                std::vector<TraceEvent> events;
+                events.reserve(static_cast<std::size_t>(count));
+                for (std::uint64_t i = head - count; i < head; ++i) {
+                    events.push_back(buf->events[i & (kEventsPerThread - 1)]);
+                }
+                snapshot.push_back({buf->tid, buf->name, std::move(events)});
+            }
+        }
+        if (wasEnabled) SetEnabled(true);
+
+        std::ostringstream out;
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        auto sep = [&]() {
+            if (!first) out << ",\n";
+            first = false;
+        };
+        for (const auto& t : snapshot) {
+            sep();
+            out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << t.tid
+                << ",\"args\":{\"name\":\"" << Escape(t.name.empty() ? "thread " + std::to_string(t.tid) : t.name)
+                << "\"}}";
+            for (const auto& e : t.events) {
+                sep();
+                out << "{\"ph\":\"" << e.phase << "\",\"cat\":\"" << Escape(e.category ? e.category : "")
+                    << "\",\"name\":\"" << Escape(e.name ? e.name : "") << "\",\"pid\":1,\"tid\":" << t.tid
+                    << ",\"ts\":" << FormatUs(e.startNs);
+                if (e.phase == 'X') out << ",\"dur\":" << FormatUs(e.durNs);
+                if (e.phase == 'i') out << ",\"s\":\"t\"";
+                if (e.phase == 's' || e.phase == 't' || e.phase == 'f') {
+                    out << ",\"id\":" << e.flowId;
+                    if (e.phase == 'f') out << ",\"bp\":\"e\"";
+                }
+                if (e.detail[0] != '\0') out << ",\"args\":{\"detail\":\"" << Escape(e.detail) << "\"}";
+                out << "}";
+            }
+        }
+        out << "]}\n";
+        return out.str();
+    }
+
+    static bool WriteChromeJson(const std::string& path) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) return false;
+        file << ToChromeJson();
+        return static_cast<bool>(file);
+    }
+
+    /// Drop buffered events (and buffers of exited threads)
+    static void Clear() {
+        const bool wasEnabled = EnabledFlag().exchange(false, std::memory_order_seq_cst);
+        {
+            std::lock_guard<std::mutex> lock(Registry().mutex);
+            auto& buffers = Registry().buffers;
+            for (auto& buf : buffers) {
+                while (buf->writing.load(std::memory_order_seq_cst)) {
+                }
+                buf->head.store(0, std::memory_order_release);
+            }
+            buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                                         [](const auto& b) { return b->exited.load(std::memory_order_acquire); }),
+                          buffers.end());
+        }
+        if (wasEnabled) SetEnabled(true);
+    }
+
+    /// Events currently buffered across all threads
+    static std::size_t EventCount() {
+        std::lock_guard<std::mutex> lock(Registry().mutex);
+        std::size_t n = 0;
+        for (auto& buf : Registry().buffers) {
+            n += static_cast<std::size_t>(std::min<std::uint64_t>(buf->head.load(std::memory_order_acquire), kEventsPerThread));
+        }
+        return n;
+    }
+
+    /// Threads with a registered buffer (named or traced, still running or holding events)
+    static std::size_t ThreadCount() {
+        std::lock_guard<std::mutex> lock(Registry().mutex);
+        return Registry().buffers.size();
+    }
+
+    /// Threads whose event ring is allocated
+    static std::size_t RingCount() {
+        std::lock_guard<std::mutex> lock(Registry().mutex);
+        const auto& buffers = Registry().buffers;
+        return static_cast<std::size_t>(std::count_if(buffers.begin(), buffers.end(), [](const auto& b) {
+            return b->ringAllocated.load(std::memory_order_acquire);
+        }));
+    }
+
+private:
+    struct ThreadBuffer {
+        std::unique_ptr<TraceEvent[]> events; // written by the owner inside `writing` only
+        std::atomic<bool> ringAllocated{false};
+        std::atomic<std::uint64_t> head{0};
+        std::atomic<bool> writing{false};
+        std::atomic<bool> exited{false};
+        std::uint32_t tid = 0;
+        std::string name;
+    };
+
+    struct RegistryState {
+        std::mutex mutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        std::uint32_t nextTid = 1;
+    };
+
+    // Keeps the calling thread's buffer registered; marks it exited on thread exit
+    struct LocalHandle {
+        std::shared_ptr<ThreadBuffer> buffer;
+        ~LocalHandle() {
+            if (buffer) buffer->exited.store(true, std::memory_order_release);
+        }
+    };
+
+    static std::atomic<bool>& EnabledFlag() {
+        static std::atomic<bool> enabled{false};
+        return enabled;
+    }
+
+    static std::chrono::steady_clock::time_point Epoch() {
+        static const auto epoch = std::chrono::steady_clock::now();
+        return epoch;
+    }
+
+    static RegistryState& Registry() {
+        static RegistryState* state = new RegistryState(); // leaked: usable during static destruction
+        return *state;
+    }
+
+    static ThreadBuffer& Local() {
+        thread_local LocalHandle handle;
+        if (!handle.buffer) {
+            auto buf = std::make_shared<ThreadBuffer>();
+            std::lock_guard<std::mutex> lock(Registry().mutex);
+            buf->tid = Registry().nextTid++;
+            // Short-lived named threads (bulk jobs, exports) would otherwise pile up here;
+            // exited buffers with events are kept for export until Clear()
+            auto& buffers = Registry().buffers;
+            buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                                         [](const auto& b) {
+                                             return b->exited.load(std::memory_order_acquire) &&
+                                                    b->head.load(std::memory_order_acquire) == 0;
+                                         }),
+                          buffers.end());
+            buffers.push_back(buf);
+            handle.buffer = std::move(buf);
+        }
+        return *handle.buffer;
+    }
+
+    static void Record(const char* category, const char* name, char phase, std::uint64_t startNs,
+                       std::uint64_t durNs, std::uint64_t flowId, std::string_view detail) {
+        ThreadBuffer& buf = Local();
+        // Dekker-style handshake with ToChromeJson/Clear: announce the write, then re-check the flag.
+        buf.writing.store(true, std::memory_order_seq_cst);
+        if (!EnabledFlag().load(std::memory_order_seq_cst)) {
+            buf.writing.store(false, std::memory_order_release);
+            return;
+        }
+        if (!buf.events) {
+            // First event while enabled; readers skip rings until they see writing == false
+            buf.events = std::make_unique<TraceEvent[]>(kEventsPerThread);
+            buf.ringAllocated.store(true, std::memory_order_release);
+        }
+        std::uint64_t idx = buf.head.load(std::memory_order_relaxed);
+        TraceEvent& e = buf.events[idx & (kEventsPerThread - 1)];
+        e.category = category;
+        e.name = name;
+        e.phase = phase;
+        e.startNs = startNs;
+        e.durNs = durNs;
+        e.flowId = flowId;
+        std::size_t n = std::min(detail.size(), sizeof(e.detail) - 1);
+        std::memcpy(e.detail, detail.data(), n);
+        e.detail[n] = '\0';
+        buf.head.store(idx + 1, std::memory_order_release);
+        buf.writing.store(false, std::memory_order_release);
+    }
+
+    static std::string FormatUs(std::uint64_t ns) {
+        char tmp[32];
+        std::snprintf(tmp, sizeof(tmp), "%llu.%03llu", static_cast<unsigned long long>(ns / 1000),
+                      static_cast<unsigned long long>(ns % 1000));
+        return tmp;
+    }
+
+    static std::string Escape(std::string_view s) {
+        std::string out;
+        out.reserve(s.size());
+        for (char c : s) {
+            switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char tmp[8];
+                    std::snprintf(tmp, sizeof(tmp), "\\u%04x", c);
+                    out += tmp;
+                } else {
+                    out += c;
+                }
+            }
+        }
+        return out;
+    }
+};
+
+/**
+ * @brief RAII span; records a complete event if tracing was enabled at construction
+ */
+class TraceScope {
+public:
+    TraceScope(const char* category, const char* name, std::string_view detail = {})
+        : m_category(category), m_name(name) {
+        if (Trace::Enabled()) {
+            m_active = true;
+            m_start = Trace::NowNs();
+            std::size_t n = std::min(detail.size(), sizeof(m_detail) - 1);
+            std::memcpy(m_detail, detail.data(), n);
+            m_detail[n] = '\0';
+        }
+    }
+    ~TraceScope() {
+        if (m_active) {
+            Trace::Complete(m_category, m_name, m_start, Trace::NowNs() - m_start, m_detail);
+        }
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* m_category;
+    const char* m_name;
+    bool m_active = false;
+    std::uint64_t m_start = 0;
+    char m_detail[sizeof(TraceEvent::detail)] = {};
+};
+
+} // namespace db
+
+#define KS_TRACE_CONCAT_INNER(a, b) a##b
+#define KS_TRACE_CONCAT(a, b) KS_TRACE_CONCAT_INNER(a, b)
+
+/// Scoped span: KS_TRACE_SCOPE("category", "name"[, detail string_view])
+#define KS_TRACE_SCOPE(...) ::db::TraceScope KS_TRACE_CONCAT(ksTraceScope_, __LINE__)(__VA_ARGS__)
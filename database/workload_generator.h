@@ -0,0 +1,307 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "foo_multi_index_table_model.h"
+#include "market_data_multi_index_table_model.h"
+
+namespace db {
+
+/**
+ * @brief Knobs for WorkloadGenerator (defaults match the demo data shapes)
+ */
+struct WorkloadConfig {
+    std::uint64_t seed = 42;
+    unsigned threads = 0;                  // 0 = hardware_concurrency
+    std::size_t parallelThreshold = 16384; // smaller batches run on the calling thread
+
+    std::size_t symbolCount = 64;          // real tickers first, then synthetic "SYMnnn"
+    double symbolZipfExponent = 1.1;
+    std::vector<std::pair<std::string, double>> venueWeights = {
+        {"XNAS", 0.34}, {"XNYS", 0.26}, {"BATS", 0.14}, {"ARCA", 0.12}, {"IEX", 0.08}, {"EDGX", 0.06}};
+
+    std::int64_t baseTs = 1'700'000'000'000;
+    std::int64_t tsStep = 10;              // ts = baseTs + id * tsStep
+    double minPrice = 10.0;
+    double maxPrice = 1000.0;
+    double priceNoise = 0.02;              // relative deviation around the per-symbol reference price
+
+    double fooHasFunRatio = 0.5;
+    double minCollectionPrice = 1.0;
+    double maxCollectionPrice = 500.0;
+    long maxCollectionQty = 1000;
+};
+
+/**
+ * @brief One update for a two-field reactive collection (price/qty shaped)
+ *
+ * slot is an index into whatever key space the caller maintains (e.g. the vector
+ * of ids currently in the collection); it is Zipf-skewed toward low slots.
+ */
+struct CollectionUpdate {
+    std::size_t slot = 0;
+    double price = 0.0;
+    long qty = 0;
+};
+
+/**
+ * @brief Seeded, multi-threaded synthetic workload generator
+ *
+ * Produces Foo rows, market ticks and reactive-collection updates for the UI bulk
+ * buttons, the headless mode and the benchmarks.
+ *
+ * Every generated item is a pure function of (seed, stream, index): row i is the same
+ * regardless of thread count or chunking, so runs are reproducible and a range can be
+ * generated in parallel without any shared RNG state.
+ *
+ * Skew:
+ * - Symbols follow a Zipf distribution (a handful of names carry most of the flow)
+ * - Venues are drawn from a weighted table (primary listings dominate)
+ * - Collection updates are log-uniform over slots, so low slots are hot keys
+ *
+ * Example:
+ *   db::WorkloadGenerator gen;                       // seed 42
+ *   auto foos  = gen.GenerateFoo(firstId, 10000);    // deterministic
+ *   auto ticks = gen.GenerateTicks(1, 200000);       // parallel for large counts
+ */
+class WorkloadGenerator {
+public:
+    explicit WorkloadGenerator(WorkloadConfig config = {}) : config_(std::move(config)) {
+        BuildSymbols();
+        BuildVenues();
+        symbolCdf_ = ZipfCdf(symbols_.size(), config_.symbolZipfExponent);
+    }
+
+    const WorkloadConfig& Config() const { return config_; }
+    const std::vector<std::string>& Symbols() const { return symbols_; }
+    const std::vector<std::string>& Venues() const { return venues_; }
+
+    // ---- Single items (pure functions of the index) ----
+
+    /**
+     * @brief Foo row for id; bump revision to get different content for the same id (updates)
+     */
+    FooCacheEntry MakeFoo(std::int64_t id, std::uint64_t revision = 0) const {
+        Rng rng(config_.seed, kFooStream + (revision << 32), static_cast<std::uint64_t>(id));
+        FooCacheEntry row;
+        row.id = id;
+        row.name = std::string(kFirstNames[rng.Below(std::size(kFirstNames))]) + ' ' +
+                   kLastNames[rng.Below(std::size(kLastNames))];
+        row.hasFun = rng.Unit() < config_.fooHasFunRatio;
+        return row;
+    }
+
+    MarketDataCacheEntry MakeTick(std::int64_t id) const {
+        Rng rng(config_.seed, kTickStream, static_cast<std::uint64_t>(id));
+        MarketDataCacheEntry row;
+        row.id = id;
+        std::size_t sym = SampleCdf(symbolCdf_, rng.Unit());
+        row.symbol = symbols_[sym];
+        row.venue = venues_[SampleCdf(venueCdf_, rng.Unit())];
+        row.ts = config_.baseTs + id * config_.tsStep;
+        row.price = refPrices_[sym] * (1.0 + config_.priceNoise * (2.0 * rng.Unit() - 1.0));
+        return row;
+    }
+
+    /**
+     * @brief Update number `seq` for a collection whose key space has `slotCount` entries
+     * (slotCount == 0 yields slot 0, e.g. for appends)
+     */
+    CollectionUpdate MakeCollectionUpdate(std::uint64_t seq, std::size_t slotCount) const {
+        Rng rng(config_.seed, kCollectionStream, seq);
+        CollectionUpdate u;
+        double r = rng.Unit();
+        if (slotCount > 0) {
+            // Heavy-head skew without a per-size CDF: slot = floor((n+1)^(r^s)) - 1
+            double s = std::max(1.0, config_.symbolZipfExponent);
+            double x = std::pow(static_cast<double>(slotCount + 1), std::pow(r, s));
+            u.slot = std::min(slotCount - 1, static_cast<std::size_t>(x) - 1);
+        }
+        u.price = config_.minCollectionPrice +
+                  rng.Unit() * (config_.maxCollectionPrice - config_.minCollectionPrice);
+        u.price = std::round(u.price * 100.0) / 100.0;
+        u.qty = 1 + static_cast<long>(rng.Below(static_cast<std::uint64_t>(std::max(1L, config_.maxCollectionQty))));
+        return u;
+    }
+
+    // ---- Batches (parallel above parallelThreshold) ----
+
+    std::vector<FooCacheEntry> GenerateFoo(std::int64_t firstId, std::size_t count) const {
+        return Generate<FooCacheEntry>(count, [&](std::size_t i) { return MakeFoo(firstId + static_cast<std::int64_t>(i)); });
+    }
+
+    std::vector<MarketDataCacheEntry> GenerateTicks(std::int64_t firstId, std::size_t count) const {
+        return Generate<MarketDataCacheEntry>(count, [&](std::size_t i) { return MakeTick(firstId + static_cast<std::int64_t>(i)); });
+    }
+
+    std::vector<CollectionUpdate> GenerateCollectionUpdates(std::uint64_t firstSeq, std::size_t count,
+                                                            std::size_t slotCount) const {
+        return Generate<CollectionUpdate>(count, [&](std::size_t i) { return MakeCollectionUpdate(firstSeq + i, slotCount); });
+    }
+
+private:
+    static constexpr std::uint64_t kFooStream = 0x466f6fULL;
+    static constexpr std::uint64_t kTickStream = 0x5469636bULL;
+    static constexpr std::uint64_t kCollectionStream = 0x436f6c6cULL;
+
+    static constexpr const char* kTickers[] = {
+        "AAPL", "MSFT", "NVDA", "AMZN", "META", "TSLA", "GOOG", "AMD",  "INTC", "NFLX", "ORCL", "CRM",
+        "ADBE", "QCOM", "AVGO", "SHOP", "JPM",  "BAC",  "WMT",  "XOM",  "CVX",  "KO",   "PEP",  "DIS",
+        "CSCO", "IBM",  "UBER", "PYPL", "SBUX", "NKE",  "MCD",  "COST"};
+    static constexpr const char* kFirstNames[] = {
+        "Ada", "Alan", "Barbara", "Bjarne", "Claude", "Dennis", "Donald", "Edsger", "Frances", "Grace",
+        "Herb", "Ivan", "John", "Ken", "Leslie", "Linus", "Margaret", "Niklaus", "Radia", "Rob",
+        "Sophie", "Tony", "Vint", "Whitfield"};
+    static constexpr const char* kLastNames[] = {
+        "Allen", "Backus", "Cerf", "Dijkstra", "Engelbart", "Floyd", "Goldberg", "Hamilton", "Hopper",
+        "Kahan", "Kernighan", "Knuth", "Lamport", "Liskov", "Lovelace", "McCarthy", "Perlman", "Pike",
+        "Ritchie", "Stroustrup", "Sutter", "Thompson", "Turing", "Wirth"};
+
+    /**
+     * @brief Counter-based RNG: splitmix64 seeded from (seed, stream, index)
+     */
+    class Rng {
+    public:
+        Rng(std::uint64_t seed, std::uint64_t stream, std::uint64_t index)
+            : state_(Mix(seed ^ Mix(stream + 0x9e3779b97f4a7c15ULL * (index + 1)))) {}
+
+        std::uint64_t Next() {
+            state_ += 0x9e3779b97f4a7c15ULL;
+            return Mix(state_);
+        }
+
+        double Unit() { return static_cast<double>(Next() >> 11) * 0x1.0p-53; }
+
+        std::uint64_t Below(std::uint64_t n) { return n ? Next() % n : 0; }
+
+    private:
+        static std::uint64_t Mix(std::uint64_t z) {
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+        std::uint64_t state_;
+    };
+
+    template <typename T, typename MakeFn>
+    std::vector<T> Generate(std::size_t count, MakeFn&& make) const {
+        std::vector<T> out(count);
+        unsigned threads = config_.threads ? config_.threads : std::max(1u, std::thread::hardware_concurrency());
+#ifdef __EMSCRIPTEN__
+        threads = 1;
+#endif
+        if (count < config_.parallelThreshold || threads <= 1) {
+            for (std::size_t i = 0; i < count; ++i) out[i] = make(i);
+            return out;
+        }
+
+        // At least parallelThreshold / 4 items per worker; the max keeps thresholds below 4 from dividing by zero
+        const std::size_t minPerWorker = std::max<std::size_t>(1, config_.parallelThreshold / 4);
+        threads = static_cast<unsigned>(std::min<std::size_t>(threads, count / minPerWorker + 1));
+        std::size_t chunk = (count + threads - 1) / threads;
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (unsigned t = 0; t < threads; ++t) {
+            std::size_t begin = t * chunk;
+            std::size_t end = std::min(count, begin + chunk);
+            if (begin >= end) break;
+            workers.emplace_back([&out, &make, begin, end]() {
+                for (std::size_t i = begin; i < end; ++i) out[i] = make(i);
+            });
+        }
+        for (auto& w : workers) w.join();
+        return out;
+    }
+
+    static std::vector<double> ZipfCdf(std::size_t n, double exponent) {
+        std::vector<double> cdf(n);
+        double sum = 0.0;
+        for (std::size_t k = 0; k < n; ++k) {
+            sum += 1.0 / std::pow(static_cast<double>(k + 1), exponent);
+            cdf[k] = sum;
+        }
+        for (auto& c : cdf) c /= sum;
+        return cdf;
+    }
+
+    static std::size_t SampleCdf(const std::vector<double>& cdf, double u) {
+        auto it = std::upper_bound(cdf.begin(), cdf.end(), u);
+        return std::min(static_cast<std::size_t>(it - cdf.begin()), cdf.size() - 1);
+    }
+
+    void BuildSymbols() {
+        std::size_t n = std::max<std::size_t>(1, config_.symbolCount);
+        symbols_.reserve(n);
+        refPrices_.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (i < std::size(kTickers)) {
+                symbols_.emplace_back(kTickers[i]);
+            } else {
+                std::string s = "SYM" + std::to_string(i);
+                symbols_.push_back(std::move(s));
+            }
+            Rng rng(config_.seed, kTickStream ^ 0xffffULL, i);
+            refPrices_.push_back(config_.minPrice + rng.Unit() * (config_.maxPrice - config_.minPrice));
+        }
+    }
+
+    void BuildVenues() {
+        double sum = 0.0;
+        for (const auto& [venue, weight] : config_.venueWeights) {
+            venues_.push_back(venue);
+            sum += std::max(0.0, weight);
+            venueCdf_.push_back(sum);
+        }
+        if (venues_.empty()) {
+            venues_.push_back("XNAS");
+            venueCdf_.push_back(1.0);
+            sum = 1.0;
+        }
+        for (auto& c : venueCdf_) c /= sum;
+    }
+
+    WorkloadConfig config_;
+    std::vector<std::string> symbols_;
+    std::vector<double> refPrices_;
+    std::vector<double> symbolCdf_;
+    std::vector<std::string> venues_;
+    std::vector<double> venueCdf_;
+};
+
+/**
+ * @brief Paces a stream to a target rate: Due() returns how many events should have
+ * been emitted by now that have not been yet (bounded by maxBurst).
+ */
+class WorkloadPacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit WorkloadPacer(double ratePerSec) : rate_(ratePerSec), start_(Clock::now()) {}
+
+    std::size_t Due(std::size_t maxBurst = 4096) {
+        double elapsed = std::chrono::duration<double>(Clock::now() - start_).count();
+        auto due = static_cast<std::uint64_t>(elapsed * rate_);
+        auto n = static_cast<std::size_t>(std::min<std::uint64_t>(due - std::min(due, emitted_), maxBurst));
+        emitted_ += n;
+        return n;
+    }
+
+    std::uint64_t Emitted() const { return emitted_; }
+    double Rate() const { return rate_; }
+
+private:
+    double rate_;
+    Clock::time_point start_;
+    std::uint64_t emitted_ = 0;
+};
+
+} // namespace db
@@ -0,0 +1,709 @@
+// Headless ingestion-and-model engine.
+//
+// Runs the same data path as the GUI (NatsClient feed -> multi-index models ->
+// ReactiveTwoFieldCollection -> DatabaseManager persistence) without a window,
+// printing periodic throughput and latency metrics. Intended for servers and soak tests.
+// With --db the positions are mirrored into the "positions" table and restored on start.
+//
+// Usage:
+//   KitchenSinkHeadless [--nats URL] [--subject SUBJ] [--synthetic-rate N] [--duration SEC]
+//                       [--report-interval SEC] [--db PATH] [--capacity N] [--trace PATH]
+//
+// Without --nats a built-in synthetic tick feed is used so the engine can run anywhere.
+// NATS payloads are CSV: "SYMBOL,VENUE,PRICE[,QTY[,TS_NS]]" for ticks, and
+// "id,name,has_fun" for messages on "<subject>.foo".
+// --trace records spans for the whole run and writes a Chrome/Perfetto JSON trace at exit.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "database/collection_persistence.h"
+#include "database/database_manager.h"
+#include "database/foo_multi_index_table_model.h"
+#include "database/lock_profiler.h"
+#include "database/market_data_multi_index_table_model.h"
+#include "database/reactive_two_field_collection.h"
+#include "database/trace.h"
+#include "database/workload_generator.h"
+#include "nats_client.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Positions keyed by symbol: elem1 = last price, elem2 = quantity.
+using PositionCollection = reactive::ReactiveTwoFieldCollection<
+    double, long, long, double,
+    reactive::detail::DefaultDelta1<double, long, long>,
+    reactive::detail::DefaultApplyAdd<long, long>,
+    reactive::detail::DefaultDelta2<double, long, double>,
+    reactive::detail::DefaultApplyAdd<double, double>,
+    std::string>;
+
+struct Options {
+    std::string natsUrl;
+    std::string subject = "imgui.demo";
+    double syntheticRate = 20000.0; // ticks per second when no NATS URL is given
+    double durationSec = 0.0;       // 0 = run until SIGINT/SIGTERM
+    double reportIntervalSec = 1.0;
+    std::string dbPath; // empty = :memory:
+    std::size_t capacity = 200000;
+    std::string tracePath; // empty = tracing off
+};
+
+struct Tick {
+    std::string symbol;
+    std::string venue;
+    double price{};
+    long qty{};
+    std::int64_t ts{};       // epoch nanoseconds
+    Clock::time_point origin; // when the tick entered the process (or was generated)
+    std::uint64_t traceId = 0; // NATS flow id (0 = untraced)
+};
+
+struct FooUpdate {
+    db::FooCacheEntry entry;
+};
+
+std::atomic<bool> g_stopRequested{false};
+
+void OnSignal(int) { g_stopRequested.store(true, std::memory_order_release); }
+
+std::int64_t NowEpochNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * @brief Per-interval latency samples (microseconds) with percentile summary.
+ *
+ * Each recorder is written by a single thread and drained by the reporter once per interval;
+ * Record takes a mutex that only the reporter's swap contends with, then appends to a vector.
+ */
+class LatencyRecorder {
+public:
+    void Record(double micros) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_samples.push_back(micros);
+    }
+
+    struct Summary {
+        std::size_t count = 0;
+        double p50 = 0.0;
+        double p99 = 0.0;
+        double max = 0.0;
+    };
+
+    Summary Drain() {
+        std::vector<double> samples;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            samples.swap(m_samples);
+        }
+        Summary s;
+        s.count = samples.size();
+        if (samples.empty()) return s;
+        auto pct = [&samples](double p) {
+            std::size_t k = static_cast<std::size_t>(p * static_cast<double>(samples.size() - 1));
+            std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(k), samples.end());
+            return samples[k];
+        };
+        s.p50 = pct(0.50);
+        s.p99 = pct(0.99);
+        s.max = *std::max_element(samples.begin(), samples.end());
+        return s;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<double> m_samples;
+};
+
+struct Metrics {
+    std::atomic<std::uint64_t> messagesReceived{0};
+    std::atomic<std::uint64_t> ticksApplied{0};
+    std::atomic<std::uint64_t> fooApplied{0};
+    std::atomic<std::uint64_t> parseErrors{0};
+    std::atomic<std::uint64_t> rowsPersisted{0};
+    std::atomic<std::uint64_t> persistFailures{0}; // tick batches rolled back
+    std::atomic<std::uint64_t> queriesRun{0};
+    std::atomic<std::size_t> maxPollBatch{0};
+    std::atomic<std::size_t> writeQueueDepth{0};
+
+    LatencyRecorder upsertLatency;   // model + collection apply per tick
+    LatencyRecorder endToEndLatency; // origin -> applied
+    LatencyRecorder queryLatency;    // BuildAsyncRows
+    LatencyRecorder persistLatency;  // per batch commit
+};
+
+std::vector<std::string> SplitCsv(const std::string& s) {
+    std::vector<std::string> out;
+    std::string field;
+    std::istringstream in(s);
+    while (std::getline(in, field, ',')) {
+        out.push_back(field);
+    }
+    return out;
+}
+
+bool ParseTick(const std::string& payload, Clock::time_point received, Tick& out) {
+    auto f = SplitCsv(payload);
+    if (f.size() < 3) return false;
+    try {
+        out.symbol = f[0];
+        out.venue = f[1];
+        out.price = std::stod(f[2]);
+        out.qty = f.size() > 3 ? std::stol(f[3]) : 1;
+        out.ts = f.size() > 4 ? std::stoll(f[4]) : NowEpochNs();
+        out.origin = received;
+        // If the publisher stamped the tick, account for transport latency as well.
+        if (f.size() > 4) {
+            auto transport = std::chrono::nanoseconds(NowEpochNs() - out.ts);
+            if (transport.count() > 0) {
+                out.origin = received - std::chrono::duration_cast<Clock::duration>(transport);
+            }
+        }
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+bool ParseFoo(const std::string& payload, FooUpdate& out) {
+    auto f = SplitCsv(payload);
+    if (f.size() < 3) return false;
+    try {
+        out.entry.id = std::stoll(f[0]);
+        out.entry.name = f[1];
+        out.entry.hasFun = (f[2] == "1" || f[2] == "true" || f[2] == "yes");
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+/**
+ * @brief Deterministic synthetic tick source paced to a target rate.
+ *
+ * Tick n is WorkloadGenerator::MakeTick(n) (Zipf-skewed symbols, weighted venues), so
+ * two runs at the same rate see the same sequence.
+ */
+class SyntheticFeed {
+public:
+    explicit SyntheticFeed(double ratePerSec) : m_pacer(ratePerSec) {}
+
+    // Emit all ticks that are due by now (bounded per call to keep latency samples honest).
+    void Poll(std::vector<Tick>& ticks, std::vector<FooUpdate>& foos) {
+        auto now = Clock::now();
+        std::size_t n = m_pacer.Due(4096);
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::uint64_t seq = m_seq++;
+            auto row = m_generator.MakeTick(static_cast<std::int64_t>(seq));
+            Tick t;
+            t.symbol = std::move(row.symbol);
+            t.venue = std::move(row.venue);
+            t.price = row.price;
+            t.qty = m_generator.MakeCollectionUpdate(seq, 0).qty;
+            t.ts = NowEpochNs();
+            t.origin = now;
+            ticks.push_back(std::move(t));
+
+            // Roughly 1% of the feed is reference-data (Foo) updates.
+            if (seq % 100 == 0) {
+                FooUpdate u;
+                u.entry = m_generator.MakeFoo(1 + static_cast<std::int64_t>((seq / 100) % 5000));
+                foos.push_back(std::move(u));
+            }
+        }
+    }
+
+private:
+    db::WorkloadGenerator m_generator;
+    db::WorkloadPacer m_pacer;
+    std::uint64_t m_seq = 1;
+};
+
+/**
+ * @brief Batched SQLite writer: ticks and foo upserts are queued by the ingest thread and
+ * committed in one transaction per batch on a dedicated thread, with statements prepared once.
+ *
+ * handle is the persister's own connection for a file database; on the shared :memory:
+ * handle each batch holds bulk_detail::ConnectionLock so other threads' statements
+ * cannot land in its transaction.
+ */
+class FeedPersister {
+public:
+    FeedPersister(Metrics& metrics, sqlite3* handle) : m_metrics(metrics), m_handle(handle) {
+        m_thread = std::thread([this]() { Run(); });
+    }
+
+    ~FeedPersister() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_one();
+        if (m_thread.joinable()) m_thread.join();
+    }
+
+    void Enqueue(std::vector<Tick>& ticks, std::int64_t firstId) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& t : ticks) {
+            m_pending.push_back(PendingRow{firstId++, t.symbol, t.venue, t.ts, t.price});
+        }
+        m_metrics.writeQueueDepth.store(m_pending.size() + m_pendingFoo.size(), std::memory_order_relaxed);
+        m_cv.notify_one();
+    }
+
+    // foo has no primary key, so each entry is written as a delete followed by an insert
+    void EnqueueFoo(const db::FooCacheEntry& entry) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pendingFoo.push_back(entry);
+        m_metrics.writeQueueDepth.store(m_pending.size() + m_pendingFoo.size(), std::memory_order_relaxed);
+        m_cv.notify_one();
+    }
+
+private:
+    struct PendingRow {
+        std::int64_t id;
+        std::string symbol;
+        std::string venue;
+        std::int64_t ts;
+        double price;
+    };
+
+    struct Statements {
+        sqlite3_stmt* tick = nullptr;
+        sqlite3_stmt* fooDelete = nullptr;
+        sqlite3_stmt* fooInsert = nullptr;
+
+        ~Statements() {
+            sqlite3_finalize(tick);
+            sqlite3_finalize(fooDelete);
+            sqlite3_finalize(fooInsert);
+        }
+    };
+
+    void Run() {
+        db::Trace::SetThreadName("persister");
+        sqlite3* handle = m_handle;
+        Statements stmts;
+        auto prepare = [handle](const char* sql, sqlite3_stmt** stmt) {
+            return sqlite3_prepare_v2(handle, sql, -1, stmt, nullptr) == SQLITE_OK;
+        };
+        if (!handle ||
+            !prepare("INSERT OR REPLACE INTO market_ticks(id, symbol, venue, ts, price) VALUES(?1, ?2, ?3, ?4, ?5);",
+                     &stmts.tick) ||
+            !prepare("DELETE FROM foo WHERE id = ?1;", &stmts.fooDelete) ||
+            !prepare("INSERT INTO foo(id, name, has_fun) VALUES(?1, ?2, ?3);", &stmts.fooInsert)) {
+            std::cerr << "persister: prepare failed: " << (handle ? sqlite3_errmsg(handle) : "no database") << "\n";
+            return;
+        }
+
+        std::vector<PendingRow> batch;
+        std::vector<db::FooCacheEntry> fooBatch;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait_for(lock, std::chrono::milliseconds(50),
+                              [this] { return m_stop || !m_pending.empty() || !m_pendingFoo.empty(); });
+                if (m_pending.empty() && m_pendingFoo.empty() && m_stop) break;
+                batch.swap(m_pending);
+                fooBatch.swap(m_pendingFoo);
+                m_metrics.writeQueueDepth.store(0, std::memory_order_relaxed);
+            }
+            if (batch.empty() && fooBatch.empty()) continue;
+
+            auto start = Clock::now();
+            if (WriteBatch(handle, stmts, batch, fooBatch)) {
+                const double us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+                m_metrics.persistLatency.Record(us);
+                m_metrics.rowsPersisted.fetch_add(batch.size() + fooBatch.size(), std::memory_order_relaxed);
+            } else {
+                m_metrics.persistFailures.fetch_add(1, std::memory_order_relaxed);
+            }
+            batch.clear();
+            fooBatch.clear();
+        }
+    }
+
+    // Steps a bound statement once; the statement is reset either way so the next batch can rebind it
+    static bool Step(sqlite3* handle, sqlite3_stmt* stmt, const char* what) {
+        const int rc = sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+        if (rc != SQLITE_DONE) {
+            std::cerr << "persister: " << what << " failed: " << sqlite3_errmsg(handle) << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    // One transaction; rolled back (and the batch dropped) if any statement fails
+    static bool WriteBatch(sqlite3* handle, const Statements& stmts, const std::vector<PendingRow>& batch,
+                           const std::vector<db::FooCacheEntry>& fooBatch) {
+        bulk_detail::ConnectionLock lock(handle);
+        if (sqlite3_exec(handle, "BEGIN IMMEDIATE", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            std::cerr << "persister: begin failed: " << sqlite3_errmsg(handle) << "\n";
+            return false;
+        }
+        auto fail = [handle] {
+            sqlite3_exec(handle, "ROLLBACK", nullptr, nullptr, nullptr);
+            return false;
+        };
+        for (const auto& row : batch) {
+            sqlite3_bind_int64(stmts.tick, 1, row.id);
+            sqlite3_bind_text(stmts.tick, 2, row.symbol.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_text(stmts.tick, 3, row.venue.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int64(stmts.tick, 4, row.ts);
+            sqlite3_bind_double(stmts.tick, 5, row.price);
+            if (!Step(handle, stmts.tick, "insert")) return fail();
+        }
+        // Applied in arrival order, so the last update of an id within the batch wins
+        for (const auto& entry : fooBatch) {
+            sqlite3_bind_int64(stmts.fooDelete, 1, entry.id);
+            if (!Step(handle, stmts.fooDelete, "foo delete")) return fail();
+            sqlite3_bind_int64(stmts.fooInsert, 1, entry.id);
+            sqlite3_bind_text(stmts.fooInsert, 2, entry.name.c_str(), -1, SQLITE_TRANSIENT);
+            sqlite3_bind_int(stmts.fooInsert, 3, entry.hasFun ? 1 : 0);
+            if (!Step(handle, stmts.fooInsert, "foo insert")) return fail();
+        }
+        if (sqlite3_exec(handle, "COMMIT", nullptr, nullptr, nullptr) != SQLITE_OK) {
+            std::cerr << "persister: commit failed: " << sqlite3_errmsg(handle) << "\n";
+            sqlite3_exec(handle, "ROLLBACK", nullptr, nullptr, nullptr);
+            return false;
+        }
+        return true;
+    }
+
+    Metrics& m_metrics;
+    sqlite3* m_handle;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<PendingRow> m_pending;
+    std::vector<db::FooCacheEntry> m_pendingFoo;
+    bool m_stop = false;
+    std::thread m_thread;
+};
+
+bool ParseArgs(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&](const char* name) -> const char* {
+            if (i + 1 >= argc) {
+                std::cerr << "missing value for " << name << "\n";
+                return nullptr;
+            }
+            return argv[++i];
+        };
+        const char* v = nullptr;
+        if (arg == "--nats") {
+            if (!(v = next("--nats"))) return false;
+            opts.natsUrl = v;
+        } else if (arg == "--subject") {
+            if (!(v = next("--subject"))) return false;
+            opts.subject = v;
+        } else if (arg == "--synthetic-rate") {
+            if (!(v = next("--synthetic-rate"))) return false;
+            opts.syntheticRate = std::atof(v);
+        } else if (arg == "--duration") {
+            if (!(v = next("--duration"))) return false;
+            opts.durationSec = std::atof(v);
+        } else if (arg == "--report-interval") {
+            if (!(v = next("--report-interval"))) return false;
+            opts.reportIntervalSec = std::max(0.1, std::atof(v));
+        } else if (arg == "--db") {
+            if (!(v = next("--db"))) return false;
+            opts.dbPath = v;
+        } else if (arg == "--capacity") {
+            if (!(v = next("--capacity"))) return false;
+            opts.capacity = static_cast<std::size_t>(std::atoll(v));
+        } else if (arg == "--trace") {
+            if (!(v = next("--trace"))) return false;
+            opts.tracePath = v;
+        } else if (arg == "--help" || arg == "-h") {
+            std::cout << "usage: " << argv[0]
+                      << " [--nats URL] [--subject SUBJ] [--synthetic-rate N] [--duration SEC]"
+                         " [--report-interval SEC] [--db PATH] [--capacity N] [--trace PATH]\n";
+            return false;
+        } else {
+            std::cerr << "unknown argument: " << arg << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+void PrintReport(Metrics& m, double intervalSec, const db::MarketDataMultiIndexTableModel& marketModel,
+                 const db::FooMultiIndexTableModel& fooModel, const PositionCollection& positions) {
+    static std::uint64_t s_lastMessages = 0, s_lastTicks = 0, s_lastPersisted = 0, s_lastQueries = 0;
+
+    std::uint64_t messages = m.messagesReceived.load(std::memory_order_relaxed);
+    std::uint64_t ticks = m.ticksApplied.load(std::memory_order_relaxed);
+    std::uint64_t persisted = m.rowsPersisted.load(std::memory_order_relaxed);
+    std::uint64_t queries = m.queriesRun.load(std::memory_order_relaxed);
+
+    auto upsert = m.upsertLatency.Drain();
+    auto e2e = m.endToEndLatency.Drain();
+    auto query = m.queryLatency.Drain();
+    auto persist = m.persistLatency.Drain();
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1);
+    out << "[headless] msg/s=" << (messages - s_lastMessages) / intervalSec
+        << " ticks/s=" << (ticks - s_lastTicks) / intervalSec
+        << " persisted/s=" << (persisted - s_lastPersisted) / intervalSec
+        << " queries/s=" << (queries - s_lastQueries) / intervalSec
+        << " | upsert_us p50=" << upsert.p50 << " p99=" << upsert.p99 << " max=" << upsert.max
+        << " | e2e_us p50=" << e2e.p50 << " p99=" << e2e.p99 << " max=" << e2e.max
+        << " | query_us p50=" << query.p50 << " p99=" << query.p99
+        << " | commit_us p50=" << persist.p50 << " p99=" << persist.p99
+        << " | write_queue=" << m.writeQueueDepth.load(std::memory_order_relaxed)
+        << " max_poll_batch=" << m.maxPollBatch.exchange(0, std::memory_order_relaxed)
+        << " parse_errors=" << m.parseErrors.load(std::memory_order_relaxed)
+        << " | md_rows=" << marketModel.Size() << " foo_rows=" << fooModel.Size()
+        << " positions=" << positions.size() << " qty_total=" << positions.total1()
+        << " notional_total=" << positions.total2();
+    std::cout << out.str() << std::endl;
+
+    s_lastMessages = messages;
+    s_lastTicks = ticks;
+    s_lastPersisted = persisted;
+    s_lastQueries = queries;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!ParseArgs(argc, argv, opts)) {
+        return 2;
+    }
+
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+
+    if (!opts.tracePath.empty()) {
+        db::Trace::SetEnabled(true);
+        db::Trace::SetThreadName("ingest");
+    }
+
+    // Persistence
+    DatabaseManager& dbManager = DatabaseManager::Get();
+    bool dbOk = opts.dbPath.empty() ? dbManager.Initialize(DatabaseConfig::Memory())
+                                    : dbManager.Initialize(DatabaseConfig::NativeFile(opts.dbPath));
+    if (!dbOk) {
+        std::cerr << "database init failed: " << dbManager.GetLastError() << "\n";
+        return 1;
+    }
+    try {
+        dbManager.GetConnection()("CREATE TABLE IF NOT EXISTS foo (id BIGINT, name TEXT, has_fun BOOLEAN)");
+        dbManager.GetConnection()("CREATE TABLE IF NOT EXISTS market_ticks ("
+                                  "id INTEGER PRIMARY KEY, symbol TEXT NOT NULL, venue TEXT NOT NULL, "
+                                  "ts BIGINT NOT NULL, price REAL NOT NULL)");
+    } catch (const std::exception& e) {
+        std::cerr << "schema setup failed: " << e.what() << "\n";
+        return 1;
+    }
+
+    // Models
+    db::MarketDataMultiIndexTableModel marketModel(opts.capacity);
+    db::FooMultiIndexTableModel fooModel(opts.capacity);
+    PositionCollection positions;
+
+    // Background writers get their own connections to a file database, so their transactions
+    // never mix with each other's or the ingest thread's; :memory: has only the main handle
+    DatabaseManager::OwnedConnection tickConnection;
+    DatabaseManager::OwnedConnection positionConnection;
+    if (!opts.dbPath.empty()) {
+        tickConnection = dbManager.OpenWorkerConnection();
+        positionConnection = dbManager.OpenWorkerConnection();
+        if (!tickConnection || !positionConnection) {
+            std::cerr << "database init failed: " << dbManager.GetLastError() << "\n";
+            return 1;
+        }
+    }
+
+    // File databases keep the positions across restarts: restore, then mirror every change
+    std::unique_ptr<db::CollectionPersistence<PositionCollection>> positionStore;
+    if (!opts.dbPath.empty()) {
+        try {
+            positionStore = std::make_unique<db::CollectionPersistence<PositionCollection>>(
+                positions, positionConnection.get(), "positions");
+            auto start = Clock::now();
+            std::size_t restored = positionStore->Restore();
+            std::cout << "[headless] restored " << restored << " positions in "
+                      << std::chrono::duration<double, std::milli>(Clock::now() - start).count() << " ms" << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "position restore failed: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    Metrics metrics;
+    auto persister =
+        std::make_unique<FeedPersister>(metrics, tickConnection ? tickConnection.get() : dbManager.GetRawHandle());
+
+    // Feed
+    NatsClient natsClient;
+    std::unique_ptr<SyntheticFeed> synthetic;
+    bool natsSubscribed = false;
+    if (!opts.natsUrl.empty()) {
+        natsClient.Connect(opts.natsUrl);
+        std::cout << "[headless] connecting to " << opts.natsUrl << " subject=" << opts.subject << std::endl;
+    } else {
+        synthetic = std::make_unique<SyntheticFeed>(opts.syntheticRate);
+        std::cout << "[headless] synthetic feed at " << opts.syntheticRate << " ticks/s" << std::endl;
+    }
+    const std::string fooSubject = opts.subject + ".foo";
+
+    // Query load: mimic the widgets' periodic background refreshes.
+    std::atomic<bool> queryRunning{true};
+    std::thread queryThread([&]() {
+        db::Trace::SetThreadName("query");
+        std::vector<db::AsyncTableWidget::Row> rows;
+        db::MarketDataMultiIndexTableModel::Query mdQuery;
+        mdQuery.order = db::MarketDataMultiIndexTableModel::Order::TsDesc;
+        mdQuery.limit = 2000;
+        db::FooMultiIndexTableModel::Query fooQuery;
+        fooQuery.limit = 2000;
+        while (queryRunning.load(std::memory_order_acquire)) {
+            auto start = Clock::now();
+            marketModel.BuildAsyncRows(rows, mdQuery);
+            fooModel.BuildAsyncRows(rows, fooQuery);
+            metrics.queryLatency.Record(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+            metrics.queriesRun.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    });
+
+    // Ingest loop (single writer, like the GUI thread)
+    std::int64_t nextTickId = 1;
+    std::vector<Tick> ticks;
+    std::vector<FooUpdate> foos;
+    const auto startTime = Clock::now();
+    auto nextReport = startTime + std::chrono::duration_cast<Clock::duration>(
+                                      std::chrono::duration<double>(opts.reportIntervalSec));
+
+    while (!g_stopRequested.load(std::memory_order_acquire)) {
+        auto now = Clock::now();
+        if (opts.durationSec > 0.0 && std::chrono::duration<double>(now - startTime).count() >= opts.durationSec) {
+            break;
+        }
+
+        ticks.clear();
+        foos.clear();
+        if (synthetic) {
+            synthetic->Poll(ticks, foos);
+        } else {
+            if (!natsSubscribed && natsClient.IsConnected()) {
+                natsClient.Subscribe(opts.subject);
+                natsClient.Subscribe(fooSubject);
+                natsSubscribed = true;
+                std::cout << "[headless] subscribed" << std::endl;
+            }
+            auto msgs = natsClient.PollMessages();
+            auto received = Clock::now();
+            for (const auto& msg : msgs) {
+                if (msg.subject == fooSubject) {
+                    FooUpdate u;
+                    if (ParseFoo(msg.data, u)) {
+                        foos.push_back(std::move(u));
+                    } else {
+                        metrics.parseErrors.fetch_add(1, std::memory_order_relaxed);
+                    }
+                } else {
+                    Tick t;
+                    if (ParseTick(msg.data, received, t)) {
+                        t.traceId = msg.traceId;
+                        ticks.push_back(std::move(t));
+                    } else {
+                        metrics.parseErrors.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+        }
+
+        std::size_t batchSize = ticks.size() + foos.size();
+        metrics.messagesReceived.fetch_add(batchSize, std::memory_order_relaxed);
+        std::size_t prevMax = metrics.maxPollBatch.load(std::memory_order_relaxed);
+        if (batchSize > prevMax) metrics.maxPollBatch.store(batchSize, std::memory_order_relaxed);
+
+        std::int64_t firstTickId = nextTickId;
+        for (auto& t : ticks) {
+            KS_TRACE_SCOPE("headless", "ApplyTick", t.symbol);
+            db::Trace::Flow("nats", "message", 'f', t.traceId);
+            auto applyStart = Clock::now();
+            marketModel.Upsert(db::MarketDataCacheEntry{nextTickId++, t.symbol, t.venue, t.ts, t.price});
+
+            if (auto id = positions.find_by_key(t.symbol)) {
+                positions.elem1Var(*id).value(t.price);
+                positions.elem2Var(*id).value(t.qty);
+            } else {
+                positions.push_back(t.price, t.qty, t.symbol);
+            }
+
+            auto applied = Clock::now();
+            metrics.upsertLatency.Record(std::chrono::duration<double, std::micro>(applied - applyStart).count());
+            metrics.endToEndLatency.Record(std::chrono::duration<double, std::micro>(applied - t.origin).count());
+        }
+        metrics.ticksApplied.fetch_add(ticks.size(), std::memory_order_relaxed);
+        if (!ticks.empty()) {
+            persister->Enqueue(ticks, firstTickId);
+        }
+
+        for (auto& u : foos) {
+            fooModel.Upsert(u.entry);
+            persister->EnqueueFoo(u.entry);
+        }
+        metrics.fooApplied.fetch_add(foos.size(), std::memory_order_relaxed);
+
+        if (Clock::now() >= nextReport) {
+            PrintReport(metrics, opts.reportIntervalSec, marketModel, fooModel, positions);
+            nextReport += std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(opts.reportIntervalSec));
+        }
+
+        if (batchSize == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    }
+
+    // Shutdown: stop readers, flush the writer, then tear down the feed.
+    queryRunning.store(false, std::memory_order_release);
+    if (queryThread.joinable()) queryThread.join();
+    persister.reset();
+    positionStore.reset();
+    natsClient.Disconnect();
+
+    if (!opts.tracePath.empty()) {
+        if (db::Trace::WriteChromeJson(opts.tracePath)) {
+            std::cout << "[headless] trace written to " << opts.tracePath << std::endl;
+        } else {
+            std::cerr << "failed to write trace to " << opts.tracePath << "\n";
+        }
+    }
+
+    std::cout << "[headless] done: ticks=" << metrics.ticksApplied.load()
+              << " foo=" << metrics.fooApplied.load() << " persisted=" << metrics.rowsPersisted.load()
+              << " persist_failures=" << metrics.persistFailures.load()
+              << " parse_errors=" << metrics.parseErrors.load() << std::endl;
+    if constexpr (db::kLockProfilingEnabled) {
+        std::cout << "[headless] lock contention:\n" << db::LockProfiler::Get().Report(5);
+    }
+    return 0;
+}
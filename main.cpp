@@ -8,8 +8,8 @@
 #include <string>
 #include <cmath>
 #include <cstdint>
-#include <faker-cxx/person.h>
-#include <faker-cxx/number.h>
+#include <cstdio>
+#include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <reaction/reaction.h>
@@ -23,11 +23,16 @@
 #include "database/database_manager.h"
 #include "database/schemas/table_foo.h"
 #include "database/async_table_widget.h"
+#include "database/table_codec.h"
+#include "database/shared_row_store.h"
 #include "database/foo_multi_index_table_model.h"
 #include "nats_client.h"
 
 #include "database/reactive_two_field_collection.h"
 #include "database/reactive_list_widget.h"
+#include "database/perf_hud_panel.h"
+#include "database/trace.h"
+#include "database/workload_generator.h"
 
 namespace ed = ax::NodeEditor;
 
@@ -38,14 +43,26 @@ static int g_GlobalFontIdx = 0;
 static std::vector<std::string> g_db_results;
 
 // Async Table Widget (Zero-Lock Rendering)
+using FooCodec = db::TableCodec<test_db::Foo_>;
+static std::shared_ptr<db::SharedRowStore> g_fooStore; // one copy of the foo rows, shared by the views below
 static std::unique_ptr<db::AsyncTableWidget> g_asyncTable;
+static std::unique_ptr<db::AsyncTableWidget> g_fooFunView; // HasFun rows only, sorted independently
 static std::thread g_refreshThread;
 static std::atomic<bool> g_refreshRunning{false};
+static std::atomic<bool> g_fooStoreDirty{false};
 static std::mutex g_refreshMutex;
 static std::condition_variable g_refreshCV;
 
+// Re-query foo on the refresh thread (views re-sort without a query on sort changes)
+static void RequestFooRefresh() {
+    g_fooStoreDirty = true;
+    g_refreshCV.notify_one();
+}
+
 // Shared next_id for inserting rows into foo table
 static int g_nextFooId = 100;
+static std::shared_ptr<BulkMutationJob> g_bulkJob; // "Update Rows" background job
+static bool g_bulkJobReported = false;
 
 // NATS State
 static NatsClient g_natsClient;
@@ -71,11 +88,19 @@ static std::condition_variable g_reactiveRefreshCV;
 static std::unique_ptr<db::FooMultiIndexTableModel> g_multiIndexModel;
 static std::unique_ptr<db::AsyncTableWidget> g_multiIndexTable;
 static db::FooMultiIndexTableModel::Query g_multiIndexQuery;
+static std::uint64_t g_multiIndexQueryRevision = 0; // bumped whenever g_multiIndexQuery changes
 static char g_multiIndexPrefix[128] = "";
 static char g_multiIndexContains[128] = "";
 static int g_multiIndexHasFun = 0; // 0=Any, 1=Yes, 2=No
 static int g_multiIndexOrder = 0;  // FooMultiIndexTableModel::Order
 
+// Synthetic data for all demo buttons (seeded, reproducible)
+static db::WorkloadGenerator g_workload;
+static std::uint64_t g_workloadSeq = 1; // revision/sequence for updates
+
+// Performance HUD (fed by counters registered in main())
+static db::PerfHudPanel g_perfHud;
+
 static void PushUiError(const std::string& message) {
     if (g_errorLog.size() >= kMaxErrorLogEntries) {
         g_errorLog.erase(g_errorLog.begin());
@@ -115,6 +140,12 @@ static void RenderStatusWidget(const char* title, const char* clearId, const std
     }
 }
 
+// Stable identity of a multi-index table row (for grouping and change highlighting)
+static uint64_t MultiIndexRowKey(const db::AsyncTableWidget::Row& row) {
+    const auto* data = std::any_cast<db::FooTypedData>(&row.userData);
+    return data ? static_cast<uint64_t>(data->id) : 0;
+}
+
 static void SyncMultiIndexQueryFromUi() {
     g_multiIndexQuery.namePrefix = g_multiIndexPrefix;
     g_multiIndexQuery.textContains = g_multiIndexContains;
@@ -134,6 +165,7 @@ static void SyncMultiIndexQueryFromUi() {
         g_multiIndexOrder = 0;
     }
     g_multiIndexQuery.order = static_cast<db::FooMultiIndexTableModel::Order>(g_multiIndexOrder);
+    g_multiIndexQueryRevision++;
 }
 
 void Gui() {
@@ -158,6 +190,32 @@ void Gui() {
         }
         ImGui::Separator();
 
+        g_perfHud.Tick();
+        if (ImGui::CollapsingHeader("Performance HUD")) {
+            bool tracing = db::Trace::Enabled();
+            if (ImGui::Checkbox("Tracing", &tracing)) {
+                db::Trace::SetEnabled(tracing);
+            }
+            ImGui::SameLine();
+            static std::string traceStatus;
+            if (ImGui::Button("Dump trace")) {
+                const std::string tracePath = "kitchensink_trace.json";
+                if (db::Trace::WriteChromeJson(tracePath)) {
+                    traceStatus = "wrote " + tracePath + " (open in ui.perfetto.dev)";
+                } else {
+                    PushUiError("Failed to write " + tracePath);
+                }
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("Clear trace")) {
+                db::Trace::Clear();
+                traceStatus.clear();
+            }
+            ImGui::SameLine();
+            ImGui::Text("%zu events %s", db::Trace::EventCount(), traceStatus.c_str());
+            g_perfHud.Render();
+        }
+
         static float f = 0.0f;
         ImGui::SliderFloat("Float Slider", &f, 0.0f, 1.0f);
 
@@ -239,7 +297,7 @@ void Gui() {
 
                 // Manual refresh button (wakes background thread)
                 if (ImGui::Button("Manual Refresh")) {
-                    g_refreshCV.notify_one();
+                    RequestFooRefresh();
                 }
 
                 ImGui::Separator();
@@ -253,19 +311,19 @@ void Gui() {
                 ImGui::SameLine();
                 if (ImGui::Button("Add Rows")) {
                     try {
-                        for (int i = 0; i < insertCount; i++) {
-                            auto name = std::string(faker::person::fullName());
-                            bool hasFun = faker::number::integer(0, 1) == 1;
+                        auto newRows = g_workload.GenerateFoo(g_nextFooId, static_cast<std::size_t>(insertCount));
+                        g_nextFooId += insertCount;
+                        for (const auto& row : newRows) {
                             DatabaseManager::Get().GetConnection()(sqlpp::insert_into(test_db::foo)
-                                .set(test_db::foo.Id = g_nextFooId++,
-                                     test_db::foo.Name = name,
-                                     test_db::foo.HasFun = hasFun));
+                                .set(test_db::foo.Id = row.id,
+                                     test_db::foo.Name = row.name,
+                                     test_db::foo.HasFun = row.hasFun));
                         }
                     } catch (const std::exception& e) {
                         PushUiError("Add Rows failed", e);
                         PushStatusLine(g_dbStatusLog, std::string("Add Rows failed: ") + e.what());
                     }
-                    g_refreshCV.notify_one();
+                    RequestFooRefresh();
                 }
 
                 // Update every Nth row controls
@@ -281,35 +339,91 @@ void Gui() {
                 if (updateStartRow < 0) updateStartRow = 0;
                 if (updateStartRow > 10000) updateStartRow = 10000;
                 ImGui::SameLine();
+                const bool bulkRunning = g_bulkJob && !g_bulkJob->IsFinished();
+                ImGui::BeginDisabled(bulkRunning);
                 if (ImGui::Button("Update Rows")) {
-                    try {
-                        auto& conn = DatabaseManager::Get().GetConnection();
-                        // Select all IDs
-                        std::vector<int64_t> ids;
-                        for (const auto& row : conn(sqlpp::select(test_db::foo.Id).from(test_db::foo))) {
-                            ids.push_back(row.Id);
+                    // One set-based job on a background connection instead of one UPDATE per row
+                    BulkUpdateRequest req;
+                    req.table = "foo";
+                    req.orderBy = "rowid";
+                    req.offset = static_cast<std::size_t>(updateStartRow);
+                    req.modN = static_cast<std::size_t>(updateModN);
+                    req.keyColumn = "id";
+                    req.stagedColumns = {"name", "has_fun"};
+                    req.valueProvider = [revision = g_workloadSeq++](const BulkTarget& target,
+                                                                     std::vector<BulkValue>& values) {
+                        auto row = g_workload.MakeFoo(target.key, revision);
+                        values[0] = std::move(row.name);
+                        values[1] = static_cast<std::int64_t>(row.hasFun);
+                    };
+                    g_bulkJob = DatabaseManager::Get().StartBulkUpdate(std::move(req));
+                    g_bulkJobReported = false;
+                    if (!g_bulkJob) {
+                        PushUiError("Update Rows failed: " + DatabaseManager::Get().GetLastError());
+                        PushStatusLine(g_dbStatusLog, "Update Rows failed: " + DatabaseManager::Get().GetLastError());
+                    }
+                }
+                ImGui::EndDisabled();
+
+                if (g_bulkJob) {
+                    if (bulkRunning) {
+                        char overlay[64];
+                        std::snprintf(overlay, sizeof(overlay), "%zu / %zu", g_bulkJob->GetProcessed(), g_bulkJob->GetTotal());
+                        ImGui::ProgressBar(g_bulkJob->GetProgress(), ImVec2(240.0f, 0.0f), overlay);
+                        ImGui::SameLine();
+                        if (ImGui::SmallButton("Cancel##bulk")) {
+                            g_bulkJob->Cancel();
                         }
-                        // Update every Nth row starting from startRow index
-                        for (int i = updateStartRow; i < static_cast<int>(ids.size()); i += updateModN) {
-                            auto id = ids[i];
-                            auto name = std::string(faker::person::fullName());
-                            bool hasFun = faker::number::integer(0, 1) == 1;
-                            conn(sqlpp::update(test_db::foo)
-                                .set(test_db::foo.Name = name, test_db::foo.HasFun = hasFun)
-                                .where(test_db::foo.Id == id));
+                    } else if (!g_bulkJobReported) {
+                        g_bulkJobReported = true;
+                        std::ostringstream msg;
+                        switch (g_bulkJob->GetState()) {
+                        case BulkMutationJob::State::Succeeded:
+                            msg << "Updated " << g_bulkJob->GetProcessed() << " rows in " << std::fixed
+                                << std::setprecision(1) << g_bulkJob->GetElapsedMs() << " ms";
+                            break;
+                        case BulkMutationJob::State::Cancelled:
+                            msg << "Update Rows cancelled (rolled back)";
+                            break;
+                        default:
+                            msg << "Update Rows failed: " << g_bulkJob->GetError();
+                            PushUiError(msg.str());
+                            break;
                         }
-                    } catch (const std::exception& e) {
-                        PushUiError("Update Rows failed", e);
-                        PushStatusLine(g_dbStatusLog, std::string("Update Rows failed: ") + e.what());
+                        PushStatusLine(g_dbStatusLog, msg.str());
+                        RequestFooRefresh();
                     }
-                    g_refreshCV.notify_one();
                 }
 
                 ImGui::Separator();
 
+                // Background export of the displayed rows (the table shows progress/cancel)
+                if (ImGui::Button("Export CSV")) {
+                    g_asyncTable->ExportAsync("foo_export.csv", db::ExportFormat::Csv);
+                }
+                ImGui::SameLine();
+                if (ImGui::Button("Export Columnar")) {
+                    g_asyncTable->ExportAsync("foo_export.kscol", db::ExportFormat::Columnar);
+                }
+                if (auto job = g_asyncTable->GetExportJob(); job && job->IsFinished()) {
+                    ImGui::SameLine();
+                    if (job->GetState() == db::ExportJob::State::Failed) {
+                        ImGui::TextColored(ImVec4(1, 0.4f, 0.4f, 1), "Export failed: %s", job->GetError().c_str());
+                    } else {
+                        ImGui::TextDisabled("%s: %zu rows, %.1f ms", job->GetPath().c_str(), job->GetProcessed(),
+                                            job->GetElapsedMs());
+                    }
+                }
+
                 // Render the table (zero locks!)
                 g_asyncTable->Render();
 
+                if (g_fooFunView && ImGui::TreeNode("HasFun view (shares the rows above)")) {
+                    ImGui::TextDisabled("Second view of the same store: own filter, sort and selection, no row copies");
+                    g_fooFunView->Render();
+                    ImGui::TreePop();
+                }
+
             } else {
                 ImGui::TextColored(ImVec4(1, 0, 0, 1), "Async table not initialized");
             }
@@ -341,6 +455,19 @@ void Gui() {
                     g_multiIndexTable->Refresh();
                 }
                 ImGui::SameLine();
+                // Collapsible per-HasFun groups with count and ID range (this table refreshes on the GUI thread)
+                static bool groupByHasFun = false;
+                if (ImGui::Checkbox("Group by Has Fun", &groupByHasFun)) {
+                    if (groupByHasFun) {
+                        g_multiIndexTable->EnableGrouping(
+                            {2}, {{0, db::AggregateOp::Count}, {0, db::AggregateOp::Min}, {0, db::AggregateOp::Max}},
+                            MultiIndexRowKey);
+                    } else {
+                        g_multiIndexTable->DisableGrouping();
+                    }
+                    g_multiIndexTable->Refresh();
+                }
+                ImGui::SameLine();
                 if (ImGui::Button("Refresh Cache Table")) {
                     g_multiIndexTable->Refresh();
                 }
@@ -352,10 +479,10 @@ void Gui() {
                 if (miInsertCount > 10000) miInsertCount = 10000;
                 ImGui::SameLine();
                 if (ImGui::Button("Add Cache Rows")) {
-                    for (int i = 0; i < miInsertCount; ++i) {
-                        auto name = std::string(faker::person::fullName());
-                        bool hasFun = faker::number::integer(0, 1) == 1;
-                        g_multiIndexModel->Upsert(db::FooCacheEntry{static_cast<std::int64_t>(g_nextFooId++), name, hasFun});
+                    auto newRows = g_workload.GenerateFoo(g_nextFooId, static_cast<std::size_t>(miInsertCount));
+                    g_nextFooId += miInsertCount;
+                    for (auto& row : newRows) {
+                        g_multiIndexModel->Upsert(std::move(row));
                     }
                     g_multiIndexTable->Refresh();
                 }
@@ -365,9 +492,7 @@ void Gui() {
                 ImGui::InputInt("ID##mi_update", &miUpdateId);
                 ImGui::SameLine();
                 if (ImGui::Button("Upsert ID")) {
-                    auto name = std::string(faker::person::fullName());
-                    bool hasFun = faker::number::integer(0, 1) == 1;
-                    g_multiIndexModel->Upsert(db::FooCacheEntry{static_cast<std::int64_t>(miUpdateId), name, hasFun});
+                    g_multiIndexModel->Upsert(g_workload.MakeFoo(miUpdateId, g_workloadSeq++));
                     g_multiIndexTable->Refresh();
                 }
                 ImGui::SameLine();
@@ -391,13 +516,12 @@ void Gui() {
                 static std::string lastError;
 
                 if (ImGui::Button("Insert Random Row")) {
-                    auto name = std::string(faker::person::fullName());
-                    bool hasFun = faker::number::integer(0, 1) == 1;
+                    auto row = g_workload.MakeFoo(g_nextFooId++);
                     try {
                         DatabaseManager::Get().GetConnection()(sqlpp::insert_into(test_db::foo)
-                                                                   .set(test_db::foo.Id = g_nextFooId++,
-                                                                        test_db::foo.Name = name,
-                                                                        test_db::foo.HasFun = hasFun));
+                                                                   .set(test_db::foo.Id = row.id,
+                                                                        test_db::foo.Name = row.name,
+                                                                        test_db::foo.HasFun = row.hasFun));
                         lastError.clear();
                     } catch (const std::exception& e) {
                         lastError = e.what();
@@ -521,9 +645,8 @@ void Gui() {
                 ImGui::Separator();
 
                 if (ImGui::Button("Add Random Element")) {
-                    double price = faker::number::decimal(1.0, 500.0);
-                    long qty = faker::number::integer(1L, 1000L);
-                    g_reactiveCollection->push_back(price, qty);
+                    auto u = g_workload.MakeCollectionUpdate(g_workloadSeq++, 0);
+                    g_reactiveCollection->push_back(u.price, u.qty);
                     g_reactiveRefreshCV.notify_one();
                 }
                 ImGui::SameLine();
@@ -541,10 +664,10 @@ void Gui() {
                 if (rlInsertCount > 10000) rlInsertCount = 10000;
                 ImGui::SameLine();
                 if (ImGui::Button("Add Elements")) {
-                    for (int i = 0; i < rlInsertCount; i++) {
-                        double price = faker::number::decimal(1.0, 500.0);
-                        long qty = faker::number::integer(1L, 1000L);
-                        g_reactiveCollection->push_back(price, qty);
+                    auto updates = g_workload.GenerateCollectionUpdates(g_workloadSeq, static_cast<std::size_t>(rlInsertCount), 0);
+                    g_workloadSeq += static_cast<std::uint64_t>(rlInsertCount);
+                    for (const auto& u : updates) {
+                        g_reactiveCollection->push_back(u.price, u.qty);
                     }
                     g_reactiveRefreshCV.notify_one();
                 }
@@ -570,10 +693,9 @@ void Gui() {
                     }
                     // Update every Nth element starting from startRow index
                     for (int i = rlUpdateStartRow; i < static_cast<int>(ids.size()); i += rlUpdateModN) {
-                        double price = faker::number::decimal(1.0, 500.0);
-                        long qty = faker::number::integer(1L, 1000L);
-                        g_reactiveCollection->elem1Var(ids[i]).value(price);
-                        g_reactiveCollection->elem2Var(ids[i]).value(qty);
+                        auto u = g_workload.MakeCollectionUpdate(g_workloadSeq++, 0);
+                        g_reactiveCollection->elem1Var(ids[i]).value(u.price);
+                        g_reactiveCollection->elem2Var(ids[i]).value(u.qty);
                     }
                     g_reactiveRefreshCV.notify_one();
                 }
@@ -626,6 +748,7 @@ void Gui() {
             // Poll for new messages
             auto newMsgs = g_natsClient.PollMessages();
             for (const auto& m : newMsgs) {
+                db::Trace::Flow("nats", "message", 'f', m.traceId);
                 g_natsLog.push_back("[" + m.subject + "] " + m.data);
             }
 
@@ -654,103 +777,58 @@ int main(int, char**) {
     try {
         g_dbManager.GetConnection()("CREATE TABLE IF NOT EXISTS foo (id BIGINT, name TEXT, has_fun BOOLEAN)");
 
-        // Seed initial data using sqlpp23 + faker
-        for (int i = 1; i <= 5; i++) {
-            auto name = std::string(faker::person::fullName());
-            bool hasFun = faker::number::integer(0, 1) == 1;
+        // Seed initial data using sqlpp23 + the workload generator
+        for (const auto& row : g_workload.GenerateFoo(1, 5)) {
             g_dbManager.GetConnection()(sqlpp::insert_into(test_db::foo)
-                .set(test_db::foo.Id = i, test_db::foo.Name = name, test_db::foo.HasFun = hasFun));
+                .set(test_db::foo.Id = row.id, test_db::foo.Name = row.name, test_db::foo.HasFun = row.hasFun));
         }
     } catch (const std::exception& e) {
         PushUiError("Database seed failed", e);
         PushStatusLine(g_dbStatusLog, std::string("Database seed failed: ") + e.what());
     }
 
-    // Setup Async Table Widget
-    g_asyncTable = std::make_unique<db::AsyncTableWidget>();
-    g_asyncTable->AddColumn("ID", 80.0f);
-    g_asyncTable->AddColumn("Name", 200.0f);
-    g_asyncTable->AddColumn("Has Fun", 100.0f);
-    g_asyncTable->EnableFilter(true);
-    g_asyncTable->EnableSelection(true);
-
-    // Set refresh callback (Uses sqlpp23 directly with type erasure!)
-    // Define a simple struct to hold typed data
-    struct FooTypedData {
-        int64_t id;
-        std::string name;
-        bool hasFun;
-    };
-
-    g_asyncTable->SetRefreshCallback([](auto& rows) {
-        DatabaseManager& db = DatabaseManager::Get();
-
-        // Execute query - get sqlpp23 result
-        auto results = db.GetConnection()(sqlpp::select(sqlpp::all_of(test_db::foo)).from(test_db::foo));
-
-        // Convert sqlpp23 rows with TYPE ERASURE (no FooRepository!)
-        for (const auto& sqlppRow : results) {
-            // Extract typed values from sqlpp23 row
-            int64_t id = sqlppRow.Id;
-            std::string name{sqlppRow.Name}; // string_view -> string
-            bool hasFun = sqlppRow.HasFun;
-
-            // Create typed data holder
-            FooTypedData typedData{id, name, hasFun};
-
-            // Create row with BOTH strings (for display) and typed data (for sorting)
-            rows.push_back({
-                {std::to_string(id), name, hasFun ? "Yes" : "No"}, // columns
-                typedData                                          // userData - MANDATORY!
-            });
-        }
-    });
-
-    // NEW: Set typed extractors for type-safe sorting!
-    // Extract int64 ID for accurate numeric sorting
-    g_asyncTable->SetColumnTypedExtractor(0, [](const db::AsyncTableWidget::Row& row) -> std::any {
-        if (!row.userData.has_value()) return {};
-        try {
-            auto& data = std::any_cast<const FooTypedData&>(row.userData);
-            return std::any(data.id);
-        } catch (const std::bad_any_cast&) {
-            return {};
-        }
+    // One query feeds a shared row store; rows are decoded straight from the result set
+    // into FooCodec::Row (stored as userData)
+    g_fooStore = std::make_shared<db::SharedRowStore>();
+    g_fooStore->SetPerfName("Foo Row Store (SQL)");
+    g_fooStore->SetRefreshCallback([](auto& rows) {
+        FooCodec::Query(DatabaseManager::Get().GetRawHandle(), rows);
     });
 
-    // Extract string for Name column (enables multi-column sort)
-    g_asyncTable->SetColumnTypedExtractor(1, [](const db::AsyncTableWidget::Row& row) -> std::any {
-        if (!row.userData.has_value()) return {};
-        try {
-            auto& data = std::any_cast<const FooTypedData&>(row.userData);
-            return std::any(data.name);
-        } catch (const std::bad_any_cast&) {
-            return {};
-        }
+    // Setup Async Table Widget: columns, headers and typed sort keys come from the sqlpp23 schema.
+    // Both widgets are views of g_fooStore: each owns only its sort permutation, filter and selection.
+    g_asyncTable = std::make_unique<db::AsyncTableWidget>();
+    g_asyncTable->SetPerfName("Async Table (SQL)");
+    FooCodec::ConfigureAsyncTableColumns(*g_asyncTable);
+    g_fooStore->AttachView(*g_asyncTable);
+
+    g_fooFunView = std::make_unique<db::AsyncTableWidget>();
+    g_fooFunView->SetPerfName("Async Table (SQL, HasFun view)");
+    FooCodec::ConfigureAsyncTableColumns(*g_fooFunView);
+    g_fooStore->AttachView(*g_fooFunView);
+    g_fooFunView->SetRowFilter([](const db::AsyncTableWidget::Row& row) {
+        const auto* data = std::any_cast<FooCodec::Row>(&row.userData);
+        return data && data->get<test_db::Foo_::HasFun>();
     });
+    g_fooFunView->SetSort(1, ImGuiSortDirection_Ascending); // by name
 
-    // Extract bool for HasFun column
-    g_asyncTable->SetColumnTypedExtractor(2, [](const db::AsyncTableWidget::Row& row) -> std::any {
-        if (!row.userData.has_value()) return {};
-        try {
-            auto& data = std::any_cast<const FooTypedData&>(row.userData);
-            return std::any(data.hasFun);
-        } catch (const std::bad_any_cast&) {
-            return {};
-        }
-    });
+    // Views re-sort on the refresh thread; wake it so a header click applies immediately
+    g_asyncTable->SetSortChangedCallback([] { g_refreshCV.notify_one(); });
+    g_fooFunView->SetSortChangedCallback([] { g_refreshCV.notify_one(); });
 
     // Initial load
+    g_fooStore->Refresh();
     g_asyncTable->Refresh();
+    g_fooFunView->Refresh();
 
     // Setup Multi-index LRU AsyncTable model/widget
     g_multiIndexModel = std::make_unique<db::FooMultiIndexTableModel>(5000);
-    for (int i = 0; i < 5; ++i) {
-        auto name = std::string(faker::person::fullName());
-        bool hasFun = faker::number::integer(0, 1) == 1;
-        g_multiIndexModel->Upsert(db::FooCacheEntry{static_cast<std::int64_t>(i + 1), name, hasFun});
+    g_multiIndexModel->SetPerfName("Foo Multi-Index Model");
+    for (auto& row : g_workload.GenerateFoo(1, 5)) {
+        g_multiIndexModel->Upsert(std::move(row));
     }
     g_multiIndexTable = std::make_unique<db::AsyncTableWidget>();
+    g_multiIndexTable->SetPerfName("Multi-Index Table");
     db::FooMultiIndexTableModel::ConfigureAsyncTableColumns(*g_multiIndexTable);
     SyncMultiIndexQueryFromUi();
     g_multiIndexTable->SetRefreshCallback([](auto& rows) {
@@ -758,32 +836,47 @@ int main(int, char**) {
             g_multiIndexModel->BuildAsyncRows(rows, g_multiIndexQuery);
         }
     });
+    // "Refresh Cache Table" with no writes and the same query is a no-op (both counters only grow)
+    g_multiIndexTable->SetRefreshVersionCallback([] {
+        return (g_multiIndexModel ? g_multiIndexModel->GetGeneration() : 0) + g_multiIndexQueryRevision;
+    });
+    // "Upsert ID" flashes the cells it changed
+    g_multiIndexTable->EnableChangeHighlight(MultiIndexRowKey, 1.5f);
     g_multiIndexTable->Refresh();
 
     // Start background refresh thread (every 3 seconds, or on manual trigger)
     g_refreshRunning = true;
     g_refreshThread = std::thread([]() {
+        db::Trace::SetThreadName("async table refresh");
         while (g_refreshRunning) {
+            bool timedOut = false;
             {
                 std::unique_lock<std::mutex> lock(g_refreshMutex);
-                g_refreshCV.wait_for(lock, std::chrono::seconds(3));
+                timedOut = g_refreshCV.wait_for(lock, std::chrono::seconds(3)) == std::cv_status::timeout;
             }
             if (!g_refreshRunning) break;
+            if (g_fooStoreDirty.exchange(false) || timedOut) {
+                g_fooStore->Refresh();
+            }
+            // No-ops unless the store snapshot, sort or filter changed
             if (g_asyncTable) {
                 g_asyncTable->Refresh();
             }
+            if (g_fooFunView) {
+                g_fooFunView->Refresh();
+            }
         }
     });
 
     // Setup Reactive List Widget (phmap-backed collection)
     g_reactiveCollection = std::make_unique<DemoCollection>();
-    for (int i = 0; i < 5; i++) {
-        double price = faker::number::decimal(1.0, 500.0);
-        long qty = faker::number::integer(1L, 1000L);
-        g_reactiveCollection->push_back(price, qty);
+    for (const auto& u : g_workload.GenerateCollectionUpdates(g_workloadSeq, 5, 0)) {
+        g_reactiveCollection->push_back(u.price, u.qty);
     }
+    g_workloadSeq += 5;
 
     g_reactiveList = std::make_unique<db::ReactiveListWidget<DemoCollection>>();
+    g_reactiveList->SetPerfName("Reactive List");
     g_reactiveList->SetColumnHeaders("ID", "Price", "Quantity");
     g_reactiveList->SetColumnWidths(60.0f, 120.0f, 120.0f);
     g_reactiveList->EnableFilter(true);
@@ -793,6 +886,11 @@ int main(int, char**) {
         oss << std::fixed << std::setprecision(2) << v;
         return oss.str();
     });
+    // Large quantities and price outliers, evaluated once per refresh instead of per frame
+    g_reactiveList->SetStyleRules({
+        db::StyleRule::Above(2, 900.0, IM_COL32(40, 90, 50, 255)),
+        db::StyleRule::Below(1, 20.0, 0, IM_COL32(255, 140, 120, 255)),
+    });
 
     // Initial snapshot
     g_reactiveList->Refresh(*g_reactiveCollection);
@@ -800,6 +898,7 @@ int main(int, char**) {
     // Background refresh thread (1-second interval)
     g_reactiveRefreshRunning = true;
     g_reactiveRefreshThread = std::thread([]() {
+        db::Trace::SetThreadName("reactive list refresh");
         while (g_reactiveRefreshRunning) {
             {
                 std::unique_lock<std::mutex> lock(g_reactiveRefreshMutex);
@@ -812,6 +911,17 @@ int main(int, char**) {
         }
     });
 
+    // Register diagnostics for the Performance HUD (component timers are named where each is
+    // created, before its first Refresh, since the refresh threads read them)
+    auto& perf = db::PerfRegistry::Get();
+    perf.Polled("Queues", "NATS incoming", [] { return static_cast<double>(g_natsClient.GetQueueDepth()); });
+    perf.Polled("Caches", "Foo multi-index entries", [] {
+        return g_multiIndexModel ? static_cast<double>(g_multiIndexModel->Size()) : 0.0;
+    });
+    perf.Polled("Caches", "Reactive collection entries", [] {
+        return g_reactiveCollection ? static_cast<double>(g_reactiveCollection->size()) : 0.0;
+    });
+
     // ImmApp handles the setup of HelloImGui, ImGui, Implot, etc.
     HelloImGui::RunnerParams runnerParams;
     runnerParams.callbacks.ShowGui = Gui;
@@ -894,16 +1004,24 @@ int main(int, char**) {
         g_refreshThread.join();
     }
     g_asyncTable.reset();
+    g_fooFunView.reset();
+    g_fooStore.reset();
 
     g_reactiveRefreshRunning = false;
     g_reactiveRefreshCV.notify_one();
     if (g_reactiveRefreshThread.joinable()) {
         g_reactiveRefreshThread.join();
     }
+    perf.Unregister("Caches", "Foo multi-index entries");
+    perf.Unregister("Caches", "Reactive collection entries");
     g_reactiveList.reset();
     g_reactiveCollection.reset();
     g_multiIndexTable.reset();
     g_multiIndexModel.reset();
 
+    if constexpr (db::kLockProfilingEnabled) {
+        std::cout << "Lock contention:\n" << db::LockProfiler::Get().Report(5);
+    }
+
     return 0;
 }
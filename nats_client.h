@@ -7,10 +7,13 @@
 #include <atomic>
 #include <queue>
 #include <thread>
+#include <cstdint>
+#include "database/lock_profiler.h"
 
 struct NatsMessage {
     std::string subject;
     std::string data;
+    uint64_t traceId = 0; // flow id linking receive -> poll -> apply in traces (0 = untraced)
 };
 
 class NatsClient {
@@ -29,6 +32,10 @@ public:
     std::vector<NatsMessage> PollMessages();
     void PushMessage(const std::string& subject, const std::string& data);
 
+    // Diagnostics (lock-free reads, safe from any thread)
+    size_t GetQueueDepth() const;
+    uint64_t GetReceivedCount() const;
+
     std::string GetConnectionStatus() const;
     std::string GetLastError() const;
 
@@ -39,12 +46,14 @@ private:
     std::atomic<bool> m_connected{false};
     std::atomic<bool> m_stopRequested{false};
 
-    mutable std::mutex m_stateMutex;
+    mutable db::ProfiledMutex m_stateMutex{"NatsClient::m_stateMutex"};
     std::string m_lastError;
     std::string m_status = "Disconnected";
     void* m_nativeData = nullptr;
     std::thread m_connectThread;
 
-    std::mutex m_messageMutex;
+    db::ProfiledMutex m_messageMutex{"NatsClient::m_messageMutex"};
     std::queue<NatsMessage> m_incomingMessages;
+    std::atomic<size_t> m_queueDepth{0};
+    std::atomic<uint64_t> m_receivedCount{0};
 };
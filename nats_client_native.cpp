@@ -1,5 +1,6 @@
 #ifndef __EMSCRIPTEN__
 #include "nats_client.h"
+#include "database/trace.h"
 #include <nats/nats.h>
 #include <iostream>
 #include <thread>
@@ -34,7 +35,7 @@ NatsClient::~NatsClient() {
 
 bool NatsClient::Connect(const std::string& url) {
     if (url.empty()) {
-        std::lock_guard<std::mutex> lock(m_stateMutex);
+        std::lock_guard<db::ProfiledMutex> lock(m_stateMutex);
         m_status = "Failed";
         m_lastError = "NATS URL cannot be empty";
         m_connected.store(false, std::memory_order_release);
@@ -45,7 +46,7 @@ bool NatsClient::Connect(const std::string& url) {
     Disconnect();
 
     {
-        std::lock_guard<std::mutex> lock(m_stateMutex);
+        std::lock_guard<db::ProfiledMutex> lock(m_stateMutex);
         m_status = "Connecting...";
         m_lastError = "";
     }
@@ -74,7 +75,7 @@ bool NatsClient::Connect(const std::string& url) {
             auto nd = std::make_unique<NativeData>();
             nd->conn = conn;
             {
-                std::lock_guard<std::mutex> lock(m_stateMutex);
+                std::lock_guard<db::ProfiledMutex> lock(m_stateMutex);
                 if (m_stopRequested.load(std::memory_order_acquire)) {
                     // Disconnect won during connect setup; drop this connection.
                     if (nd->conn) {
@@ -89,7 +90,7 @@ bool NatsClient::Connect(const std::string& url) {
             }
         } else {
             {
-                std::lock_guard<std::mutex> lock(m_stateMutex);
+                std::lock_guard<db::ProfiledMutex> lock(m_stateMutex);
                 if (!m_stopRequested.load(std::memory_order_acquire)) {
                     m_status = "Failed";
                     m_lastError = natsStatus_GetText(s);
@@ -106,22 +107,22 @@ bool NatsClient::Connect(const std::string& url) {
 }
 
 std::string NatsClient::GetConnectionStatus() const {
-    std::lock_guard<std::mutex> lock(m_stateMutex);
+    std::lock_guard<db::ProfiledMutex> lock(m_stateMutex);
     return m_status;
 }
 
 std::string NatsClient::GetLastError() const {
-    std::lock_guard<std::mutex> lock(m_stateMutex);
+    std::lock_guard<db::ProfiledMutex> lock(m_stateMutex);
     return m_lastError;
 }
 
 void NatsClient::UpdateStatus(const std::string& status) {
-    std::lock_guard<std::mutex> lock(m_stateMutex);
+    std::lock_guard<db::ProfiledMutex> lock(m_stateMutex);
     m_status = status;
 }
 
 void NatsClient::UpdateError(const std::string& error) {
-    std::lock_guard<std::mutex> lock(m_stateMutex);
+    std::lock_guard<db::ProfiledMutex> lock(m_stateMutex);
     m_lastError = error;
 }
 
@@ -131,7 +132,7 @@ void NatsClient::Disconnect() {
         m_connectThread.join();
     }
 
-    std::lock_guard<std::mutex> lock(m_stateMutex);
+    std::lock_guard<db::ProfiledMutex> lock(m_stateMutex);
     if (m_nativeData) {
         NativeData* nd = (NativeData*)m_nativeData;
         for (auto sub : nd->subs) {
@@ -154,7 +155,7 @@ bool NatsClient::IsConnected() const {
 
 void NatsClient::Subscribe(const std::string& subject) {
     if (!m_connected.load(std::memory_order_acquire)) return;
-    std::lock_guard<std::mutex> lock(m_stateMutex);
+    std::lock_guard<db::ProfiledMutex> lock(m_stateMutex);
     if (!m_nativeData) return;
     NativeData* nd = (NativeData*)m_nativeData;
     natsSubscription* sub = nullptr;
@@ -166,25 +167,41 @@ void NatsClient::Subscribe(const std::string& subject) {
 
 void NatsClient::Publish(const std::string& subject, const std::string& data) {
     if (!m_connected.load(std::memory_order_acquire)) return;
-    std::lock_guard<std::mutex> lock(m_stateMutex);
+    std::lock_guard<db::ProfiledMutex> lock(m_stateMutex);
     if (!m_nativeData) return;
     NativeData* nd = (NativeData*)m_nativeData;
     natsConnection_PublishString(nd->conn, subject.c_str(), data.c_str());
 }
 
 void NatsClient::PushMessage(const std::string& subject, const std::string& data) {
-    std::lock_guard<std::mutex> lock(m_messageMutex);
-    m_incomingMessages.push({subject, data});
+    KS_TRACE_SCOPE("nats", "PushMessage", subject);
+    uint64_t traceId = db::Trace::Enabled() ? db::Trace::NextFlowId() : 0;
+    db::Trace::Flow("nats", "message", 's', traceId);
+    std::lock_guard<db::ProfiledMutex> lock(m_messageMutex);
+    m_incomingMessages.push({subject, data, traceId});
+    m_queueDepth.store(m_incomingMessages.size(), std::memory_order_relaxed);
+    m_receivedCount.fetch_add(1, std::memory_order_relaxed);
 }
 
 std::vector<NatsMessage> NatsClient::PollMessages() {
-    std::lock_guard<std::mutex> lock(m_messageMutex);
+    KS_TRACE_SCOPE("nats", "PollMessages");
+    std::lock_guard<db::ProfiledMutex> lock(m_messageMutex);
     std::vector<NatsMessage> msgs;
     while (!m_incomingMessages.empty()) {
-        msgs.push_back(m_incomingMessages.front());
+        db::Trace::Flow("nats", "message", 't', m_incomingMessages.front().traceId);
+        msgs.push_back(std::move(m_incomingMessages.front()));
         m_incomingMessages.pop();
     }
+    m_queueDepth.store(0, std::memory_order_relaxed);
     return msgs;
 }
 
+size_t NatsClient::GetQueueDepth() const {
+    return m_queueDepth.load(std::memory_order_relaxed);
+}
+
+uint64_t NatsClient::GetReceivedCount() const {
+    return m_receivedCount.load(std::memory_order_relaxed);
+}
+
 #endif
@@ -1,5 +1,6 @@
 #ifdef __EMSCRIPTEN__
 #include "nats_client.h"
+#include "database/trace.h"
 #include <emscripten.h>
 #include <iostream>
 
@@ -199,7 +200,7 @@ NatsClient::~NatsClient() {
 
 bool NatsClient::Connect(const std::string& url) {
     if (url.empty()) {
-        std::lock_guard<std::mutex> lock(m_stateMutex);
+        std::lock_guard<db::ProfiledMutex> lock(m_stateMutex);
         m_status = "Failed";
         m_lastError = "NATS URL cannot be empty";
         m_connected.store(false, std::memory_order_release);
@@ -207,7 +208,7 @@ bool NatsClient::Connect(const std::string& url) {
     }
 
     {
-        std::lock_guard<std::mutex> lock(m_stateMutex);
+        std::lock_guard<db::ProfiledMutex> lock(m_stateMutex);
         m_status = "Connecting...";
         m_lastError = "";
     }
@@ -219,7 +220,7 @@ bool NatsClient::Connect(const std::string& url) {
 void NatsClient::Disconnect() {
     nats_disconnect_js();
     m_connected.store(false, std::memory_order_release);
-    std::lock_guard<std::mutex> lock(m_stateMutex);
+    std::lock_guard<db::ProfiledMutex> lock(m_stateMutex);
     m_status = "Disconnected";
 }
 
@@ -228,25 +229,25 @@ bool NatsClient::IsConnected() const {
 }
 
 std::string NatsClient::GetConnectionStatus() const {
-    std::lock_guard<std::mutex> lock(m_stateMutex);
+    std::lock_guard<db::ProfiledMutex> lock(m_stateMutex);
     return m_status;
 }
 
 std::string NatsClient::GetLastError() const {
-    std::lock_guard<std::mutex> lock(m_stateMutex);
+    std::lock_guard<db::ProfiledMutex> lock(m_stateMutex);
     return m_lastError;
 }
 
 void NatsClient::UpdateStatus(const std::string& status) {
     {
-        std::lock_guard<std::mutex> lock(m_stateMutex);
+        std::lock_guard<db::ProfiledMutex> lock(m_stateMutex);
         m_status = status;
     }
     m_connected.store(status == "Connected", std::memory_order_release);
 }
 
 void NatsClient::UpdateError(const std::string& error) {
-    std::lock_guard<std::mutex> lock(m_stateMutex);
+    std::lock_guard<db::ProfiledMutex> lock(m_stateMutex);
     m_lastError = error;
 }
 
@@ -259,18 +260,34 @@ void NatsClient::Publish(const std::string& subject, const std::string& data) {
 }
 
 void NatsClient::PushMessage(const std::string& subject, const std::string& data) {
-    std::lock_guard<std::mutex> lock(m_messageMutex);
-    m_incomingMessages.push({subject, data});
+    KS_TRACE_SCOPE("nats", "PushMessage", subject);
+    uint64_t traceId = db::Trace::Enabled() ? db::Trace::NextFlowId() : 0;
+    db::Trace::Flow("nats", "message", 's', traceId);
+    std::lock_guard<db::ProfiledMutex> lock(m_messageMutex);
+    m_incomingMessages.push({subject, data, traceId});
+    m_queueDepth.store(m_incomingMessages.size(), std::memory_order_relaxed);
+    m_receivedCount.fetch_add(1, std::memory_order_relaxed);
 }
 
 std::vector<NatsMessage> NatsClient::PollMessages() {
-    std::lock_guard<std::mutex> lock(m_messageMutex);
+    KS_TRACE_SCOPE("nats", "PollMessages");
+    std::lock_guard<db::ProfiledMutex> lock(m_messageMutex);
     std::vector<NatsMessage> msgs;
     while (!m_incomingMessages.empty()) {
-        msgs.push_back(m_incomingMessages.front());
+        db::Trace::Flow("nats", "message", 't', m_incomingMessages.front().traceId);
+        msgs.push_back(std::move(m_incomingMessages.front()));
         m_incomingMessages.pop();
     }
+    m_queueDepth.store(0, std::memory_order_relaxed);
     return msgs;
 }
 
+size_t NatsClient::GetQueueDepth() const {
+    return m_queueDepth.load(std::memory_order_relaxed);
+}
+
+uint64_t NatsClient::GetReceivedCount() const {
+    return m_receivedCount.load(std::memory_order_relaxed);
+}
+
 #endif
@@ -0,0 +1,174 @@
+#include "database/async_table_widget.h"
+#include "database/schemas/table_foo.h"
+#include "database/table_codec.h"
+
+#include <sqlite3.h>
+
+#include <atomic>
+#include <any>
+#include <functional>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using FooCodec = db::TableCodec<test_db::Foo_>;
+
+static db::AsyncTableWidget::Row MakeRow(int64_t id) {
+    return {{std::to_string(id)}, std::any(id)};
+}
+
+static bool WaitFor(const std::function<bool()>& predicate) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+static int64_t IdAt(const std::vector<db::AsyncTableWidget::Row>& rows, size_t i) {
+    return std::any_cast<const FooCodec::Row&>(rows[i].userData).get<test_db::Foo_::Id>();
+}
+
+int main() {
+    // 1) Rows become visible before the producer finishes
+    {
+        db::AsyncTableWidget widget;
+        widget.AddColumn("ID");
+        std::atomic<bool> release{false};
+        widget.SetStreamingRefreshCallback([&](db::AsyncTableWidget::StreamSink& sink) {
+            sink.Push(MakeRow(1));
+            while (!release.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            for (int64_t i = 2; i <= 100; i++) sink.Push(MakeRow(i));
+        }, 16);
+        std::thread worker([&] { widget.Refresh(); });
+        bool sawFirstRow = WaitFor([&] { return widget.GetRowCount() == 1; });
+        bool streaming = widget.IsStreaming();
+        release = true;
+        worker.join();
+        if (!sawFirstRow || !streaming) return 1;
+        if (widget.GetRowCount() != 100 || widget.IsStreaming()) return 2;
+    }
+
+    // 2) CancelStreaming stops the producer; the next refresh completes
+    {
+        db::AsyncTableWidget widget;
+        widget.AddColumn("ID");
+        std::atomic<bool> cancelled{false};
+        bool endless = true;
+        widget.SetStreamingRefreshCallback([&](db::AsyncTableWidget::StreamSink& sink) {
+            for (int64_t i = 0; endless || i < 10; i++) {
+                if (sink.Cancelled()) {
+                    cancelled = true;
+                    return;
+                }
+                sink.Push(MakeRow(i));
+                if (endless) std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        });
+        std::thread worker([&] { widget.Refresh(); });
+        bool sawRows = WaitFor([&] { return widget.GetRowCount() > 0; });
+        widget.CancelStreaming();
+        worker.join();
+        if (!sawRows || !cancelled) return 3;
+        endless = false;
+        widget.Refresh();
+        if (widget.GetRowCount() != 10 || widget.IsStreaming()) return 4;
+    }
+
+    // 3) SQLite: ORDER BY pushed down from the sort specs, plus cancellation mid-query
+    {
+        sqlite3* conn = nullptr;
+        if (sqlite3_open(":memory:", &conn) != SQLITE_OK) return 5;
+        sqlite3_exec(conn,
+                     "CREATE TABLE foo (id BIGINT, name TEXT, has_fun BOOLEAN);"
+                     "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 200000) "
+                     "INSERT INTO foo SELECT i, 'name' || ((i * 7919) % 200000), i % 2 FROM n;",
+                     nullptr, nullptr, nullptr);
+
+        db::AsyncTableWidget widget;
+        FooCodec::ConfigureAsyncTableColumns(widget);
+        widget.SetStreamingRefreshCallback([conn](auto& sink) { FooCodec::Stream(conn, sink, " WHERE id <= 1000"); });
+        widget.SetSort(0, ImGuiSortDirection_Descending);
+        widget.Refresh();
+        if (widget.GetRowCount() != 1000) return 6;
+        int64_t expected = 1000;
+        bool descending = true;
+        widget.ForEachRow([&](const db::AsyncTableWidget::Row& row) {
+            descending = descending && std::any_cast<const FooCodec::Row&>(row.userData).get<0>() == expected--;
+        });
+        if (!descending) return 6;
+
+        // Cancelled between rows
+        bool finished = true;
+        size_t produced = 0;
+        widget.SetStreamingRefreshCallback([&](auto& sink) {
+            finished = db::StreamQuery(conn, FooCodec::SelectSql(), sink, [&](sqlite3_stmt* stmt) {
+                if (++produced == 10) widget.CancelStreaming();
+                FooCodec::Row row;
+                FooCodec::ReadRow(stmt, row);
+                return FooCodec::ToAsyncRow(std::move(row));
+            });
+        });
+        widget.Refresh();
+        if (finished || produced != 10) return 7;
+
+        // Cancelled inside a step (unindexed ORDER BY sorts before the first row)
+        widget.SetStreamingRefreshCallback([&](auto& sink) {
+            widget.CancelStreaming();
+            finished = FooCodec::Stream(conn, sink);
+        });
+        widget.SetSort(1, ImGuiSortDirection_Ascending);
+        widget.Refresh();
+        if (finished) return 8;
+
+        // Cancelling must not leave the progress handler installed
+        std::vector<db::AsyncTableWidget::Row> rows;
+        FooCodec::Query(conn, rows, " WHERE id <= 3 ORDER BY id DESC");
+        if (rows.size() != 3 || IdAt(rows, 0) != 3 || IdAt(rows, 2) != 1) return 9;
+        sqlite3_close(conn);
+    }
+
+    // 4) In-memory sort of the finished stream when the source is unordered
+    {
+        db::AsyncTableWidget widget;
+        widget.AddColumn("ID");
+        widget.SetColumnTypedExtractor(0, [](const db::AsyncTableWidget::Row& row) { return row.userData; });
+        widget.SetStreamingRefreshCallback([](db::AsyncTableWidget::StreamSink& sink) {
+            for (int64_t id : {5, 1, 4, 2, 3}) sink.Push(MakeRow(id));
+        }, 2);
+        widget.SetSort(0, ImGuiSortDirection_Ascending);
+        widget.Refresh();
+        std::vector<int64_t> ids;
+        widget.ForEachRow([&](const db::AsyncTableWidget::Row& row) { ids.push_back(std::any_cast<int64_t>(row.userData)); });
+        if (ids != std::vector<int64_t>{1, 2, 3, 4, 5}) return 10;
+    }
+
+    // 5) A refresh keeps the previous complete result up until the new stream catches up
+    {
+        db::AsyncTableWidget widget;
+        widget.AddColumn("ID");
+        int64_t total = 100;
+        bool shrank = false;
+        widget.SetStreamingRefreshCallback([&](db::AsyncTableWidget::StreamSink& sink) {
+            for (int64_t i = 0; i < total; i++) {
+                sink.Push(MakeRow(i));
+                if (widget.GetRowCount() < 100) shrank = true;
+            }
+        }, 4);
+        widget.Refresh(); // nothing displayed yet: streams in from the first row
+        if (widget.GetRowCount() != 100 || !shrank) return 11;
+        shrank = false;
+        total = 150;
+        widget.Refresh();
+        if (shrank || widget.GetRowCount() != 150) return 12;
+
+        // A smaller result replaces the old one when it completes
+        total = 40;
+        widget.Refresh();
+        if (shrank || widget.GetRowCount() != 40 || widget.IsStreaming()) return 13;
+    }
+
+    return 0;
+}
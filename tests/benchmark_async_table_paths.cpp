@@ -1,11 +1,31 @@
+// Parametric benchmark for the two table data paths: SQLite (prepare/step/format, as the
+// async widget does) and the in-memory MarketDataMultiIndexTableModel::BuildAsyncRows.
+//
+// Every case is run for each dataset size and path; results are JSON lines
+// ({"case":..., "path":..., "rows":..., "p50_ms":..., "p99_ms":...}) so runs can be stored
+// as baselines and compared:
+//
+//   benchmark_async_table_paths --sizes 10000,100000,1000000 --output base.jsonl
+//   benchmark_async_table_paths --sizes 10000,100000,1000000 --baseline base.jsonl --threshold 0.15
+//
+// With --baseline the exit code is 3 when any case's p50 or p99 regressed by more than the
+// threshold (and by more than --min-delta-ms, to ignore jitter on sub-millisecond cases).
+
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <map>
 #include <numeric>
-#include <random>
+#include <optional>
+#include <sstream>
 #include <string>
+#include <variant>
 #include <vector>
 
 #include <sqlite3.h>
@@ -13,24 +33,66 @@
 
 #include "database/async_table_widget.h"
 #include "database/market_data_multi_index_table_model.h"
+#include "database/workload_generator.h"
 
 namespace {
 
-struct BenchRow {
-    std::int64_t id{};
-    std::string symbol;
-    std::string venue;
-    std::int64_t ts{};
-    double price{};
+using Order = db::MarketDataMultiIndexTableModel::Order;
+
+/// One query shape, expressed once and translated to both paths
+struct BenchCase {
+    std::string name{};
+    std::optional<std::string> symbol{};
+    std::optional<std::string> venue{};
+    std::optional<double> tsWindow{};  // fraction of the ts range (centered), e.g. 0.01
+    std::optional<std::pair<double, double>> priceQuantiles{}; // price band as dataset quantiles
+    Order order = Order::TsDesc;
+    std::size_t offset = 0;
+    std::size_t limit = 2000;
+};
+
+std::vector<BenchCase> DefaultCases() {
+    std::vector<BenchCase> cases;
+    auto add = [&](BenchCase c) { cases.push_back(std::move(c)); };
+    // Selectivity: indexed equality filters narrowing from everything to one (symbol, venue)
+    add({.name = "sym_venue/ts_desc", .symbol = "NVDA", .venue = "XNAS"});
+    add({.name = "sym_venue/ts_asc", .symbol = "NVDA", .venue = "XNAS", .order = Order::TsAsc});
+    add({.name = "sym_venue_ts1pct/ts_desc", .symbol = "NVDA", .venue = "XNAS", .tsWindow = 0.01});
+    add({.name = "symbol/ts_desc", .symbol = "NVDA"});
+    add({.name = "venue/ts_desc", .venue = "XNAS"});
+    add({.name = "none/ts_desc"});
+    // Filter types: range on a non-key column with and without a matching order
+    add({.name = "price_band/price_asc", .priceQuantiles = std::make_pair(0.45, 0.55), .order = Order::PriceAsc});
+    add({.name = "price_band/ts_desc", .priceQuantiles = std::make_pair(0.45, 0.55)});
+    // Orders
+    add({.name = "none/price_desc", .order = Order::PriceDesc});
+    add({.name = "none/symbol_asc", .order = Order::SymbolAsc});
+    // Offset depth (pagination far from the head)
+    add({.name = "sym_venue/ts_desc/offset10k", .symbol = "NVDA", .venue = "XNAS", .offset = 10000});
+    add({.name = "none/ts_desc/offset100k", .offset = 100000});
+    return cases;
+}
+
+struct Options {
+    std::vector<std::size_t> sizes = {10000, 100000, 1000000};
+    int warmup = 2;
+    int iterations = 15;
+    bool runSqlite = true;
+    bool runMultiIndex = true;
+    std::string caseFilter; // substring match on case name
+    std::string outputPath; // empty = stdout
+    std::string baselinePath;
+    double threshold = 0.10;
+    double minDeltaMs = 0.05;
 };
 
-struct QuerySpec {
-    std::string symbol;
-    std::string venue;
-    std::int64_t minTs{};
-    std::int64_t maxTs{};
-    std::size_t limit{};
-    std::size_t offset{};
+struct Result {
+    std::string caseName;
+    std::string path;
+    std::size_t rows = 0;
+    int iterations = 0;
+    std::size_t resultRows = 0;
+    double p50 = 0, p99 = 0, mean = 0, min = 0, max = 0;
 };
 
 void CheckSqlite(int rc, sqlite3* db, const char* where) {
@@ -41,27 +103,103 @@ void CheckSqlite(int rc, sqlite3* db, const char* where) {
     throw std::runtime_error(msg);
 }
 
-void BuildRowsFromSqlite(sqlpp::sqlite3::connection& conn,
-                         const QuerySpec& query,
-                         std::vector<db::AsyncTableWidget::Row>& out) {
-    out.clear();
-    sqlite3* db = conn.native_handle();
+// ---- SQLite path -------------------------------------------------------------------------
 
-    static constexpr const char* kSql =
-        "SELECT id, symbol, venue, ts, price "
-        "FROM market_ticks "
-        "WHERE symbol = ?1 AND venue = ?2 AND ts >= ?3 AND ts <= ?4 "
-        "ORDER BY ts DESC LIMIT ?5 OFFSET ?6;";
+using SqlParam = std::variant<std::int64_t, double, std::string>;
 
-    sqlite3_stmt* stmt = nullptr;
-    CheckSqlite(sqlite3_prepare_v2(db, kSql, -1, &stmt, nullptr), db, "sqlite3_prepare_v2");
+struct SqlQuery {
+    std::string sql;
+    std::vector<SqlParam> params;
+};
 
-    CheckSqlite(sqlite3_bind_text(stmt, 1, query.symbol.c_str(), -1, SQLITE_TRANSIENT), db, "bind symbol");
-    CheckSqlite(sqlite3_bind_text(stmt, 2, query.venue.c_str(), -1, SQLITE_TRANSIENT), db, "bind venue");
-    CheckSqlite(sqlite3_bind_int64(stmt, 3, query.minTs), db, "bind minTs");
-    CheckSqlite(sqlite3_bind_int64(stmt, 4, query.maxTs), db, "bind maxTs");
-    CheckSqlite(sqlite3_bind_int64(stmt, 5, static_cast<sqlite3_int64>(query.limit)), db, "bind limit");
-    CheckSqlite(sqlite3_bind_int64(stmt, 6, static_cast<sqlite3_int64>(query.offset)), db, "bind offset");
+/// Dataset facts the relative filters (ts window, price quantiles) resolve against
+struct DatasetInfo {
+    std::int64_t minTs = 0;
+    std::int64_t maxTs = 0;
+    std::vector<double> sortedPrices;
+
+    explicit DatasetInfo(const std::vector<db::MarketDataCacheEntry>& rows) {
+        minTs = rows.front().ts;
+        maxTs = rows.back().ts;
+        sortedPrices.reserve(rows.size());
+        for (const auto& r : rows) sortedPrices.push_back(r.price);
+        std::sort(sortedPrices.begin(), sortedPrices.end());
+    }
+
+    double PriceQuantile(double q) const {
+        const auto idx = static_cast<std::size_t>(q * static_cast<double>(sortedPrices.size() - 1));
+        return sortedPrices[idx];
+    }
+};
+
+std::optional<std::pair<std::int64_t, std::int64_t>> WindowFor(const BenchCase& c, const DatasetInfo& info) {
+    if (!c.tsWindow) return std::nullopt;
+    const double span = static_cast<double>(info.maxTs - info.minTs);
+    const auto mid = info.minTs + static_cast<std::int64_t>(span / 2);
+    const auto half = static_cast<std::int64_t>(span * *c.tsWindow / 2);
+    return std::make_pair(mid - half, mid + half);
+}
+
+std::optional<std::pair<double, double>> PriceBandFor(const BenchCase& c, const DatasetInfo& info) {
+    if (!c.priceQuantiles) return std::nullopt;
+    return std::make_pair(info.PriceQuantile(c.priceQuantiles->first), info.PriceQuantile(c.priceQuantiles->second));
+}
+
+SqlQuery ToSql(const BenchCase& c, const DatasetInfo& info) {
+    SqlQuery q;
+    std::vector<std::string> where;
+    auto bind = [&](SqlParam p) {
+        q.params.push_back(std::move(p));
+        return "?" + std::to_string(q.params.size());
+    };
+    if (c.symbol) where.push_back("symbol = " + bind(*c.symbol));
+    if (c.venue) where.push_back("venue = " + bind(*c.venue));
+    if (auto w = WindowFor(c, info)) {
+        where.push_back("ts >= " + bind(w->first));
+        where.push_back("ts <= " + bind(w->second));
+    }
+    if (auto band = PriceBandFor(c, info)) {
+        where.push_back("price >= " + bind(band->first));
+        where.push_back("price <= " + bind(band->second));
+    }
+
+    q.sql = "SELECT id, symbol, venue, ts, price FROM market_ticks";
+    for (std::size_t i = 0; i < where.size(); ++i) {
+        q.sql += (i == 0 ? " WHERE " : " AND ") + where[i];
+    }
+    switch (c.order) {
+        case Order::LruMostRecentFirst:
+        case Order::TsDesc: q.sql += " ORDER BY ts DESC"; break;
+        case Order::TsAsc: q.sql += " ORDER BY ts ASC"; break;
+        case Order::PriceAsc: q.sql += " ORDER BY price ASC"; break;
+        case Order::PriceDesc: q.sql += " ORDER BY price DESC"; break;
+        case Order::SymbolAsc: q.sql += " ORDER BY symbol ASC, ts ASC"; break;
+        case Order::SymbolDesc: q.sql += " ORDER BY symbol DESC, ts DESC"; break;
+    }
+    q.sql += " LIMIT " + bind(c.limit == 0 ? std::int64_t{-1} : static_cast<std::int64_t>(c.limit));
+    q.sql += " OFFSET " + bind(static_cast<std::int64_t>(c.offset));
+    q.sql += ";";
+    return q;
+}
+
+void BuildRowsFromSqlite(sqlite3* db, const SqlQuery& query, std::vector<db::AsyncTableWidget::Row>& out) {
+    out.clear();
+
+    sqlite3_stmt* stmt = nullptr;
+    CheckSqlite(sqlite3_prepare_v2(db, query.sql.c_str(), -1, &stmt, nullptr), db, "sqlite3_prepare_v2");
+    for (std::size_t i = 0; i < query.params.size(); ++i) {
+        const int idx = static_cast<int>(i + 1);
+        std::visit([&](const auto& v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::int64_t>) {
+                CheckSqlite(sqlite3_bind_int64(stmt, idx, v), db, "bind int");
+            } else if constexpr (std::is_same_v<T, double>) {
+                CheckSqlite(sqlite3_bind_double(stmt, idx, v), db, "bind double");
+            } else {
+                CheckSqlite(sqlite3_bind_text(stmt, idx, v.c_str(), -1, SQLITE_TRANSIENT), db, "bind text");
+            }
+        }, query.params[i]);
+    }
 
     while (true) {
         const int rc = sqlite3_step(stmt);
@@ -92,14 +230,13 @@ void BuildRowsFromSqlite(sqlpp::sqlite3::connection& conn,
     CheckSqlite(sqlite3_finalize(stmt), db, "sqlite3_finalize");
 }
 
-void SeedSqlite(sqlpp::sqlite3::connection& conn, const std::vector<BenchRow>& rows) {
+void SeedSqlite(sqlpp::sqlite3::connection& conn, const std::vector<db::MarketDataCacheEntry>& rows) {
     conn("CREATE TABLE market_ticks ("
          "id INTEGER PRIMARY KEY, "
          "symbol TEXT NOT NULL, "
          "venue TEXT NOT NULL, "
          "ts BIGINT NOT NULL, "
          "price REAL NOT NULL)");
-    conn("CREATE INDEX idx_market_ticks_symbol_venue_ts ON market_ticks(symbol, venue, ts)");
 
     sqlite3* db = conn.native_handle();
     CheckSqlite(sqlite3_exec(db, "BEGIN TRANSACTION", nullptr, nullptr, nullptr), db, "BEGIN");
@@ -122,126 +259,282 @@ void SeedSqlite(sqlpp::sqlite3::connection& conn, const std::vector<BenchRow>& r
 
     CheckSqlite(sqlite3_finalize(stmt), db, "finalize insert");
     CheckSqlite(sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr), db, "COMMIT");
+
+    // Same ordered access paths the multi-index container has, so the comparison is like for like
+    conn("CREATE INDEX idx_market_ticks_symbol_venue_ts ON market_ticks(symbol, venue, ts)");
+    conn("CREATE INDEX idx_market_ticks_symbol_ts ON market_ticks(symbol, ts)");
+    conn("CREATE INDEX idx_market_ticks_ts ON market_ticks(ts)");
+    conn("CREATE INDEX idx_market_ticks_price ON market_ticks(price)");
+    conn("ANALYZE");
 }
 
-std::vector<BenchRow> GenerateRows(std::size_t count) {
-    static const std::vector<std::string> symbols = {
-        "AAPL", "MSFT", "NVDA", "AMZN", "META", "TSLA", "GOOG", "AMD",
-        "INTC", "NFLX", "ORCL", "CRM", "ADBE", "QCOM", "AVGO", "SHOP"};
-    static const std::vector<std::string> venues = {"XNAS", "XNYS", "BATS", "IEX"};
+// ---- Multi-index path --------------------------------------------------------------------
 
-    std::mt19937_64 rng(42);
-    std::uniform_int_distribution<int> symbolDist(0, static_cast<int>(symbols.size() - 1));
-    std::uniform_int_distribution<int> venueDist(0, static_cast<int>(venues.size() - 1));
-    std::uniform_real_distribution<double> priceDist(10.0, 1000.0);
+db::MarketDataMultiIndexTableModel::Query ToModelQuery(const BenchCase& c, const DatasetInfo& info) {
+    db::MarketDataMultiIndexTableModel::Query q;
+    q.symbolEq = c.symbol;
+    q.venueEq = c.venue;
+    if (auto w = WindowFor(c, info)) {
+        q.minTs = w->first;
+        q.maxTs = w->second;
+    }
+    if (auto band = PriceBandFor(c, info)) {
+        q.minPrice = band->first;
+        q.maxPrice = band->second;
+    }
+    q.order = c.order;
+    q.offset = c.offset;
+    q.limit = c.limit;
+    return q;
+}
 
-    std::vector<BenchRow> rows;
-    rows.reserve(count);
-    const std::int64_t baseTs = 1'700'000'000'000;
+// ---- Measurement -------------------------------------------------------------------------
 
-    for (std::size_t i = 0; i < count; ++i) {
-        rows.push_back(BenchRow{static_cast<std::int64_t>(i + 1),
-                                symbols[symbolDist(rng)],
-                                venues[venueDist(rng)],
-                                baseTs + static_cast<std::int64_t>(i * 10),
-                                priceDist(rng)});
-    }
-    return rows;
+double Percentile(std::vector<double> sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    std::sort(sorted.begin(), sorted.end());
+    const auto rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
 }
 
 template <typename Fn>
-std::vector<double> RunTimed(Fn&& fn, int iterations, std::uint64_t& checksum) {
+Result Measure(const std::string& caseName, const std::string& path, std::size_t rows, const Options& opts, Fn&& fn) {
+    for (int i = 0; i < opts.warmup; ++i) {
+        fn();
+    }
     std::vector<double> ms;
-    ms.reserve(static_cast<std::size_t>(iterations));
-    for (int i = 0; i < iterations; ++i) {
+    ms.reserve(static_cast<std::size_t>(opts.iterations));
+    std::size_t resultRows = 0;
+    for (int i = 0; i < opts.iterations; ++i) {
         auto start = std::chrono::steady_clock::now();
-        checksum += fn();
+        resultRows = fn();
         auto end = std::chrono::steady_clock::now();
         ms.push_back(std::chrono::duration<double, std::milli>(end - start).count());
     }
-    return ms;
+
+    Result r;
+    r.caseName = caseName;
+    r.path = path;
+    r.rows = rows;
+    r.iterations = opts.iterations;
+    r.resultRows = resultRows;
+    r.p50 = Percentile(ms, 0.50);
+    r.p99 = Percentile(ms, 0.99);
+    r.mean = std::accumulate(ms.begin(), ms.end(), 0.0) / static_cast<double>(ms.size());
+    const auto [minIt, maxIt] = std::minmax_element(ms.begin(), ms.end());
+    r.min = *minIt;
+    r.max = *maxIt;
+    return r;
 }
 
-void PrintStats(const char* label, const std::vector<double>& samples) {
-    const double total = std::accumulate(samples.begin(), samples.end(), 0.0);
-    const double avg = total / static_cast<double>(samples.size());
-    const auto [minIt, maxIt] = std::minmax_element(samples.begin(), samples.end());
-    std::cout << label << " avg_ms=" << avg << " min_ms=" << *minIt << " max_ms=" << *maxIt
-              << " n=" << samples.size() << "\n";
+std::string ToJsonLine(const Result& r) {
+    char buf[512];
+    std::snprintf(buf, sizeof(buf),
+                  "{\"case\":\"%s\",\"path\":\"%s\",\"rows\":%zu,\"iterations\":%d,\"result_rows\":%zu,"
+                  "\"p50_ms\":%.4f,\"p99_ms\":%.4f,\"mean_ms\":%.4f,\"min_ms\":%.4f,\"max_ms\":%.4f}",
+                  r.caseName.c_str(), r.path.c_str(), r.rows, r.iterations, r.resultRows, r.p50, r.p99, r.mean,
+                  r.min, r.max);
+    return buf;
 }
 
-} // namespace
+// ---- Baseline comparison -----------------------------------------------------------------
+
+// Minimal reader for the flat objects written by ToJsonLine (one per line)
+std::optional<std::string> JsonField(const std::string& line, const std::string& key) {
+    const std::string needle = "\"" + key + "\":";
+    auto pos = line.find(needle);
+    if (pos == std::string::npos) return std::nullopt;
+    pos += needle.size();
+    if (pos < line.size() && line[pos] == '"') {
+        auto end = line.find('"', pos + 1);
+        if (end == std::string::npos) return std::nullopt;
+        return line.substr(pos + 1, end - pos - 1);
+    }
+    auto end = line.find_first_of(",}", pos);
+    return line.substr(pos, end == std::string::npos ? std::string::npos : end - pos);
+}
 
-int main() {
-    try {
-        constexpr std::size_t kRows = 200000;
-        constexpr int kWarmupIters = 3;
-        constexpr int kMeasureIters = 20;
+std::string ResultKey(const std::string& path, const std::string& caseName, std::size_t rows) {
+    return path + "|" + caseName + "|" + std::to_string(rows);
+}
 
-        auto rows = GenerateRows(kRows);
+std::map<std::string, Result> LoadBaseline(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("cannot open baseline " + path);
+    }
+    std::map<std::string, Result> out;
+    std::string line;
+    while (std::getline(in, line)) {
+        auto caseName = JsonField(line, "case");
+        auto benchPath = JsonField(line, "path");
+        auto rows = JsonField(line, "rows");
+        auto p50 = JsonField(line, "p50_ms");
+        auto p99 = JsonField(line, "p99_ms");
+        if (!caseName || !benchPath || !rows || !p50 || !p99) continue;
+        Result r;
+        r.caseName = *caseName;
+        r.path = *benchPath;
+        r.rows = static_cast<std::size_t>(std::strtoull(rows->c_str(), nullptr, 10));
+        r.p50 = std::atof(p50->c_str());
+        r.p99 = std::atof(p99->c_str());
+        out[ResultKey(r.path, r.caseName, r.rows)] = r;
+    }
+    return out;
+}
 
-        db::MarketDataMultiIndexTableModel model(kRows + 1000);
-        for (const auto& row : rows) {
-            model.Upsert(db::MarketDataCacheEntry{row.id, row.symbol, row.venue, row.ts, row.price});
+/// Prints a comparison table to stderr; returns the number of regressions
+int Compare(const std::vector<Result>& results, const std::map<std::string, Result>& baseline, const Options& opts) {
+    int regressions = 0;
+    std::fprintf(stderr, "%-34s %-12s %9s %10s %10s %8s %10s %10s %8s\n", "case", "path", "rows", "base p50",
+                 "p50", "delta", "base p99", "p99", "delta");
+    for (const auto& r : results) {
+        auto it = baseline.find(ResultKey(r.path, r.caseName, r.rows));
+        if (it == baseline.end()) {
+            std::fprintf(stderr, "%-34s %-12s %9zu %10s %10.3f %8s %10s %10.3f %8s  (new)\n", r.caseName.c_str(),
+                         r.path.c_str(), r.rows, "-", r.p50, "-", "-", r.p99, "-");
+            continue;
         }
+        const Result& b = it->second;
+        auto regressed = [&](double base, double cur) {
+            return cur > base * (1.0 + opts.threshold) && (cur - base) > opts.minDeltaMs;
+        };
+        const bool bad = regressed(b.p50, r.p50) || regressed(b.p99, r.p99);
+        regressions += bad ? 1 : 0;
+        auto pct = [](double base, double cur) { return base > 0 ? 100.0 * (cur - base) / base : 0.0; };
+        std::fprintf(stderr, "%-34s %-12s %9zu %10.3f %10.3f %7.1f%% %10.3f %10.3f %7.1f%%%s\n", r.caseName.c_str(),
+                     r.path.c_str(), r.rows, b.p50, r.p50, pct(b.p50, r.p50), b.p99, r.p99, pct(b.p99, r.p99),
+                     bad ? "  REGRESSION" : "");
+    }
+    return regressions;
+}
+
+// ---- CLI ---------------------------------------------------------------------------------
 
-        sqlpp::sqlite3::connection_config cfg;
-        cfg.path_to_database = ":memory:";
-        cfg.flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX;
-        sqlpp::sqlite3::connection conn(cfg);
-        SeedSqlite(conn, rows);
-
-        QuerySpec spec{
-            .symbol = "NVDA",
-            .venue = "XNAS",
-            .minTs = rows.front().ts,
-            .maxTs = rows.back().ts,
-            .limit = 2000,
-            .offset = 0,
+std::vector<std::size_t> ParseSizes(const std::string& s) {
+    std::vector<std::size_t> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(static_cast<std::size_t>(std::strtoull(item.c_str(), nullptr, 10)));
+    }
+    return out;
+}
+
+bool ParseArgs(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::runtime_error("missing value for " + arg);
+            return argv[++i];
         };
+        if (arg == "--sizes") {
+            opts.sizes = ParseSizes(next());
+        } else if (arg == "--iterations") {
+            opts.iterations = std::max(1, std::atoi(next().c_str()));
+        } else if (arg == "--warmup") {
+            opts.warmup = std::max(0, std::atoi(next().c_str()));
+        } else if (arg == "--paths") {
+            const std::string v = next();
+            opts.runSqlite = v.find("sqlite") != std::string::npos;
+            opts.runMultiIndex = v.find("multi_index") != std::string::npos;
+        } else if (arg == "--case") {
+            opts.caseFilter = next();
+        } else if (arg == "--output") {
+            opts.outputPath = next();
+        } else if (arg == "--baseline") {
+            opts.baselinePath = next();
+        } else if (arg == "--threshold") {
+            opts.threshold = std::atof(next().c_str());
+        } else if (arg == "--min-delta-ms") {
+            opts.minDeltaMs = std::atof(next().c_str());
+        } else if (arg == "--list") {
+            for (const auto& c : DefaultCases()) std::cout << c.name << "\n";
+            return false;
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--sizes N,N,...] [--iterations N] [--warmup N] [--paths sqlite,multi_index]"
+                         " [--case SUBSTR] [--output FILE] [--baseline FILE] [--threshold FRACTION]"
+                         " [--min-delta-ms MS] [--list]\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
 
-        db::MarketDataMultiIndexTableModel::Query miQuery;
-        miQuery.symbolEq = spec.symbol;
-        miQuery.venueEq = spec.venue;
-        miQuery.minTs = spec.minTs;
-        miQuery.maxTs = spec.maxTs;
-        miQuery.order = db::MarketDataMultiIndexTableModel::Order::TsDesc;
-        miQuery.limit = spec.limit;
-        miQuery.offset = spec.offset;
-
-        std::vector<db::AsyncTableWidget::Row> out;
-        std::uint64_t checksum = 0;
-
-        for (int i = 0; i < kWarmupIters; ++i) {
-            BuildRowsFromSqlite(conn, spec, out);
-            checksum += out.size();
-            model.BuildAsyncRows(out, miQuery);
-            checksum += out.size();
+int main(int argc, char** argv) {
+    try {
+        Options opts;
+        if (!ParseArgs(argc, argv, opts)) {
+            return 0;
+        }
+
+        std::ofstream file;
+        if (!opts.outputPath.empty()) {
+            file.open(opts.outputPath, std::ios::trunc);
+            if (!file) throw std::runtime_error("cannot open " + opts.outputPath);
+        }
+        std::ostream& out = opts.outputPath.empty() ? std::cout : file;
+
+        std::vector<BenchCase> cases;
+        for (auto& c : DefaultCases()) {
+            if (opts.caseFilter.empty() || c.name.find(opts.caseFilter) != std::string::npos) cases.push_back(c);
+        }
+
+        db::WorkloadConfig workload;
+        workload.symbolCount = 16;
+        db::WorkloadGenerator generator(workload);
+
+        std::vector<Result> results;
+        std::vector<db::AsyncTableWidget::Row> rowsOut;
+        for (std::size_t size : opts.sizes) {
+            std::cerr << "dataset " << size << " rows\n";
+            auto rows = generator.GenerateTicks(1, size);
+            if (rows.empty()) continue;
+            const DatasetInfo info(rows);
+
+            if (opts.runSqlite) {
+                sqlpp::sqlite3::connection_config cfg;
+                cfg.path_to_database = ":memory:";
+                cfg.flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX;
+                sqlpp::sqlite3::connection conn(cfg);
+                SeedSqlite(conn, rows);
+                for (const auto& c : cases) {
+                    const SqlQuery q = ToSql(c, info);
+                    results.push_back(Measure(c.name, "sqlite", size, opts, [&]() {
+                        BuildRowsFromSqlite(conn.native_handle(), q, rowsOut);
+                        return rowsOut.size();
+                    }));
+                    out << ToJsonLine(results.back()) << std::endl;
+                }
+            }
+
+            if (opts.runMultiIndex) {
+                db::MarketDataMultiIndexTableModel model(size + 1000);
+                for (const auto& row : rows) {
+                    model.Upsert(row);
+                }
+                model.SetResultCacheCapacity(0); // every repetition walks the indices instead of copying a cached result
+                for (const auto& c : cases) {
+                    const auto q = ToModelQuery(c, info);
+                    results.push_back(Measure(c.name, "multi_index", size, opts, [&]() {
+                        model.BuildAsyncRows(rowsOut, q);
+                        return rowsOut.size();
+                    }));
+                    out << ToJsonLine(results.back()) << std::endl;
+                }
+            }
         }
 
-        auto sqliteMs = RunTimed(
-            [&]() -> std::uint64_t {
-                BuildRowsFromSqlite(conn, spec, out);
-                return static_cast<std::uint64_t>(out.size() * 13 + (out.empty() ? 0 : out.front().columns[0].size()));
-            },
-            kMeasureIters,
-            checksum);
-
-        auto multiIndexMs = RunTimed(
-            [&]() -> std::uint64_t {
-                model.BuildAsyncRows(out, miQuery);
-                return static_cast<std::uint64_t>(out.size() * 17 + (out.empty() ? 0 : out.front().columns[0].size()));
-            },
-            kMeasureIters,
-            checksum);
-
-        PrintStats("sqlite_async_path", sqliteMs);
-        PrintStats("multi_index_path", multiIndexMs);
-
-        const double sqliteAvg = std::accumulate(sqliteMs.begin(), sqliteMs.end(), 0.0) / sqliteMs.size();
-        const double miAvg = std::accumulate(multiIndexMs.begin(), multiIndexMs.end(), 0.0) / multiIndexMs.size();
-        std::cout << "speedup_x=" << (sqliteAvg / miAvg) << " rows_total=" << kRows << " checksum=" << checksum
-                  << "\n";
+        if (!opts.baselinePath.empty()) {
+            const int regressions = Compare(results, LoadBaseline(opts.baselinePath), opts);
+            if (regressions > 0) {
+                std::cerr << regressions << " regression(s) above " << opts.threshold * 100.0 << "%\n";
+                return 3;
+            }
+        }
         return 0;
     } catch (const std::exception& e) {
         std::cerr << "benchmark failed: " << e.what() << "\n";
@@ -0,0 +1,356 @@
+// Memory footprint benchmark for every row representation in the project.
+//
+// A counting global operator new/delete tracks live heap bytes and allocation counts, so each
+// structure is measured as (heap delta) / rows after building it:
+//   - AsyncTableWidget::Row as produced by each refresh path (SQLite step+format, market-data
+//     and Foo multi-index BuildAsyncRows), including the owning vector
+//   - MarketDataCacheEntry inside MarketDataMultiIndexTableModel (LRU + all five indices)
+//   - FooCacheEntry inside FooMultiIndexTableModel
+//   - an element of ReactiveTwoFieldCollection, including its reaction monitor (plain and
+//     string-keyed, as used by the GUI and the headless positions)
+//   - a 4-field ReactiveFieldCollection element vs. the same position split across two
+//     two-field collections
+//   - the SQLite :memory: table for reference (SQLite's own allocator, sqlite3_memory_used)
+//
+// A second pass fills each container to --rss-rows (default 1M) and records the process RSS
+// reached, for capacity planning.
+//
+//   benchmark_memory_footprint [--rows N] [--rss-rows N]
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <sqlite3.h>
+
+#include "database/async_table_widget.h"
+#include "database/foo_multi_index_table_model.h"
+#include "database/market_data_multi_index_table_model.h"
+#include "database/reactive_field_collection.h"
+#include "database/reactive_two_field_collection.h"
+#include "database/workload_generator.h"
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// ---- Counting allocator ------------------------------------------------------------------
+
+namespace {
+
+std::atomic<std::int64_t> g_liveBytes{0};
+std::atomic<std::uint64_t> g_allocations{0};
+
+// Every block carries a header with its size (and the offset back to the malloc'd pointer
+// for over-aligned blocks), so deletes can be accounted without sized-delete support.
+struct alignas(alignof(std::max_align_t)) AllocHeader {
+    std::size_t size;
+    std::size_t offset;
+};
+
+void* CountedAlloc(std::size_t size, std::size_t align) {
+    align = std::max(align, alignof(AllocHeader));
+    const std::size_t headerSpace = ((sizeof(AllocHeader) + align - 1) / align) * align;
+    void* raw = std::malloc(size + headerSpace + (align > alignof(std::max_align_t) ? align : 0));
+    if (!raw) return nullptr;
+    auto base = reinterpret_cast<std::uintptr_t>(raw) + headerSpace;
+    base = (base + align - 1) & ~(static_cast<std::uintptr_t>(align) - 1);
+    auto* header = reinterpret_cast<AllocHeader*>(base) - 1;
+    header->size = size;
+    header->offset = base - reinterpret_cast<std::uintptr_t>(raw);
+    g_liveBytes.fetch_add(static_cast<std::int64_t>(size), std::memory_order_relaxed);
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return reinterpret_cast<void*>(base);
+}
+
+void CountedFree(void* p) noexcept {
+    if (!p) return;
+    auto* header = static_cast<AllocHeader*>(p) - 1;
+    g_liveBytes.fetch_sub(static_cast<std::int64_t>(header->size), std::memory_order_relaxed);
+    std::free(static_cast<char*>(p) - header->offset);
+}
+
+void* CountedAllocOrThrow(std::size_t size, std::size_t align) {
+    if (void* p = CountedAlloc(size, align)) return p;
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+void* operator new(std::size_t n) { return CountedAllocOrThrow(n, alignof(std::max_align_t)); }
+void* operator new[](std::size_t n) { return CountedAllocOrThrow(n, alignof(std::max_align_t)); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept { return CountedAlloc(n, alignof(std::max_align_t)); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept { return CountedAlloc(n, alignof(std::max_align_t)); }
+void* operator new(std::size_t n, std::align_val_t a) { return CountedAllocOrThrow(n, static_cast<std::size_t>(a)); }
+void* operator new[](std::size_t n, std::align_val_t a) { return CountedAllocOrThrow(n, static_cast<std::size_t>(a)); }
+void operator delete(void* p) noexcept { CountedFree(p); }
+void operator delete[](void* p) noexcept { CountedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { CountedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { CountedFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept { CountedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { CountedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { CountedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { CountedFree(p); }
+
+namespace {
+
+using PlainCollection = reactive::ReactiveTwoFieldCollection<double, long>;
+using KeyedCollection = reactive::ReactiveTwoFieldCollection<
+    double, long, long, double,
+    reactive::detail::DefaultDelta1<double, long, long>,
+    reactive::detail::DefaultApplyAdd<long, long>,
+    reactive::detail::DefaultDelta2<double, long, double>,
+    reactive::detail::DefaultApplyAdd<double, double>,
+    std::string>;
+
+// price, qty, fees, margin with net qty / notional / fees / max margin totals
+using PositionCollection = reactive::ReactiveFieldCollection<
+    reactive::Fields<double, long, double, double>,
+    reactive::Totals<reactive::SumOf<1, long>, reactive::SumOfProduct<0, 1, double>,
+                     reactive::SumOf<2, double>, reactive::MaxOf<3, double>>>;
+
+struct Options {
+    std::size_t rows = 100000;
+    std::size_t rssRows = 1000000;
+};
+
+struct HeapMark {
+    std::int64_t bytes = g_liveBytes.load();
+    std::uint64_t allocations = g_allocations.load();
+};
+
+void TrimHeap() {
+#if defined(__GLIBC__)
+    malloc_trim(0);
+#endif
+}
+
+double RssMiB() {
+    std::ifstream statm("/proc/self/statm");
+    long pages = 0, resident = 0;
+    if (!(statm >> pages >> resident)) return 0.0;
+    return static_cast<double>(resident) * 4096.0 / (1024.0 * 1024.0);
+}
+
+void Report(const char* name, std::size_t rows, const HeapMark& before) {
+    const HeapMark after;
+    const double bytes = static_cast<double>(after.bytes - before.bytes);
+    const double allocs = static_cast<double>(after.allocations - before.allocations);
+    std::printf("%-44s %10zu %14.1f %14.2f\n", name, rows, bytes / static_cast<double>(rows),
+                allocs / static_cast<double>(rows));
+    std::fflush(stdout);
+}
+
+// Same formatting as the GUI's SQLite refresh callback: step, copy text, to_string numbers
+void BuildRowsFromSqlite(sqlite3* db, std::vector<db::AsyncTableWidget::Row>& out) {
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(db, "SELECT id, symbol, venue, ts, price FROM market_ticks;", -1, &stmt, nullptr);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const auto id = static_cast<std::int64_t>(sqlite3_column_int64(stmt, 0));
+        const char* symbol = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        const char* venue = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+        const auto ts = static_cast<std::int64_t>(sqlite3_column_int64(stmt, 3));
+        const double price = sqlite3_column_double(stmt, 4);
+        db::MarketDataTypedData typed{id, symbol ? symbol : "", venue ? venue : "", ts, price};
+        out.push_back(db::AsyncTableWidget::Row{
+            {std::to_string(id), typed.symbol, typed.venue, std::to_string(ts), std::to_string(price)}, typed});
+    }
+    sqlite3_finalize(stmt);
+}
+
+sqlite3* SeedSqlite(const std::vector<db::MarketDataCacheEntry>& rows) {
+    sqlite3* db = nullptr;
+    sqlite3_open(":memory:", &db);
+    sqlite3_exec(db,
+                 "CREATE TABLE market_ticks (id INTEGER PRIMARY KEY, symbol TEXT NOT NULL, venue TEXT NOT NULL, "
+                 "ts BIGINT NOT NULL, price REAL NOT NULL);"
+                 "CREATE INDEX idx_market_ticks_symbol_venue_ts ON market_ticks(symbol, venue, ts);",
+                 nullptr, nullptr, nullptr);
+    sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr);
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(db, "INSERT INTO market_ticks VALUES(?1, ?2, ?3, ?4, ?5);", -1, &stmt, nullptr);
+    for (const auto& r : rows) {
+        sqlite3_bind_int64(stmt, 1, r.id);
+        sqlite3_bind_text(stmt, 2, r.symbol.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 3, r.venue.c_str(), -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt, 4, r.ts);
+        sqlite3_bind_double(stmt, 5, r.price);
+        sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr);
+    return db;
+}
+
+template <typename Collection, typename Push>
+void FillCollection(Collection& c, const db::WorkloadGenerator& gen, std::size_t rows, Push&& push) {
+    auto updates = gen.GenerateCollectionUpdates(0, rows, 0);
+    for (std::size_t i = 0; i < updates.size(); ++i) {
+        push(c, i, updates[i]);
+    }
+}
+
+void MeasurePerRow(const Options& opts, const db::WorkloadGenerator& gen) {
+    const std::size_t n = opts.rows;
+    std::printf("%-44s %10s %14s %14s\n", "structure", "rows", "bytes/row", "allocs/row");
+
+    // Inputs are generated before each mark so only the structure under test is counted
+    auto ticks = gen.GenerateTicks(1, n);
+    auto foos = gen.GenerateFoo(1, n);
+
+    {
+        db::MarketDataMultiIndexTableModel model(n + 1);
+        HeapMark before;
+        for (const auto& t : ticks) model.Upsert(t);
+        Report("MarketDataCacheEntry in model (5 indices)", n, before);
+
+        std::vector<db::AsyncTableWidget::Row> out;
+        db::MarketDataMultiIndexTableModel::Query all;
+        all.order = db::MarketDataMultiIndexTableModel::Order::TsDesc;
+        HeapMark rowsBefore;
+        model.BuildAsyncRows(out, all);
+        Report("AsyncTableWidget::Row via market BuildAsyncRows", out.size(), rowsBefore);
+    }
+    {
+        db::FooMultiIndexTableModel model(n + 1);
+        HeapMark before;
+        for (const auto& f : foos) model.Upsert(f);
+        Report("FooCacheEntry in model", n, before);
+
+        std::vector<db::AsyncTableWidget::Row> out;
+        HeapMark rowsBefore;
+        model.BuildAsyncRows(out, {});
+        Report("AsyncTableWidget::Row via Foo BuildAsyncRows", out.size(), rowsBefore);
+    }
+    {
+        sqlite3* db = SeedSqlite(ticks);
+        std::printf("%-44s %10zu %14.1f %14s\n", "SQLite :memory: table + index (sqlite heap)", n,
+                    static_cast<double>(sqlite3_memory_used()) / static_cast<double>(n), "-");
+        std::vector<db::AsyncTableWidget::Row> out;
+        HeapMark before;
+        BuildRowsFromSqlite(db, out);
+        Report("AsyncTableWidget::Row via SQLite refresh", out.size(), before);
+        out.clear();
+        out.shrink_to_fit();
+        sqlite3_close(db);
+    }
+    {
+        HeapMark before;
+        {
+            PlainCollection c;
+            FillCollection(c, gen, n, [](PlainCollection& col, std::size_t, const db::CollectionUpdate& u) {
+                col.push_back(u.price, u.qty);
+            });
+            Report("ReactiveTwoFieldCollection element + monitor", n, before);
+        }
+    }
+    {
+        std::vector<std::string> keys;
+        keys.reserve(n);
+        for (std::size_t i = 0; i < n; ++i) keys.push_back("SYM" + std::to_string(i));
+        HeapMark before;
+        KeyedCollection c;
+        FillCollection(c, gen, n, [&](KeyedCollection& col, std::size_t i, const db::CollectionUpdate& u) {
+            col.push_back(u.price, u.qty, keys[i]);
+        });
+        Report("keyed collection element + monitor + key", n, before);
+    }
+    {
+        HeapMark before;
+        {
+            PlainCollection priceQty, feesMargin;
+            FillCollection(priceQty, gen, n, [&](PlainCollection& col, std::size_t, const db::CollectionUpdate& u) {
+                col.push_back(u.price, u.qty);
+                feesMargin.push_back(u.price * 0.001, u.qty);
+            });
+            Report("4-field position as 2 two-field collections", n, before);
+        }
+    }
+    {
+        HeapMark before;
+        {
+            PositionCollection c;
+            FillCollection(c, gen, n, [](PositionCollection& col, std::size_t, const db::CollectionUpdate& u) {
+                col.push_back({u.price, u.qty, u.price * 0.001, u.price * static_cast<double>(u.qty) * 0.1});
+            });
+            Report("4-field position in ReactiveFieldCollection", n, before);
+        }
+    }
+}
+
+void MeasureRss(const Options& opts, const db::WorkloadGenerator& gen) {
+    const std::size_t n = opts.rssRows;
+    std::printf("\n%-44s %10s %14s %14s\n", "RSS at scale", "rows", "RSS MiB", "+heap MiB");
+    std::int64_t stageStartBytes = 0;
+    auto stage = [&](const std::function<void()>& build) {
+        TrimHeap();
+        stageStartBytes = g_liveBytes.load();
+        build();
+        TrimHeap();
+    };
+    // RSS is process-wide (the allocator keeps freed pages); +heap is live bytes added by this stage
+    auto print = [&](const char* name) {
+        std::printf("%-44s %10zu %14.1f %14.1f\n", name, n, RssMiB(),
+                    static_cast<double>(g_liveBytes.load() - stageStartBytes) / (1024.0 * 1024.0));
+        std::fflush(stdout);
+    };
+
+    std::printf("%-44s %10s %14.1f %14s\n", "baseline", "-", RssMiB(), "-");
+    stage([&]() {
+        db::MarketDataMultiIndexTableModel model(n + 1);
+        for (std::size_t i = 0; i < n; ++i) model.Upsert(gen.MakeTick(static_cast<std::int64_t>(i + 1)));
+        print("MarketDataMultiIndexTableModel");
+        std::vector<db::AsyncTableWidget::Row> out;
+        model.BuildAsyncRows(out, {});
+        print("  + AsyncTableWidget rows for all of it");
+    });
+    stage([&]() {
+        db::FooMultiIndexTableModel model(n + 1);
+        for (std::size_t i = 0; i < n; ++i) model.Upsert(gen.MakeFoo(static_cast<std::int64_t>(i + 1)));
+        print("FooMultiIndexTableModel");
+    });
+    stage([&]() {
+        PlainCollection c;
+        FillCollection(c, gen, n, [](PlainCollection& col, std::size_t, const db::CollectionUpdate& u) {
+            col.push_back(u.price, u.qty);
+        });
+        print("ReactiveTwoFieldCollection");
+    });
+    std::printf("%-44s %10s %14.1f %14s\n", "after teardown", "-", RssMiB(), "-");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--rows" && i + 1 < argc) {
+            opts.rows = std::max<std::size_t>(1, static_cast<std::size_t>(std::atoll(argv[++i])));
+        } else if (arg == "--rss-rows" && i + 1 < argc) {
+            opts.rssRows = static_cast<std::size_t>(std::atoll(argv[++i]));
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--rows N] [--rss-rows N]\n";
+            return 2;
+        }
+    }
+
+    db::WorkloadConfig workload;
+    workload.threads = 1; // keep generator threads out of the heap accounting
+    const db::WorkloadGenerator gen(workload);
+
+    MeasurePerRow(opts, gen);
+    if (opts.rssRows > 0) {
+        MeasureRss(opts, gen);
+    }
+    return 0;
+}
@@ -0,0 +1,406 @@
+// Concurrent reader/writer benchmark for the multi-index table models.
+//
+// W writer threads Upsert at a target rate (per writer; 0 = as fast as possible) while R reader
+// threads run a rotating mix of BuildAsyncRows queries, mimicking NATS ingestion racing the
+// widgets' background refreshes. With --lookups N each reader operation also does N FindById
+// point lookups; --policy clock lets those run under the shared lock instead of the writer
+// lock (exact LRU has to relocate the entry). Reported per run:
+//   - writer Upsert latency p50/p99/p99.9/max and achieved vs target rate
+//   - reader query throughput and latency p50/p99/max
+//   - starvation: the longest gap between two completed operations of any single thread,
+//     and the fewest queries completed by one reader (fairness)
+//
+// The harness is templated on the model; a different locking strategy only needs a
+// ModelAdapter specialization (row factory + query mix) to be compared on the same workload.
+//
+//   benchmark_model_contention --model market --writers 2 --readers 4 --rate 50000 --duration 5
+//   benchmark_model_contention --model foo --lookups 64 --policy clock
+//   benchmark_model_contention --model sharded --shards 8 --shard-key symbol --writers 8 --rate 0
+//
+// A summary goes to stderr and one JSON line per run to stdout.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "database/foo_multi_index_table_model.h"
+#include "database/market_data_multi_index_table_model.h"
+#include "database/sharded_market_data_model.h"
+#include "database/workload_generator.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string model = "both"; // market | foo | sharded | both (market + foo)
+    unsigned writers = 2;
+    unsigned readers = 4;
+    double ratePerWriter = 20000.0; // upserts/s per writer, 0 = unthrottled
+    double durationSec = 5.0;
+    std::size_t rows = 200000;      // preloaded rows (also the key space writers update)
+    std::size_t capacity = 0;       // 0 = rows + 10%
+    double starvationMs = 100.0;    // gap above which a thread counts as starved
+    db::EvictionPolicy policy = db::EvictionPolicy::Lru;
+    std::size_t lookups = 0;        // FindById calls per reader operation
+    std::size_t shards = 0;         // sharded model: 0 = one per hardware thread
+    db::ShardedMarketDataTableModel::ShardKey shardKey = db::ShardedMarketDataTableModel::ShardKey::Id;
+};
+
+// ---- Model adapters ----------------------------------------------------------------------
+
+template <typename Model>
+struct ModelAdapter;
+
+template <>
+struct ModelAdapter<db::MarketDataMultiIndexTableModel> {
+    using Model = db::MarketDataMultiIndexTableModel;
+    static constexpr const char* kName = "market";
+
+    static std::unique_ptr<Model> Make(std::size_t capacity, const Options& opts) {
+        auto model = std::make_unique<Model>(capacity, opts.policy);
+        model->SetResultCacheCapacity(0); // readers repeat the mix; measure lookups, not cached copies
+        return model;
+    }
+
+    static db::MarketDataCacheEntry MakeRow(const db::WorkloadGenerator& gen, std::int64_t id, std::uint64_t revision) {
+        auto row = gen.MakeTick(id);
+        row.price += static_cast<double>(revision % 100) * 0.01; // vary the price index between revisions
+        return row;
+    }
+
+    static std::vector<Model::Query> QueryMix(const db::WorkloadGenerator& gen) {
+        using Order = Model::Order;
+        const auto& symbols = gen.Symbols();
+        std::vector<Model::Query> mix;
+        Model::Query q;
+        q.symbolEq = symbols.front();
+        q.venueEq = "XNAS";
+        q.order = Order::TsDesc;
+        q.limit = 2000;
+        mix.push_back(q); // the default widget query: one (symbol, venue) page
+        q = {};
+        q.symbolEq = symbols[symbols.size() / 2];
+        q.order = Order::TsAsc;
+        q.limit = 2000;
+        mix.push_back(q); // symbol filter, full scan of the ts index
+        q = {};
+        q.order = Order::TsDesc;
+        q.limit = 2000;
+        mix.push_back(q); // unfiltered head page
+        q = {};
+        q.order = Order::PriceDesc;
+        q.offset = 5000;
+        q.limit = 500;
+        mix.push_back(q); // deep page on another index
+        return mix;
+    }
+};
+
+// Same rows and queries as the unsharded model, so the two runs are directly comparable
+template <>
+struct ModelAdapter<db::ShardedMarketDataTableModel> : ModelAdapter<db::MarketDataMultiIndexTableModel> {
+    using Model = db::ShardedMarketDataTableModel;
+    static constexpr const char* kName = "sharded";
+
+    static std::unique_ptr<Model> Make(std::size_t capacity, const Options& opts) {
+        return std::make_unique<Model>(capacity, opts.shards, opts.shardKey, opts.policy);
+    }
+};
+
+template <>
+struct ModelAdapter<db::FooMultiIndexTableModel> {
+    using Model = db::FooMultiIndexTableModel;
+    static constexpr const char* kName = "foo";
+
+    static std::unique_ptr<Model> Make(std::size_t capacity, const Options& opts) {
+        auto model = std::make_unique<Model>(capacity, opts.policy);
+        model->SetResultCacheCapacity(0); // readers repeat the mix; measure lookups, not cached copies
+        return model;
+    }
+
+    static db::FooCacheEntry MakeRow(const db::WorkloadGenerator& gen, std::int64_t id, std::uint64_t revision) {
+        return gen.MakeFoo(id, revision);
+    }
+
+    static std::vector<Model::Query> QueryMix(const db::WorkloadGenerator&) {
+        using Order = Model::Order;
+        std::vector<Model::Query> mix;
+        Model::Query q;
+        q.order = Order::LruMostRecentFirst;
+        q.limit = 2000;
+        mix.push_back(q);
+        q = {};
+        q.order = Order::NameAsc;
+        q.namePrefix = "a";
+        q.limit = 2000;
+        mix.push_back(q);
+        q = {};
+        q.order = Order::IdAsc;
+        q.hasFunFilter = true;
+        q.textContains = "ar";
+        q.limit = 1000;
+        mix.push_back(q);
+        q = {};
+        q.order = Order::IdDesc;
+        q.offset = 10000;
+        q.limit = 500;
+        mix.push_back(q);
+        return mix;
+    }
+};
+
+// ---- Measurement -------------------------------------------------------------------------
+
+struct ThreadStats {
+    std::vector<float> latencyUs;
+    std::uint64_t ops = 0;
+    double maxGapMs = 0.0;
+};
+
+double Percentile(std::vector<float>& samples, double p) {
+    if (samples.empty()) return 0.0;
+    const auto rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(samples.size())));
+    const std::size_t idx = std::clamp<std::size_t>(rank, 1, samples.size()) - 1;
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(idx), samples.end());
+    return samples[idx];
+}
+
+std::vector<float> Merge(const std::vector<ThreadStats>& stats) {
+    std::vector<float> all;
+    for (const auto& s : stats) all.insert(all.end(), s.latencyUs.begin(), s.latencyUs.end());
+    return all;
+}
+
+const char* PolicyName(db::EvictionPolicy policy) {
+    return policy == db::EvictionPolicy::Clock ? "clock" : "lru";
+}
+
+double MicrosSince(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+template <typename Model>
+int RunContention(const Options& opts) {
+    using Adapter = ModelAdapter<Model>;
+
+    db::WorkloadConfig workload;
+    workload.symbolCount = 32;
+    const db::WorkloadGenerator gen(workload);
+    const std::size_t capacity = opts.capacity ? opts.capacity : opts.rows + opts.rows / 10 + 1;
+
+    const auto model = Adapter::Make(capacity, opts);
+    for (std::size_t i = 0; i < opts.rows; ++i) {
+        model->Upsert(Adapter::MakeRow(gen, static_cast<std::int64_t>(i + 1), 0));
+    }
+    const auto mix = Adapter::QueryMix(gen);
+
+    std::vector<ThreadStats> writerStats(opts.writers);
+    std::vector<ThreadStats> readerStats(opts.readers);
+    std::atomic<bool> go{false};
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+
+    for (unsigned w = 0; w < opts.writers; ++w) {
+        threads.emplace_back([&, w]() {
+            ThreadStats& st = writerStats[w];
+            if (opts.ratePerWriter > 0) {
+                st.latencyUs.reserve(static_cast<std::size_t>(opts.ratePerWriter * opts.durationSec * 1.1));
+            }
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            db::WorkloadPacer pacer(opts.ratePerWriter > 0 ? opts.ratePerWriter : 1.0);
+            std::uint64_t seq = 0;
+            auto last = Clock::now();
+            while (!stop.load(std::memory_order_relaxed)) {
+                std::size_t due = opts.ratePerWriter > 0 ? pacer.Due(256) : 64;
+                if (due == 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                    continue;
+                }
+                for (std::size_t i = 0; i < due; ++i, ++seq) {
+                    // Writers interleave over the preloaded key space: steady size, real index moves
+                    const auto id = static_cast<std::int64_t>((seq * opts.writers + w) % opts.rows + 1);
+                    auto row = Adapter::MakeRow(gen, id, seq + 1);
+                    const auto start = Clock::now();
+                    model->Upsert(std::move(row));
+                    const auto end = Clock::now();
+                    st.latencyUs.push_back(static_cast<float>(MicrosSince(start, end)));
+                    st.maxGapMs = std::max(st.maxGapMs, MicrosSince(last, end) / 1000.0);
+                    last = end;
+                    ++st.ops;
+                }
+            }
+        });
+    }
+
+    for (unsigned r = 0; r < opts.readers; ++r) {
+        threads.emplace_back([&, r]() {
+            ThreadStats& st = readerStats[r];
+            std::vector<db::AsyncTableWidget::Row> rows;
+            std::size_t next = r; // readers start at different points of the mix
+            std::uint64_t lookupSeq = r;
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            auto last = Clock::now();
+            while (!stop.load(std::memory_order_relaxed)) {
+                const auto start = Clock::now();
+                model->BuildAsyncRows(rows, mix[next++ % mix.size()]);
+                for (std::size_t i = 0; i < opts.lookups; ++i) {
+                    // Skewed toward a hot tenth of the key space, like a dashboard's watched rows
+                    lookupSeq = lookupSeq * 6364136223846793005ULL + 1442695040888963407ULL;
+                    const std::size_t span = (lookupSeq >> 60) < 12 ? opts.rows / 10 + 1 : opts.rows;
+                    model->FindById(static_cast<std::int64_t>((lookupSeq >> 20) % span + 1));
+                }
+                const auto end = Clock::now();
+                st.latencyUs.push_back(static_cast<float>(MicrosSince(start, end)));
+                st.maxGapMs = std::max(st.maxGapMs, MicrosSince(last, end) / 1000.0);
+                last = end;
+                ++st.ops;
+            }
+        });
+    }
+
+    const auto begin = Clock::now();
+    go.store(true, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::duration<double>(opts.durationSec));
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& t : threads) t.join();
+    const double elapsed = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    auto writes = Merge(writerStats);
+    auto reads = Merge(readerStats);
+    const double writeRate = static_cast<double>(writes.size()) / elapsed;
+    const double targetRate = opts.ratePerWriter * opts.writers;
+    const double readRate = static_cast<double>(reads.size()) / elapsed;
+
+    double writerMaxGap = 0.0, readerMaxGap = 0.0;
+    std::uint64_t minReaderOps = readerStats.empty() ? 0 : UINT64_MAX;
+    unsigned starved = 0;
+    for (const auto& s : writerStats) {
+        writerMaxGap = std::max(writerMaxGap, s.maxGapMs);
+        starved += s.maxGapMs > opts.starvationMs ? 1 : 0;
+    }
+    for (const auto& s : readerStats) {
+        readerMaxGap = std::max(readerMaxGap, s.maxGapMs);
+        minReaderOps = std::min(minReaderOps, s.ops);
+        starved += s.maxGapMs > opts.starvationMs ? 1 : 0;
+    }
+
+    const double wP50 = Percentile(writes, 0.50), wP99 = Percentile(writes, 0.99), wP999 = Percentile(writes, 0.999);
+    const double wMax = writes.empty() ? 0.0 : *std::max_element(writes.begin(), writes.end());
+    const double rP50 = Percentile(reads, 0.50), rP99 = Percentile(reads, 0.99);
+    const double rMax = reads.empty() ? 0.0 : *std::max_element(reads.begin(), reads.end());
+
+    std::fprintf(stderr,
+                 "[%s] policy=%s writers=%u readers=%u rows=%zu lookups=%zu %.1fs\n"
+                 "  writes: %.0f/s (target %s) upsert_us p50=%.1f p99=%.1f p99.9=%.1f max=%.1f max_gap_ms=%.1f\n"
+                 "  reads:  %.1f q/s query_us p50=%.1f p99=%.1f max=%.1f max_gap_ms=%.1f min_queries_per_reader=%llu\n"
+                 "  starved threads (gap > %.0f ms): %u\n",
+                 Adapter::kName, PolicyName(opts.policy), opts.writers, opts.readers, opts.rows, opts.lookups, elapsed,
+                 writeRate,
+                 opts.ratePerWriter > 0 ? std::to_string(static_cast<long long>(targetRate)).c_str() : "unthrottled",
+                 wP50, wP99, wP999, wMax, writerMaxGap, readRate, rP50, rP99, rMax, readerMaxGap,
+                 static_cast<unsigned long long>(minReaderOps), opts.starvationMs, starved);
+
+    std::printf("{\"model\":\"%s\",\"policy\":\"%s\",\"writers\":%u,\"readers\":%u,\"rows\":%zu,\"lookups\":%zu,"
+                "\"duration_s\":%.2f,"
+                "\"target_write_rate\":%.0f,\"write_rate\":%.0f,\"upsert_p50_us\":%.2f,\"upsert_p99_us\":%.2f,"
+                "\"upsert_p999_us\":%.2f,\"upsert_max_us\":%.2f,\"writer_max_gap_ms\":%.2f,"
+                "\"query_rate\":%.2f,\"query_p50_us\":%.2f,\"query_p99_us\":%.2f,\"query_max_us\":%.2f,"
+                "\"reader_max_gap_ms\":%.2f,\"min_queries_per_reader\":%llu,\"starved_threads\":%u}\n",
+                Adapter::kName, PolicyName(opts.policy), opts.writers, opts.readers, opts.rows, opts.lookups, elapsed,
+                targetRate, writeRate, wP50, wP99,
+                wP999, wMax, writerMaxGap, readRate, rP50, rP99, rMax, readerMaxGap,
+                static_cast<unsigned long long>(minReaderOps), starved);
+    std::fflush(stdout);
+    return 0;
+}
+
+bool ParseArgs(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::cerr << "missing value for " << arg << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (arg == "--model") {
+            opts.model = next();
+        } else if (arg == "--writers") {
+            opts.writers = static_cast<unsigned>(std::atoi(next()));
+        } else if (arg == "--readers") {
+            opts.readers = static_cast<unsigned>(std::atoi(next()));
+        } else if (arg == "--rate") {
+            opts.ratePerWriter = std::atof(next());
+        } else if (arg == "--duration") {
+            opts.durationSec = std::max(0.1, std::atof(next()));
+        } else if (arg == "--rows") {
+            opts.rows = std::max<std::size_t>(1, static_cast<std::size_t>(std::atoll(next())));
+        } else if (arg == "--capacity") {
+            opts.capacity = static_cast<std::size_t>(std::atoll(next()));
+        } else if (arg == "--starvation-ms") {
+            opts.starvationMs = std::atof(next());
+        } else if (arg == "--policy") {
+            const std::string policy = next();
+            if (policy != "lru" && policy != "clock") {
+                std::cerr << "unknown policy " << policy << "\n";
+                return false;
+            }
+            opts.policy = policy == "clock" ? db::EvictionPolicy::Clock : db::EvictionPolicy::Lru;
+        } else if (arg == "--shards") {
+            opts.shards = static_cast<std::size_t>(std::atoll(next()));
+        } else if (arg == "--shard-key") {
+            const std::string key = next();
+            if (key != "id" && key != "symbol") {
+                std::cerr << "unknown shard key " << key << "\n";
+                return false;
+            }
+            opts.shardKey = key == "symbol" ? db::ShardedMarketDataTableModel::ShardKey::Symbol
+                                            : db::ShardedMarketDataTableModel::ShardKey::Id;
+        } else if (arg == "--lookups") {
+            opts.lookups = static_cast<std::size_t>(std::atoll(next()));
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--model market|foo|sharded|both] [--writers W] [--readers R] [--rate UPSERTS_PER_WRITER]"
+                         " [--duration SEC] [--rows N] [--capacity N] [--starvation-ms MS] [--policy lru|clock]"
+                         " [--lookups N] [--shards N] [--shard-key id|symbol]\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!ParseArgs(argc, argv, opts)) {
+        return 2;
+    }
+    try {
+        int rc = 0;
+        if (opts.model == "market" || opts.model == "both") {
+            rc |= RunContention<db::MarketDataMultiIndexTableModel>(opts);
+        }
+        if (opts.model == "foo" || opts.model == "both") {
+            rc |= RunContention<db::FooMultiIndexTableModel>(opts);
+        }
+        if (opts.model == "sharded") {
+            rc |= RunContention<db::ShardedMarketDataTableModel>(opts);
+        }
+        return rc;
+    } catch (const std::exception& e) {
+        std::cerr << "benchmark failed: " << e.what() << "\n";
+        return 1;
+    }
+}
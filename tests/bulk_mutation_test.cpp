@@ -0,0 +1,78 @@
+#include "database/bulk_mutation.h"
+
+#include <sqlite3.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+static long Count(sqlite3* handle, const std::string& sql) {
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(handle, sql.c_str(), -1, &stmt, nullptr);
+    long n = sqlite3_step(stmt) == SQLITE_ROW ? static_cast<long>(sqlite3_column_int64(stmt, 0)) : -1;
+    sqlite3_finalize(stmt);
+    return n;
+}
+
+int main() {
+    // A :memory: database shared by the job and another writer, like DatabaseManager's
+    // main connection in DatabaseMode::Memory
+    sqlite3* handle = nullptr;
+    if (sqlite3_open_v2(":memory:", &handle, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX,
+                        nullptr) != SQLITE_OK) {
+        return 1;
+    }
+    sqlite3_exec(handle, "CREATE TABLE foo (id BIGINT, name TEXT)", nullptr, nullptr, nullptr);
+    sqlite3_exec(handle, "WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 1000) "
+                         "INSERT INTO foo SELECT i, 'row ' || i FROM n",
+                 nullptr, nullptr, nullptr);
+
+    // The job stalls in its first chunk and is cancelled; meanwhile another thread writes
+    BulkMutationJob job;
+    std::atomic<bool> started{false};
+    BulkUpdateRequest req;
+    req.table = "foo";
+    req.orderBy = "rowid";
+    req.keyColumn = "id";
+    req.chunkSize = 100;
+    req.stagedColumns = {"name"};
+    req.valueProvider = [&](const BulkTarget& target, std::vector<BulkValue>& values) {
+        if (target.seq == 0) {
+            started = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            job.Cancel();
+        }
+        values[0] = std::string("bulk");
+    };
+    std::thread bulk([&] { bulk_detail::RunBulkUpdateExclusive(handle, req, job); });
+
+    int insertRc = SQLITE_ERROR;
+    int updateRc = SQLITE_ERROR;
+    std::thread writer([&] {
+        while (!started) std::this_thread::yield();
+        insertRc = sqlite3_exec(handle, "INSERT INTO foo VALUES (5000, 'writer')", nullptr, nullptr, nullptr);
+        updateRc = sqlite3_exec(handle, "UPDATE foo SET name = 'writer' WHERE id = 1", nullptr, nullptr, nullptr);
+    });
+    bulk.join();
+    writer.join();
+
+    if (job.GetState() != BulkMutationJob::State::Cancelled) return 2;
+    if (insertRc != SQLITE_OK || updateRc != SQLITE_OK) return 3;
+    // The writer's statements ran after the rollback instead of inside the job's transaction
+    if (Count(handle, "SELECT count(*) FROM foo WHERE name = 'bulk'") != 0) return 4;
+    if (Count(handle, "SELECT count(*) FROM foo WHERE id = 5000") != 1) return 5;
+    if (Count(handle, "SELECT count(*) FROM foo WHERE id = 1 AND name = 'writer'") != 1) return 6;
+    if (Count(handle, "SELECT count(*) FROM foo") != 1001) return 7;
+    if (!sqlite3_get_autocommit(handle)) return 8;
+
+    // The connection is usable for another job afterwards
+    BulkMutationJob again;
+    req.valueProvider = [](const BulkTarget&, std::vector<BulkValue>& values) { values[0] = std::string("bulk"); };
+    bulk_detail::RunBulkUpdateExclusive(handle, req, again);
+    if (again.GetState() != BulkMutationJob::State::Succeeded) return 9;
+    if (Count(handle, "SELECT count(*) FROM foo WHERE name = 'bulk'") != 1001) return 10;
+
+    sqlite3_close(handle);
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "database/async_table_widget.h"
+
+#include <any>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct Tick {
+    int64_t id;
+    double price;
+    std::string venue;
+};
+
+using Row = db::AsyncTableWidget::Row;
+
+static Row MakeRow(const Tick& tick) {
+    return {{std::to_string(tick.id), std::to_string(tick.price), tick.venue}, std::any(tick)};
+}
+
+int main() {
+    std::vector<Tick> ticks = {{1, 10.0, "A"}, {2, 20.0, "B"}, {3, 30.0, "C"}};
+
+    db::AsyncTableWidget widget;
+    widget.AddColumn("ID");
+    widget.AddColumn("Price");
+    widget.AddColumn("Venue");
+    widget.SetColumnTypedExtractor(0, [](const Row& row) { return std::any(std::any_cast<const Tick&>(row.userData).id); });
+    widget.SetColumnTypedExtractor(1, [](const Row& row) { return std::any(std::any_cast<const Tick&>(row.userData).price); });
+    widget.SetRefreshCallback([&](auto& rows) {
+        for (const auto& tick : ticks) rows.push_back(MakeRow(tick));
+    });
+    widget.EnableChangeHighlight([](const Row& row) { return (uint64_t)std::any_cast<const Tick&>(row.userData).id; }, 60.0f);
+    widget.SetSort(0, ImGuiSortDirection_Ascending);
+
+    // First refresh: nothing to compare against
+    widget.Refresh();
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++) {
+            if (widget.GetCellChange(row, col) != db::CellChange::None) return 1;
+        }
+    }
+
+    // Price up on 1, down on 3, venue change on 2, new row 4; matched by key despite the sort
+    ticks = {{4, 5.0, "D"}, {3, 25.0, "C"}, {2, 20.0, "Z"}, {1, 11.0, "A"}};
+    widget.SetSort(0, ImGuiSortDirection_Descending);
+    widget.Refresh();
+    // Displayed: 4, 3, 2, 1
+    if (widget.GetCellChange(0, 0) != db::CellChange::Changed || widget.GetCellChange(0, 2) != db::CellChange::Changed) return 2;
+    if (widget.GetCellChange(1, 1) != db::CellChange::Down || widget.GetCellChange(1, 0) != db::CellChange::None) return 3;
+    if (widget.GetCellChange(2, 2) != db::CellChange::Changed || widget.GetCellChange(2, 1) != db::CellChange::None) return 4;
+    if (widget.GetCellChange(3, 1) != db::CellChange::Up || widget.GetCellChange(3, 2) != db::CellChange::None) return 5;
+
+    // Unchanged rows keep fading from their last change; a new change replaces the marks
+    ticks = {{4, 5.0, "D"}, {3, 25.0, "C"}, {2, 21.0, "Z"}, {1, 11.0, "A"}};
+    widget.Refresh();
+    if (widget.GetCellChange(1, 1) != db::CellChange::Down) return 6;
+    if (widget.GetCellChange(2, 1) != db::CellChange::Up || widget.GetCellChange(2, 2) != db::CellChange::None) return 7;
+
+    // Tracker: counts and reset
+    db::CellChangeTracker<Row> tracker([](const Row& row) { return (uint64_t)std::stoll(row.columns[0]); }, {});
+    std::vector<Row> before = {{"1", "x"}, {"2", "y"}};
+    std::vector<Row> after = {{"2", "y"}, {"1", "w"}};
+    tracker.Apply(before, {}, 2, 0.0f);
+    auto changes = tracker.Apply(after, before, 2, 1.0f);
+    if (tracker.LastChangedRows() != 1 || changes->Get(1, 1) != db::CellChange::Changed) return 8;
+    if (changes->changedAt[0] >= 0 || changes->changedAt[1] != 1.0f) return 9;
+    tracker.Reset();
+    changes = tracker.Apply(before, after, 2, 2.0f);
+    if (tracker.LastChangedRows() != 0 || changes->changedAt[1] >= 0) return 10;
+
+    return 0;
+}
@@ -0,0 +1,252 @@
+#include "database/collection_persistence.h"
+
+#include <sqlite3.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Positions keyed by symbol with an ordered index: elem1 = price, elem2 = qty
+using Positions = reactive::ReactiveTwoFieldCollection<
+    double, long, long, double,
+    reactive::detail::DefaultDelta1<double, long, long>,
+    reactive::detail::DefaultApplyAdd<long, long>,
+    reactive::detail::DefaultDelta2<double, long, double>,
+    reactive::detail::DefaultApplyAdd<double, double>,
+    std::string, reactive::AggMode::Add, reactive::AggMode::Add,
+    reactive::DefaultExtract1<double, long, long>,
+    reactive::DefaultExtract2<double, long, double>,
+    false, true>;
+
+using Store = db::CollectionPersistence<Positions>;
+
+static sqlite3* Open(const std::string& path) {
+    sqlite3* handle = nullptr;
+    if (sqlite3_open(path.c_str(), &handle) != SQLITE_OK) return nullptr;
+    sqlite3_exec(handle, "PRAGMA journal_mode = WAL", nullptr, nullptr, nullptr);
+    return handle;
+}
+
+static long CountRows(sqlite3* handle) {
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(handle, "SELECT count(*) FROM positions", -1, &stmt, nullptr);
+    long n = sqlite3_step(stmt) == SQLITE_ROW ? static_cast<long>(sqlite3_column_int64(stmt, 0)) : -1;
+    sqlite3_finalize(stmt);
+    return n;
+}
+
+static std::string Symbol(int i) { return "SYM" + std::to_string(i); }
+
+int main() {
+    const std::string path = (std::filesystem::temp_directory_path() / "collection_persistence_test.db").string();
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + "-wal");
+    std::filesystem::remove(path + "-shm");
+
+    constexpr int kPositions = 20000;
+    std::map<std::string, std::pair<double, long>> expected;
+    long expectedQty = 0;
+    double expectedNotional = 0.0;
+    std::size_t maxId = 0;
+
+    // 1) First session: every change reaches the table
+    {
+        sqlite3* handle = Open(path);
+        if (!handle) return 1;
+        {
+            Positions positions;
+            Store store(positions, handle, "positions");
+            for (int i = 0; i < kPositions; i++) positions.push_back(1.0 + i % 100, i % 7 + 1, Symbol(i));
+            for (int i = 0; i < kPositions; i += 3) {
+                auto id = positions.find_by_key(Symbol(i));
+                positions.elem1Var(*id).value(500.0 + i % 13);
+                positions.elem2Var(*id).value(i % 11 + 2);
+            }
+            for (int i = 1; i < kPositions; i += 10) positions.erase_by_key(Symbol(i));
+
+            // Inserted and erased within one batch: never written
+            auto transient = positions.push_back(9.0, 9, std::string("TRANSIENT"));
+            positions.erase(transient);
+
+            store.Flush();
+            const Store::Stats stats = store.GetStats();
+            if (stats.pending != 0 || stats.failedBatches != 0 || stats.batches == 0) return 2;
+            if (CountRows(handle) != static_cast<long>(positions.size())) return 3;
+
+            // Changes after the flush are committed by the destructor
+            positions.elem2Var(*positions.find_by_key(Symbol(0))).value(42);
+
+            for (auto it = positions.cbegin(); it != positions.cend(); ++it) {
+                const auto& rec = it->second;
+                maxId = std::max(maxId, it->first);
+                expected[rec.key] = {rec.lastElem1, rec.lastElem2};
+            }
+            expected[Symbol(0)].second = 42;
+            expectedQty = positions.total1();
+            expectedNotional = positions.total2();
+        }
+        sqlite3_close(handle);
+    }
+
+    // 2) Restart: restore from the table, no feed replay
+    {
+        sqlite3* handle = Open(path);
+        if (!handle) return 4;
+        {
+            Positions positions;
+            Store store(positions, handle, "positions");
+            const auto start = std::chrono::steady_clock::now();
+            const std::size_t restored = store.Restore();
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            std::printf("restore: %zu positions in %.1f ms\n", restored, ms);
+
+            if (restored != expected.size() || positions.size() != expected.size()) return 5;
+            if (positions.total1() != expectedQty) return 6;
+            if (std::fabs(positions.total2() - expectedNotional) > 1e-6 * std::fabs(expectedNotional)) return 7;
+            for (const auto& [key, values] : expected) {
+                auto id = positions.find_by_key(key);
+                if (!id) return 8;
+                if (positions.elem1Var(*id).get() != values.first || positions.elem2Var(*id).get() != values.second) {
+                    return 9;
+                }
+            }
+            if (positions.find_by_key(std::string("TRANSIENT"))) return 10;
+
+            // Ordered index rebuilt: ascending (price, qty)
+            std::pair<double, long> last{-1.0, -1};
+            bool sorted = true;
+            std::size_t visited = 0;
+            positions.for_each_ordered([&](std::size_t, const Positions::ElemRecordSnapshot& snap) {
+                const std::pair<double, long> cur{snap.lastElem1, snap.lastElem2};
+                if (cur < last) sorted = false;
+                last = cur;
+                visited++;
+            });
+            if (!sorted || visited != expected.size()) return 11;
+
+            // Restored elements stay reactive; new ids continue after the restored ones
+            auto id0 = *positions.find_by_key(Symbol(0));
+            positions.elem2Var(id0).value(43);
+            if (positions.total1() != expectedQty + 1) return 12;
+            if (positions.push_back(1.0, 1, std::string("NEW")) <= maxId) return 13;
+
+            // bulk_load only fills an empty collection
+            bool threw = false;
+            try {
+                positions.bulk_load({Positions::LoadRecord{maxId + 100, 1.0, 1, "X"}});
+            } catch (const std::runtime_error&) {
+                threw = true;
+            }
+            if (!threw) return 14;
+        }
+        if (CountRows(handle) != static_cast<long>(expected.size()) + 1) return 15;
+        sqlite3_close(handle);
+    }
+
+    // 3) Duplicate ids are rejected and leave the collection empty
+    {
+        Positions positions;
+        bool threw = false;
+        try {
+            positions.bulk_load({Positions::LoadRecord{1, 1.0, 1, "A"}, Positions::LoadRecord{1, 2.0, 2, "B"}});
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        if (!threw || !positions.empty() || positions.find_by_key(std::string("A"))) return 16;
+    }
+
+    // 4) Writers sharing one :memory: handle: two stores, a statement-at-a-time writer and a
+    //    bulk job that gets cancelled. Every hedge batch is rolled back until the poison row
+    //    is removed; nothing another writer did may be rolled back with it, or land in it.
+    {
+        sqlite3* handle = nullptr;
+        if (sqlite3_open_v2(":memory:", &handle, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX,
+                            nullptr) != SQLITE_OK) {
+            return 17;
+        }
+        sqlite3_exec(handle, "CREATE TABLE other (id INTEGER, name TEXT)", nullptr, nullptr, nullptr);
+        sqlite3_exec(handle, "INSERT INTO other VALUES (1, 'a'), (2, 'b'), (3, 'c')", nullptr, nullptr, nullptr);
+        {
+            Positions positions;
+            Positions hedges;
+            Store store(positions, handle, "positions");
+            Store hedgeStore(hedges, handle, "hedges", Store::Options{64, std::chrono::milliseconds(1)});
+            sqlite3_exec(handle,
+                         "CREATE TRIGGER poison BEFORE INSERT ON hedges WHEN NEW.key = 'POISON' "
+                         "BEGIN SELECT RAISE(ABORT, 'poison'); END",
+                         nullptr, nullptr, nullptr);
+
+            BulkMutationJob job;
+            std::atomic<bool> started{false};
+            BulkUpdateRequest req;
+            req.table = "other";
+            req.orderBy = "rowid";
+            req.keyColumn = "id";
+            req.chunkSize = 1;
+            req.stagedColumns = {"name"};
+            req.valueProvider = [&](const BulkTarget& target, std::vector<BulkValue>& values) {
+                if (target.seq == 0) {
+                    started = true;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                    job.Cancel();
+                }
+                values[0] = std::string("bulk");
+            };
+            std::thread bulk([&] { bulk_detail::RunBulkUpdateExclusive(handle, req, job); });
+            while (!started) std::this_thread::yield();
+
+            std::atomic<bool> stop{false};
+            long inserted = 0;
+            std::thread single([&] {
+                for (long id = 100; !stop; id++) {
+                    const std::string sql = "INSERT INTO other VALUES (" + std::to_string(id) + ", 'single')";
+                    if (sqlite3_exec(handle, sql.c_str(), nullptr, nullptr, nullptr) == SQLITE_OK) inserted++;
+                }
+            });
+            std::thread hedger([&] {
+                hedges.push_back(2.0, 1, std::string("POISON"));
+                for (int i = 0; i < 2000; i++) hedges.push_back(2.0, i % 5 + 1, Symbol(i));
+            });
+            for (int i = 0; i < 2000; i++) {
+                positions.push_back(1.0, i % 3 + 1, Symbol(i));
+                if (i % 100 == 0) store.Flush();
+            }
+            hedger.join();
+            bulk.join();
+            store.Flush();
+            stop = true;
+            single.join();
+
+            if (job.GetState() != BulkMutationJob::State::Cancelled) return 18;
+            if (store.GetStats().failedBatches != 0 || hedgeStore.GetStats().failedBatches == 0) return 19;
+            if (CountRows(handle) != 2000) return 20;
+
+            // The poisoned batches rolled back only their own rows
+            hedges.erase_by_key(std::string("POISON"));
+            hedgeStore.Flush();
+            if (hedgeStore.GetStats().pending != 0) return 21;
+            sqlite3_stmt* stmt = nullptr;
+            sqlite3_prepare_v2(handle,
+                               "SELECT (SELECT count(*) FROM hedges), "
+                               "(SELECT count(*) FROM other WHERE name = 'bulk'), "
+                               "(SELECT count(*) FROM other WHERE name = 'single')",
+                               -1, &stmt, nullptr);
+            const bool ok = sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_int64(stmt, 0) == 2000 &&
+                            sqlite3_column_int64(stmt, 1) == 0 && sqlite3_column_int64(stmt, 2) == inserted;
+            sqlite3_finalize(stmt);
+            if (!ok || !sqlite3_get_autocommit(handle)) return 22;
+        }
+        sqlite3_close(handle);
+    }
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + "-wal");
+    std::filesystem::remove(path + "-shm");
+    return 0;
+}
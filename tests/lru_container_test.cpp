@@ -0,0 +1,146 @@
+#include "database/foo_multi_index_table_model.h"
+#include "database/lru_container.h"
+
+#include <cstdint>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+#include <boost/multi_index/tag.hpp>
+
+struct Item {
+    int64_t id;
+    int value;
+};
+
+struct ById {};
+
+using Cache = db::LruContainer<
+    Item, boost::multi_index::indexed_by<boost::multi_index::ordered_unique<
+              boost::multi_index::tag<ById>, boost::multi_index::member<Item, int64_t, &Item::id>>>>;
+
+struct Priced {
+    int64_t id;
+    double price;
+};
+
+struct ByPrice {};
+
+using PricedCache = db::LruContainer<
+    Priced, boost::multi_index::indexed_by<
+                boost::multi_index::ordered_unique<boost::multi_index::tag<ById>,
+                                                   boost::multi_index::member<Priced, int64_t, &Priced::id>>,
+                boost::multi_index::ordered_non_unique<boost::multi_index::tag<ByPrice>,
+                                                       boost::multi_index::member<Priced, double, &Priced::price>>>>;
+
+static bool Has(const Cache& c, int64_t id) { return c.find_no_update<ById>(id) != c.end<ById>(); }
+
+static std::vector<int64_t> Recent(const Cache& c) {
+    std::vector<int64_t> ids;
+    for (const auto& item : c.get_container().get<0>()) ids.push_back(item.id);
+    return ids;
+}
+
+int main() {
+    // Exact LRU: unchanged multi_index_lru semantics
+    {
+        Cache c(3);
+        for (int64_t id = 1; id <= 3; id++) c.insert({id, 0});
+        c.find<ById>(1);
+        c.insert({4, 0});
+        if (Has(c, 2) || !Has(c, 1) || c.size() != 3) return 1;
+        if (Recent(c) != std::vector<int64_t>{4, 1, 3}) return 2;
+        if (c.insert({3, 9})) return 3; // duplicate: refreshed, not replaced
+        if (Recent(c) != std::vector<int64_t>{3, 4, 1}) return 4;
+    }
+
+    // CLOCK: a shared-lock lookup gives the entry a second chance
+    {
+        Cache c(3, db::EvictionPolicy::Clock);
+        for (int64_t id = 1; id <= 3; id++) c.insert({id, 0});
+        if (Recent(c) != std::vector<int64_t>{3, 2, 1}) return 5;
+        if (c.find_shared<ById>(1) == c.end<ById>()) return 6;
+        c.insert({4, 0});
+        if (!Has(c, 1) || Has(c, 2) || c.evictions() != 1) return 7;
+        if (Recent(c) != std::vector<int64_t>{1, 4, 3}) return 8;
+        // 1 went back to the front with its bit cleared; 3 is now the oldest
+        c.insert({5, 0});
+        if (!Has(c, 1) || Has(c, 3) || !Has(c, 4)) return 9;
+
+        if (!c.erase<ById>(4) || c.erase<ById>(4)) return 10;
+        c.insert({6, 0});
+        c.insert({7, 0});
+        if (c.size() != 3 || !Has(c, 7) || !Has(c, 6)) return 11;
+
+        // Every entry referenced: one pass clears the bits, then the oldest goes (never the new one)
+        for (int64_t id : Recent(c)) c.find_shared<ById>(id);
+        auto before = Recent(c);
+        c.insert({8, 0});
+        if (c.size() != 3 || !Has(c, 8) || Has(c, before.back())) return 12;
+    }
+
+    // In-place upsert keeps the node, repositions the changed index and refreshes recency
+    {
+        PricedCache c(10);
+        for (int64_t id = 1; id <= 3; id++) c.insert({id, 10.0 * static_cast<double>(id)});
+        const Priced* node = &*c.find_no_update<ById>(1);
+        if (!c.upsert<ById>({1, 25.0}) || &*c.find_no_update<ById>(1) != node) return 30;
+        std::vector<int64_t> byPrice;
+        for (const auto& e : c.get_container().get<ByPrice>()) byPrice.push_back(e.id);
+        if (byPrice != std::vector<int64_t>{2, 1, 3}) return 31;
+        if (c.get_container().get<0>().front().id != 1 || c.size() != 3) return 32;
+        if (!c.upsert<ById>({4, 1.0}) || c.size() != 4) return 33;
+        if (c.modify<ById>(9, [](Priced& p) { p.price = 0; })) return 34;
+        if (!c.modify<ById>(3, [](Priced& p) { p.price = 0; }) || c.get_container().get<ByPrice>().begin()->id != 3) return 35;
+    }
+
+    // Many readers touching under a shared lock while a writer inserts
+    {
+        Cache c(1000, db::EvictionPolicy::Clock);
+        std::shared_mutex mutex;
+        for (int64_t id = 0; id < 1000; id++) c.insert({id, 0});
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 4; r++) {
+            readers.emplace_back([&] {
+                for (int i = 0; i < 20000; i++) {
+                    std::shared_lock lock(mutex);
+                    c.find_shared<ById>(i % 100); // hot set
+                }
+            });
+        }
+        for (int64_t id = 1000; id < 5000; id++) {
+            std::unique_lock lock(mutex);
+            c.insert({id, 0});
+        }
+        for (auto& t : readers) t.join();
+        if (c.size() != 1000) return 13;
+    }
+
+    // Model: FindById with CLOCK keeps a hot row alive across churn
+    {
+        db::FooMultiIndexTableModel model(4, db::EvictionPolicy::Clock);
+        for (int64_t id = 1; id <= 4; id++) model.Upsert({id, "n" + std::to_string(id), false});
+        for (int64_t id = 5; id <= 40; id++) {
+            if (!model.FindById(1)) return 14;
+            model.Upsert({id, "n" + std::to_string(id), true});
+        }
+        auto row = model.FindByIdNoUpdate(1);
+        if (!row || row->name != "n1" || model.Size() != 4) return 15;
+        std::vector<db::AsyncTableWidget::Row> rows;
+        model.BuildAsyncRows(rows, {});
+        if (rows.size() != 4) return 16;
+        bool has40 = false;
+        for (const auto& r : rows) has40 = has40 || r.columns[0] == "40";
+        if (!has40) return 16;
+
+        db::FooMultiIndexTableModel lru(2);
+        lru.Upsert({1, "a", false});
+        lru.Upsert({2, "b", false});
+        if (!lru.FindById(1)) return 17;
+        lru.Upsert({3, "c", false});
+        if (!lru.FindById(1) || lru.FindById(2)) return 18;
+    }
+    return 0;
+}
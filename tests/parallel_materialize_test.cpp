@@ -0,0 +1,95 @@
+#include "database/market_data_multi_index_table_model.h"
+#include "database/parallel_for.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Query = db::MarketDataMultiIndexTableModel::Query;
+
+int main() {
+    // Every index visited exactly once, also with concurrent callers
+    std::vector<std::atomic<int>> hits(100000);
+    std::vector<std::thread> callers;
+    for (int t = 0; t < 3; t++) {
+        callers.emplace_back([&] {
+            db::ParallelPool::Get().For(hits.size(), 777, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++) hits[i].fetch_add(1, std::memory_order_relaxed);
+            });
+        });
+    }
+    for (auto& t : callers) t.join();
+    for (const auto& h : hits) {
+        if (h.load() != 3) return 1;
+    }
+
+    // Prices format exactly like std::to_string
+    for (double price : {0.0, 1.5, -2.25, 123.456789123, 1e15, 0.0000004}) {
+        db::MarketDataCacheEntry entry{1, "AAPL", "XNAS", 2, price};
+        if (db::MarketDataMultiIndexTableModel::MakeAsyncRow(entry).columns[4] != std::to_string(price)) return 2;
+    }
+
+    // Parallel materialization keeps the serial order and content
+    db::MarketDataMultiIndexTableModel model(60000);
+    for (int64_t id = 1; id <= 50000; id++) {
+        model.Upsert({id, id % 3 ? "AAPL" : "MSFT", "XNAS", 1000 + id, 10.0 + static_cast<double>(id % 997) / 4});
+    }
+    Query all;
+    all.order = db::MarketDataMultiIndexTableModel::Order::PriceDesc;
+    std::vector<db::AsyncTableWidget::Row> rows;
+    const auto start = std::chrono::steady_clock::now();
+    model.BuildAsyncRows(rows, all);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::printf("50000 rows in %.2f ms on %u pool workers\n", ms, db::ParallelPool::Get().WorkerCount());
+    if (rows.size() != 50000) return 3;
+    double last = 1e9;
+    for (const auto& row : rows) {
+        const auto* data = std::any_cast<db::MarketDataTypedData>(&row.userData);
+        if (!data || std::to_string(data->id) != row.columns[0] || data->price > last) return 4;
+        last = data->price;
+    }
+    Query page = all;
+    page.offset = 100;
+    page.limit = 10;
+    std::vector<db::AsyncTableWidget::Row> pageRows;
+    model.BuildAsyncRows(pageRows, page);
+    if (pageRows.size() != 10 || pageRows[0].columns != rows[100].columns) return 5;
+
+    // Formatting runs after the lock is released: writes during it must not leave a stale
+    // cached result, and every row is formatted from one consistent entry
+    std::atomic<bool> stop{false};
+    std::thread writer([&] {
+        for (int round = 0; !stop.load(); round++) {
+            for (int64_t id = 1; id <= 50000; id += 7) {
+                const double price = 10.0 + static_cast<double>((id + round) % 997) / 4;
+                model.Upsert({id, id % 3 ? "AAPL" : "MSFT", "XNAS", 1000 + id, price});
+            }
+        }
+    });
+    for (int i = 0; i < 20; i++) {
+        model.BuildAsyncRows(rows, all);
+        for (const auto& row : rows) {
+            const auto* data = std::any_cast<db::MarketDataTypedData>(&row.userData);
+            if (!data || std::to_string(data->id) != row.columns[0] || std::to_string(data->price) != row.columns[4]) {
+                stop = true;
+                writer.join();
+                return 6;
+            }
+        }
+    }
+    stop = true;
+    writer.join();
+    model.BuildAsyncRows(rows, all);
+    model.SetResultCacheCapacity(0);
+    std::vector<db::AsyncTableWidget::Row> fresh;
+    model.BuildAsyncRows(fresh, all);
+    if (rows.size() != fresh.size()) return 7;
+    for (std::size_t i = 0; i < rows.size(); i++) {
+        if (rows[i].columns != fresh[i].columns) return 7;
+    }
+    return 0;
+}
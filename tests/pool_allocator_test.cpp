@@ -0,0 +1,123 @@
+#include "database/pool_allocator.h"
+#include "database/reactive_two_field_collection.h"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+struct Node {
+    std::int64_t a;
+    double b;
+    char pad[40];
+};
+
+using PooledCollection = reactive::ReactiveTwoFieldCollection<
+    double, long, long, double,
+    reactive::detail::DefaultDelta1<double, long, long>,
+    reactive::detail::DefaultApplyAdd<long, long>,
+    reactive::detail::DefaultDelta2<double, long, double>,
+    reactive::detail::DefaultApplyAdd<double, double>,
+    std::monostate, reactive::AggMode::Add, reactive::AggMode::Add,
+    reactive::DefaultExtract1<double, long, long>,
+    reactive::DefaultExtract2<double, long, double>,
+    false, false, reactive::DefaultCompare<double, long>, std::unordered_map,
+    db::PoolAllocPolicy>;
+
+using PlainCollection = reactive::ReactiveTwoFieldCollection<double, long>;
+
+// Insert/erase churn over a fixed-size working set
+template <typename Collection>
+static double Churn(Collection& c, std::size_t live, std::size_t rounds) {
+    std::vector<typename Collection::id_type> ids;
+    for (std::size_t i = 0; i < live; i++) ids.push_back(c.push_back(1.0, 1));
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t r = 0; r < rounds; r++) {
+        for (std::size_t i = r % 7; i < ids.size(); i += 7) {
+            c.erase(ids[i]);
+            ids[i] = c.push_back(static_cast<double>(r), static_cast<long>(i));
+        }
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main() {
+    using Alloc = db::PoolAllocator<Node>;
+    const db::PoolStats empty = Alloc::Stats();
+    if (empty.live != 0 || empty.slotSize < sizeof(Node)) return 1;
+
+    // Freed slots are reused: churn does not grow the pool
+    {
+        Alloc alloc;
+        std::vector<Node*> nodes;
+        for (int i = 0; i < 5000; i++) nodes.push_back(alloc.allocate(1));
+        const db::PoolStats full = Alloc::Stats();
+        if (full.live != 5000 || full.capacity < full.live || full.free != full.capacity - full.live) return 2;
+        for (int round = 0; round < 20; round++) {
+            for (std::size_t i = round % 2; i < nodes.size(); i += 2) alloc.deallocate(nodes[i], 1);
+            for (std::size_t i = round % 2; i < nodes.size(); i += 2) nodes[i] = alloc.allocate(1);
+        }
+        if (Alloc::Stats().slabs != full.slabs) return 3;
+        for (auto* p : nodes) alloc.deallocate(p, 1);
+    }
+    if (Alloc::Stats().live != 0) return 4;
+
+    // Allocated on one thread, freed on another; the exiting thread's cache goes back to the pool
+    {
+        std::vector<Node*> handoff(10000);
+        std::thread producer([&] {
+            Alloc alloc;
+            for (auto& p : handoff) p = alloc.allocate(1);
+        });
+        producer.join();
+        Alloc alloc;
+        for (auto* p : handoff) alloc.deallocate(p, 1);
+        const db::PoolStats s = Alloc::Stats();
+        if (s.live != 0 || s.free != s.capacity) return 5;
+    }
+
+    // Frees from a thread_local destructor that runs after the thread's cache is gone
+    {
+        struct Holder {
+            std::vector<Node*> nodes;
+            ~Holder() {
+                Alloc alloc;
+                for (auto* p : nodes) alloc.deallocate(p, 1);
+            }
+        };
+        std::thread worker([] {
+            thread_local Holder holder; // constructed before the cache, so destroyed after it
+            Alloc alloc;
+            for (int i = 0; i < 1000; i++) holder.nodes.push_back(alloc.allocate(1));
+        });
+        worker.join();
+        const db::PoolStats s = Alloc::Stats();
+        if (s.live != 0 || s.free != s.capacity) return 11;
+    }
+
+    // Collection node maps draw from the pools
+    {
+        PooledCollection c;
+        std::vector<PooledCollection::id_type> ids;
+        for (int i = 0; i < 1000; i++) ids.push_back(c.push_back(1.0 + i, i));
+        auto stats = PooledCollection::allocator_stats();
+        if (stats.elems.live < 1000 || stats.monitors.live < 1000) return 6;
+        for (auto id : ids) c.erase(id);
+        if (!c.empty() || c.total1() != 0) return 7;
+        stats = PooledCollection::allocator_stats();
+        if (stats.elems.live != 0 || stats.monitors.live != 0) return 8;
+        if (PlainCollection::allocator_stats().elems.capacity != 0) return 9;
+    }
+
+    {
+        PlainCollection plain;
+        PooledCollection pooled;
+        const double plainMs = Churn(plain, 20000, 50);
+        const double pooledMs = Churn(pooled, 20000, 50);
+        if (plain.size() != 20000 || pooled.size() != 20000 || plain.total1() != pooled.total1()) return 10;
+        const auto stats = PooledCollection::allocator_stats().elems;
+        std::printf("churn: std::allocator %.1f ms, pool %.1f ms (elem slots live %zu, free %zu, %zu slabs)\n",
+                    plainMs, pooledMs, stats.live, stats.free, stats.slabs);
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include "database/async_table_widget.h"
+#include "database/foo_multi_index_table_model.h"
+#include "database/market_data_multi_index_table_model.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using Order = db::MarketDataMultiIndexTableModel::Order;
+using Query = db::MarketDataMultiIndexTableModel::Query;
+using Rows = std::vector<db::AsyncTableWidget::Row>;
+
+static db::MarketDataCacheEntry Tick(int64_t id, const char* symbol, double price) {
+    return {id, symbol, "XNAS", 1000 + id, price};
+}
+
+static std::vector<std::string> Ids(const Rows& rows) {
+    std::vector<std::string> ids;
+    for (const auto& row : rows) ids.push_back(row.columns[0]);
+    return ids;
+}
+
+int main() {
+    db::MarketDataMultiIndexTableModel model(100);
+    for (int64_t id = 1; id <= 20; id++) model.Upsert(Tick(id, id % 2 ? "AAPL" : "MSFT", 10.0 + id));
+
+    Query aapl;
+    aapl.symbolEq = "AAPL";
+    aapl.order = Order::PriceDesc;
+    Query msft = aapl;
+    msft.symbolEq = "MSFT";
+    Query lru;
+    lru.order = Order::LruMostRecentFirst;
+    lru.symbolEq = "AAPL";
+
+    const auto& cache = model.GetResultCache();
+    Rows rows, again;
+    // Stored on the second request, served from the cache on the third
+    model.BuildAsyncRows(rows, aapl);
+    model.BuildAsyncRows(rows, aapl);
+    model.BuildAsyncRows(again, aapl);
+    if (cache.Hits() != 1 || Ids(again) != Ids(rows) || rows.size() != 10) return 1;
+    model.BuildAsyncRows(rows, msft);
+    model.BuildAsyncRows(rows, msft);
+    model.BuildAsyncRows(rows, lru);
+    model.BuildAsyncRows(rows, lru);
+
+    // A MSFT tick cannot change the AAPL results
+    const auto generation = model.GetGeneration();
+    model.Upsert(Tick(2, "MSFT", 99.0));
+    if (model.GetGeneration() == generation) return 2;
+    model.BuildAsyncRows(rows, aapl);
+    if (cache.Hits() != 2) return 3;
+    model.BuildAsyncRows(rows, msft);
+    if (cache.Hits() != 2 || rows.front().columns[0] != "2") return 4;
+
+    // An AAPL tick invalidates both AAPL queries, and the result reflects it
+    model.Upsert(Tick(3, "AAPL", 500.0));
+    model.BuildAsyncRows(rows, aapl);
+    if (cache.Hits() != 2 || rows.front().columns[0] != "3") return 5;
+    model.BuildAsyncRows(rows, lru);
+    if (cache.Hits() != 2 || rows.front().columns[0] != "3") return 6;
+
+    // Recency-only change (exact LRU lookup) only affects LRU-ordered queries
+    model.BuildAsyncRows(rows, aapl);
+    model.BuildAsyncRows(rows, lru);
+    const auto hits = cache.Hits();
+    if (!model.FindById(5)) return 7;
+    model.BuildAsyncRows(rows, aapl);
+    if (cache.Hits() != hits + 1) return 8;
+    model.BuildAsyncRows(rows, lru);
+    if (cache.Hits() != hits + 1 || rows.front().columns[0] != "5") return 9;
+
+    // A symbol change is seen by queries on the old and the new symbol
+    model.BuildAsyncRows(rows, msft);
+    model.BuildAsyncRows(rows, msft);
+    model.Upsert(Tick(7, "MSFT", 1.0));
+    model.BuildAsyncRows(rows, aapl);
+    if (rows.size() != 9) return 10;
+    model.BuildAsyncRows(rows, msft);
+    if (rows.size() != 11) return 11;
+
+    // Erase and eviction
+    model.EraseById(9);
+    model.BuildAsyncRows(rows, aapl);
+    if (rows.size() != 8) return 12;
+    db::MarketDataMultiIndexTableModel small(3);
+    for (int64_t id = 1; id <= 3; id++) small.Upsert(Tick(id, "AAPL", static_cast<double>(id)));
+    small.BuildAsyncRows(rows, msft);
+    small.BuildAsyncRows(rows, aapl);
+    small.BuildAsyncRows(rows, aapl);
+    small.Upsert(Tick(4, "MSFT", 4.0)); // evicts an AAPL row
+    small.BuildAsyncRows(rows, aapl);
+    if (rows.size() != 2) return 13;
+
+    // Foo model: same contract
+    db::FooMultiIndexTableModel foo(100);
+    for (int64_t id = 1; id <= 10; id++) foo.Upsert({id, "n" + std::to_string(id), id % 2 == 0});
+    db::FooMultiIndexTableModel::Query fun;
+    fun.hasFunFilter = true;
+    fun.order = db::FooMultiIndexTableModel::Order::IdAsc;
+    foo.BuildAsyncRows(rows, fun);
+    foo.BuildAsyncRows(rows, fun);
+    foo.Upsert({3, "n3", false});
+    foo.BuildAsyncRows(rows, fun);
+    if (foo.GetResultCache().Hits() != 1 || rows.size() != 5) return 14;
+    foo.Upsert({3, "n3", true});
+    foo.BuildAsyncRows(rows, fun);
+    if (foo.GetResultCache().Hits() != 1 || rows.size() != 6) return 15;
+
+    // Widget: an unchanged version skips the refresh callback entirely
+    db::AsyncTableWidget table;
+    db::MarketDataMultiIndexTableModel::ConfigureAsyncTableColumns(table);
+    int calls = 0;
+    table.SetRefreshCallback([&](Rows& out) {
+        calls++;
+        model.BuildAsyncRows(out, aapl);
+    });
+    table.SetRefreshVersionCallback([&] { return model.GetGeneration(); });
+    table.Refresh();
+    table.Refresh();
+    if (calls != 1 || table.GetRowCount() != 8) return 16;
+    model.Upsert(Tick(11, "AAPL", 1.0));
+    table.Refresh();
+    table.Refresh();
+    if (calls != 2) return 17;
+    table.SetStyleRules({db::StyleRule::Above(4, 50.0, IM_COL32(0, 128, 0, 255))});
+    table.Refresh();
+    if (calls != 3) return 18;
+    return 0;
+}
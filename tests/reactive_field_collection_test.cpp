@@ -0,0 +1,141 @@
+#include "database/reactive_field_collection.h"
+
+#include <atomic>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+// Position: price, qty, fees, margin
+using PositionFields = reactive::Fields<double, long, double, double>;
+using PositionTotals = reactive::Totals<
+    reactive::SumOf<1, long>,             // net qty
+    reactive::SumOfProduct<0, 1, double>, // notional
+    reactive::SumOf<2, double>,           // fees
+    reactive::MaxOf<3, double>>;          // largest margin
+
+using Positions = reactive::ReactiveFieldCollection<PositionFields, PositionTotals, std::string, true>;
+
+static bool Near(double a, double b) { return std::fabs(a - b) < 1e-9; }
+
+static bool CheckTotals(const Positions& c, long qty, double notional, double fees, double margin) {
+    return c.total<0>() == qty && Near(c.total<1>(), notional) && Near(c.total<2>(), fees) &&
+           Near(c.total<3>(), margin);
+}
+
+static int Run(bool combined) {
+    Positions c(Positions::policies_type{}, combined);
+    auto a = c.push_back({10.0, 5, 1.0, 100.0}, "AAA");
+    auto b = c.push_back({20.0, 3, 0.5, 300.0}, "BBB");
+    if (c.size() != 2 || !CheckTotals(c, 8, 110.0, 1.5, 300.0)) return 1;
+
+    // One field through its Var: every total sees the change
+    c.fieldVar<1>(a).value(7);
+    if (!CheckTotals(c, 10, 130.0, 1.5, 300.0)) return 2;
+    if (c.values(a) != std::make_tuple(10.0, 7L, 1.0, 100.0)) return 3;
+
+    // All fields at once
+    c.assign(b, {30.0, 1, 2.0, 50.0});
+    if (!CheckTotals(c, 8, 100.0, 3.0, 100.0)) return 4;
+
+    // Ordered index (lexicographic on the tuple): a (10.0) before b (30.0)
+    if (c.bottom_k(2) != std::vector<std::size_t>{a, b}) return 5;
+    c.fieldVar<0>(a).value(40.0);
+    if (c.bottom_k(2) != std::vector<std::size_t>{b, a}) return 6;
+    auto it = c.ordered_begin();
+    if (it == c.ordered_end() || (*it).first != b || (*it).second.key != "BBB") return 7;
+    std::vector<std::size_t> visited;
+    c.for_each_ordered([&](std::size_t id, const Positions::ElemRecordSnapshot& snap) {
+        if (id == a && std::get<0>(snap.last) == 40.0 && snap.key == "AAA") visited.push_back(id);
+        if (id == b) visited.push_back(id);
+    });
+    if (visited != std::vector<std::size_t>{b, a}) return 7;
+
+    // Custom comparator: by margin, descending
+    c.set_compare([](const Positions::values_type& x, const Positions::values_type& y) {
+        return std::get<3>(x) > std::get<3>(y);
+    });
+    if (c.top_k(1) != std::vector<std::size_t>{b}) return 8;
+
+    // Keys and erase
+    if (c.find_by_key(std::string("BBB")) != b) return 9;
+    c.erase_by_key(std::string("BBB"));
+    if (c.size() != 1 || c.find_by_key(std::string("BBB")) || !CheckTotals(c, 7, 280.0, 1.0, 100.0)) return 10;
+    c.erase(a);
+    if (!c.empty() || !CheckTotals(c, 0, 0.0, 0.0, 0.0)) return 11;
+
+    // Batch push
+    std::vector<Positions::values_type> vals{{1.0, 1, 0.1, 10.0}, {2.0, 2, 0.2, 20.0}};
+    std::vector<std::string> keys{"X", "Y"};
+    c.push_back(vals, &keys);
+    if (c.size() != 2 || !CheckTotals(c, 3, 5.0, 0.3, 20.0) || !c.find_by_key(std::string("Y"))) return 12;
+    return 0;
+}
+
+// Custom apply policy: clamp the summed qty
+struct ClampQty {
+    bool operator()(long& total, const long& d) const {
+        long v = std::min(10L, total + d);
+        if (v == total) return false;
+        total = v;
+        return true;
+    }
+};
+
+// Seqlock: a reader never sees a half-written record
+template <typename Record, typename Store, typename Consistent>
+static bool NoTornReads(Record& rec, Store&& store, Consistent&& consistent) {
+    std::atomic<bool> stop{false};
+    std::atomic<bool> torn{false};
+    std::thread reader([&] {
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (!consistent(rec.load_last())) torn = true;
+        }
+    });
+    for (long i = 0; i < 200000; ++i) {
+        store(rec, i);
+        if ((i & 1023) == 0) std::this_thread::yield();
+    }
+    stop = true;
+    reader.join();
+    return !torn;
+}
+
+int main() {
+    {
+        static_assert(Positions::lock_free_reads);
+        Positions::ElemRecord rec;
+        bool ok = NoTornReads(
+            rec, [](Positions::ElemRecord& r, long i) { r.store_last({double(i), i, double(i), double(i)}); },
+            [](const Positions::values_type& v) {
+                return std::get<0>(v) == double(std::get<1>(v)) && std::get<2>(v) == std::get<0>(v) &&
+                       std::get<3>(v) == std::get<0>(v);
+            });
+        if (!ok) return 30;
+
+        using TwoField = reactive::ReactiveTwoFieldCollection<double, long>;
+        TwoField::ElemRecord rec2;
+        ok = NoTornReads(
+            rec2, [](TwoField::ElemRecord& r, long i) { r.store_last(double(i), i); },
+            [](const std::pair<double, long>& v) { return v.first == double(v.second); });
+        if (!ok) return 31;
+    }
+
+    if (int rc = Run(false)) return rc;
+    if (int rc = Run(true)) return 20 + rc;
+
+    using Clamped = reactive::ReactiveFieldCollection<
+        reactive::Fields<long>,
+        reactive::Totals<reactive::TotalPolicy<long, reactive::FieldExtract<0, long>, reactive::AggMode::Add,
+                                               reactive::ExtractDelta<long, reactive::FieldExtract<0, long>>,
+                                               ClampQty>,
+                         reactive::MinOf<0, long>>>;
+    Clamped c;
+    auto id = c.push_back(std::make_tuple(6L));
+    c.push_back(std::make_tuple(8L));
+    if (c.total<0>() != 10 || c.total<1>() != 6) return 40;
+    c.fieldVar<0>(id).value(9);
+    if (c.total<0>() != 10 || c.total<1>() != 8) return 41;
+    return 0;
+}
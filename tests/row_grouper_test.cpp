@@ -0,0 +1,94 @@
+#include "database/async_table_widget.h"
+#include "database/row_grouper.h"
+
+#include <any>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using Row = db::AsyncTableWidget::Row;
+
+struct Tick {
+    int64_t id;
+    std::string symbol;
+    std::string venue;
+    double price;
+};
+
+static Row MakeRow(const Tick& t) {
+    return {{std::to_string(t.id), t.symbol, t.venue, std::to_string(t.price)}, std::any(t)};
+}
+
+static const db::GroupSnapshot::Node* Find(const db::GroupSnapshot& s, const std::string& path) {
+    for (const auto& node : s.nodes) {
+        if (node.path == path) return &node;
+    }
+    return nullptr;
+}
+
+int main() {
+    auto price = [](const Row& r) -> std::optional<double> { return std::any_cast<const Tick&>(r.userData).price; };
+    db::RowGrouper<Row> grouper({1, 2},
+                                {{3, db::AggregateOp::Count},
+                                 {3, db::AggregateOp::Sum},
+                                 {3, db::AggregateOp::Min},
+                                 {3, db::AggregateOp::Max},
+                                 {3, db::AggregateOp::Last}},
+                                {nullptr, price, price, price, price},
+                                [](const Row& r) { return (uint64_t)std::any_cast<const Tick&>(r.userData).id; });
+
+    std::vector<Tick> ticks = {
+        {1, "AAPL", "XNAS", 10}, {2, "AAPL", "XNAS", 30}, {3, "AAPL", "BATS", 20},
+        {4, "MSFT", "XNAS", 5},  {5, "MSFT", "BATS", 7},
+    };
+    auto rowsOf = [&] {
+        std::vector<Row> rows;
+        for (const auto& t : ticks) rows.push_back(MakeRow(t));
+        return rows;
+    };
+
+    grouper.Apply(rowsOf());
+    auto snap = grouper.BuildSnapshot(4);
+    if (grouper.GroupCount() != 6 || snap.nodes.size() != 6) return 1;
+    const auto* aapl = Find(snap, "AAPL");
+    if (!aapl || aapl->label != "AAPL (3)" || aapl->cells[3] != "n=3  sum=60  min=10  max=30  last=20") return 2;
+    if (aapl->subtreeEnd != 3 || snap.nodes[1].path != "AAPL\x1f" "BATS") return 3;
+    const auto* aaplXnas = Find(snap, "AAPL\x1f" "XNAS");
+    if (!aaplXnas || aaplXnas->rows != std::vector<size_t>{0, 1}) return 4;
+
+    // Unchanged snapshot: nothing touched, nothing rescanned
+    grouper.Apply(rowsOf());
+    if (grouper.LastTouchedRows() != 0 || grouper.LastRescannedGroups() != 0) return 5;
+
+    // Patch one row: only its path (AAPL, AAPL/XNAS) is rescanned, because 30 was the max
+    ticks[1].price = 12;
+    grouper.Apply(rowsOf());
+    if (grouper.LastTouchedRows() != 1 || grouper.LastRescannedGroups() != 2) return 6;
+    snap = grouper.BuildSnapshot(4);
+    if (Find(snap, "AAPL")->cells[3] != "n=3  sum=42  min=10  max=20  last=12") return 7;
+    if (Find(snap, "MSFT")->cells[3] != "n=2  sum=12  min=5  max=7  last=7") return 8;
+
+    // Move a row to another venue, erase one and drop the emptied group
+    ticks[2].venue = "XNAS";
+    ticks.erase(ticks.begin() + 4);
+    grouper.Apply(rowsOf());
+    snap = grouper.BuildSnapshot(4);
+    if (grouper.LastTouchedRows() != 2) return 9;
+    if (Find(snap, "AAPL\x1f" "BATS") || Find(snap, "MSFT\x1f" "BATS")) return 10;
+    if (Find(snap, "AAPL\x1f" "XNAS")->label != "XNAS (3)") return 11;
+    if (Find(snap, "MSFT")->cells[3] != "n=1  sum=5  min=5  max=5  last=5") return 12;
+
+    // Widget integration: grouping is applied on Refresh
+    db::AsyncTableWidget widget;
+    widget.AddColumn("ID");
+    widget.AddColumn("Symbol");
+    widget.AddColumn("Venue");
+    widget.AddColumn("Price");
+    widget.SetColumnTypedExtractor(3, [](const Row& r) { return std::any(std::any_cast<const Tick&>(r.userData).price); });
+    widget.SetRefreshCallback([&](std::vector<Row>& rows) { rows = rowsOf(); });
+    widget.EnableGrouping({1}, {{3, db::AggregateOp::Sum}});
+    widget.Refresh();
+    if (!widget.IsGrouped() || widget.GetRowCount() != ticks.size()) return 13;
+
+    return 0;
+}
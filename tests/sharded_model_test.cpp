@@ -0,0 +1,153 @@
+#include "database/market_data_multi_index_table_model.h"
+#include "database/sharded_market_data_model.h"
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Order = db::MarketDataMultiIndexTableModel::Order;
+using Query = db::MarketDataMultiIndexTableModel::Query;
+using ShardKey = db::ShardedMarketDataTableModel::ShardKey;
+
+static const char* kSymbols[] = {"AAPL", "MSFT", "NVDA", "AMZN", "META"};
+static const char* kVenues[] = {"XNAS", "BATS"};
+
+static db::MarketDataCacheEntry MakeTick(int64_t id) {
+    // ts and price are unique, so every ordered query has exactly one right answer
+    return {id, kSymbols[(id * 7) % 5], kVenues[id % 2], 1000 + (id * 37) % 1009, 100.0 + static_cast<double>((id * 53) % 1013) / 8};
+}
+
+static std::vector<std::string> Ids(const std::vector<db::AsyncTableWidget::Row>& rows) {
+    std::vector<std::string> ids;
+    for (const auto& row : rows) ids.push_back(row.columns[0]);
+    return ids;
+}
+
+int main() {
+    db::MarketDataMultiIndexTableModel reference(2000);
+    db::ShardedMarketDataTableModel byId(2000, 4, ShardKey::Id);
+    db::ShardedMarketDataTableModel bySymbol(2000, 3, ShardKey::Symbol);
+    for (int64_t id = 1; id <= 1000; id++) {
+        reference.Upsert(MakeTick(id));
+        byId.Upsert(MakeTick(id));
+        bySymbol.Upsert(MakeTick(id));
+    }
+    // Replace some rows; Upsert must not leave the old version behind
+    for (int64_t id = 1; id <= 1000; id += 9) {
+        auto tick = MakeTick(id);
+        tick.price += 1000;
+        reference.Upsert(tick);
+        byId.Upsert(tick);
+        bySymbol.Upsert(tick);
+    }
+    if (byId.Size() != 1000 || bySymbol.Size() != 1000 || byId.ShardCount() != 4) return 1;
+
+    std::vector<Query> queries;
+    for (Order order : {Order::TsAsc, Order::TsDesc, Order::PriceAsc, Order::PriceDesc}) {
+        Query q;
+        q.order = order;
+        queries.push_back(q);
+        q.offset = 100;
+        q.limit = 50;
+        q.minPrice = 150;
+        queries.push_back(q);
+        q = {};
+        q.order = order;
+        q.symbolEq = "NVDA";
+        q.venueEq = "BATS";
+        q.minTs = 1200;
+        q.limit = 20;
+        queries.push_back(q); // (symbol, venue, ts) range path for ts orders
+    }
+
+    std::vector<db::AsyncTableWidget::Row> expected, got;
+    int rc = 10;
+    for (const auto& q : queries) {
+        reference.BuildAsyncRows(expected, q);
+        byId.BuildAsyncRows(got, q);
+        if (expected.empty() || Ids(got) != Ids(expected)) return rc;
+        bySymbol.BuildAsyncRows(got, q);
+        if (Ids(got) != Ids(expected)) return rc + 1;
+        rc += 2;
+    }
+
+    // Symbol order: (symbol, ts) is unique here as well
+    for (Order order : {Order::SymbolAsc, Order::SymbolDesc}) {
+        Query q;
+        q.order = order;
+        reference.BuildAsyncRows(expected, q);
+        byId.BuildAsyncRows(got, q);
+        if (Ids(got) != Ids(expected)) return 50;
+    }
+
+    // Tie-heavy data: few distinct ts/price values, rows inserted out of id order and some moved
+    // onto existing values; every order still matches the unsharded model (ties break by id)
+    {
+        auto tiedTick = [](int64_t id) {
+            return db::MarketDataCacheEntry{id, kSymbols[id % 3], kVenues[(id / 3) % 2], 1000 + id % 4,
+                                            100.0 + static_cast<double>(id % 3)};
+        };
+        db::MarketDataMultiIndexTableModel tiedRef(2000);
+        db::ShardedMarketDataTableModel tiedById(2000, 4, ShardKey::Id);
+        db::ShardedMarketDataTableModel tiedBySymbol(2000, 3, ShardKey::Symbol);
+        for (int64_t i = 0; i < 600; i++) {
+            const int64_t id = (i * 247) % 600 + 1;
+            tiedRef.Upsert(tiedTick(id));
+            tiedById.Upsert(tiedTick(id));
+            tiedBySymbol.Upsert(tiedTick(id));
+        }
+        for (int64_t id = 600; id >= 1; id -= 7) {
+            auto tick = tiedTick(id);
+            tick.ts = 1000 + (id + 1) % 4;
+            tick.price = 100.0 + static_cast<double>((id + 2) % 3);
+            tiedRef.Upsert(tick);
+            tiedById.Upsert(tick);
+            tiedBySymbol.Upsert(tick);
+        }
+        for (Order order : {Order::TsAsc, Order::TsDesc, Order::PriceAsc, Order::PriceDesc, Order::SymbolAsc,
+                            Order::SymbolDesc}) {
+            Query q;
+            q.order = order;
+            for (int variant = 0; variant < 2; variant++) {
+                tiedRef.BuildAsyncRows(expected, q);
+                tiedById.BuildAsyncRows(got, q);
+                if (expected.empty() || Ids(got) != Ids(expected)) return 60;
+                tiedBySymbol.BuildAsyncRows(got, q);
+                if (Ids(got) != Ids(expected)) return 61;
+                q.symbolEq = "MSFT";
+                q.venueEq = "BATS";
+                q.offset = 3;
+                q.limit = 25;
+            }
+        }
+    }
+
+    // Recency order is approximate across shards but must still list every row once
+    Query recent;
+    recent.order = Order::LruMostRecentFirst;
+    byId.BuildAsyncRows(got, recent);
+    if (got.size() != 1000) return 51;
+
+    if (!byId.EraseById(10) || byId.EraseById(10) || byId.FindById(10)) return 52;
+    if (!bySymbol.EraseById(10) || bySymbol.FindById(10) || !bySymbol.FindById(11)) return 53;
+    if (bySymbol.FindById(12)->symbol != MakeTick(12).symbol) return 54;
+
+    // Concurrent writers on all shards plus a merging reader
+    db::ShardedMarketDataTableModel concurrent(100000, 8);
+    std::vector<std::thread> threads;
+    for (int w = 0; w < 4; w++) {
+        threads.emplace_back([&, w] {
+            for (int64_t i = 0; i < 5000; i++) concurrent.Upsert(MakeTick(i * 4 + w + 1));
+        });
+    }
+    threads.emplace_back([&] {
+        std::vector<db::AsyncTableWidget::Row> rows;
+        Query q;
+        q.order = Order::TsDesc;
+        for (int i = 0; i < 50; i++) concurrent.BuildAsyncRows(rows, q);
+    });
+    for (auto& t : threads) t.join();
+    if (concurrent.Size() != 20000) return 55;
+    return 0;
+}
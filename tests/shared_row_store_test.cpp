@@ -0,0 +1,75 @@
+#include "database/async_table_widget.h"
+#include "database/shared_row_store.h"
+
+#include <any>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+static std::vector<int64_t> DisplayedIds(const db::AsyncTableWidget& widget) {
+    std::vector<int64_t> ids;
+    widget.ForEachRow([&](const db::AsyncTableWidget::Row& row) { ids.push_back(std::any_cast<int64_t>(row.userData)); });
+    return ids;
+}
+
+static void ConfigureIdColumn(db::AsyncTableWidget& widget) {
+    widget.AddColumn("ID");
+    widget.SetColumnTypedExtractor(0, [](const db::AsyncTableWidget::Row& row) { return row.userData; });
+}
+
+int main() {
+    int ingests = 0;
+    std::vector<int64_t> source = {3, 1, 4, 5, 2};
+
+    auto store = std::make_shared<db::SharedRowStore>();
+    store->SetRefreshCallback([&](auto& rows) {
+        ingests++;
+        for (int64_t id : source) rows.push_back({{std::to_string(id)}, std::any(id)});
+    });
+
+    db::AsyncTableWidget ascending;
+    db::AsyncTableWidget oddDescending;
+    ConfigureIdColumn(ascending);
+    ConfigureIdColumn(oddDescending);
+    store->AttachView(ascending);
+    store->AttachView(oddDescending);
+    ascending.SetSort(0, ImGuiSortDirection_Ascending);
+    oddDescending.SetSort(0, ImGuiSortDirection_Descending);
+    oddDescending.SetRowFilter([](const db::AsyncTableWidget::Row& row) { return std::any_cast<int64_t>(row.userData) % 2 != 0; });
+
+    // One ingest feeds both views
+    store->Refresh();
+    ascending.Refresh();
+    oddDescending.Refresh();
+    if (ingests != 1) return 1;
+    if (DisplayedIds(ascending) != std::vector<int64_t>{1, 2, 3, 4, 5}) return 2;
+    if (DisplayedIds(oddDescending) != std::vector<int64_t>{5, 3, 1}) return 3;
+
+    // Both views reference the store's rows instead of copying them
+    const auto snapshot = store->GetSnapshot();
+    if (!snapshot) return 4;
+    const db::AsyncTableWidget::Row* begin = snapshot->chunks[0]->data();
+    const db::AsyncTableWidget::Row* end = begin + snapshot->chunks[0]->size();
+    bool shared = true;
+    auto inStore = [&](const db::AsyncTableWidget::Row& row) { shared = shared && &row >= begin && &row < end; };
+    ascending.ForEachRow(inStore);
+    oddDescending.ForEachRow(inStore);
+    if (!shared) return 4;
+
+    // A sort change only re-sorts the view; the store is not queried again
+    ascending.SetSort(0, ImGuiSortDirection_Descending);
+    ascending.Refresh();
+    if (ingests != 1 || DisplayedIds(ascending) != std::vector<int64_t>{5, 4, 3, 2, 1}) return 5;
+
+    // New snapshot: views pick it up on their next refresh and keep their own order/filter
+    source = {7, 6, 9};
+    store->Refresh();
+    ascending.Refresh();
+    oddDescending.Refresh();
+    if (DisplayedIds(ascending) != std::vector<int64_t>{9, 7, 6}) return 6;
+    if (DisplayedIds(oddDescending) != std::vector<int64_t>{9, 7}) return 7;
+    if (snapshot->rowCount != 5) return 8; // earlier snapshot stays valid while referenced
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include "database/async_table_widget.h"
+#include "database/style_rules.h"
+
+#include <any>
+#include <optional>
+#include <vector>
+
+int main() {
+    const ImU32 green = IM_COL32(0, 255, 0, 255);
+    const ImU32 red = IM_COL32(255, 0, 0, 255);
+    const ImU32 grey = IM_COL32(128, 128, 128, 255);
+    const std::vector<double> values = {150.0, 100.0, 0.5, -3.0};
+    auto valueOf = [&](size_t row, int col) -> std::optional<double> {
+        if (col == 1) return values[row];
+        return std::nullopt;
+    };
+
+    db::RowStyler styler;
+    if (styler.Apply(values.size(), 2, valueOf)) return 1; // no rules, no styles
+
+    // Thresholds are exclusive, ranges inclusive; first matching rule wins per target
+    styler.SetRules({
+        db::StyleRule::Above(1, 100.0, green),
+        db::StyleRule::Between(1, -1.0, 100.0, 0, grey),
+        db::StyleRule::Above(1, 0.0, red),
+        db::StyleRule::Below(1, 0.0, red).WholeRow(),
+        db::StyleRule::Above(0, 0.0, red), // column without numeric values never matches
+    });
+    auto styles = styler.Apply(values.size(), 2, valueOf);
+    if (!styles || styles->rowCount() != 4 || styles->cells.size() != 8) return 2;
+    if (styles->Cell(0, 1).bg != green || styles->Cell(0, 1).text != 0) return 3;
+    if (styles->Cell(1, 1).text != grey || styles->Cell(1, 1).bg != 0) return 4;
+    if (styles->Cell(2, 1).text != grey) return 5;
+    if (styles->Cell(3, 1).bg != 0 || styles->Row(3).bg != red) return 6;
+    if (styles->Row(0).bg != 0 || styles->Cell(0, 0).bg != 0) return 7;
+
+    // Row-only rules allocate no per-cell array
+    styler.SetRules({db::StyleRule::Below(1, 0.0, red).WholeRow()});
+    styles = styler.Apply(values.size(), 2, valueOf);
+    if (!styles->cells.empty() || styles->Cell(3, 1).bg != 0 || styles->Row(3).bg != red) return 8;
+
+    // Widget: rules read the typed extractors during Refresh (and SetData)
+    db::AsyncTableWidget widget;
+    widget.AddColumn("Value");
+    widget.SetColumnTypedExtractor(0, [](const db::AsyncTableWidget::Row& row) { return row.userData; });
+    widget.SetStyleRules({db::StyleRule::Above(0, 10.0, green)});
+    widget.SetRefreshCallback([](auto& rows) {
+        rows.push_back({{"5"}, std::any(5.0)});
+        rows.push_back({{"50"}, std::any(50.0)});
+    });
+    widget.Refresh();
+    if (widget.GetRowCount() != 2) return 9;
+
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include "database/async_table_widget.h"
+#include "database/table_codec.h"
+
+#include <sqlite3.h>
+#include <sqlpp23/core/name/create_name_tag.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Covers the column kinds test_db::Foo_ lacks: unsigned and nullable columns
+struct Sample_ {
+    struct Id {
+        SQLPP_CREATE_NAME_TAG_FOR_SQL_AND_CPP(id, Id);
+        using data_type = ::sqlpp::integral;
+        using has_default = std::true_type;
+    };
+    struct SeqNo {
+        SQLPP_CREATE_NAME_TAG_FOR_SQL_AND_CPP(seq_no, SeqNo);
+        using data_type = ::sqlpp::unsigned_integral;
+        using has_default = std::true_type;
+    };
+    struct Score {
+        SQLPP_CREATE_NAME_TAG_FOR_SQL_AND_CPP(score, Score);
+        using data_type = std::optional<::sqlpp::floating_point>;
+        using has_default = std::true_type;
+    };
+    struct Note {
+        SQLPP_CREATE_NAME_TAG_FOR_SQL_AND_CPP(note, Note);
+        using data_type = std::optional<::sqlpp::text>;
+        using has_default = std::true_type;
+    };
+
+    SQLPP_CREATE_NAME_TAG_FOR_SQL_AND_CPP(samples, samples);
+
+    template <typename T>
+    using _table_columns = sqlpp::table_columns<T, Id, SeqNo, Score, Note>;
+    using _required_insert_columns = sqlpp::detail::type_set<>;
+};
+
+using SampleCodec = db::TableCodec<Sample_>;
+
+static std::vector<std::int64_t> DisplayedIds(const db::AsyncTableWidget& widget) {
+    std::vector<std::int64_t> ids;
+    widget.ForEachRow([&](const db::AsyncTableWidget::Row& row) {
+        ids.push_back(std::any_cast<const SampleCodec::Row&>(row.userData).get<Sample_::Id>());
+    });
+    return ids;
+}
+
+int main() {
+    // Header labels are derived from the SQL names
+    if (SampleCodec::HeaderLabel(0) != "ID" || SampleCodec::HeaderLabel(1) != "Seq No" ||
+        SampleCodec::HeaderLabel(3) != "Note") {
+        return 1;
+    }
+    if (SampleCodec::SelectSql() != "SELECT id, seq_no, score, note FROM samples") return 2;
+
+    sqlite3* conn = nullptr;
+    if (sqlite3_open(":memory:", &conn) != SQLITE_OK) return 3;
+    // seq_no values whose text order differs from their numeric order
+    sqlite3_exec(conn,
+                 "CREATE TABLE samples (id BIGINT, seq_no BIGINT, score DOUBLE, note TEXT);"
+                 "INSERT INTO samples VALUES (1, 100, 2.5, 'a'), (2, 9, NULL, NULL), (3, 10, 0.5, 'c');",
+                 nullptr, nullptr, nullptr);
+
+    // SQL NULL decodes to std::nullopt and renders as an empty cell
+    std::vector<db::AsyncTableWidget::Row> rows;
+    SampleCodec::Query(conn, rows, " ORDER BY id");
+    if (rows.size() != 3) return 4;
+    const auto& withValues = std::any_cast<const SampleCodec::Row&>(rows[0].userData);
+    const auto& withNulls = std::any_cast<const SampleCodec::Row&>(rows[1].userData);
+    if (withValues.get<Sample_::SeqNo>() != 100u || withValues.get<Sample_::Score>() != 2.5 ||
+        withValues.get<Sample_::Note>() != "a") {
+        return 5;
+    }
+    if (withNulls.get<Sample_::Score>().has_value() || withNulls.get<Sample_::Note>().has_value()) return 6;
+    if (rows[1].columns[2] != "" || rows[1].columns[3] != "" || rows[0].columns[1] != "100") return 7;
+
+    // NULL sorts before any value; two NULLs compare equal
+    const auto& third = std::any_cast<const SampleCodec::Row&>(rows[2].userData);
+    if (SampleCodec::CompareColumn(withNulls, withValues, 2) != -1) return 8;
+    if (SampleCodec::CompareColumn(withValues, withNulls, 3) != 1) return 9;
+    if (SampleCodec::CompareColumn(withNulls, withNulls, 2) != 0) return 10;
+    if (SampleCodec::CompareColumn(third, withValues, 1) != -1) return 11;
+    if (SampleCodec::CompareColumn(third, withValues, 2) != -1) return 11;
+
+    // Sort keys are types the widget compares natively: uint64 as int64, optional unwrapped
+    {
+        db::AsyncTableWidget widget;
+        SampleCodec::ConfigureAsyncTableColumns(widget);
+        widget.SetRefreshCallback([conn](auto& out) { SampleCodec::Query(conn, out, " ORDER BY id"); });
+        widget.SetSort(1, ImGuiSortDirection_Ascending);
+        widget.Refresh();
+        if (DisplayedIds(widget) != std::vector<std::int64_t>{2, 3, 1}) return 12;
+
+        widget.SetRefreshCallback([conn](auto& out) { SampleCodec::Query(conn, out, " WHERE score IS NOT NULL"); });
+        widget.SetSort(2, ImGuiSortDirection_Descending);
+        widget.Refresh();
+        if (DisplayedIds(widget) != std::vector<std::int64_t>{1, 3}) return 13;
+    }
+
+    // ORDER BY from sort specs; any out-of-range column drops the whole clause
+    using Spec = db::AsyncTableWidget::SortSpec;
+    std::vector<Spec> specs(2);
+    specs[0].columnIndex = 1;
+    specs[0].direction = ImGuiSortDirection_Descending;
+    specs[1].columnIndex = 0;
+    specs[1].direction = ImGuiSortDirection_Ascending;
+    if (SampleCodec::OrderByClause(specs) != " ORDER BY seq_no DESC, id ASC") return 14;
+    specs[1].columnIndex = static_cast<int>(SampleCodec::kColumnCount);
+    if (!SampleCodec::OrderByClause(specs).empty()) return 15;
+    specs[1].columnIndex = -1;
+    if (!SampleCodec::OrderByClause(specs).empty()) return 16;
+    if (!SampleCodec::OrderByClause({}).empty()) return 17;
+
+    sqlite3_close(conn);
+    return 0;
+}
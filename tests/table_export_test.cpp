@@ -0,0 +1,115 @@
+#include "database/async_table_widget.h"
+#include "database/table_export.h"
+
+#include <any>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static bool WaitFinished(const db::ExportJob& job) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (!job.IsFinished()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+static std::string ReadFile(const std::filesystem::path& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+int main() {
+    const auto dir = std::filesystem::temp_directory_path() / "table_export_test_files";
+    std::filesystem::create_directories(dir);
+
+    db::AsyncTableWidget widget;
+    widget.AddColumn("ID");
+    widget.AddColumn("Name");
+    widget.EnableSelection(true);
+    std::vector<db::AsyncTableWidget::Row> rows;
+    for (int64_t i = 0; i < 20000; i++) {
+        rows.push_back({{std::to_string(i), i == 7 ? "a, \"quoted\"\tname" : "n" + std::to_string(i)}, std::any(i)});
+    }
+    widget.SetData(std::move(rows));
+
+    // 1) CSV of the whole snapshot, with RFC 4180 quoting
+    {
+        auto job = widget.ExportAsync((dir / "all.csv").string(), db::ExportFormat::Csv);
+        if (!job || !WaitFinished(*job) || job->GetState() != db::ExportJob::State::Succeeded) return 1;
+        std::string csv = ReadFile(dir / "all.csv");
+        if (std::count(csv.begin(), csv.end(), '\n') != 20001) return 2;
+        if (csv.rfind("ID,Name\n0,n0\n", 0) != 0) return 3;
+        if (csv.find("\n7,\"a, \"\"quoted\"\"\tname\"\n") == std::string::npos) return 3;
+        if (job->GetProcessed() != 20000 || job->GetBytesWritten() != csv.size()) return 4;
+        if (std::filesystem::exists(dir / "all.csv.part")) return 4;
+    }
+
+    // 2) Selection only, TSV, in display order
+    widget.GetSelection().SetItemSelected(19999, true);
+    widget.GetSelection().SetItemSelected(7, true);
+    {
+        auto job = widget.ExportAsync((dir / "sel.tsv").string(), db::ExportFormat::Tsv, true);
+        if (!WaitFinished(*job)) return 5;
+        if (ReadFile(dir / "sel.tsv") != "ID\tName\n7\ta, \"quoted\" name\n19999\tn19999\n") return 5;
+    }
+
+    // 3) Oversized clipboard copies fall back to a background TSV export
+    widget.SetClipboardLimit(16, (dir / "clip.tsv").string());
+    {
+        auto job = widget.CopySelectionToClipboard();
+        if (!job || !WaitFinished(*job) || job->GetState() != db::ExportJob::State::Succeeded) return 6;
+        if (ReadFile(dir / "clip.tsv") != ReadFile(dir / "sel.tsv")) return 6;
+    }
+
+    // 4) Columnar: header, then row groups of per-column lengths + bytes
+    {
+        std::vector<std::vector<std::string>> data = {{"1", "x"}, {"22", ""}, {"333", "zz"}};
+        db::ExportJob job;
+        db::RunTableExport((dir / "t.kscol").string(), db::ExportFormat::Columnar, {"A", "B"}, data.size(),
+                           [&](size_t i) -> const std::vector<std::string>& { return data[i]; }, job, 1 << 20, 2);
+        std::string bin = ReadFile(dir / "t.kscol");
+        auto u32At = [&](size_t off) {
+            uint32_t v;
+            std::memcpy(&v, bin.data() + off, 4);
+            return v;
+        };
+        if (job.GetState() != db::ExportJob::State::Succeeded || bin.compare(0, 6, "KSCOL1") != 0) return 7;
+        if (u32At(8) != 2) return 7;
+        size_t off = 8 + 4 + 8 + (4 + 1) * 2;
+        // Group 1: 2 rows; column A lengths 1,2 + "122"; column B lengths 1,0 + "x"
+        if (u32At(off) != 2 || u32At(off + 4) != 1 || u32At(off + 8) != 2 || bin.compare(off + 12, 3, "122") != 0) return 8;
+        off += 15;
+        if (u32At(off) != 1 || u32At(off + 4) != 0 || bin.compare(off + 8, 1, "x") != 0) return 8;
+        off += 9;
+        // Group 2: 1 row
+        if (u32At(off) != 1 || u32At(off + 4) != 3 || bin.compare(off + 8, 3, "333") != 0) return 9;
+        if (bin.size() != off + 11 + 4 + 2) return 9;
+    }
+
+    // 5) Cancel mid-export: no output file, no partial file
+    {
+        std::vector<std::string> cells = {"v"};
+        db::ExportJob job;
+        db::RunTableExport((dir / "cancel.csv").string(), db::ExportFormat::Csv, {"V"}, 100000,
+                           [&](size_t i) -> const std::vector<std::string>& {
+                               if (i == 500) job.Cancel();
+                               return cells;
+                           },
+                           job, 64);
+        if (job.GetState() != db::ExportJob::State::Cancelled || job.GetProcessed() >= 100000) return 10;
+        if (std::filesystem::exists(dir / "cancel.csv") || std::filesystem::exists(dir / "cancel.csv.part")) return 10;
+    }
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
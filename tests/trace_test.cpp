@@ -0,0 +1,94 @@
+#include "database/trace.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+static bool Contains(const std::string& s, const std::string& part) { return s.find(part) != std::string::npos; }
+
+int main() {
+    using db::Trace;
+
+    // Naming threads and recording while disabled allocates no rings
+    Trace::SetThreadName("main");
+    for (int i = 0; i < 20; i++) {
+        std::thread([] {
+            Trace::SetThreadName("short-lived");
+            KS_TRACE_SCOPE("test", "ignored");
+            Trace::Instant("test", "ignored");
+        }).join();
+    }
+    if (Trace::RingCount() != 0 || Trace::EventCount() != 0) return 1;
+    // Exited threads without events are pruned as new ones register: main + the last one
+    if (Trace::ThreadCount() > 2) return 2;
+
+    // Spans, instants and flows are recorded once enabled
+    Trace::SetEnabled(true);
+    const std::uint64_t flow = Trace::NextFlowId();
+    {
+        KS_TRACE_SCOPE("model", "Upsert", "id \"7\"\n");
+        Trace::Instant("feed", "gap");
+        Trace::Flow("feed", "tick", 's', flow);
+    }
+    std::thread([flow] {
+        Trace::SetThreadName("worker \\ 1");
+        Trace::Flow("feed", "tick", 'f', flow);
+    }).join();
+    if (Trace::RingCount() != 2 || Trace::EventCount() != 4) return 3;
+
+    const std::string json = Trace::ToChromeJson();
+    if (!Contains(json, "\"name\":\"thread_name\"") || !Contains(json, "\"args\":{\"name\":\"main\"}")) return 4;
+    if (!Contains(json, "\"args\":{\"name\":\"worker \\\\ 1\"}")) return 5;
+    if (!Contains(json, "\"ph\":\"X\",\"cat\":\"model\",\"name\":\"Upsert\"") || !Contains(json, "\"dur\":")) return 6;
+    if (!Contains(json, "\"args\":{\"detail\":\"id \\\"7\\\"\\n\"}")) return 7;
+    if (!Contains(json, "\"ph\":\"i\"") || !Contains(json, "\"s\":\"t\"")) return 8;
+    const std::string id = ",\"id\":" + std::to_string(flow);
+    if (!Contains(json, "\"ph\":\"s\"") || !Contains(json, "\"ph\":\"f\"") || !Contains(json, id) ||
+        !Contains(json, "\"bp\":\"e\"")) {
+        return 9;
+    }
+    if (!Trace::Enabled()) return 10; // export restores the flag
+
+    // The ring keeps the newest kEventsPerThread events
+    Trace::Clear();
+    if (Trace::EventCount() != 0 || Trace::ThreadCount() != 1) return 11; // the exited worker is dropped
+    for (std::size_t i = 0; i < Trace::kEventsPerThread + 10; i++) {
+        Trace::Instant("test", "fill", std::to_string(i));
+    }
+    if (Trace::EventCount() != Trace::kEventsPerThread) return 12;
+    const std::string full = Trace::ToChromeJson();
+    if (Contains(full, "\"detail\":\"9\"}") || !Contains(full, "\"detail\":\"10\"}") ||
+        !Contains(full, "\"detail\":\"" + std::to_string(Trace::kEventsPerThread + 9) + "\"}")) {
+        return 13;
+    }
+    Trace::Clear();
+
+    // Enable/disable handshake: writers race exports, clears and toggles without torn events
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 3; t++) {
+        writers.emplace_back([&] {
+            while (!stop) {
+                KS_TRACE_SCOPE("test", "span", "0123456789");
+            }
+        });
+    }
+    for (int i = 0; i < 50; i++) {
+        const std::string out = Trace::ToChromeJson();
+        if (out.empty() || !Contains(out, "\"traceEvents\":[")) return 14;
+        if (Contains(out, "\"name\":\"span\"") && !Contains(out, "\"detail\":\"0123456789\"")) return 15;
+        if (i % 10 == 0) Trace::Clear();
+        Trace::SetEnabled(i % 3 != 0);
+    }
+    stop = true;
+    for (auto& w : writers) w.join();
+
+    Trace::SetEnabled(false);
+    const std::size_t before = Trace::EventCount();
+    {
+        KS_TRACE_SCOPE("test", "after disable");
+    }
+    if (Trace::EventCount() != before) return 16;
+    return 0;
+}